@@ -402,3 +402,54 @@ substring(const char *str, long lo, long hi)
 
 	return subs;
 }
+
+/* The finalizer of MurmurHash3, makes all bits avalanche. */
+static inline unsigned long
+hash_fmix(unsigned long hash)
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdUL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53UL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+/* 
+ * Returns a 64-bit hash code of the string.
+ * It is the FNV-1a hash followed by the finalizer of MurmurHash3, 
+ * so the low bits can be used directly as the index of 
+ * a power-of-two sized table.
+ */
+unsigned long
+string_hash(const char *str)
+{
+	unsigned long hash = 0xcbf29ce484222325UL;	/* FNV offset basis */
+
+	while (*str != '\0') {
+		hash ^= (unsigned char)*str++;
+		hash *= 0x100000001b3UL;		/* FNV prime */
+	}
+
+	return hash_fmix(hash);
+}
+
+/* 
+ * Returns a 64-bit hash code of the LEN bytes that KEY points to,
+ * the same way as string_hash().
+ */
+unsigned long
+bytes_hash(const void *key, size_t len)
+{
+	const unsigned char *ptr = (const unsigned char *)key;
+	unsigned long hash = 0xcbf29ce484222325UL;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= ptr[i];
+		hash *= 0x100000001b3UL;
+	}
+
+	return hash_fmix(hash);
+}
@@ -0,0 +1,85 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "bloomfilter.h"
+
+#define CACHE_LINE	64
+
+/* 
+ * Initializes an empty Bloom filter sized for NKEYS keys and the 
+ * false positive rate FPRATE. A classic filter needs log2(1/p) bits 
+ * set per key and log2(1/p) / ln(2) bits per key, the blocked one 
+ * is given 20% more bits to make up for the uneven load of its blocks.
+ */
+void
+bloom_init(struct bloom_filter *bf, unsigned long nkeys, double fprate,
+	bloom_hash_ft *hash)
+{
+	unsigned long bits;
+	double p;
+	int k;
+
+	assert(fprate > 0.0 && fprate < 1.0);
+
+	for (k = 0, p = 1.0; p > fprate; k++)
+		p /= 2.0;
+	bits = (unsigned long)((double)(nkeys + 1) * (double)k * 
+		1.4427 * 1.2);
+
+	if (k > BLOOM_MAX_HASHES)
+		k = BLOOM_MAX_HASHES;
+
+	bf->nhashes = k;
+	bf->nblocks = (bits + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+	bf->hash = hash;
+	bf->blocks = (struct bloom_block *)aligned_alloc(CACHE_LINE,
+		bf->nblocks * sizeof(struct bloom_block));
+	if (bf->blocks == NULL)
+		errmsg_exit("Memory allocated failure, %s\n", 
+			strerror(errno));
+	bloom_reset(bf);
+}
+
+/* Removes all keys from this Bloom filter. */
+void
+bloom_reset(struct bloom_filter *bf)
+{
+	memset(bf->blocks, 0, bf->nblocks * sizeof(struct bloom_block));
+}
+
+/* Clears this Bloom filter. */
+void
+bloom_clear(struct bloom_filter *bf)
+{
+	free(bf->blocks);
+	bf->blocks = NULL;
+	bf->nblocks = 0;
+}
@@ -0,0 +1,84 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "zipf.h"
+#include <math.h>
+
+/* Initializes a Zipf generator over N ranks. */
+void
+zipf_init(struct zipf_gen *zg, unsigned long n, double skew)
+{
+	unsigned long i;
+	double sum = 0.0;
+
+	assert(n > 0);
+
+	zg->n = n;
+	zg->skew = skew;
+	zg->cdf = (double *)algmalloc(n * sizeof(double));
+	for (i = 0; i < n; i++) {
+		sum += 1.0 / pow((double)(i + 1), skew);
+		zg->cdf[i] = sum;
+	}
+	for (i = 0; i < n; i++)
+		zg->cdf[i] /= sum;
+}
+
+/* 
+ * Returns a random rank, 
+ * by binary search over the cumulative probabilities.
+ */
+unsigned long
+zipf_next(const struct zipf_gen *zg)
+{
+	unsigned long lo = 0, hi = zg->n - 1, mid;
+	double u;
+
+	u = ((double)rand() * ((double)RAND_MAX + 1.0) + (double)rand()) /
+		(((double)RAND_MAX + 1.0) * ((double)RAND_MAX + 1.0));
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (zg->cdf[mid] < u)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* Clears the Zipf generator. */
+void
+zipf_clear(struct zipf_gen *zg)
+{
+	ALGFREE(zg->cdf);
+	zg->n = 0;
+}
@@ -0,0 +1,640 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "lineprobhash.h"
+#include "separatechainhash.h"
+#include "robinhoodhash.h"
+#include "swisstablehash.h"
+#include "bucketchainhash.h"
+#include "cuckoohash.h"
+#include "hashmap.h"
+#include "concurrenthash.h"
+#include "zipf.h"
+
+/* The number of lookups per mix. */
+#define LOOKUPS		(1UL << 20)
+
+#define NLOADS		4
+#define NTABLES		8
+
+/* The operations of a hash table under test. */
+struct table_ops {
+	const char *name;
+	void (*init)(unsigned long);	/* initializes by capacity */
+	void (*put)(const struct element *);
+	bool (*get)(const char *);	/* returns true on a hit */
+	unsigned long (*probes)(const char *);
+	double (*load)(void);		/* current load factor */
+	void (*clear)(void);
+};
+
+static struct line_prob_hash lph;
+static struct schain_hash sch;
+static struct robin_hood_hash rhh;
+static struct swiss_table swt;
+static struct bchain_hash bch;
+static struct cuckoo_hash ckh;
+static struct hash_map hm;
+static struct concurrent_hash ch;
+
+static struct element *els;	/* distinct keys, zero padded */
+static struct element *misses;	/* keys never inserted */
+static const char **queries;	/* keys of a lookup mix */
+
+static void lp_init(unsigned long);
+static void lp_put(const struct element *);
+static bool lp_get(const char *);
+static unsigned long lp_probes(const char *);
+static double lp_load(void);
+static void lp_clear(void);
+static void sc_init(unsigned long);
+static void sc_put(const struct element *);
+static bool sc_get(const char *);
+static unsigned long sc_probes(const char *);
+static double sc_load(void);
+static void sc_clear(void);
+static void rh_init(unsigned long);
+static void rh_put(const struct element *);
+static bool rh_get(const char *);
+static unsigned long rh_probes(const char *);
+static double rh_load(void);
+static void rh_clear(void);
+static void sw_init(unsigned long);
+static void sw_put(const struct element *);
+static bool sw_get(const char *);
+static unsigned long sw_probes(const char *);
+static double sw_load(void);
+static void sw_clear(void);
+static void bc_init(unsigned long);
+static void bc_put(const struct element *);
+static bool bc_get(const char *);
+static unsigned long bc_probes(const char *);
+static double bc_load(void);
+static void bc_clear(void);
+static void ck_init(unsigned long);
+static void ck_put(const struct element *);
+static bool ck_get(const char *);
+static unsigned long ck_probes(const char *);
+static double ck_load(void);
+static void ck_clear(void);
+static void hm_init(unsigned long);
+static void hm_put(const struct element *);
+static bool hm_get(const char *);
+static unsigned long hm_probes(const char *);
+static double hm_load(void);
+static void hm_clear(void);
+static void ch_init(unsigned long);
+static void ch_put(const struct element *);
+static bool ch_get(const char *);
+static unsigned long ch_probes(const char *);
+static double ch_load(void);
+static void ch_clear(void);
+
+static const struct table_ops tables[NTABLES] = {
+	{"linear-probing", lp_init, lp_put, lp_get, lp_probes, lp_load,
+		lp_clear},
+	{"separate-chains", sc_init, sc_put, sc_get, sc_probes, sc_load,
+		sc_clear},
+	{"robin-hood", rh_init, rh_put, rh_get, rh_probes, rh_load,
+		rh_clear},
+	{"swiss-table", sw_init, sw_put, sw_get, sw_probes, sw_load,
+		sw_clear},
+	{"bucket-chains", bc_init, bc_put, bc_get, bc_probes, bc_load,
+		bc_clear},
+	{"cuckoo", ck_init, ck_put, ck_get, ck_probes, ck_load, ck_clear},
+	{"hash-map", hm_init, hm_put, hm_get, hm_probes, hm_load, hm_clear},
+	{"concurrent", ch_init, ch_put, ch_get, ch_probes, ch_load,
+		ch_clear}
+};
+
+static unsigned long next_prime(unsigned long);
+static unsigned long read_keys(const char *);
+static void make_queries(unsigned long, int, const struct zipf_gen *);
+static double run_lookups(const struct table_ops *);
+
+int
+main(int argc, char *argv[])
+{
+	const double loads[NLOADS] = {0.25, 0.50, 0.75, 0.90};
+	const struct table_ops *t;
+	struct zipf_gen zg;
+	unsigned long nkeys, n, cap, i, p, sum, max;
+	int hitpct, k, l, f;
+	double skew, ins, uni, zpf;
+	clock_t start_time, end_time;
+
+	if (argc < 4)
+		errmsg_exit("Usage: %s <hit percent> <zipf skew> <file>...\n",
+			argv[0]);
+
+	if (sscanf(argv[1], "%d", &hitpct) != 1 || hitpct < 0 || 
+		hitpct > 100)
+		errmsg_exit("Illegal hit percent, %s\n", argv[1]);
+	if (sscanf(argv[2], "%lf", &skew) != 1 || skew <= 0.0)
+		errmsg_exit("Illegal zipf skew, %s\n", argv[2]);
+
+	SET_RANDOM_SEED;
+	queries = (const char **)algmalloc(LOOKUPS * sizeof(char *));
+
+	/* every file holds keys of another length */
+	for (f = 3; f < argc; f++) {
+		nkeys = read_keys(argv[f]);
+		printf("File \"%s\": %lu distinct keys of length %lu, "
+			"%d%% hits, zipf skew %.2f\n", argv[f], nkeys,
+			(unsigned long)strlen(els[0].key), hitpct, skew);
+
+		for (l = 0; l < NLOADS; l++) {
+			/* the largest capacity filled to this load factor */
+			for (cap = 16; loads[l] * (double)(cap * 2) <= 
+				(double)nkeys; cap *= 2)
+				;
+			n = (unsigned long)(loads[l] * (double)cap);
+			if (n > nkeys)
+				continue;
+
+			printf("\nLoad factor %.2f, capacity %lu, %lu keys\n",
+				loads[l], cap, n);
+			printf("%-16s %6s %10s %10s %10s %8s %6s\n", "table",
+				"load", "put Mop/s", "uni Mop/s", "zipf Mop/s",
+				"avg prb", "max");
+
+			zipf_init(&zg, n, skew);
+			for (k = 0; k < NTABLES; k++) {
+				t = &tables[k];
+				t->init(cap);
+				start_time = clock();
+				for (i = 0; i < n; i++)
+					t->put(&els[i]);
+				end_time = clock();
+				ins = (double)n / ((double)(end_time - 
+					start_time) / CLOCKS_PER_SEC) / 1e6;
+
+				make_queries(n, hitpct, NULL);
+				uni = run_lookups(t);
+				for (i = 0, sum = 0, max = 0; i < LOOKUPS; i++) {
+					p = t->probes(queries[i]);
+					sum += p;
+					if (p > max)
+						max = p;
+				}
+
+				make_queries(n, hitpct, &zg);
+				zpf = run_lookups(t);
+
+				printf("%-16s %6.3f %10.3f %10.3f %10.3f "
+					"%8.3f %6lu\n", t->name, t->load(), ins,
+					uni, zpf, (double)sum / LOOKUPS, max);
+				t->clear();
+			}
+			zipf_clear(&zg);
+		}
+		printf("\n");
+
+		ALGFREE(els);
+		ALGFREE(misses);
+	}
+
+	ALGFREE(queries);
+
+	return 0;
+}
+
+/* 
+ * Returns the smallest prime not less than N. The modular hashing of 
+ * the linear-probing and separate-chains tables only looks at the last 
+ * characters of a key if the table size is a power of 2.
+ */
+static unsigned long
+next_prime(unsigned long n)
+{
+	unsigned long d;
+
+	for (;; n++) {
+		for (d = 2; d * d <= n; d++)
+			if (n % d == 0)
+				break;
+		if (d * d > n)
+			return n;
+	}
+}
+
+/* 
+ * Reads the distinct keys of the file, a missing key is made 
+ * of each of them by a leading '#', which randkeyval never writes.
+ */
+static unsigned long
+read_keys(const char *fname)
+{
+	struct element item;
+	struct swiss_table seen;
+	FILE *fp;
+	unsigned long n = 0, cap = 1024, len;
+
+	fp = open_file(fname, "rb");
+	els = (struct element *)algmalloc(cap * sizeof(struct element));
+	swhash_init(&seen, 0);
+	while (!feof(fp)) {
+		if (fread(&item, sizeof(struct element), 1, fp) == 0)
+			continue;
+		if (swhash_get(&seen, item.key) != NULL)
+			continue;
+		swhash_put(&seen, &item);
+
+		if (n == cap) {
+			cap *= 2;
+			els = (struct element *)algrealloc(els, 
+				cap * sizeof(struct element));
+		}
+		/* zero padded, the hash map compares all the bytes */
+		for (len = 0; len < MAX_KEY_LEN - 1 && item.key[len] != '\0';
+			len++)
+			;
+		memset(els[n].key, 0, MAX_KEY_LEN);
+		memcpy(els[n].key, item.key, len);
+		els[n].value = item.value;
+		n++;
+	}
+	swhash_clear(&seen);
+	close_file(fp);
+
+	if (n == 0)
+		errmsg_exit("No data in \"%s\" file.\n", fname);
+
+	misses = (struct element *)algmalloc(n * sizeof(struct element));
+	memcpy(misses, els, n * sizeof(struct element));
+	for (cap = 0; cap < n; cap++)
+		misses[cap].key[0] = '#';
+
+	return n;
+}
+
+/* 
+ * Fills the lookup mix over the first N keys, 
+ * uniformly if ZG is NULL, or by the Zipf ranks.
+ */
+static void
+make_queries(unsigned long n, int hitpct, const struct zipf_gen *zg)
+{
+	unsigned long i, j;
+
+	for (i = 0; i < LOOKUPS; i++) {
+		if (zg == NULL)
+			j = rand_range_integer(0, (unsigned int)n);
+		else
+			j = zipf_next(zg);
+
+		if ((int)rand_range_integer(0, 100) < hitpct)
+			queries[i] = els[j].key;
+		else
+			queries[i] = misses[j].key;
+	}
+}
+
+/* Returns the million lookups per second of the mix. */
+static double
+run_lookups(const struct table_ops *t)
+{
+	clock_t start_time, end_time;
+	unsigned long i, hits = 0;
+
+	start_time = clock();
+	for (i = 0; i < LOOKUPS; i++)
+		hits += t->get(queries[i]);
+	end_time = clock();
+
+	/* keeps the lookups from being optimized out */
+	if (hits > LOOKUPS)
+		errmsg_exit("Too many hits.\n");
+
+	return (double)LOOKUPS / ((double)(end_time - start_time) / 
+		CLOCKS_PER_SEC) / 1e6;
+}
+
+/******************** the tables under test ********************/
+
+static void
+lp_init(unsigned long cap)
+{
+	cap = next_prime(cap);
+	LPHASH_INIT(&lph, cap);
+	/* an empty slot is the one with an empty key and zero value */
+	memset(lph.items, 0, cap * sizeof(struct element));
+}
+
+static void
+lp_put(const struct element *item)
+{
+	lphash_put(&lph, item);
+}
+
+static bool
+lp_get(const char *key)
+{
+	return lphash_get(&lph, key) != NULL;
+}
+
+static unsigned long
+lp_probes(const char *key)
+{
+	return lphash_probes(&lph, key);
+}
+
+static double
+lp_load(void)
+{
+	return (double)LPHASH_PAIRS(&lph) / (double)LPHASH_SIZE(&lph);
+}
+
+static void
+lp_clear(void)
+{
+	LPHASH_CLEAR(&lph);
+}
+
+static void
+sc_init(unsigned long cap)
+{
+	schash_init(&sch, next_prime(cap));
+}
+
+static void
+sc_put(const struct element *item)
+{
+	schash_put(&sch, item);
+}
+
+static bool
+sc_get(const char *key)
+{
+	return schash_get(&sch, key) != NULL;
+}
+
+static unsigned long
+sc_probes(const char *key)
+{
+	return schash_probes(&sch, key);
+}
+
+static double
+sc_load(void)
+{
+	return (double)SCHASH_PAIRS(&sch) / (double)SCHASH_SIZE(&sch);
+}
+
+static void
+sc_clear(void)
+{
+	schash_clear(&sch);
+}
+
+static void
+rh_init(unsigned long cap)
+{
+	rhhash_init(&rhh, cap);
+}
+
+static void
+rh_put(const struct element *item)
+{
+	rhhash_put(&rhh, item);
+}
+
+static bool
+rh_get(const char *key)
+{
+	return rhhash_get(&rhh, key) != NULL;
+}
+
+static unsigned long
+rh_probes(const char *key)
+{
+	return rhhash_probes(&rhh, key);
+}
+
+static double
+rh_load(void)
+{
+	return (double)RHHASH_PAIRS(&rhh) / (double)RHHASH_SIZE(&rhh);
+}
+
+static void
+rh_clear(void)
+{
+	rhhash_clear(&rhh);
+}
+
+static void
+sw_init(unsigned long cap)
+{
+	swhash_init(&swt, cap);
+}
+
+static void
+sw_put(const struct element *item)
+{
+	swhash_put(&swt, item);
+}
+
+static bool
+sw_get(const char *key)
+{
+	return swhash_get(&swt, key) != NULL;
+}
+
+static unsigned long
+sw_probes(const char *key)
+{
+	return swhash_probes(&swt, key);
+}
+
+static double
+sw_load(void)
+{
+	return (double)SWHASH_PAIRS(&swt) / (double)SWHASH_SIZE(&swt);
+}
+
+static void
+sw_clear(void)
+{
+	swhash_clear(&swt);
+}
+
+static void
+bc_init(unsigned long cap)
+{
+	bchash_init(&bch, cap / BCHASH_BUCKET_SLOTS);
+}
+
+static void
+bc_put(const struct element *item)
+{
+	bchash_put(&bch, item);
+}
+
+static bool
+bc_get(const char *key)
+{
+	return bchash_get(&bch, key) != NULL;
+}
+
+static unsigned long
+bc_probes(const char *key)
+{
+	return bchash_probes(&bch, key);
+}
+
+static double
+bc_load(void)
+{
+	return (double)BCHASH_PAIRS(&bch) / 
+		(double)(BCHASH_SIZE(&bch) * BCHASH_BUCKET_SLOTS);
+}
+
+static void
+bc_clear(void)
+{
+	bchash_clear(&bch);
+}
+
+static void
+ck_init(unsigned long cap)
+{
+	ckhash_init(&ckh, cap);
+}
+
+static void
+ck_put(const struct element *item)
+{
+	ckhash_put(&ckh, item);
+}
+
+static bool
+ck_get(const char *key)
+{
+	return ckhash_get(&ckh, key) != NULL;
+}
+
+static unsigned long
+ck_probes(const char *key)
+{
+	return ckhash_probes(&ckh, key);
+}
+
+static double
+ck_load(void)
+{
+	return (double)CKHASH_PAIRS(&ckh) / (double)CKHASH_SIZE(&ckh);
+}
+
+static void
+ck_clear(void)
+{
+	ckhash_clear(&ckh);
+}
+
+/* 
+ * The keys are stored in place, so they are compared as zero padded.
+ * The map is sized to CAP like the others, it is a power of 2.
+ */
+static void
+hm_init(unsigned long cap)
+{
+	hmap_init(&hm, MAX_KEY_LEN, sizeof(long), NULL, NULL);
+	hmap_reserve(&hm, cap);
+}
+
+static void
+hm_put(const struct element *item)
+{
+	hmap_put(&hm, item->key, &item->value);
+}
+
+static bool
+hm_get(const char *key)
+{
+	return hmap_get(&hm, key) != NULL;
+}
+
+static unsigned long
+hm_probes(const char *key)
+{
+	return hmap_probes(&hm, key);
+}
+
+static double
+hm_load(void)
+{
+	return (double)HMAP_PAIRS(&hm) / (double)HMAP_SIZE(&hm);
+}
+
+static void
+hm_clear(void)
+{
+	hmap_clear(&hm);
+}
+
+static void
+ch_init(unsigned long cap)
+{
+	chash_init(&ch, cap);
+}
+
+static void
+ch_put(const struct element *item)
+{
+	chash_put(&ch, item);
+}
+
+static bool
+ch_get(const char *key)
+{
+	struct element item;
+
+	return chash_get(&ch, key, &item) == 0;
+}
+
+static unsigned long
+ch_probes(const char *key)
+{
+	return chash_probes(&ch, key);
+}
+
+static double
+ch_load(void)
+{
+	return (double)chash_pairs(&ch) / (double)chash_size(&ch);
+}
+
+static void
+ch_clear(void)
+{
+	chash_clear(&ch);
+}
@@ -0,0 +1,163 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "separatechainhash.h"
+#include "bloomfilter.h"
+#include <getopt.h>
+
+#define MISSES		100000
+
+static void usage_info(const char *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct element item;
+	struct schain_hash sch;
+	struct bloom_filter bf;
+	FILE *fp;
+	clock_t start_time, end_time;
+	char *fname = NULL, **misses;
+	double fprate = 0.0;
+	unsigned long n = 0, i, fps;
+
+	int op;
+	const char *optstr = "f:p:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'f':
+			fname = optarg;
+			break;
+		case 'p':
+			if (sscanf(optarg, "%lf", &fprate) != 1 ||
+				fprate <= 0.0 || fprate >= 1.0)
+				errmsg_exit("Illegal rate. -p %s\n", optarg);
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	
+	fp = open_file(fname, "rb");
+	
+	SET_RANDOM_SEED;
+	
+	/* a small table, so the misses walk long chains */
+	schash_init(&sch, 97);
+	
+	printf("Start read data from \"%s\" file to "
+		"the separate-chains hash table.\n", fname);
+	start_time = clock();
+	rewind(fp);
+	while (!feof(fp)) {
+		if (fread(&item, sizeof(struct element), 1, fp) > 0) {
+			schash_put(&sch, &item);
+			n++;
+		}
+	}
+	end_time = clock();
+	printf("Read completed, estimated time(s): %.3f\n\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	/* the keys in the data file never start with '#' */
+	misses = (char **)algmalloc(MISSES * sizeof(char *));
+	for (i = 0; i < MISSES; i++) {
+		misses[i] = rand_string(16);
+		misses[i][0] = '#';
+	}
+	
+	printf("Begin search %d missing keys without a guard.\n", MISSES);
+	start_time = clock();
+	for (i = 0; i < MISSES; i++)
+		if (schash_get(&sch, misses[i]) != NULL)
+			errmsg_exit("Key %s is found.\n", misses[i]);
+	end_time = clock();
+	printf("Search completed, estimated time(s): %.3f\n\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	bloom_init(&bf, n, fprate, NULL);
+	schash_set_guard(&sch, &bf);
+	printf("Attached a Bloom filter of %lu bits, %d bits per key set.\n",
+		BLOOM_BITS(&bf), BLOOM_HASHES(&bf));
+	
+	printf("Begin search %d missing keys with the guard.\n", MISSES);
+	start_time = clock();
+	for (i = 0; i < MISSES; i++)
+		if (schash_get(&sch, misses[i]) != NULL)
+			errmsg_exit("Key %s is found.\n", misses[i]);
+	end_time = clock();
+	printf("Search completed, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	for (i = 0, fps = 0; i < MISSES; i++)
+		if (bloom_contains(&bf, misses[i]))
+			fps++;
+	printf("False positive rate: %.5f (expected %.5f)\n\n",
+		(double)fps / MISSES, fprate);
+	
+	printf("Check all keys are still found with the guard.\n");
+	rewind(fp);
+	while (!feof(fp)) {
+		if (fread(&item, sizeof(struct element), 1, fp) > 0 &&
+			schash_get(&sch, item.key) == NULL)
+			errmsg_exit("Key %s is lost.\n", item.key);
+	}
+	close_file(fp);
+	printf("Total elements: %lu\n", SCHASH_PAIRS(&sch));
+	
+	for (i = 0; i < MISSES; i++)
+		ALGFREE(misses[i]);
+	ALGFREE(misses);
+	bloom_clear(&bf);
+	schash_clear(&sch);
+	
+	return 0;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -f -p\n", pname);
+	fprintf(stderr, "-f: The data file will be read in memory.\n");
+	fprintf(stderr, "-p: The false positive rate of the Bloom filter.\n");
+	exit(EXIT_FAILURE);
+}
@@ -0,0 +1,306 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "bucketchainhash.h"
+#include "queue.h"
+
+#define CACHE_LINE	64
+
+/* The fingerprint uses the high bits, the bucket index the low bits. */
+#define TAG_OF(h)	((unsigned char)((h) >> 56))
+
+static struct bchash_bucket * buckets_alloc(unsigned long);
+static struct element * locate(const struct bchain_hash *, const char *,
+	struct bchash_bucket **, int *);
+static void bucket_add(struct bchash_bucket *, unsigned char,
+	struct element *);
+static void resize(struct bchain_hash *, unsigned long);
+static void chain_free(struct bchash_bucket *);
+
+/* Initializes an empty bucketized separate-chain hash table */
+void
+bchash_init(struct bchain_hash *bch, unsigned long htsize)
+{
+	unsigned long sz;
+
+	for (sz = 1; sz < htsize; sz <<= 1)
+		;
+
+	bch->pairs = 0;
+	bch->size = sz;
+	bch->buckets = buckets_alloc(sz);
+}
+
+/* 
+ * Returns the value associated with the specified key 
+ * in the bucketized separate-chain hash table.
+ */
+struct element * 
+bchash_get(const struct bchain_hash *bch, const char *key)
+{
+	struct bchash_bucket *bk;
+	int slot;
+
+	if (key == NULL)
+		return NULL;
+
+	return locate(bch, key, &bk, &slot);
+}
+
+/* 
+ * Returns the number of buckets visited by searching the key 
+ * in the bucketized separate-chain hash table.
+ */
+unsigned long
+bchash_probes(const struct bchain_hash *bch, const char *key)
+{
+	struct bchash_bucket *bk;
+	unsigned long h, n;
+	int i;
+
+	h = string_hash(key);
+	bk = &bch->buckets[h & (bch->size - 1)];
+	for (n = 1; ; n++) {
+		for (i = 0; i < bk->count; i++)
+			if (bk->tags[i] == TAG_OF(h) &&
+				strcmp(bk->items[i]->key, key) == 0)
+				return n;
+		if ((bk = bk->next) == NULL)
+			break;
+	}
+
+	return n;
+}
+
+/* 
+ * Inserts the specified key-value pair into the bucketized 
+ * separate-chain hash table, overwriting the old value with 
+ * the new value if the table already contains the key.
+ */
+void
+bchash_put(struct bchain_hash *bch, const struct element *item)
+{
+	struct bchash_bucket *bk;
+	struct element *el;
+	unsigned long h;
+	int slot;
+
+	assert(item != NULL);
+
+	if ((el = locate(bch, item->key, &bk, &slot)) != NULL) {
+		el->value = item->value;
+		return;
+	}
+
+	if (bch->pairs + 1 > bch->size * BCHASH_MAX_LOAD)
+		resize(bch, bch->size * 2);
+
+	el = (struct element *)algmalloc(sizeof(struct element));
+	*el = *item;
+	h = string_hash(item->key);
+	bucket_add(&bch->buckets[h & (bch->size - 1)], TAG_OF(h), el);
+	bch->pairs++;
+}
+
+/* 
+ * Removes the specified key and its associated value from this 
+ * bucketized separate-chain hash table. The last pair of the chain 
+ * fills the hole, so only the tail bucket may be partly filled.
+ */
+void
+bchash_delete(struct bchain_hash *bch, const char *key)
+{
+	struct bchash_bucket *bk, *tail, *prev;
+	struct element *el;
+	int slot;
+
+	if (key == NULL || (el = locate(bch, key, &bk, &slot)) == NULL)
+		return;
+
+	ALGFREE(el);
+
+	prev = NULL;
+	tail = &bch->buckets[string_hash(key) & (bch->size - 1)];
+	for (; tail->next != NULL; tail = tail->next)
+		prev = tail;
+
+	tail->count--;
+	bk->tags[slot] = tail->tags[tail->count];
+	bk->items[slot] = tail->items[tail->count];
+
+	/* frees the empty overflow bucket */
+	if (tail->count == 0 && prev != NULL) {
+		prev->next = NULL;
+		free(tail);
+	}
+
+	bch->pairs--;
+}
+
+/* Returns all keys in this bucketized separate-chain hash table. */
+void 
+bchash_keys(const struct bchain_hash *bch, struct queue *keys)
+{
+	struct bchash_bucket *bk;
+	unsigned long i;
+	int j;
+
+	for (i = 0; i < bch->size; i++)
+		for (bk = &bch->buckets[i]; bk != NULL; bk = bk->next)
+			for (j = 0; j < bk->count; j++)
+				enqueue(keys, bk->items[j]->key);
+}
+
+/* Clears this bucketized separate-chain hash table */
+void 
+bchash_clear(struct bchain_hash *bch)
+{
+	struct bchash_bucket *bk;
+	unsigned long i;
+	int j;
+
+	for (i = 0; i < bch->size; i++) {
+		for (bk = &bch->buckets[i]; bk != NULL; bk = bk->next)
+			for (j = 0; j < bk->count; j++)
+				ALGFREE(bk->items[j]);
+		chain_free(bch->buckets[i].next);
+	}
+
+	free(bch->buckets);
+	bch->buckets = NULL;
+	bch->pairs = 0;
+	bch->size = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* Allocates N empty buckets aligned to the cache line. */
+static struct bchash_bucket *
+buckets_alloc(unsigned long n)
+{
+	struct bchash_bucket *bks;
+
+	bks = (struct bchash_bucket *)aligned_alloc(CACHE_LINE,
+		n * sizeof(struct bchash_bucket));
+	if (bks == NULL)
+		errmsg_exit("Memory allocated failure, %s\n", 
+			strerror(errno));
+	memset(bks, 0, n * sizeof(struct bchash_bucket));
+
+	return bks;
+}
+
+/* 
+ * Returns the element of the key, and the bucket and the slot 
+ * where it is stored. Returns NULL if not found.
+ */
+static struct element *
+locate(const struct bchain_hash *bch, const char *key, 
+	struct bchash_bucket **bkp, int *slot)
+{
+	struct bchash_bucket *bk;
+	unsigned long h;
+	unsigned char tag;
+	int i;
+
+	h = string_hash(key);
+	tag = TAG_OF(h);
+
+	for (bk = &bch->buckets[h & (bch->size - 1)]; bk != NULL;
+		bk = bk->next) {
+		for (i = 0; i < bk->count; i++) {
+			if (bk->tags[i] == tag &&
+				strcmp(bk->items[i]->key, key) == 0) {
+				*bkp = bk;
+				*slot = i;
+				return bk->items[i];
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/* Appends the element to the first bucket has a free slot. */
+static void
+bucket_add(struct bchash_bucket *bk, unsigned char tag, struct element *el)
+{
+	while (bk->count == BCHASH_BUCKET_SLOTS) {
+		if (bk->next == NULL)
+			bk->next = buckets_alloc(1);
+		bk = bk->next;
+	}
+
+	bk->tags[bk->count] = tag;
+	bk->items[bk->count] = el;
+	bk->count++;
+}
+
+/* 
+ * Rehashes all key-value pairs into N buckets, 
+ * the elements themselves are not copied.
+ */
+static void
+resize(struct bchain_hash *bch, unsigned long n)
+{
+	struct bchash_bucket *obks, *bk;
+	unsigned long i, osize, h;
+	int j;
+
+	obks = bch->buckets;
+	osize = bch->size;
+
+	bch->size = n;
+	bch->buckets = buckets_alloc(n);
+	for (i = 0; i < osize; i++) {
+		for (bk = &obks[i]; bk != NULL; bk = bk->next)
+			for (j = 0; j < bk->count; j++) {
+				h = string_hash(bk->items[j]->key);
+				bucket_add(&bch->buckets[h & (n - 1)],
+					TAG_OF(h), bk->items[j]);
+			}
+		chain_free(obks[i].next);
+	}
+
+	free(obks);
+}
+
+/* Frees a chain of overflow buckets. */
+static void
+chain_free(struct bchash_bucket *bk)
+{
+	struct bchash_bucket *nbk;
+
+	for (; bk != NULL; bk = nbk) {
+		nbk = bk->next;
+		free(bk);
+	}
+}
@@ -0,0 +1,246 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "concurrenthash.h"
+#include "lineprobhash.h"
+#include <getopt.h>
+
+#define OPS_PER_THREAD	1000000
+
+struct worker {
+	pthread_t tid;
+	unsigned long seed;
+};
+
+static struct element *els;	/* keys read from the file */
+static unsigned long nels;
+static int putpct;		/* percentage of put operations */
+
+static struct concurrent_hash ch;
+static struct line_prob_hash lph;
+static pthread_mutex_t biglock = PTHREAD_MUTEX_INITIALIZER;
+
+static void * chash_worker(void *);
+static void * lphash_worker(void *);
+static double run(void *(*)(void *), int);
+static unsigned long next_rand(unsigned long *);
+static void usage_info(const char *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct element item;
+	FILE *fp;
+	char *fname = NULL;
+	unsigned long i, cap = 1024;
+	int nthreads = 0, t;
+	double ct, lt;
+
+	int op;
+	const char *optstr = "f:t:p:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'f':
+			fname = optarg;
+			break;
+		case 't':
+			if (sscanf(optarg, "%d", &nthreads) != 1)
+				errmsg_exit("Illegal number. -t %s\n",
+					optarg);
+			break;
+		case 'p':
+			if (sscanf(optarg, "%d", &putpct) != 1)
+				errmsg_exit("Illegal number. -p %s\n",
+					optarg);
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	if (nthreads <= 0 || nthreads > 256)
+		errmsg_exit("The number of threads must be in 1 ~ 256.\n");
+	if (putpct < 0 || putpct > 100)
+		errmsg_exit("The put percentage must be in 0 ~ 100.\n");
+	
+	fp = open_file(fname, "rb");
+	
+	SET_RANDOM_SEED;
+	
+	els = (struct element *)algmalloc(cap * sizeof(struct element));
+	while (!feof(fp)) {
+		if (fread(&item, sizeof(struct element), 1, fp) > 0) {
+			if (nels == cap) {
+				cap *= 2;
+				els = (struct element *)algrealloc(els, 
+					cap * sizeof(struct element));
+			}
+			els[nels++] = item;
+		}
+	}
+	close_file(fp);
+	if (nels == 0)
+		errmsg_exit("No data in \"%s\" file.\n", fname);
+	
+	printf("Keys: %lu, operations per thread: %d, puts: %d%%\n", 
+		nels, OPS_PER_THREAD, putpct);
+	printf("The first half of keys are loaded before each run, "
+		"puts may insert the rest.\n\n");
+	printf("%-8s %22s %22s\n", "threads", "concurrent hash(Mops/s)",
+		"mutex lphash(Mops/s)");
+	
+	for (t = 1; ; t = (t * 2 > nthreads && t < nthreads) ?
+		nthreads : t * 2) {
+		chash_init(&ch, 16);
+		for (i = 0; i < nels / 2; i++)
+			chash_put(&ch, &els[i]);
+		ct = run(chash_worker, t);
+		for (i = 0; i < nels / 2; i++)
+			if (chash_get(&ch, els[i].key, &item) != 0)
+				errmsg_exit("Key %s lost.\n", els[i].key);
+		chash_clear(&ch);
+		
+		LPHASH_INIT(&lph, nels * 2);
+		memset(lph.items, 0, nels * 2 * sizeof(struct element));
+		for (i = 0; i < nels / 2; i++)
+			lphash_put(&lph, &els[i]);
+		lt = run(lphash_worker, t);
+		LPHASH_CLEAR(&lph);
+		
+		printf("%-8d %22.3f %22.3f\n", t, 
+			(double)t * OPS_PER_THREAD / ct / 1e6,
+			(double)t * OPS_PER_THREAD / lt / 1e6);
+		if (t == nthreads)
+			break;
+	}
+	
+	ALGFREE(els);
+	
+	return 0;
+}
+
+static void *
+chash_worker(void *arg)
+{
+	struct worker *w = (struct worker *)arg;
+	struct element item;
+	unsigned long r;
+	int i;
+
+	for (i = 0; i < OPS_PER_THREAD; i++) {
+		r = next_rand(&w->seed);
+		if ((int)(r % 100) < putpct) {
+			item = els[(r >> 8) % nels];
+			item.value = (long)r;
+			chash_put(&ch, &item);
+		} else {
+			chash_get(&ch, els[(r >> 8) % nels].key, &item);
+		}
+	}
+
+	return NULL;
+}
+
+static void *
+lphash_worker(void *arg)
+{
+	struct worker *w = (struct worker *)arg;
+	struct element item;
+	unsigned long r;
+	int i;
+
+	for (i = 0; i < OPS_PER_THREAD; i++) {
+		r = next_rand(&w->seed);
+		pthread_mutex_lock(&biglock);
+		if ((int)(r % 100) < putpct) {
+			item = els[(r >> 8) % nels];
+			item.value = (long)r;
+			lphash_put(&lph, &item);
+		} else {
+			lphash_get(&lph, els[(r >> 8) % nels].key);
+		}
+		pthread_mutex_unlock(&biglock);
+	}
+
+	return NULL;
+}
+
+/* Runs the worker in NTH threads, returns the wall time in seconds. */
+static double
+run(void *(*worker)(void *), int nth)
+{
+	struct worker ws[256];
+	struct timespec start, end;
+	int i;
+
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < nth; i++) {
+		ws[i].seed = (unsigned long)rand() * 2654435761UL + 1;
+		if (pthread_create(&ws[i].tid, NULL, worker, &ws[i]) != 0)
+			errmsg_exit("Creates thread failure.\n");
+	}
+	for (i = 0; i < nth; i++)
+		pthread_join(ws[i].tid, NULL);
+	timespec_get(&end, TIME_UTC);
+
+	return (double)(end.tv_sec - start.tv_sec) +
+		(double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/* The xorshift64 generator, one state per thread. */
+static unsigned long
+next_rand(unsigned long *s)
+{
+	*s ^= *s << 13;
+	*s ^= *s >> 7;
+	*s ^= *s << 17;
+	return *s;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -f -t -p\n", pname);
+	fprintf(stderr, "-f: The data file will be read in memory.\n");
+	fprintf(stderr, "-t: The largest number of threads.\n");
+	fprintf(stderr, "-p: The percentage of put operations.\n");
+	exit(EXIT_FAILURE);
+}
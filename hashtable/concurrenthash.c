@@ -0,0 +1,476 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "concurrenthash.h"
+#include "queue.h"
+
+#define SLOT_EMPTY	0
+#define SLOT_USED	1
+#define SLOT_DEAD	2	/* deleted or moved, only in old tables */
+
+#define SEGMENT_OF(h)	(((h) >> 32) & (CHASH_SEGMENTS - 1))
+
+static struct chash_table * table_alloc(unsigned long);
+static long table_find(const struct chash_table *, unsigned long,
+	const char *);
+static void table_insert(struct chash_table *, unsigned long,
+	const struct element *);
+static void table_delete(struct chash_table *, unsigned long);
+static void write_begin(struct chash_segment *);
+static void write_end(struct chash_segment *);
+static void migrate(struct chash_segment *, unsigned long);
+static void grow(struct chash_segment *);
+
+/* Initializes an empty concurrent hash table. */
+void
+chash_init(struct concurrent_hash *ch, unsigned long htsize)
+{
+	struct chash_segment *seg;
+	unsigned long sz;
+	int i;
+
+	for (sz = 8; sz * CHASH_SEGMENTS < htsize; sz <<= 1)
+		;
+
+	for (i = 0; i < CHASH_SEGMENTS; i++) {
+		seg = &ch->segs[i];
+		if (pthread_mutex_init(&seg->lock, NULL) != 0)
+			errmsg_exit("Initializes mutex failure.\n");
+		atomic_init(&seg->seq, 0);
+		atomic_init(&seg->table, table_alloc(sz));
+		atomic_init(&seg->old, NULL);
+		seg->moved = 0;
+		seg->pairs = 0;
+		seg->retired = NULL;
+	}
+}
+
+/* 
+ * Copies the key-value pair associated with the specified key 
+ * into ITEM, returns -1 if not found. The reader retries while 
+ * a writer is modifying the same segment.
+ */
+int
+chash_get(struct concurrent_hash *ch, const char *key, struct element *item)
+{
+	struct chash_segment *seg;
+	struct chash_table *tb;
+	unsigned long h, s1, s2;
+	long i;
+	int found;
+
+	if (key == NULL)
+		return -1;
+
+	h = string_hash(key);
+	seg = &ch->segs[SEGMENT_OF(h)];
+
+	do {
+		s1 = atomic_load_explicit(&seg->seq, memory_order_acquire);
+		if (s1 & 1)
+			continue;
+
+		found = -1;
+		tb = atomic_load_explicit(&seg->table, memory_order_acquire);
+		if ((i = table_find(tb, h, key)) >= 0) {
+			*item = tb->items[i];
+			found = 0;
+		} else {
+			tb = atomic_load_explicit(&seg->old,
+				memory_order_acquire);
+			if (tb != NULL && (i = table_find(tb, h, key)) >= 0) {
+				*item = tb->items[i];
+				found = 0;
+			}
+		}
+
+		atomic_thread_fence(memory_order_acquire);
+		s2 = atomic_load_explicit(&seg->seq, memory_order_relaxed);
+	} while ((s1 & 1) || s1 != s2);
+
+	return found;
+}
+
+/* 
+ * Returns the number of slots visited by searching the key in the
+ * concurrent hash table, both tables are counted while it grows.
+ */
+unsigned long
+chash_probes(struct concurrent_hash *ch, const char *key)
+{
+	struct chash_segment *seg;
+	struct chash_table *tb[2];
+	unsigned long h, i, n = 0, mask;
+	int t;
+
+	h = string_hash(key);
+	seg = &ch->segs[SEGMENT_OF(h)];
+	tb[0] = atomic_load(&seg->table);
+	tb[1] = atomic_load(&seg->old);
+
+	for (t = 0; t < 2 && tb[t] != NULL; t++) {
+		mask = tb[t]->size - 1;
+		for (i = h & mask; ; i = (i + 1) & mask) {
+			n++;
+			if (tb[t]->states[i] == SLOT_EMPTY)
+				break;
+			if (tb[t]->states[i] == SLOT_USED &&
+				strcmp(tb[t]->items[i].key, key) == 0)
+				return n;
+		}
+	}
+
+	return n;
+}
+
+/* 
+ * Inserts the specified key-value pair into the concurrent hash table, 
+ * overwriting the old value with the new value if already contains.
+ */
+void
+chash_put(struct concurrent_hash *ch, const struct element *item)
+{
+	struct chash_segment *seg;
+	struct chash_table *tb, *old;
+	unsigned long h;
+	long i;
+
+	assert(item != NULL);
+
+	h = string_hash(item->key);
+	seg = &ch->segs[SEGMENT_OF(h)];
+
+	pthread_mutex_lock(&seg->lock);
+	write_begin(seg);
+
+	tb = atomic_load_explicit(&seg->table, memory_order_relaxed);
+	old = atomic_load_explicit(&seg->old, memory_order_relaxed);
+
+	if ((i = table_find(tb, h, item->key)) >= 0) {
+		tb->items[i].value = item->value;
+	} else {
+		if (old != NULL && (i = table_find(old, h, item->key)) >= 0) {
+			/* moves it to the current table */
+			old->states[i] = SLOT_DEAD;
+			seg->pairs--;
+		}
+
+		if ((double)(seg->pairs + 1) > 
+			(double)tb->size * CHASH_MAX_LOAD) {
+			if (old != NULL)
+				migrate(seg, old->size);
+			grow(seg);
+			tb = atomic_load_explicit(&seg->table,
+				memory_order_relaxed);
+		}
+		table_insert(tb, h, item);
+		seg->pairs++;
+	}
+
+	/* helps to move the old table forward */
+	if (atomic_load_explicit(&seg->old, memory_order_relaxed) != NULL)
+		migrate(seg, CHASH_MIGRATE_STEP);
+
+	write_end(seg);
+	pthread_mutex_unlock(&seg->lock);
+}
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the concurrent hash table.
+ */
+int
+chash_delete(struct concurrent_hash *ch, const char *key)
+{
+	struct chash_segment *seg;
+	struct chash_table *tb, *old;
+	unsigned long h;
+	long i;
+	int ret = -1;
+
+	if (key == NULL)
+		return -1;
+
+	h = string_hash(key);
+	seg = &ch->segs[SEGMENT_OF(h)];
+
+	pthread_mutex_lock(&seg->lock);
+	write_begin(seg);
+
+	tb = atomic_load_explicit(&seg->table, memory_order_relaxed);
+	old = atomic_load_explicit(&seg->old, memory_order_relaxed);
+
+	if ((i = table_find(tb, h, key)) >= 0) {
+		table_delete(tb, i);
+		ret = 0;
+	} else if (old != NULL && (i = table_find(old, h, key)) >= 0) {
+		/* the probe chains of an old table must be kept */
+		old->states[i] = SLOT_DEAD;
+		ret = 0;
+	}
+	if (ret == 0)
+		seg->pairs--;
+
+	write_end(seg);
+	pthread_mutex_unlock(&seg->lock);
+
+	return ret;
+}
+
+/* 
+ * Returns the number of key-value pairs 
+ * in this concurrent hash table.
+ */
+unsigned long
+chash_pairs(struct concurrent_hash *ch)
+{
+	unsigned long n = 0;
+	int i;
+
+	for (i = 0; i < CHASH_SEGMENTS; i++) {
+		pthread_mutex_lock(&ch->segs[i].lock);
+		n += ch->segs[i].pairs;
+		pthread_mutex_unlock(&ch->segs[i].lock);
+	}
+
+	return n;
+}
+
+/* Returns the number of slots in this concurrent hash table. */
+unsigned long
+chash_size(struct concurrent_hash *ch)
+{
+	unsigned long n = 0;
+	int i;
+
+	for (i = 0; i < CHASH_SEGMENTS; i++) {
+		pthread_mutex_lock(&ch->segs[i].lock);
+		n += atomic_load(&ch->segs[i].table)->size;
+		pthread_mutex_unlock(&ch->segs[i].lock);
+	}
+
+	return n;
+}
+
+/* Returns all keys in this concurrent hash table. */
+void
+chash_keys(struct concurrent_hash *ch, struct queue *keys)
+{
+	struct chash_table *tb[2];
+	unsigned long i;
+	int s, t;
+
+	for (s = 0; s < CHASH_SEGMENTS; s++) {
+		tb[0] = atomic_load(&ch->segs[s].table);
+		tb[1] = atomic_load(&ch->segs[s].old);
+		for (t = 0; t < 2 && tb[t] != NULL; t++)
+			for (i = 0; i < tb[t]->size; i++)
+				if (tb[t]->states[i] == SLOT_USED)
+					enqueue(keys, tb[t]->items[i].key);
+	}
+}
+
+/* Clears this concurrent hash table. */
+void
+chash_clear(struct concurrent_hash *ch)
+{
+	struct chash_segment *seg;
+	struct chash_table *tb;
+	int i;
+
+	for (i = 0; i < CHASH_SEGMENTS; i++) {
+		seg = &ch->segs[i];
+		if ((tb = atomic_load(&seg->old)) != NULL) {
+			tb->next = seg->retired;
+			seg->retired = tb;
+		}
+		tb = atomic_load(&seg->table);
+		tb->next = seg->retired;
+		seg->retired = tb;
+
+		while ((tb = seg->retired) != NULL) {
+			seg->retired = tb->next;
+			ALGFREE(tb->states);
+			ALGFREE(tb->items);
+			ALGFREE(tb);
+		}
+
+		atomic_store(&seg->table, NULL);
+		atomic_store(&seg->old, NULL);
+		seg->pairs = 0;
+		pthread_mutex_destroy(&seg->lock);
+	}
+}
+
+/******************** static function boundary ********************/
+
+static struct chash_table *
+table_alloc(unsigned long size)
+{
+	struct chash_table *tb;
+
+	tb = (struct chash_table *)algmalloc(sizeof(struct chash_table));
+	tb->size = size;
+	tb->states = (unsigned char *)algcalloc(size, sizeof(char));
+	tb->items = (struct element *)algmalloc(size * 
+		sizeof(struct element));
+	tb->next = NULL;
+
+	return tb;
+}
+
+/* 
+ * Returns the slot of the key, -1 if not found. A reader may see 
+ * a table being modified, so the probe is bounded by the table size 
+ * and the key comparison by the key length.
+ */
+static long
+table_find(const struct chash_table *tb, unsigned long h, const char *key)
+{
+	unsigned long i, n, mask = tb->size - 1;
+
+	for (i = h & mask, n = 0; n < tb->size; i = (i + 1) & mask, n++) {
+		if (tb->states[i] == SLOT_EMPTY)
+			break;
+		if (tb->states[i] == SLOT_USED &&
+			strncmp(tb->items[i].key, key, MAX_KEY_LEN) == 0)
+			return (long)i;
+	}
+
+	return -1;
+}
+
+/* Inserts the key-value pair that is known not in the table. */
+static void
+table_insert(struct chash_table *tb, unsigned long h, 
+	const struct element *item)
+{
+	unsigned long i, mask = tb->size - 1;
+
+	for (i = h & mask; tb->states[i] != SLOT_EMPTY; i = (i + 1) & mask)
+		;
+	tb->items[i] = *item;
+	tb->states[i] = SLOT_USED;
+}
+
+/* 
+ * Removes the slot I of a current table, the following keys of 
+ * the cluster are shifted backward to keep it free of dead slots.
+ */
+static void
+table_delete(struct chash_table *tb, unsigned long i)
+{
+	unsigned long j, k, mask = tb->size - 1;
+
+	for (j = i; ; ) {
+		j = (j + 1) & mask;
+		if (tb->states[j] == SLOT_EMPTY)
+			break;
+
+		/* moves j to i unless its home is cyclically in (i, j] */
+		k = string_hash(tb->items[j].key) & mask;
+		if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+			continue;
+
+		tb->items[i] = tb->items[j];
+		i = j;
+	}
+	tb->states[i] = SLOT_EMPTY;
+}
+
+/* Makes the sequence counter odd, the segment lock must be held. */
+static void
+write_begin(struct chash_segment *seg)
+{
+	unsigned long s;
+
+	s = atomic_load_explicit(&seg->seq, memory_order_relaxed);
+	atomic_store_explicit(&seg->seq, s + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+/* Makes the sequence counter even again. */
+static void
+write_end(struct chash_segment *seg)
+{
+	unsigned long s;
+
+	s = atomic_load_explicit(&seg->seq, memory_order_relaxed);
+	atomic_store_explicit(&seg->seq, s + 1, memory_order_release);
+}
+
+/* 
+ * Moves at most N slots of the old table to the current table, 
+ * the old table is retired when all of its slots are moved.
+ */
+static void
+migrate(struct chash_segment *seg, unsigned long n)
+{
+	struct chash_table *tb, *old;
+	unsigned long i;
+
+	tb = atomic_load_explicit(&seg->table, memory_order_relaxed);
+	old = atomic_load_explicit(&seg->old, memory_order_relaxed);
+
+	for (i = 0; i < n && seg->moved < old->size; i++, seg->moved++) {
+		if (old->states[seg->moved] != SLOT_USED)
+			continue;
+		table_insert(tb, string_hash(old->items[seg->moved].key),
+			&old->items[seg->moved]);
+		old->states[seg->moved] = SLOT_DEAD;
+	}
+
+	if (seg->moved == old->size) {
+		/* 
+		 * readers may still be probing it, 
+		 * so it is freed at chash_clear().
+		 */
+		atomic_store_explicit(&seg->old, NULL, memory_order_release);
+		old->next = seg->retired;
+		seg->retired = old;
+	}
+}
+
+/* 
+ * Installs a table of double size, the keys are moved into it 
+ * a few at a time by the subsequent writers of this segment.
+ */
+static void
+grow(struct chash_segment *seg)
+{
+	struct chash_table *tb;
+
+	tb = atomic_load_explicit(&seg->table, memory_order_relaxed);
+	atomic_store_explicit(&seg->old, tb, memory_order_release);
+	atomic_store_explicit(&seg->table, table_alloc(tb->size * 2),
+		memory_order_release);
+	seg->moved = 0;
+}
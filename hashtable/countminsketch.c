@@ -0,0 +1,202 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "countminsketch.h"
+#include <math.h>
+
+static inline unsigned long row_hash(unsigned long, unsigned int);
+static int cmp_long(const void *, const void *);
+
+/* Initializes an empty sketch. */
+void
+cms_init(struct cm_sketch *cms, enum cms_kind kind, double epsilon,
+	double delta)
+{
+	unsigned long w;
+	double d;
+
+	assert(epsilon > 0.0 && epsilon < 1.0);
+	assert(delta > 0.0 && delta < 1.0);
+
+	for (w = 1; (double)w < exp(1.0) / epsilon; w <<= 1)
+		;
+	d = ceil(log(1.0 / delta));
+	if (d < 1.0)
+		d = 1.0;
+	else if (d > CMS_MAX_DEPTH)
+		d = CMS_MAX_DEPTH;
+
+	/* the median of count sketch needs an odd number of rows */
+	if (kind == CMS_COUNT_SKETCH && (unsigned int)d % 2 == 0)
+		d += (unsigned int)d < CMS_MAX_DEPTH ? 1.0 : -1.0;
+
+	cms->kind = kind;
+	cms->depth = (unsigned int)d;
+	cms->width = w;
+	cms->total = 0;
+	cms->counters = (long *)algcalloc(cms->depth * w, sizeof(long));
+}
+
+/* 
+ * Counts the key COUNT times. With conservative update, a counter 
+ * is only raised to the new estimate of the key, not added to,
+ * so the keys sharing the counter get less overestimated.
+ */
+void
+cms_add(struct cm_sketch *cms, const char *key, long count)
+{
+	unsigned long h, r, idx[CMS_MAX_DEPTH];
+	unsigned int i;
+	long est, *c;
+
+	h = string_hash(key);
+	cms->total += count;
+
+	switch (cms->kind) {
+	case CMS_COUNT_MIN:
+		for (i = 0; i < cms->depth; i++) {
+			r = row_hash(h, i) & (cms->width - 1);
+			cms->counters[i * cms->width + r] += count;
+		}
+		break;
+	case CMS_CONSERVATIVE:
+		est = LONG_MAX;
+		for (i = 0; i < cms->depth; i++) {
+			idx[i] = i * cms->width + 
+				(row_hash(h, i) & (cms->width - 1));
+			if (cms->counters[idx[i]] < est)
+				est = cms->counters[idx[i]];
+		}
+		est += count;
+		for (i = 0; i < cms->depth; i++)
+			if (cms->counters[idx[i]] < est)
+				cms->counters[idx[i]] = est;
+		break;
+	case CMS_COUNT_SKETCH:
+		for (i = 0; i < cms->depth; i++) {
+			r = row_hash(h, i);
+			c = &cms->counters[i * cms->width + 
+				(r & (cms->width - 1))];
+			/* the top bit is the sign of the key in this row */
+			*c += (r >> 63) != 0 ? -count : count;
+		}
+		break;
+	}
+}
+
+/* 
+ * Returns the estimated count of the key, the smallest counter 
+ * for count-min, or the median of signed counters for count sketch.
+ */
+long
+cms_estimate(const struct cm_sketch *cms, const char *key)
+{
+	unsigned long h, r;
+	unsigned int i;
+	long est[CMS_MAX_DEPTH], c, min = LONG_MAX;
+
+	h = string_hash(key);
+	for (i = 0; i < cms->depth; i++) {
+		r = row_hash(h, i);
+		c = cms->counters[i * cms->width + (r & (cms->width - 1))];
+		if (cms->kind != CMS_COUNT_SKETCH) {
+			if (c < min)
+				min = c;
+		} else
+			est[i] = (r >> 63) != 0 ? -c : c;
+	}
+
+	if (cms->kind != CMS_COUNT_SKETCH)
+		return min;
+
+	qsort(est, cms->depth, sizeof(long), cmp_long);
+	return est[cms->depth / 2] > 0 ? est[cms->depth / 2] : 0;
+}
+
+/* 
+ * Adds all counts of the sketch SRC into DST. A merged conservative 
+ * sketch is still never too small, but not as tight as one sketch 
+ * of the whole stream.
+ */
+void
+cms_merge(struct cm_sketch *dst, const struct cm_sketch *src)
+{
+	unsigned long i, n;
+
+	if (dst->kind != src->kind || dst->depth != src->depth ||
+		dst->width != src->width)
+		errmsg_exit("Merges sketches of different kinds or sizes.\n");
+
+	n = dst->depth * dst->width;
+	for (i = 0; i < n; i++)
+		dst->counters[i] += src->counters[i];
+	dst->total += src->total;
+}
+
+/* Removes all counts from this sketch. */
+void
+cms_reset(struct cm_sketch *cms)
+{
+	memset(cms->counters, 0, cms->depth * cms->width * sizeof(long));
+	cms->total = 0;
+}
+
+/* Clears this sketch. */
+void
+cms_clear(struct cm_sketch *cms)
+{
+	ALGFREE(cms->counters);
+	cms->depth = 0;
+	cms->width = 0;
+	cms->total = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* Returns the hash code H remixed for row I. */
+static inline unsigned long
+row_hash(unsigned long h, unsigned int i)
+{
+	h ^= (i + 1) * 0x9e3779b97f4a7c15UL;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdUL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+static int
+cmp_long(const void *a, const void *b)
+{
+	long x = *(const long *)a, y = *(const long *)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
@@ -0,0 +1,477 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "cuckoohash.h"
+#include "queue.h"
+
+#define CACHE_LINE	64
+
+/* The fingerprint uses the high bits, the bucket index the low bits. */
+#define TAG_OF(h)	((unsigned char)((h) >> 56))
+
+/* A bucket visited by the insertion path search. */
+struct bfs_node {
+	unsigned long bucket;	/* bucket index */
+	int parent;		/* the node this bucket is reached from */
+	int slot;		/* the slot of parent bucket moves here */
+};
+
+static inline unsigned long alt_index(unsigned long, unsigned char,
+	unsigned long);
+static struct ckhash_bucket * buckets_alloc(unsigned long);
+static int bucket_add(struct ckhash_bucket *, unsigned char,
+	struct element *);
+static int bfs(const struct cuckoo_hash *, unsigned long, unsigned long,
+	struct bfs_node *, int *);
+static int move_path(struct cuckoo_hash *, struct bfs_node *, int, int,
+	unsigned char, struct element *);
+static int insert(struct cuckoo_hash *, struct element *);
+static inline void stash_add(struct cuckoo_hash *, struct element *);
+static inline void stash_remove(struct cuckoo_hash *, int);
+static void resize(struct cuckoo_hash *, unsigned long);
+
+/* Initializes an empty cuckoo hash table. */
+void
+ckhash_init(struct cuckoo_hash *ckh, unsigned long htsize)
+{
+	unsigned long sz;
+
+	for (sz = 2; sz * CKHASH_BUCKET_SLOTS < htsize; sz <<= 1)
+		;
+
+	ckh->pairs = 0;
+	ckh->size = sz;
+	ckh->buckets = buckets_alloc(sz);
+	ckh->nstash = 0;
+}
+
+/* 
+ * Returns the value associated with the specified key in the 
+ * cuckoo hash table. It reads at most two buckets, and the stash 
+ * only if it is not empty, an element is only read if its 
+ * fingerprint matches.
+ */
+struct element * 
+ckhash_get(const struct cuckoo_hash *ckh, const char *key)
+{
+	const struct ckhash_bucket *bk;
+	unsigned long h, i, mask = ckh->size - 1;
+	unsigned char tag;
+	int j;
+
+	if (key == NULL)
+		return NULL;
+
+	h = string_hash(key);
+	tag = TAG_OF(h);
+
+	i = h & mask;
+	bk = &ckh->buckets[i];
+	for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+		if (bk->items[j] != NULL && bk->tags[j] == tag &&
+			strcmp(bk->items[j]->key, key) == 0)
+			return bk->items[j];
+
+	bk = &ckh->buckets[alt_index(i, tag, mask)];
+	for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+		if (bk->items[j] != NULL && bk->tags[j] == tag &&
+			strcmp(bk->items[j]->key, key) == 0)
+			return bk->items[j];
+
+	for (j = 0; j < ckh->nstash; j++)
+		if (ckh->stashtags[j] == tag && 
+			strcmp(ckh->stash[j]->key, key) == 0)
+			return ckh->stash[j];
+
+	return NULL;
+}
+
+/* 
+ * Returns the number of buckets visited by searching the key 
+ * in the cuckoo hash table, the stash counts as one bucket.
+ */
+unsigned long
+ckhash_probes(const struct cuckoo_hash *ckh, const char *key)
+{
+	const struct ckhash_bucket *bk;
+	unsigned long h, i, mask = ckh->size - 1;
+	int j;
+
+	h = string_hash(key);
+	i = h & mask;
+	bk = &ckh->buckets[i];
+	for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+		if (bk->items[j] != NULL && bk->tags[j] == TAG_OF(h) &&
+			strcmp(bk->items[j]->key, key) == 0)
+			return 1;
+
+	bk = &ckh->buckets[alt_index(i, TAG_OF(h), mask)];
+	for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+		if (bk->items[j] != NULL && bk->tags[j] == TAG_OF(h) &&
+			strcmp(bk->items[j]->key, key) == 0)
+			return 2;
+
+	return ckh->nstash > 0 ? 3 : 2;
+}
+
+/* 
+ * Inserts the specified key-value pair into the cuckoo hash table, 
+ * overwriting the old value with the new value if the table already 
+ * contains the specified key.
+ */
+void
+ckhash_put(struct cuckoo_hash *ckh, const struct element *item)
+{
+	struct element *el;
+
+	assert(item != NULL);
+
+	if ((el = ckhash_get(ckh, item->key)) != NULL) {
+		el->value = item->value;
+		return;
+	}
+
+	if ((double)(ckh->pairs + 1) > 
+		(double)CKHASH_SIZE(ckh) * CKHASH_MAX_LOAD)
+		resize(ckh, ckh->size * 2);
+
+	el = (struct element *)algmalloc(sizeof(struct element));
+	*el = *item;
+	while (insert(ckh, el) != 0) {
+		if (ckh->nstash < CKHASH_STASH_SIZE) {
+			stash_add(ckh, el);
+			break;
+		}
+		resize(ckh, ckh->size * 2);
+	}
+
+	ckh->pairs++;
+}
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the cuckoo hash table. The stashed pairs are moved 
+ * back into their buckets if there is room now.
+ */
+void
+ckhash_delete(struct cuckoo_hash *ckh, const char *key)
+{
+	struct ckhash_bucket *bk;
+	struct element *el;
+	unsigned long h, i, mask = ckh->size - 1;
+	int j, k;
+
+	if ((el = ckhash_get(ckh, key)) == NULL)
+		return;
+
+	h = string_hash(key);
+	i = h & mask;
+	for (k = 0; k < 2; k++) {
+		bk = &ckh->buckets[i];
+		for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+			if (bk->items[j] == el)
+				bk->items[j] = NULL;
+		i = alt_index(i, TAG_OF(h), mask);
+	}
+
+	for (j = 0; j < ckh->nstash; j++)
+		if (ckh->stash[j] == el)
+			stash_remove(ckh, j);
+
+	ALGFREE(el);
+	ckh->pairs--;
+
+	for (j = 0; j < ckh->nstash; ) {
+		el = ckh->stash[j];
+		h = string_hash(el->key);
+		i = h & mask;
+		if (bucket_add(&ckh->buckets[i], TAG_OF(h), el) == 0 ||
+			bucket_add(&ckh->buckets[alt_index(i, TAG_OF(h),
+			mask)], TAG_OF(h), el) == 0)
+			stash_remove(ckh, j);
+		else
+			j++;
+	}
+}
+
+/* Returns all keys in this cuckoo hash table. */
+void
+ckhash_keys(const struct cuckoo_hash *ckh, struct queue *keys)
+{
+	unsigned long i;
+	int j;
+
+	for (i = 0; i < ckh->size; i++)
+		for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+			if (ckh->buckets[i].items[j] != NULL)
+				enqueue(keys, ckh->buckets[i].items[j]->key);
+
+	for (j = 0; j < ckh->nstash; j++)
+		enqueue(keys, ckh->stash[j]->key);
+}
+
+/* Clears this cuckoo hash table. */
+void
+ckhash_clear(struct cuckoo_hash *ckh)
+{
+	unsigned long i;
+	int j;
+
+	for (i = 0; i < ckh->size; i++)
+		for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+			if (ckh->buckets[i].items[j] != NULL)
+				ALGFREE(ckh->buckets[i].items[j]);
+
+	for (j = 0; j < ckh->nstash; j++)
+		ALGFREE(ckh->stash[j]);
+
+	free(ckh->buckets);
+	ckh->buckets = NULL;
+	ckh->nstash = 0;
+	ckh->pairs = 0;
+	ckh->size = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* 
+ * Returns the other candidate bucket of a key from one of them and 
+ * its fingerprint, so a key can be moved without rehashing it.
+ */
+static inline unsigned long
+alt_index(unsigned long i, unsigned char tag, unsigned long mask)
+{
+	return (i ^ ((unsigned long)(tag + 1) * 0xc6a4a7935bd1e995UL)) & mask;
+}
+
+/* Allocates N empty buckets aligned to the cache line. */
+static struct ckhash_bucket *
+buckets_alloc(unsigned long n)
+{
+	struct ckhash_bucket *bks;
+
+	bks = (struct ckhash_bucket *)aligned_alloc(CACHE_LINE,
+		n * sizeof(struct ckhash_bucket));
+	if (bks == NULL)
+		errmsg_exit("Memory allocated failure, %s\n", 
+			strerror(errno));
+	memset(bks, 0, n * sizeof(struct ckhash_bucket));
+
+	return bks;
+}
+
+/* Puts the element into a free slot of the bucket, -1 if it is full. */
+static int
+bucket_add(struct ckhash_bucket *bk, unsigned char tag, struct element *el)
+{
+	int j;
+
+	for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+		if (bk->items[j] == NULL) {
+			bk->tags[j] = tag;
+			bk->items[j] = el;
+			return 0;
+		}
+
+	return -1;
+}
+
+/* 
+ * Searches breadth first from the two candidate buckets for a bucket 
+ * has a free slot, returns the node of it and sets the free slot, 
+ * -1 if not found in CKHASH_BFS_MAX buckets.
+ */
+static int
+bfs(const struct cuckoo_hash *ckh, unsigned long i1, unsigned long i2,
+	struct bfs_node *nodes, int *eslot)
+{
+	const struct ckhash_bucket *bk;
+	int head, n, j;
+
+	nodes[0].bucket = i1;
+	nodes[1].bucket = i2;
+	nodes[0].parent = nodes[1].parent = -1;
+	n = 2;
+
+	for (head = 0; head < n; head++) {
+		bk = &ckh->buckets[nodes[head].bucket];
+		for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+			if (bk->items[j] == NULL) {
+				*eslot = j;
+				return head;
+			}
+
+		for (j = 0; j < CKHASH_BUCKET_SLOTS && n < CKHASH_BFS_MAX;
+			j++) {
+			nodes[n].bucket = alt_index(nodes[head].bucket,
+				bk->tags[j], ckh->size - 1);
+			nodes[n].parent = head;
+			nodes[n].slot = j;
+			n++;
+		}
+	}
+
+	return -1;
+}
+
+/* 
+ * Moves the keys along the path backward from the free slot, then 
+ * puts the element into the slot freed in the first bucket. 
+ * Returns -1 if a bucket appears twice and the path is broken, 
+ * the keys already moved are still in one of their buckets.
+ */
+static int
+move_path(struct cuckoo_hash *ckh, struct bfs_node *nodes, int k, int e,
+	unsigned char tag, struct element *el)
+{
+	struct ckhash_bucket *from, *to;
+	int p, s;
+
+	while ((p = nodes[k].parent) >= 0) {
+		s = nodes[k].slot;
+		from = &ckh->buckets[nodes[p].bucket];
+		to = &ckh->buckets[nodes[k].bucket];
+		if (from->items[s] == NULL || to->items[e] != NULL ||
+			alt_index(nodes[p].bucket, from->tags[s], 
+			ckh->size - 1) != nodes[k].bucket)
+			return -1;
+
+		to->tags[e] = from->tags[s];
+		to->items[e] = from->items[s];
+		from->items[s] = NULL;
+		e = s;
+		k = p;
+	}
+
+	to = &ckh->buckets[nodes[k].bucket];
+	if (to->items[e] != NULL)
+		return -1;
+	to->tags[e] = tag;
+	to->items[e] = el;
+
+	return 0;
+}
+
+/* 
+ * Inserts the element that is known not in the table into one of
+ * its buckets, returns -1 if no insertion path is found.
+ */
+static int
+insert(struct cuckoo_hash *ckh, struct element *el)
+{
+	struct bfs_node nodes[CKHASH_BFS_MAX];
+	unsigned long h, i1, i2;
+	unsigned char tag;
+	int k, e, tries;
+
+	h = string_hash(el->key);
+	tag = TAG_OF(h);
+	i1 = h & (ckh->size - 1);
+	i2 = alt_index(i1, tag, ckh->size - 1);
+
+	if (bucket_add(&ckh->buckets[i1], tag, el) == 0 ||
+		bucket_add(&ckh->buckets[i2], tag, el) == 0)
+		return 0;
+
+	for (tries = 0; tries < 2; tries++) {
+		if ((k = bfs(ckh, i1, i2, nodes, &e)) < 0)
+			return -1;
+		if (move_path(ckh, nodes, k, e, tag, el) == 0)
+			return 0;
+	}
+
+	return -1;
+}
+
+/* 
+ * Rehashes all key-value pairs into N buckets, 
+ * or more buckets if they are still not fit.
+ */
+static void
+resize(struct cuckoo_hash *ckh, unsigned long n)
+{
+	struct ckhash_bucket *obks;
+	struct element **els;
+	unsigned long i, m;
+	int j;
+
+	/* collects all elements, the stash included */
+	els = (struct element **)algmalloc((ckh->pairs + 1) *
+		sizeof(struct element *));
+	for (i = 0, m = 0; i < ckh->size; i++)
+		for (j = 0; j < CKHASH_BUCKET_SLOTS; j++)
+			if (ckh->buckets[i].items[j] != NULL)
+				els[m++] = ckh->buckets[i].items[j];
+	for (j = 0; j < ckh->nstash; j++)
+		els[m++] = ckh->stash[j];
+
+	obks = ckh->buckets;
+
+	ckh->buckets = NULL;
+	for (;;) {
+		if (ckh->buckets != NULL)
+			free(ckh->buckets);
+		ckh->size = n;
+		ckh->buckets = buckets_alloc(n);
+		ckh->nstash = 0;
+
+		for (i = 0; i < m; i++) {
+			if (insert(ckh, els[i]) == 0)
+				continue;
+			if (ckh->nstash == CKHASH_STASH_SIZE)
+				break;
+			stash_add(ckh, els[i]);
+		}
+		if (i == m)
+			break;
+		n *= 2;
+	}
+
+	free(obks);
+	ALGFREE(els);
+}
+
+/* Keeps the element aside in the stash with its fingerprint. */
+static inline void
+stash_add(struct cuckoo_hash *ckh, struct element *el)
+{
+	ckh->stashtags[ckh->nstash] = TAG_OF(string_hash(el->key));
+	ckh->stash[ckh->nstash++] = el;
+}
+
+/* Removes the Jth element of the stash, the last one takes its place. */
+static inline void
+stash_remove(struct cuckoo_hash *ckh, int j)
+{
+	ckh->nstash--;
+	ckh->stashtags[j] = ckh->stashtags[ckh->nstash];
+	ckh->stash[j] = ckh->stash[ckh->nstash];
+}
@@ -0,0 +1,359 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "hashmap.h"
+#include "queue.h"
+
+#define HMAP_MIN_SIZE		8
+
+static inline unsigned long hash_code(const struct hash_map *, const void *);
+static inline int key_equal(const struct hash_map *, const void *,
+	const void *);
+static void alloc_slots(struct hash_map *, unsigned long);
+static void resize(struct hash_map *, unsigned long);
+static int insert(struct hash_map *, const void *, const void *);
+static long locate(const struct hash_map *, const void *);
+
+/* 
+ * Initializes an empty hash map. If HASH is NULL, the keys are hashed 
+ * by bytes_hash(), or as integers if KSIZE is 8. If EQUAL is NULL, 
+ * the keys are compared by memcmp().
+ */
+void
+hmap_init(struct hash_map *hm, unsigned int ksize, unsigned int vsize,
+	hmap_hash_ft *hash, algcomp_ft *equal)
+{
+	assert(ksize != 0);
+
+	hm->pairs = 0;
+	hm->keysize = ksize;
+	hm->valsize = vsize;
+	hm->slotsize = ksize + vsize;
+	hm->hash = hash;
+	hm->equal = equal;
+	hm->swap = (unsigned char *)algmalloc(2 * hm->slotsize);
+	alloc_slots(hm, HMAP_MIN_SIZE);
+}
+
+/* 
+ * Returns the value associated with the specified key, 
+ * NULL if not found.
+ */
+void *
+hmap_get(const struct hash_map *hm, const void *key)
+{
+	long i;
+
+	if (key == NULL)
+		return NULL;
+
+	if (HMAP_ISINTKEY(hm)) {
+		unsigned long k;
+
+		memcpy(&k, key, sizeof(k));
+		return hmap_get_u64(hm, k);
+	}
+
+	if ((i = locate(hm, key)) < 0)
+		return NULL;
+	return HMAP_SLOT_VALUE(hm, i);
+}
+
+/* 
+ * Returns the number of slots visited by searching the key 
+ * in the hash map.
+ */
+unsigned long
+hmap_probes(const struct hash_map *hm, const void *key)
+{
+	unsigned long i, mask = hm->size - 1;
+	unsigned int dist;
+
+	i = hash_code(hm, key);
+	for (dist = 1; dist <= hm->dists[i]; dist++) {
+		if (key_equal(hm, HMAP_SLOT_KEY(hm, i), key))
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return dist;
+}
+
+/* Grows the hash map to at least SIZE slots. */
+void
+hmap_reserve(struct hash_map *hm, unsigned long size)
+{
+	unsigned long htsize;
+
+	for (htsize = hm->size; htsize < size; htsize *= 2)
+		;
+	if (htsize > hm->size)
+		resize(hm, htsize);
+}
+
+/* 
+ * Inserts the specified key-value pair into the hash map, 
+ * overwriting the old value with the new value if the map 
+ * already contains the specified key.
+ */
+void
+hmap_put(struct hash_map *hm, const void *key, const void *val)
+{
+	long i;
+
+	assert(key != NULL);
+
+	if (HMAP_ISINTKEY(hm)) {
+		unsigned long k;
+
+		memcpy(&k, key, sizeof(k));
+		hmap_put_u64(hm, k, val);
+		return;
+	}
+
+	if ((i = locate(hm, key)) >= 0) {
+		memcpy(HMAP_SLOT_VALUE(hm, i), val, hm->valsize);
+		return;
+	}
+
+	if ((double)(hm->pairs + 1) > (double)hm->size * HMAP_MAX_LOAD)
+		resize(hm, hm->size * 2);
+
+	while (insert(hm, key, val) != 0)
+		resize(hm, hm->size * 2);
+}
+
+/* 
+ * Inserts the integer key and its associated value into the hash map,
+ * the old value is found without calling back key_equal().
+ */
+void
+hmap_put_u64(struct hash_map *hm, unsigned long key, const void *val)
+{
+	void *old;
+
+	assert(HMAP_ISINTKEY(hm));
+
+	if ((old = hmap_get_u64(hm, key)) != NULL) {
+		memcpy(old, val, hm->valsize);
+		return;
+	}
+
+	if ((double)(hm->pairs + 1) > (double)hm->size * HMAP_MAX_LOAD)
+		resize(hm, hm->size * 2);
+
+	while (insert(hm, &key, val) != 0)
+		resize(hm, hm->size * 2);
+}
+
+/* 
+ * Removes the specified key and its associated value from the
+ * hash map, the rest of the cluster is shifted backward.
+ */
+int
+hmap_delete(struct hash_map *hm, const void *key)
+{
+	long i;
+	unsigned long j, mask = hm->size - 1;
+
+	if (key == NULL || (i = locate(hm, key)) < 0)
+		return -1;
+
+	j = (i + 1) & mask;
+	while (hm->dists[j] > 1) {
+		memcpy(HMAP_SLOT_KEY(hm, i), HMAP_SLOT_KEY(hm, j),
+			hm->slotsize);
+		hm->dists[i] = hm->dists[j] - 1;
+		i = j;
+		j = (j + 1) & mask;
+	}
+
+	hm->dists[i] = 0;
+	hm->pairs--;
+
+	return 0;
+}
+
+/* Returns all keys in this hash map. */
+void
+hmap_keys(const struct hash_map *hm, struct queue *keys)
+{
+	unsigned long i;
+
+	for (i = 0; i < hm->size; i++)
+		if (hm->dists[i] != 0)
+			enqueue(keys, HMAP_SLOT_KEY(hm, i));
+}
+
+/* Clears this hash map. */
+void
+hmap_clear(struct hash_map *hm)
+{
+	ALGFREE(hm->dists);
+	ALGFREE(hm->slots);
+	ALGFREE(hm->swap);
+	hm->pairs = 0;
+	hm->size = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* Returns the home slot of the key. */
+static inline unsigned long
+hash_code(const struct hash_map *hm, const void *key)
+{
+	unsigned long k;
+
+	if (hm->hash != NULL)
+		return hm->hash(key, hm->keysize) & (hm->size - 1);
+
+	if (hm->keysize == sizeof(unsigned long)) {
+		memcpy(&k, key, sizeof(k));
+		return hmap_hash_u64(k) & (hm->size - 1);
+	}
+	return bytes_hash(key, hm->keysize) & (hm->size - 1);
+}
+
+static inline int
+key_equal(const struct hash_map *hm, const void *key1, const void *key2)
+{
+	if (hm->equal != NULL)
+		return hm->equal(key1, key2) == 0;
+	return memcmp(key1, key2, hm->keysize) == 0;
+}
+
+static void
+alloc_slots(struct hash_map *hm, unsigned long htsize)
+{
+	hm->size = htsize;
+	hm->dists = (unsigned char *)algcalloc(htsize, sizeof(char));
+	hm->slots = (unsigned char *)algmalloc(htsize * hm->slotsize);
+}
+
+/* Rehashes all key-value pairs into a map of the given size. */
+static void
+resize(struct hash_map *hm, unsigned long htsize)
+{
+	unsigned char *odists, *oslots, *slot;
+	unsigned long i, osize;
+
+	odists = hm->dists;
+	oslots = hm->slots;
+	osize = hm->size;
+
+	hm->pairs = 0;
+	alloc_slots(hm, htsize);
+	for (i = 0; i < osize; i++) {
+		if (odists[i] == 0)
+			continue;
+
+		slot = oslots + i * hm->slotsize;
+		if (insert(hm, slot, slot + hm->keysize) != 0) {
+			/* it is rare, starts over with a larger map */
+			ALGFREE(hm->dists);
+			ALGFREE(hm->slots);
+			hm->dists = odists;
+			hm->slots = oslots;
+			hm->size = osize;
+			resize(hm, htsize * 2);
+			return;
+		}
+	}
+
+	ALGFREE(odists);
+	ALGFREE(oslots);
+}
+
+/* 
+ * Inserts the key-value pair that is known not in the map by 
+ * Robin Hood hashing, returns -1 if a probe distance exceeded
+ * HMAP_MAX_DIST, the map is left unchanged in that case.
+ */
+static int
+insert(struct hash_map *hm, const void *key, const void *val)
+{
+	unsigned char *carry, *tmp;
+	unsigned long i, mask = hm->size - 1;
+	unsigned int dist, td;
+
+	/* simulates the probing first, nothing moves if it fails */
+	i = hash_code(hm, key);
+	for (dist = 1; hm->dists[i] != 0; dist++) {
+		if (hm->dists[i] < dist)
+			dist = hm->dists[i];
+		if (dist == HMAP_MAX_DIST + 1)
+			return -1;
+		i = (i + 1) & mask;
+	}
+
+	carry = hm->swap;
+	tmp = hm->swap + hm->slotsize;
+	memcpy(carry, key, hm->keysize);
+	memcpy(carry + hm->keysize, val, hm->valsize);
+
+	i = hash_code(hm, key);
+	dist = 1;
+	while (hm->dists[i] != 0) {
+		if (hm->dists[i] < dist) {
+			memcpy(tmp, HMAP_SLOT_KEY(hm, i), hm->slotsize);
+			memcpy(HMAP_SLOT_KEY(hm, i), carry, hm->slotsize);
+			memcpy(carry, tmp, hm->slotsize);
+			td = hm->dists[i];
+			hm->dists[i] = (unsigned char)dist;
+			dist = td;
+		}
+		i = (i + 1) & mask;
+		dist++;
+	}
+
+	memcpy(HMAP_SLOT_KEY(hm, i), carry, hm->slotsize);
+	hm->dists[i] = (unsigned char)dist;
+	hm->pairs++;
+
+	return 0;
+}
+
+/* Returns the slot of the key, -1 if not found. */
+static long
+locate(const struct hash_map *hm, const void *key)
+{
+	unsigned long i, mask = hm->size - 1;
+	unsigned int dist;
+
+	i = hash_code(hm, key);
+	for (dist = 1; dist <= hm->dists[i]; dist++) {
+		if (key_equal(hm, HMAP_SLOT_KEY(hm, i), key))
+			return (long)i;
+		i = (i + 1) & mask;
+	}
+
+	return -1;
+}
@@ -0,0 +1,171 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "hashmap.h"
+#include "queue.h"
+#include <getopt.h>
+
+static void usage_info(const char *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct element item;
+	struct hash_map hm, im;
+	FILE *fp;
+	clock_t start_time, end_time;
+	struct queue qu;
+	char *fname = NULL, *key = NULL, kbuf[MAX_KEY_LEN];
+	long *val;
+	unsigned long i, n;
+
+	int op;
+	const char *optstr = "f:k:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'f':
+			fname = optarg;
+			break;
+		case 'k':
+			key = optarg;
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	
+	fp = open_file(fname, "rb");
+	
+	SET_RANDOM_SEED;
+	
+	/* string keys are stored in place, zero padded */
+	hmap_init(&hm, MAX_KEY_LEN, sizeof(long), NULL, NULL);
+	
+	printf("Start read data from \"%s\" file to the hash map.\n", fname);
+	start_time = clock();
+	rewind(fp);
+	while (!feof(fp)) {
+		if (fread(&item, sizeof(struct element), 1, fp) > 0) {
+			memset(kbuf, 0, MAX_KEY_LEN);
+			memcpy(kbuf, item.key, strnlen(item.key, 
+				MAX_KEY_LEN - 1));
+			hmap_put(&hm, kbuf, &item.value);
+		}
+	}
+	close_file(fp);
+	end_time = clock();
+	printf("Read completed, estimated time(s): %.3f\n\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	memset(kbuf, 0, MAX_KEY_LEN);
+	strncpy(kbuf, key, MAX_KEY_LEN - 1);
+
+	printf("Begin search key: %s\n", key);
+	start_time = clock();
+	if ((val = (long *)hmap_get(&hm, kbuf)) != NULL)
+		printf("It's value: %ld\n", *val);
+	else
+		printf("Not found.\n");
+	end_time = clock();
+	printf("Search completed, estimated time(s): %.3f\n\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	printf("Begin delete key: %s\n", key);
+	start_time = clock();
+	hmap_delete(&hm, kbuf);
+	end_time = clock();
+	printf("Deletion completed, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("\n");
+	
+	printf("Following output this hash map:\n");
+	QUEUE_INIT(&qu, 0);
+	hmap_keys(&hm, &qu);
+	while (!QUEUE_ISEMPTY(&qu)) {
+		dequeue(&qu, (void **)&key);
+		val = (long *)hmap_get(&hm, key);
+		printf("%s\t%ld\n", key, *val);
+	}
+	queue_clear(&qu);
+	
+	printf("Total elements: %lu\n", HMAP_PAIRS(&hm));
+	printf("Map size: %lu\n", HMAP_SIZE(&hm));
+	printf("Bytes per element: %.2f\n\n", (double)HMAP_SIZE(&hm) * 
+		(hm.slotsize + 1) / (double)HMAP_PAIRS(&hm));
+	
+	n = HMAP_PAIRS(&hm);
+	hmap_clear(&hm);
+
+	/* the same number of integer keys through the integer path */
+	hmap_init(&im, sizeof(unsigned long), sizeof(long), NULL, NULL);
+	printf("Start put %lu integer keys to the hash map.\n", n);
+	start_time = clock();
+	for (i = 0; i < n; i++)
+		hmap_put_u64(&im, i * 7 + 1, &i);
+	end_time = clock();
+	printf("Put completed, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	start_time = clock();
+	for (i = 0; i < n; i++)
+		if ((val = (long *)hmap_get_u64(&im, i * 7 + 1)) == NULL ||
+			*val != (long)i)
+			errmsg_exit("Integer key %lu lost.\n", i * 7 + 1);
+	end_time = clock();
+	printf("Search completed, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("Bytes per element: %.2f\n", (double)HMAP_SIZE(&im) * 
+		(im.slotsize + 1) / (double)HMAP_PAIRS(&im));
+
+	hmap_clear(&im);
+	
+	return 0;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -f -k\n", pname);
+	fprintf(stderr, "-f: The data file will be read in memory..\n");
+	fprintf(stderr, "-k: The key will be searched.\n");
+	exit(EXIT_FAILURE);
+}
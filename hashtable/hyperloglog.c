@@ -0,0 +1,122 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "hyperloglog.h"
+#include <math.h>
+
+/* Initializes an empty counter of 2^PRECISION registers. */
+void
+hll_init(struct hyperloglog *hll, unsigned int precision)
+{
+	if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION)
+		errmsg_exit("The precision must be in [%d, %d].\n",
+			HLL_MIN_PRECISION, HLL_MAX_PRECISION);
+
+	hll->precision = precision;
+	hll->nregs = 1UL << precision;
+	hll->regs = (unsigned char *)algcalloc(hll->nregs, 1);
+}
+
+/* Adds the key into the counter. */
+void
+hll_add(struct hyperloglog *hll, const char *key)
+{
+	unsigned long h, w;
+	unsigned char r;
+
+	h = string_hash(key);
+	/* the guard bit bounds the leading zeros of the rest bits */
+	w = h << hll->precision | 1UL << (hll->precision - 1);
+	r = (unsigned char)(__builtin_clzl(w) + 1);
+	if (hll->regs[h >> (64 - hll->precision)] < r)
+		hll->regs[h >> (64 - hll->precision)] = r;
+}
+
+/* 
+ * Returns the estimated number of distinct keys. The estimate of 
+ * a few keys is corrected by linear counting of the empty registers.
+ * The hash code has 64 bits, so the large range needs no correction.
+ */
+double
+hll_estimate(const struct hyperloglog *hll)
+{
+	unsigned long i, zeros = 0;
+	double m = (double)hll->nregs, alpha, sum = 0.0, est;
+
+	for (i = 0; i < hll->nregs; i++) {
+		sum += ldexp(1.0, -(int)hll->regs[i]);
+		if (hll->regs[i] == 0)
+			zeros++;
+	}
+
+	switch (hll->nregs) {
+	case 16:
+		alpha = 0.673;
+		break;
+	case 32:
+		alpha = 0.697;
+		break;
+	case 64:
+		alpha = 0.709;
+		break;
+	default:
+		alpha = 0.7213 / (1.0 + 1.079 / m);
+		break;
+	}
+
+	est = alpha * m * m / sum;
+	if (est <= 2.5 * m && zeros > 0)
+		est = m * log(m / (double)zeros);
+
+	return est;
+}
+
+/* Merges the counter SRC into DST. */
+void
+hll_merge(struct hyperloglog *dst, const struct hyperloglog *src)
+{
+	unsigned long i;
+
+	if (dst->precision != src->precision)
+		errmsg_exit("Merges counters of different precisions.\n");
+
+	for (i = 0; i < dst->nregs; i++)
+		if (dst->regs[i] < src->regs[i])
+			dst->regs[i] = src->regs[i];
+}
+
+/* Clears the counter. */
+void
+hll_clear(struct hyperloglog *hll)
+{
+	ALGFREE(hll->regs);
+	hll->nregs = 0;
+}
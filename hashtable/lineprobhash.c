@@ -31,11 +31,14 @@
  */
 #include "lineprobhash.h"
 #include "queue.h"
+#include "bloomfilter.h"
 
+/* the last key hashed, its hash is only valid for the same table size */
 static struct {
 	char key[MAX_KEY_LEN + 1];
+	unsigned long htsize;
 	long hash;
-} hash_buffer = {"", -1};
+} hash_buffer = {"", 0, -1};
 
 static long hash_code(const char *, unsigned long);
 static int isnull(struct element *);
@@ -49,6 +52,9 @@ lphash_get(const struct line_prob_hash *lph, const char *key)
 {
 	unsigned long i;
 	
+	if (lph->guard != NULL && !bloom_contains(lph->guard, key))
+		return NULL;
+
 	for (i = hash_code(key, lph->size); !isnull(&(lph->items[i]));
 		i = (i + 1) % lph->size) {
 		if (strcmp(lph->items[i].key, key) == 0)
@@ -58,6 +64,44 @@ lphash_get(const struct line_prob_hash *lph, const char *key)
 	return NULL;
 }
 
+/* 
+ * Returns the number of slots visited by searching the key 
+ * in the linear-probing hash table.
+ */
+unsigned long
+lphash_probes(const struct line_prob_hash *lph, const char *key)
+{
+	unsigned long i, n = 1;
+	
+	for (i = hash_code(key, lph->size); !isnull(&(lph->items[i]));
+		i = (i + 1) % lph->size, n++) {
+		if (strcmp(lph->items[i].key, key) == 0)
+			break;
+	}
+
+	return n;
+}
+
+/* 
+ * Attaches a Bloom filter as the guard of lphash_get(), 
+ * all keys in the linear-probing hash table are added into it.
+ * The deleted keys stay in the filter, which only makes it 
+ * less selective.
+ */
+void
+lphash_set_guard(struct line_prob_hash *lph, struct bloom_filter *bf)
+{
+	unsigned long i;
+
+	lph->guard = bf;
+	if (bf == NULL)
+		return;
+
+	for (i = 0; i < lph->size; i++)
+		if (!isnull(&(lph->items[i])))
+			bloom_add(bf, lph->items[i].key);
+}
+
 /* 
  * Inserts the specified key-value pair into 
  * the linear-probing hash table. 
@@ -88,6 +132,8 @@ lphash_put(struct line_prob_hash *lph, const struct element *item)
 	/* insert item to the empty location of Items.*/
 	lph->items[i] = *item;
 	lph->pairs++;
+	if (lph->guard != NULL)
+		bloom_add(lph->guard, item->key);
 }
 
 /* 
@@ -152,7 +198,7 @@ hash_code(const char *key, unsigned long htsize)
 	
 	assert(key != NULL && (len = strlen(key)) > 0);
 	
-	if (strcmp(hash_buffer.key, key) == 0)
+	if (hash_buffer.htsize == htsize && strcmp(hash_buffer.key, key) == 0)
 		return hash_buffer.hash;
 	else {
 		hash = 0;
@@ -160,6 +206,7 @@ hash_code(const char *key, unsigned long htsize)
 			hash = (R * hash + string_char_at(key, i)) % htsize;
 		
 		strncpy(hash_buffer.key, key, MAX_KEY_LEN);
+		hash_buffer.htsize = htsize;
 		hash_buffer.hash = hash;
 		
 		return hash;
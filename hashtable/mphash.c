@@ -0,0 +1,176 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "perfecthash.h"
+#include "swisstablehash.h"
+#include <getopt.h>
+
+#define MISSES		100000
+
+static void usage_info(const char *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct element item, *items, *ent;
+	struct swiss_table swt;
+	struct mphash mph, mmph;
+	FILE *fp;
+	clock_t start_time, end_time;
+	char *fname = NULL, *oname = NULL, *key;
+	unsigned long n = 0, cap = 1024, i, fps;
+	unsigned char *seen;
+	const long *val;
+	int nthreads = 0;
+
+	int op;
+	const char *optstr = "f:t:o:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'f':
+			fname = optarg;
+			break;
+		case 't':
+			if (sscanf(optarg, "%d", &nthreads) != 1 ||
+				nthreads <= 0 || nthreads > 64)
+				errmsg_exit("Illegal threads. -t %s\n", optarg);
+			break;
+		case 'o':
+			oname = optarg;
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	
+	fp = open_file(fname, "rb");
+	
+	SET_RANDOM_SEED;
+	
+	/* the keys must be distinct, a later value replaces an earlier */
+	swhash_init(&swt, 1024);
+	items = (struct element *)algmalloc(cap * sizeof(struct element));
+	
+	printf("Start read data from \"%s\" file.\n", fname);
+	start_time = clock();
+	rewind(fp);
+	while (!feof(fp)) {
+		if (fread(&item, sizeof(struct element), 1, fp) > 0) {
+			if ((ent = swhash_get(&swt, item.key)) != NULL) {
+				items[ent->value].value = item.value;
+				continue;
+			}
+			if (n == cap) {
+				cap *= 2;
+				items = (struct element *)algrealloc(items,
+					cap * sizeof(struct element));
+			}
+			items[n] = item;
+			item.value = (long)n++;
+			swhash_put(&swt, &item);
+		}
+	}
+	close_file(fp);
+	swhash_clear(&swt);
+	end_time = clock();
+	printf("Read completed, %lu distinct keys, estimated time(s): "
+		"%.3f\n\n", n, 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	printf("Begin build the minimal perfect hash in %d threads.\n",
+		nthreads);
+	start_time = clock();
+	mphash_build(&mph, items, n, MPHASH_GAMMA, nthreads);
+	end_time = clock();
+	printf("Build completed, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("Levels: %lu, fallback keys: %lu, bits per key: %.3f\n\n",
+		mph.hdr->nlevels, mph.hdr->nfallback, 
+		MPHASH_BITS_PER_KEY(&mph));
+	
+	mphash_save(&mph, oname);
+	mphash_clear(&mph);
+	mphash_open(&mmph, oname);
+	printf("Saved to \"%s\" and mapped back, %lu bytes.\n\n", oname, 
+		(unsigned long)mmph.len);
+	
+	printf("Check every key has its own index and value.\n");
+	seen = (unsigned char *)algcalloc(n, 1);
+	start_time = clock();
+	for (i = 0; i < n; i++) {
+		if ((val = mphash_get(&mmph, items[i].key)) == NULL ||
+			*val != items[i].value)
+			errmsg_exit("Key %s is lost.\n", items[i].key);
+		if (seen[val - mmph.values]++ != 0)
+			errmsg_exit("Key %s shares its index.\n", items[i].key);
+	}
+	end_time = clock();
+	printf("Check completed, estimated time(s): %.3f\n\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	/* the keys in the data file never start with '#' */
+	for (i = 0, fps = 0; i < MISSES; i++) {
+		key = rand_string(16);
+		key[0] = '#';
+		if (mphash_get(&mmph, key) != NULL)
+			fps++;
+		ALGFREE(key);
+	}
+	printf("False positive rate of %d missing keys: %.5f\n", MISSES,
+		(double)fps / MISSES);
+	
+	ALGFREE(seen);
+	ALGFREE(items);
+	mphash_clear(&mmph);
+	
+	return 0;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -f -t -o\n", pname);
+	fprintf(stderr, "-f: The data file will be read in memory.\n");
+	fprintf(stderr, "-t: The number of threads to build.\n");
+	fprintf(stderr, "-o: The image file to be written and mapped.\n");
+	exit(EXIT_FAILURE);
+}
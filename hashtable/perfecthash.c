@@ -0,0 +1,475 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "perfecthash.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MPHASH_MAGIC	"ALGMPH1"
+
+/* The number of words of a rank block. */
+#define RANK_WORDS	8
+
+#define FINGERPRINT(h)	((unsigned short)((h) >> 48))
+
+/* The work of a thread over keys [lo, hi) of a level. */
+struct build_job {
+	const unsigned long *keys;	/* hash codes of the keys */
+	unsigned long lo, hi;
+	unsigned long *next;		/* the keys collided */
+	unsigned long nnext;
+	atomic_ulong *bits;		/* the keys hashed to */
+	atomic_ulong *coll;		/* the keys collided on */
+	unsigned long nbits;		/* bits of this level */
+	unsigned long level;
+	const struct element *items;	/* the keys to place */
+	long *values;
+	unsigned short *fps;
+	const struct mphash *mph;
+};
+
+static inline unsigned long level_hash(unsigned long, unsigned long,
+	unsigned long);
+static unsigned long lookup(const struct mphash *, unsigned long);
+static void run_jobs(void *(*)(void *), struct build_job *, int);
+static void * hash_keys(void *);
+static void * mark_bits(void *);
+static void * collect_collided(void *);
+static void * place_values(void *);
+static int cmp_ulong(const void *, const void *);
+static void attach(struct mphash *, unsigned char *, size_t);
+static size_t image_size(const struct mphash_header *);
+
+/* 
+ * Builds a minimal perfect hash map of the N distinct keys 
+ * in NTHREADS threads.
+ */
+void
+mphash_build(struct mphash *mph, const struct element *items,
+	unsigned long n, double gamma, int nthreads)
+{
+	struct build_job *jobs;
+	struct mphash_header hdr;
+	unsigned long *keys, *next, *tmp, nkeys, nbits, nwords;
+	unsigned long *lvbits[MPHASH_MAX_LEVELS], lvwords[MPHASH_MAX_LEVELS];
+	unsigned long i, l, w, cnt, *p;
+	atomic_ulong *bits, *coll;
+	unsigned char *base;
+	size_t len;
+	int t;
+
+	assert(n > 0 && gamma > 0.0);
+	if (nthreads <= 0)
+		nthreads = 1;
+
+	jobs = (struct build_job *)algcalloc(nthreads, 
+		sizeof(struct build_job));
+	keys = (unsigned long *)algmalloc(n * sizeof(long));
+	next = (unsigned long *)algmalloc(n * sizeof(long));
+
+	for (t = 0; t < nthreads; t++) {
+		jobs[t].items = items;
+		jobs[t].next = keys;
+		jobs[t].lo = n * t / nthreads;
+		jobs[t].hi = n * (t + 1) / nthreads;
+	}
+	run_jobs(hash_keys, jobs, nthreads);
+
+	/* every level keeps the keys having a bit of their own */
+	for (l = 0, nkeys = n, nwords = 0; l < MPHASH_MAX_LEVELS && 
+		nkeys > 0; l++) {
+		nbits = (unsigned long)(gamma * (double)nkeys);
+		nbits = nbits < 64 ? 64 : (nbits + 63) / 64 * 64;
+		bits = (atomic_ulong *)algcalloc(nbits / 64, 
+			sizeof(atomic_ulong));
+		coll = (atomic_ulong *)algcalloc(nbits / 64, 
+			sizeof(atomic_ulong));
+
+		for (t = 0; t < nthreads; t++) {
+			jobs[t].keys = keys;
+			jobs[t].lo = nkeys * t / nthreads;
+			jobs[t].hi = nkeys * (t + 1) / nthreads;
+			jobs[t].next = next;
+			jobs[t].bits = bits;
+			jobs[t].coll = coll;
+			jobs[t].nbits = nbits;
+			jobs[t].level = l;
+		}
+		run_jobs(mark_bits, jobs, nthreads);
+		run_jobs(collect_collided, jobs, nthreads);
+
+		lvbits[l] = (unsigned long *)algmalloc(nbits / 8);
+		for (w = 0; w < nbits / 64; w++)
+			lvbits[l][w] = atomic_load_explicit(&bits[w],
+				memory_order_relaxed) & 
+				~atomic_load_explicit(&coll[w],
+				memory_order_relaxed);
+		lvwords[l] = nbits / 64;
+		nwords += nbits / 64;
+		ALGFREE(bits);
+		ALGFREE(coll);
+
+		/* the collided keys of all threads are moved together */
+		for (t = 0, cnt = 0; t < nthreads; t++) {
+			memmove(next + cnt, next + jobs[t].lo, 
+				jobs[t].nnext * sizeof(long));
+			cnt += jobs[t].nnext;
+		}
+		nkeys = cnt;
+		tmp = keys;
+		keys = next;
+		next = tmp;
+	}
+
+	/* the rest of keys are kept by their hash codes */
+	qsort(keys, nkeys, sizeof(long), cmp_ulong);
+	for (i = 1; i < nkeys; i++)
+		if (keys[i] == keys[i - 1])
+			errmsg_exit("Duplicate keys or hash codes, "
+				"the keys must be distinct.\n");
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, MPHASH_MAGIC, sizeof(hdr.magic));
+	hdr.nkeys = n;
+	hdr.nlevels = l;
+	hdr.nwords = nwords;
+	hdr.nranks = (nwords + RANK_WORDS - 1) / RANK_WORDS + 1;
+	hdr.nfallback = nkeys;
+
+	len = image_size(&hdr);
+	base = (unsigned char *)algcalloc(len, 1);
+	memcpy(base, &hdr, sizeof(hdr));
+	attach(mph, base, len);
+	mph->mapped = 0;
+
+	p = (unsigned long *)mph->levels;
+	for (l = 0, w = 0; l < hdr.nlevels; l++) {
+		p[l] = w;
+		memcpy((unsigned long *)mph->words + w, lvbits[l],
+			lvwords[l] * sizeof(long));
+		w += lvwords[l];
+		ALGFREE(lvbits[l]);
+	}
+	p[l] = w;
+
+	p = (unsigned long *)mph->ranks;
+	for (w = 0, cnt = 0; w < nwords; w++) {
+		if (w % RANK_WORDS == 0)
+			p[w / RANK_WORDS] = cnt;
+		cnt += (unsigned long)__builtin_popcountl(mph->words[w]);
+	}
+	p[hdr.nranks - 1] = cnt;
+	memcpy((unsigned long *)mph->fallback, keys, nkeys * sizeof(long));
+
+	for (t = 0; t < nthreads; t++) {
+		jobs[t].lo = n * t / nthreads;
+		jobs[t].hi = n * (t + 1) / nthreads;
+		jobs[t].values = (long *)mph->values;
+		jobs[t].fps = (unsigned short *)mph->fps;
+		jobs[t].mph = mph;
+	}
+	run_jobs(place_values, jobs, nthreads);
+
+	ALGFREE(keys);
+	ALGFREE(next);
+	ALGFREE(jobs);
+}
+
+/* Returns the index of the key in [0, N). */
+unsigned long
+mphash_index(const struct mphash *mph, const char *key)
+{
+	return lookup(mph, string_hash(key));
+}
+
+/* 
+ * Returns the value associated with the key, NULL if not found,
+ * the fingerprint rules out most keys not in the key set.
+ */
+const long *
+mphash_get(const struct mphash *mph, const char *key)
+{
+	unsigned long h, i;
+
+	if (key == NULL)
+		return NULL;
+
+	h = string_hash(key);
+	if ((i = lookup(mph, h)) >= mph->hdr->nkeys ||
+		mph->fps[i] != FINGERPRINT(h))
+		return NULL;
+	return &mph->values[i];
+}
+
+/* Writes the image of the map to the file. */
+void
+mphash_save(const struct mphash *mph, const char *fname)
+{
+	FILE *fp;
+
+	fp = open_file(fname, "wb");
+	if (fwrite(mph->base, 1, mph->len, fp) != mph->len)
+		errmsg_exit("Writes file %s failure, %s\n", fname,
+			strerror(errno));
+	close_file(fp);
+}
+
+/* Maps the image in the file, it is queried with no loading. */
+void
+mphash_open(struct mphash *mph, const char *fname)
+{
+	struct mphash_header hdr;
+	struct stat st;
+	void *base;
+	int fd;
+
+	if ((fd = open(fname, O_RDONLY)) < 0)
+		errmsg_exit("Open file %s failure, %s\n", fname,
+			strerror(errno));
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(hdr))
+		errmsg_exit("File %s is not an image.\n", fname);
+
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED)
+		errmsg_exit("Maps file %s failure, %s\n", fname,
+			strerror(errno));
+	close(fd);
+
+	memcpy(&hdr, base, sizeof(hdr));
+	if (memcmp(hdr.magic, MPHASH_MAGIC, sizeof(hdr.magic)) != 0 ||
+		image_size(&hdr) != (size_t)st.st_size)
+		errmsg_exit("File %s is not an image.\n", fname);
+
+	attach(mph, (unsigned char *)base, st.st_size);
+	mph->mapped = 1;
+}
+
+/* Clears this minimal perfect hash map. */
+void
+mphash_clear(struct mphash *mph)
+{
+	if (mph->mapped)
+		munmap(mph->base, mph->len);
+	else
+		ALGFREE(mph->base);
+	mph->base = NULL;
+	mph->len = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* Returns the bit of the key hash code H at level L of N bits. */
+static inline unsigned long
+level_hash(unsigned long h, unsigned long l, unsigned long n)
+{
+	h ^= (l + 1) * 0x9e3779b97f4a7c15UL;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdUL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53UL;
+	h ^= h >> 33;
+
+	return h % n;
+}
+
+/* Returns the index of the key hash code. */
+static unsigned long
+lookup(const struct mphash *mph, unsigned long h)
+{
+	const struct mphash_header *hdr = mph->hdr;
+	unsigned long l, b, w, i, r, lo, hi, mid;
+
+	for (l = 0; l < hdr->nlevels; l++) {
+		b = level_hash(h, l, (mph->levels[l + 1] - 
+			mph->levels[l]) * 64);
+		w = mph->levels[l] + b / 64;
+		if ((mph->words[w] >> (b % 64) & 1) == 0)
+			continue;
+
+		/* the rank of the bit */
+		r = mph->ranks[w / RANK_WORDS];
+		for (i = w / RANK_WORDS * RANK_WORDS; i < w; i++)
+			r += (unsigned long)__builtin_popcountl(mph->words[i]);
+		r += (unsigned long)__builtin_popcountl(mph->words[w] &
+			((1UL << (b % 64)) - 1));
+		return r;
+	}
+
+	lo = 0;
+	hi = hdr->nfallback;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (mph->fallback[mid] < h)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	/* returns an index beyond the keys if not found */
+	if (lo == hdr->nfallback || mph->fallback[lo] != h)
+		return hdr->nkeys;
+	return mph->ranks[hdr->nranks - 1] + lo;
+}
+
+/* Runs the job in NTHREADS threads, and waits them. */
+static void
+run_jobs(void *(*job)(void *), struct build_job *jobs, int nthreads)
+{
+	pthread_t *tids;
+	int t;
+
+	if (nthreads == 1) {
+		job(&jobs[0]);
+		return;
+	}
+
+	tids = (pthread_t *)algmalloc(nthreads * sizeof(pthread_t));
+	for (t = 0; t < nthreads; t++)
+		if (pthread_create(&tids[t], NULL, job, &jobs[t]) != 0)
+			errmsg_exit("Creates thread failure.\n");
+	for (t = 0; t < nthreads; t++)
+		pthread_join(tids[t], NULL);
+	ALGFREE(tids);
+}
+
+static void *
+hash_keys(void *arg)
+{
+	struct build_job *job = (struct build_job *)arg;
+	unsigned long i;
+
+	for (i = job->lo; i < job->hi; i++)
+		job->next[i] = string_hash(job->items[i].key);
+
+	return NULL;
+}
+
+/* Sets the bit of every key, or the collision bit if it was set. */
+static void *
+mark_bits(void *arg)
+{
+	struct build_job *job = (struct build_job *)arg;
+	unsigned long i, b, bit, old;
+
+	for (i = job->lo; i < job->hi; i++) {
+		b = level_hash(job->keys[i], job->level, job->nbits);
+		bit = 1UL << (b % 64);
+		old = atomic_fetch_or_explicit(&job->bits[b / 64], bit,
+			memory_order_relaxed);
+		if ((old & bit) != 0)
+			atomic_fetch_or_explicit(&job->coll[b / 64], bit,
+				memory_order_relaxed);
+	}
+
+	return NULL;
+}
+
+/* Moves the keys collided to the front of this thread's part. */
+static void *
+collect_collided(void *arg)
+{
+	struct build_job *job = (struct build_job *)arg;
+	unsigned long i, b;
+
+	job->nnext = 0;
+	for (i = job->lo; i < job->hi; i++) {
+		b = level_hash(job->keys[i], job->level, job->nbits);
+		if ((atomic_load_explicit(&job->coll[b / 64],
+			memory_order_relaxed) >> (b % 64) & 1) != 0)
+			job->next[job->lo + job->nnext++] = job->keys[i];
+	}
+
+	return NULL;
+}
+
+/* Stores the value and fingerprint of every key at its index. */
+static void *
+place_values(void *arg)
+{
+	struct build_job *job = (struct build_job *)arg;
+	unsigned long i, h, k;
+
+	for (i = job->lo; i < job->hi; i++) {
+		h = string_hash(job->items[i].key);
+		k = lookup(job->mph, h);
+		job->values[k] = job->items[i].value;
+		job->fps[k] = FINGERPRINT(h);
+	}
+
+	return NULL;
+}
+
+static int
+cmp_ulong(const void *a, const void *b)
+{
+	unsigned long x = *(const unsigned long *)a;
+	unsigned long y = *(const unsigned long *)b;
+
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Sets the pointers into the image. */
+static void
+attach(struct mphash *mph, unsigned char *base, size_t len)
+{
+	const struct mphash_header *hdr;
+	unsigned long *p;
+
+	mph->base = base;
+	mph->len = len;
+	mph->hdr = hdr = (const struct mphash_header *)base;
+
+	p = (unsigned long *)(base + sizeof(struct mphash_header));
+	mph->levels = p;
+	p += hdr->nlevels + 1;
+	mph->words = p;
+	p += hdr->nwords;
+	mph->ranks = p;
+	p += hdr->nranks;
+	mph->fallback = p;
+	p += hdr->nfallback;
+	mph->values = (const long *)p;
+	p += hdr->nkeys;
+	mph->fps = (const unsigned short *)p;
+}
+
+/* Returns the bytes of the image, 8 bytes aligned. */
+static size_t
+image_size(const struct mphash_header *hdr)
+{
+	return sizeof(struct mphash_header) + (hdr->nlevels + 1 + 
+		hdr->nwords + hdr->nranks + hdr->nfallback + hdr->nkeys) *
+		sizeof(long) + (hdr->nkeys * sizeof(short) + 7) / 8 * 8;
+}
@@ -0,0 +1,289 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "robinhoodhash.h"
+#include "queue.h"
+
+#define RHHASH_MIN_SIZE		8
+
+/* Is the slot i of the table empty? */
+#define RHHASH_ISNULL(rhh, i)	((rhh)->dists[i] == 0)
+
+static inline unsigned long hash_code(const char *, unsigned long);
+static void alloc_slots(struct robin_hood_hash *, unsigned long);
+static void resize(struct robin_hood_hash *, unsigned long);
+static int insert(struct robin_hood_hash *, const struct element *);
+static long locate(const struct robin_hood_hash *, const char *);
+
+/* 
+ * Initializes an empty Robin Hood hash table, 
+ * the size is rounded up to a power of 2.
+ */
+void
+rhhash_init(struct robin_hood_hash *rhh, unsigned long htsize)
+{
+	unsigned long sz = RHHASH_MIN_SIZE;
+
+	while (sz < htsize)
+		sz <<= 1;
+
+	rhh->pairs = 0;
+	alloc_slots(rhh, sz);
+}
+
+/* 
+ * Returns the value associated with the specified key
+ * in the Robin Hood hash table.
+ */
+struct element *
+rhhash_get(const struct robin_hood_hash *rhh, const char *key)
+{
+	long i;
+
+	if (key == NULL || (i = locate(rhh, key)) < 0)
+		return NULL;
+	return &(rhh->items[i]);
+}
+
+/* 
+ * Returns the number of slots visited by searching the key 
+ * in the Robin Hood hash table.
+ */
+unsigned long
+rhhash_probes(const struct robin_hood_hash *rhh, const char *key)
+{
+	unsigned long i, mask = rhh->size - 1;
+	unsigned int dist;
+
+	i = hash_code(key, rhh->size);
+	for (dist = 1; dist <= rhh->dists[i]; dist++) {
+		if (strcmp(rhh->items[i].key, key) == 0)
+			break;
+		i = (i + 1) & mask;
+	}
+
+	return dist;
+}
+
+/* 
+ * Inserts the specified key-value pair into the Robin Hood hash table,
+ * overwriting the old value with the new value if the table 
+ * already contains the specified key.
+ *
+ * While probing, an element that is closer to its home slot than 
+ * the incoming one gives up its slot ("takes from the rich"), 
+ * the displaced element then continues probing. 
+ * That keeps the variance of the probe distances small.
+ */
+void
+rhhash_put(struct robin_hood_hash *rhh, const struct element *item)
+{
+	long i;
+
+	assert(item != NULL);
+
+	if ((i = locate(rhh, item->key)) >= 0) {
+		rhh->items[i].value = item->value;
+		return;
+	}
+
+	if ((double)(rhh->pairs + 1) > (double)rhh->size * RHHASH_MAX_LOAD)
+		resize(rhh, rhh->size * 2);
+
+	/* a too long probe sequence, grows the table and retries */
+	while (insert(rhh, item) != 0)
+		resize(rhh, rhh->size * 2);
+}
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the Robin Hood hash table.
+ *
+ * Instead of a tombstone, the following elements in the same
+ * cluster are shifted backward by one slot until an empty slot 
+ * or an element in its home slot is met.
+ */
+void
+rhhash_delete(struct robin_hood_hash *rhh, const char *key)
+{
+	long i;
+	unsigned long j, mask = rhh->size - 1;
+
+	if (key == NULL || (i = locate(rhh, key)) < 0)
+		return;
+
+	j = (i + 1) & mask;
+	while (rhh->dists[j] > 1) {
+		rhh->items[i] = rhh->items[j];
+		rhh->dists[i] = rhh->dists[j] - 1;
+		i = j;
+		j = (j + 1) & mask;
+	}
+
+	rhh->dists[i] = 0;
+	rhh->pairs--;
+}
+
+/* Returns all keys in this Robin Hood hash table */
+void
+rhhash_keys(const struct robin_hood_hash *rhh, struct queue *keys)
+{
+	unsigned long i;
+
+	for (i = 0; i < rhh->size; i++)
+		if (!RHHASH_ISNULL(rhh, i))
+			enqueue(keys, rhh->items[i].key);
+}
+
+/* Clears this Robin Hood hash table. */
+void
+rhhash_clear(struct robin_hood_hash *rhh)
+{
+	ALGFREE(rhh->dists);
+	ALGFREE(rhh->items);
+	rhh->pairs = 0;
+	rhh->size = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* Returns the home slot of the key, between 0 and size-1. */
+static inline unsigned long
+hash_code(const char *key, unsigned long htsize)
+{
+	return string_hash(key) & (htsize - 1);
+}
+
+static void
+alloc_slots(struct robin_hood_hash *rhh, unsigned long htsize)
+{
+	rhh->size = htsize;
+	rhh->dists = (unsigned char *)algcalloc(htsize, sizeof(char));
+	rhh->items = (struct element *)
+		algmalloc(htsize * sizeof(struct element));
+}
+
+/* Rehashes all key-value pairs into a table of the given size. */
+static void
+resize(struct robin_hood_hash *rhh, unsigned long htsize)
+{
+	unsigned char *odists;
+	struct element *oitems;
+	unsigned long i, osize;
+
+	odists = rhh->dists;
+	oitems = rhh->items;
+	osize = rhh->size;
+
+	rhh->pairs = 0;
+	alloc_slots(rhh, htsize);
+	for (i = 0; i < osize; i++)
+		if (odists[i] != 0 && insert(rhh, &oitems[i]) != 0) {
+			/* it is rare, starts over with a larger table */
+			ALGFREE(rhh->dists);
+			ALGFREE(rhh->items);
+			rhh->dists = odists;
+			rhh->items = oitems;
+			rhh->size = osize;
+			resize(rhh, htsize * 2);
+			return;
+		}
+
+	ALGFREE(odists);
+	ALGFREE(oitems);
+}
+
+/* 
+ * Inserts the item that is known not in the table, 
+ * returns -1 if a probe distance exceeded RHHASH_MAX_DIST,
+ * the table is left unchanged in that case.
+ */
+static int
+insert(struct robin_hood_hash *rhh, const struct element *item)
+{
+	struct element el, tmp;
+	unsigned long i, mask = rhh->size - 1;
+	unsigned int dist, td;
+
+	/* simulates the probing first, nothing moves if it fails */
+	i = hash_code(item->key, rhh->size);
+	for (dist = 1; !RHHASH_ISNULL(rhh, i); dist++) {
+		if (rhh->dists[i] < dist)
+			dist = rhh->dists[i];
+		if (dist == RHHASH_MAX_DIST + 1)
+			return -1;
+		i = (i + 1) & mask;
+	}
+
+	el = *item;
+	i = hash_code(item->key, rhh->size);
+	dist = 1;
+	while (!RHHASH_ISNULL(rhh, i)) {
+		if (rhh->dists[i] < dist) {
+			tmp = rhh->items[i];
+			rhh->items[i] = el;
+			el = tmp;
+			td = rhh->dists[i];
+			rhh->dists[i] = (unsigned char)dist;
+			dist = td;
+		}
+		i = (i + 1) & mask;
+		dist++;
+	}
+
+	rhh->items[i] = el;
+	rhh->dists[i] = (unsigned char)dist;
+	rhh->pairs++;
+
+	return 0;
+}
+
+/* 
+ * Returns the slot of the key, -1 if not found.
+ * The search stops as soon as it meets an element closer to 
+ * its home slot than the key would be, because the insertion 
+ * would have put the key there.
+ */
+static long
+locate(const struct robin_hood_hash *rhh, const char *key)
+{
+	unsigned long i, mask = rhh->size - 1;
+	unsigned int dist;
+
+	i = hash_code(key, rhh->size);
+	for (dist = 1; dist <= rhh->dists[i]; dist++) {
+		if (strcmp(rhh->items[i].key, key) == 0)
+			return (long)i;
+		i = (i + 1) & mask;
+	}
+
+	return -1;
+}
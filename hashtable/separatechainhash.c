@@ -32,6 +32,7 @@
 #include "separatechainhash.h"
 #include "seqlist.h"
 #include "queue.h"
+#include "bloomfilter.h"
 
 /* Buffer hash key */
 static struct {
@@ -49,6 +50,7 @@ schash_init(struct schain_hash *sch, unsigned long htsize)
 	
 	sch->pairs = 0;
 	sch->size = htsize;
+	sch->guard = NULL;
 	sch->lists = (struct seqlist *)
 		algmalloc(htsize * sizeof(struct seqlist));
 	
@@ -69,10 +71,58 @@ schash_get(const struct schain_hash *sch, const char *key)
 	if (key == NULL)
 		return NULL;
 	
+	if (sch->guard != NULL && !bloom_contains(sch->guard, key))
+		return NULL;
+
 	hash = hash_code(key, sch->size);
 	return seqlist_get(&(sch->lists[hash]), key);
 }
 
+/* 
+ * Returns the number of nodes visited by searching the key 
+ * in the separate-chains hash table.
+ */
+unsigned long
+schash_probes(const struct schain_hash *sch, const char *key)
+{
+	struct seqlist_node *pnode;
+	unsigned long n = 0;
+
+	pnode = sch->lists[hash_code(key, sch->size)].first;
+	for (; pnode != NULL; pnode = pnode->next) {
+		n++;
+		if (strcmp(pnode->item.key, key) == 0)
+			break;
+	}
+
+	return n;
+}
+
+/* 
+ * Attaches a Bloom filter as the guard of schash_get(), 
+ * all keys in the separate-chains hash table are added into it.
+ * The deleted keys stay in the filter, which only makes it 
+ * less selective.
+ */
+void
+schash_set_guard(struct schain_hash *sch, struct bloom_filter *bf)
+{
+	struct queue keys;
+	void *key;
+
+	sch->guard = bf;
+	if (bf == NULL)
+		return;
+
+	QUEUE_INIT(&keys, 0);
+	schash_keys(sch, &keys);
+	while (!QUEUE_ISEMPTY(&keys)) {
+		dequeue(&keys, &key);
+		bloom_add(bf, key);
+	}
+	queue_clear(&keys);
+}
+
 /* 
  * Inserts the specified key-value pair into 
  * the separate-chains hash table.
@@ -94,6 +144,8 @@ schash_put(struct schain_hash *sch, const struct element *item)
 	
 	hash = hash_code(item->key, sch->size);
 	seqlist_put(&(sch->lists[hash]), item);
+	if (sch->guard != NULL)
+		bloom_add(sch->guard, item->key);
 }
 
 /* 
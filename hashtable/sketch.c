@@ -0,0 +1,244 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "countminsketch.h"
+#include "spacesaving.h"
+#include "hyperloglog.h"
+#include "zipf.h"
+#include <getopt.h>
+#include <pthread.h>
+
+#define STREAM_LEN	(1UL << 22)
+#define EPSILON		0.0005
+#define DELTA		0.01
+#define SUMMARY_KEYS	256
+#define TOPK		20
+#define PRECISION	14
+
+/* A part of the stream counted by a thread in its own sketches. */
+struct worker {
+	pthread_t tid;
+	unsigned long lo, hi;
+	struct cm_sketch cm, cu, cs;
+	struct space_saving ss;
+	struct hyperloglog hll;
+};
+
+static struct element *els;	/* keys read from the file */
+static unsigned long *stream;	/* ranks of the keys in the stream */
+
+static void * count_part(void *);
+static void usage_info(const char *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct element item;
+	struct worker *ws;
+	struct spsv_counter top[TOPK];
+	struct zipf_gen zg;
+	FILE *fp;
+	clock_t start_time, end_time;
+	char *fname = NULL;
+	unsigned long n = 0, cap = 1024, i, distinct, hits;
+	long *exact, ecm, ecu, ecs;
+	double skew = -1.0;
+	int nthreads = 0, t;
+
+	int op;
+	const char *optstr = "f:s:t:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'f':
+			fname = optarg;
+			break;
+		case 's':
+			if (sscanf(optarg, "%lf", &skew) != 1 || skew < 0.0)
+				errmsg_exit("Illegal skew. -s %s\n", optarg);
+			break;
+		case 't':
+			if (sscanf(optarg, "%d", &nthreads) != 1 ||
+				nthreads <= 0 || nthreads > 64)
+				errmsg_exit("Illegal threads. -t %s\n", optarg);
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	
+	fp = open_file(fname, "rb");
+	
+	SET_RANDOM_SEED;
+	
+	els = (struct element *)algmalloc(cap * sizeof(struct element));
+	rewind(fp);
+	while (!feof(fp)) {
+		if (fread(&item, sizeof(struct element), 1, fp) > 0) {
+			if (n == cap) {
+				cap *= 2;
+				els = (struct element *)algrealloc(els,
+					cap * sizeof(struct element));
+			}
+			els[n++] = item;
+		}
+	}
+	close_file(fp);
+	if (n == 0)
+		errmsg_exit("No keys in file %s.\n", fname);
+	
+	printf("Generate a stream of %lu keys over %lu keys, skew %.2f.\n",
+		STREAM_LEN, n, skew);
+	zipf_init(&zg, n, skew);
+	stream = (unsigned long *)algmalloc(STREAM_LEN * sizeof(long));
+	exact = (long *)algcalloc(n, sizeof(long));
+	for (i = 0; i < STREAM_LEN; i++) {
+		stream[i] = zipf_next(&zg);
+		exact[stream[i]]++;
+	}
+	zipf_clear(&zg);
+	for (i = 0, distinct = 0; i < n; i++)
+		if (exact[i] > 0)
+			distinct++;
+	
+	printf("Count the stream in %d threads, each in its own sketches.\n",
+		nthreads);
+	ws = (struct worker *)algcalloc(nthreads, sizeof(struct worker));
+	start_time = clock();
+	for (t = 0; t < nthreads; t++) {
+		ws[t].lo = STREAM_LEN * t / nthreads;
+		ws[t].hi = STREAM_LEN * (t + 1) / nthreads;
+		if (pthread_create(&ws[t].tid, NULL, count_part, &ws[t]) != 0)
+			errmsg_exit("Creates thread failure.\n");
+	}
+	for (t = 0; t < nthreads; t++)
+		pthread_join(ws[t].tid, NULL);
+	
+	for (t = 1; t < nthreads; t++) {
+		cms_merge(&ws[0].cm, &ws[t].cm);
+		cms_merge(&ws[0].cu, &ws[t].cu);
+		cms_merge(&ws[0].cs, &ws[t].cs);
+		spsv_merge(&ws[0].ss, &ws[t].ss);
+		hll_merge(&ws[0].hll, &ws[t].hll);
+	}
+	end_time = clock();
+	printf("Count and merge completed, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("Sketch size: %u x %lu counters.\n\n", ws[0].cm.depth,
+		ws[0].cm.width);
+	
+	printf("%-20s %10s %10s %10s %10s %10s\n", "Hot key", "Exact",
+		"Count-min", "Conserv", "CountSk", "SpaceSav");
+	spsv_top(&ws[0].ss, top, TOPK);
+	for (i = 0, hits = 0; i < TOPK; i++) {
+		const struct spsv_counter *c = spsv_get(&ws[0].ss, els[i].key);
+
+		printf("%-20.20s %10ld %10ld %10ld %10ld %10ld\n", els[i].key,
+			exact[i], cms_estimate(&ws[0].cm, els[i].key), 
+			cms_estimate(&ws[0].cu, els[i].key),
+			cms_estimate(&ws[0].cs, els[i].key),
+			c != NULL ? c->count : 0L);
+		if (c != NULL && c->count >= top[TOPK - 1].count)
+			hits++;
+	}
+	printf("Recall of top %d keys by space-saving: %.2f\n\n", TOPK,
+		(double)hits / TOPK);
+	
+	for (i = 0, ecm = 0, ecu = 0, ecs = 0; i < n; i++) {
+		ecm += labs(cms_estimate(&ws[0].cm, els[i].key) - exact[i]);
+		ecu += labs(cms_estimate(&ws[0].cu, els[i].key) - exact[i]);
+		ecs += labs(cms_estimate(&ws[0].cs, els[i].key) - exact[i]);
+	}
+	printf("Mean absolute error over all keys, count-min: %.3f, "
+		"conservative: %.3f, count sketch: %.3f\n", (double)ecm / n,
+		(double)ecu / n, (double)ecs / n);
+	printf("Distinct keys: %lu, HyperLogLog estimated: %.0f\n", 
+		distinct, hll_estimate(&ws[0].hll));
+	
+	for (t = 0; t < nthreads; t++) {
+		cms_clear(&ws[t].cm);
+		cms_clear(&ws[t].cu);
+		cms_clear(&ws[t].cs);
+		spsv_clear(&ws[t].ss);
+		hll_clear(&ws[t].hll);
+	}
+	ALGFREE(ws);
+	ALGFREE(exact);
+	ALGFREE(stream);
+	ALGFREE(els);
+	
+	return 0;
+}
+
+static void *
+count_part(void *arg)
+{
+	struct worker *w = (struct worker *)arg;
+	const char *key;
+	unsigned long i;
+
+	cms_init(&w->cm, CMS_COUNT_MIN, EPSILON, DELTA);
+	cms_init(&w->cu, CMS_CONSERVATIVE, EPSILON, DELTA);
+	cms_init(&w->cs, CMS_COUNT_SKETCH, EPSILON, DELTA);
+	spsv_init(&w->ss, SUMMARY_KEYS);
+	hll_init(&w->hll, PRECISION);
+
+	for (i = w->lo; i < w->hi; i++) {
+		key = els[stream[i]].key;
+		cms_add(&w->cm, key, 1);
+		cms_add(&w->cu, key, 1);
+		cms_add(&w->cs, key, 1);
+		spsv_add(&w->ss, key, 1);
+		hll_add(&w->hll, key);
+	}
+
+	return NULL;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -f -s -t\n", pname);
+	fprintf(stderr, "-f: The key file written by randkeyval.\n");
+	fprintf(stderr, "-s: The Zipf skew of the key stream.\n");
+	fprintf(stderr, "-t: The number of threads to count.\n");
+	exit(EXIT_FAILURE);
+}
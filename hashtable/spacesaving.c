@@ -0,0 +1,286 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "spacesaving.h"
+
+static unsigned long key_hash(const void *, unsigned int);
+static void key_copy(char *, const char *);
+static unsigned long * find(const struct space_saving *, const char *);
+static void swim(struct space_saving *, unsigned long);
+static void sink(struct space_saving *, unsigned long);
+static void rebuild(struct space_saving *, const struct spsv_counter *,
+		unsigned long);
+static int cmp_count(const void *, const void *);
+
+/* Initializes an empty summary monitors at most CAPACITY keys. */
+void
+spsv_init(struct space_saving *ss, unsigned long capacity)
+{
+	assert(capacity > 0);
+
+	ss->capacity = capacity;
+	ss->size = 0;
+	ss->total = 0;
+	ss->counters = (struct spsv_counter *)algmalloc(capacity *
+		sizeof(struct spsv_counter));
+	ss->heap = (unsigned long *)algmalloc(capacity * sizeof(long));
+	ss->pos = (unsigned long *)algmalloc(capacity * sizeof(long));
+	hmap_init(&ss->index, MAX_KEY_LEN, sizeof(long), key_hash, NULL);
+}
+
+/* 
+ * Counts the key COUNT times. If the key is not monitored and 
+ * the summary is full, it replaces the key with the smallest count.
+ */
+void
+spsv_add(struct space_saving *ss, const char *key, long count)
+{
+	struct spsv_counter *c;
+	char buf[MAX_KEY_LEN];
+	unsigned long *idx, i;
+
+	assert(count > 0);
+	ss->total += count;
+
+	key_copy(buf, key);
+	if ((idx = find(ss, buf)) != NULL) {
+		ss->counters[*idx].count += count;
+		sink(ss, ss->pos[*idx]);
+		return;
+	}
+
+	if (ss->size < ss->capacity) {
+		i = ss->size++;
+		c = &ss->counters[i];
+		memcpy(c->key, buf, MAX_KEY_LEN);
+		c->count = count;
+		c->error = 0;
+		ss->heap[i] = i;
+		ss->pos[i] = i;
+		hmap_put(&ss->index, c->key, &i);
+		swim(ss, i);
+		return;
+	}
+
+	/* the key with the smallest count is evicted */
+	i = ss->heap[0];
+	c = &ss->counters[i];
+	hmap_delete(&ss->index, c->key);
+	memcpy(c->key, buf, MAX_KEY_LEN);
+	c->error = c->count;
+	c->count += count;
+	hmap_put(&ss->index, c->key, &i);
+	sink(ss, 0);
+}
+
+/* Returns the counter of the key, NULL if it is not monitored. */
+const struct spsv_counter *
+spsv_get(const struct space_saving *ss, const char *key)
+{
+	char buf[MAX_KEY_LEN];
+	unsigned long *idx;
+
+	key_copy(buf, key);
+	if ((idx = find(ss, buf)) == NULL)
+		return NULL;
+	return &ss->counters[*idx];
+}
+
+/* Copies the K most frequent keys into TOP by descending count. */
+unsigned long
+spsv_top(const struct space_saving *ss, struct spsv_counter *top,
+	unsigned long k)
+{
+	struct spsv_counter *all;
+
+	all = (struct spsv_counter *)algmalloc((ss->size + 1) *
+		sizeof(struct spsv_counter));
+	memcpy(all, ss->counters, ss->size * sizeof(struct spsv_counter));
+	qsort(all, ss->size, sizeof(struct spsv_counter), cmp_count);
+
+	if (k > ss->size)
+		k = ss->size;
+	memcpy(top, all, k * sizeof(struct spsv_counter));
+	ALGFREE(all);
+
+	return k;
+}
+
+/* Merges the summary SRC into DST. */
+void
+spsv_merge(struct space_saving *dst, const struct space_saving *src)
+{
+	struct spsv_counter *all, *c;
+	const struct spsv_counter *s;
+	unsigned long i, n;
+	long dmin, smin;
+
+	/* a key missing in a summary not full is surely not counted */
+	dmin = dst->size == dst->capacity ? 
+		dst->counters[dst->heap[0]].count : 0;
+	smin = src->size == src->capacity ? 
+		src->counters[src->heap[0]].count : 0;
+
+	all = (struct spsv_counter *)algmalloc((dst->size + src->size + 1) *
+		sizeof(struct spsv_counter));
+	for (i = 0; i < dst->size; i++) {
+		c = &all[i];
+		*c = dst->counters[i];
+		if ((s = spsv_get(src, c->key)) != NULL) {
+			c->count += s->count;
+			c->error += s->error;
+		} else {
+			c->count += smin;
+			c->error += smin;
+		}
+	}
+	for (i = 0, n = dst->size; i < src->size; i++) {
+		s = &src->counters[i];
+		if (spsv_get(dst, s->key) != NULL)
+			continue;
+		c = &all[n++];
+		*c = *s;
+		c->count += dmin;
+		c->error += dmin;
+	}
+
+	qsort(all, n, sizeof(struct spsv_counter), cmp_count);
+	rebuild(dst, all, n < dst->capacity ? n : dst->capacity);
+	dst->total += src->total;
+	ALGFREE(all);
+}
+
+/* Clears this summary. */
+void
+spsv_clear(struct space_saving *ss)
+{
+	ALGFREE(ss->counters);
+	ALGFREE(ss->heap);
+	ALGFREE(ss->pos);
+	hmap_clear(&ss->index);
+	ss->capacity = 0;
+	ss->size = 0;
+	ss->total = 0;
+}
+
+/******************** static function boundary ********************/
+
+static unsigned long
+key_hash(const void *key, unsigned int ksize)
+{
+	(void)ksize;
+	return string_hash((const char *)key);
+}
+
+/* The keys of the index are zero-padded, so memcmp() compares them. */
+static void
+key_copy(char *buf, const char *key)
+{
+	memset(buf, 0, MAX_KEY_LEN);
+	memcpy(buf, key, strnlen(key, MAX_KEY_LEN - 1));
+}
+
+static unsigned long *
+find(const struct space_saving *ss, const char *buf)
+{
+	return (unsigned long *)hmap_get(&ss->index, buf);
+}
+
+/* Moves the counter at heap position K up to its place. */
+static void
+swim(struct space_saving *ss, unsigned long k)
+{
+	unsigned long i = ss->heap[k], p;
+	long cnt = ss->counters[i].count;
+
+	while (k > 0) {
+		p = (k - 1) / 2;
+		if (ss->counters[ss->heap[p]].count <= cnt)
+			break;
+		ss->heap[k] = ss->heap[p];
+		ss->pos[ss->heap[k]] = k;
+		k = p;
+	}
+	ss->heap[k] = i;
+	ss->pos[i] = k;
+}
+
+/* Moves the counter at heap position K down to its place. */
+static void
+sink(struct space_saving *ss, unsigned long k)
+{
+	unsigned long i = ss->heap[k], j;
+	long cnt = ss->counters[i].count;
+
+	while ((j = 2 * k + 1) < ss->size) {
+		if (j + 1 < ss->size && ss->counters[ss->heap[j + 1]].count <
+			ss->counters[ss->heap[j]].count)
+			j++;
+		if (cnt <= ss->counters[ss->heap[j]].count)
+			break;
+		ss->heap[k] = ss->heap[j];
+		ss->pos[ss->heap[k]] = k;
+		k = j;
+	}
+	ss->heap[k] = i;
+	ss->pos[i] = k;
+}
+
+/* Refills the summary with the N counters sorted by descending count. */
+static void
+rebuild(struct space_saving *ss, const struct spsv_counter *cs,
+	unsigned long n)
+{
+	unsigned long i, k;
+
+	hmap_clear(&ss->index);
+	hmap_init(&ss->index, MAX_KEY_LEN, sizeof(long), key_hash, NULL);
+
+	/* a descending array reversed is a min-heap */
+	for (i = 0; i < n; i++) {
+		ss->counters[i] = cs[i];
+		k = n - 1 - i;
+		ss->heap[k] = i;
+		ss->pos[i] = k;
+		hmap_put(&ss->index, ss->counters[i].key, &i);
+	}
+	ss->size = n;
+}
+
+/* Orders the counters by descending count. */
+static int
+cmp_count(const void *a, const void *b)
+{
+	long x = ((const struct spsv_counter *)a)->count;
+	long y = ((const struct spsv_counter *)b)->count;
+
+	return x > y ? -1 : (x < y ? 1 : 0);
+}
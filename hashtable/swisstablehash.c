@@ -0,0 +1,358 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "swisstablehash.h"
+#include "queue.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* 
+ * Control bytes: a full slot holds the low 7 bits of the hash code 
+ * (0 ~ 127), the empty and deleted slots have the sign bit set.
+ */
+#define CTRL_EMPTY	((signed char)-128)
+#define CTRL_DELETED	((signed char)-2)
+
+#define SWHASH_MIN_SIZE		SWHASH_GROUP_WIDTH
+
+/* Is the control byte a full slot? */
+#define ISFULL(c)	((c) >= 0)
+
+/* The high bits of hash code choose the group, the low 7 bits are tag */
+#define HASH_H1(h)	((h) >> 7)
+#define HASH_H2(h)	((signed char)((h) & 0x7f))
+
+static inline unsigned int match_byte(const signed char *, signed char);
+static inline unsigned int match_empty(const signed char *);
+static inline unsigned int match_empty_or_deleted(const signed char *);
+static long locate(const struct swiss_table *, const char *, unsigned long);
+static unsigned long find_free_slot(const struct swiss_table *,
+	unsigned long);
+static void alloc_slots(struct swiss_table *, unsigned long);
+static void rehash(struct swiss_table *, unsigned long);
+
+/* 
+ * Initializes an empty swiss table, the size is rounded up to 
+ * a power of 2 and not less than one group.
+ */
+void
+swhash_init(struct swiss_table *swt, unsigned long htsize)
+{
+	unsigned long sz = SWHASH_MIN_SIZE;
+
+	while (sz < htsize)
+		sz <<= 1;
+
+	swt->pairs = 0;
+	swt->deleted = 0;
+	alloc_slots(swt, sz);
+}
+
+/* 
+ * Returns the value associated with the specified key
+ * in the swiss table.
+ */
+struct element *
+swhash_get(const struct swiss_table *swt, const char *key)
+{
+	long i;
+
+	if (key == NULL)
+		return NULL;
+
+	if ((i = locate(swt, key, string_hash(key))) < 0)
+		return NULL;
+	return &(swt->items[i]);
+}
+
+/* 
+ * Returns the number of groups visited by searching the key 
+ * in the swiss table.
+ */
+unsigned long
+swhash_probes(const struct swiss_table *swt, const char *key)
+{
+	unsigned long g, step, gmask, slot, hash;
+	unsigned int mask;
+	const signed char *group;
+
+	hash = string_hash(key);
+	gmask = swt->size / SWHASH_GROUP_WIDTH - 1;
+	g = HASH_H1(hash) & gmask;
+	for (step = 1; step <= gmask + 1; step++) {
+		group = swt->ctrl + g * SWHASH_GROUP_WIDTH;
+		mask = match_byte(group, HASH_H2(hash));
+		while (mask != 0) {
+			slot = g * SWHASH_GROUP_WIDTH + __builtin_ctz(mask);
+			if (strcmp(swt->items[slot].key, key) == 0)
+				return step;
+			mask &= mask - 1;
+		}
+
+		if (match_empty(group) != 0)
+			break;
+		g = (g + step) & gmask;
+	}
+
+	return step;
+}
+
+/* 
+ * Inserts the specified key-value pair into the swiss table, 
+ * overwriting the old value with the new value if the table 
+ * already contains the specified key.
+ */
+void
+swhash_put(struct swiss_table *swt, const struct element *item)
+{
+	unsigned long hash, i;
+	long j;
+
+	assert(item != NULL);
+
+	hash = string_hash(item->key);
+	if ((j = locate(swt, item->key, hash)) >= 0) {
+		swt->items[j].value = item->value;
+		return;
+	}
+
+	if (swt->pairs + swt->deleted + 1 > SWHASH_MAX_LOAD(swt->size)) {
+		/* 
+		 * drops the tombstones only if they are many enough, 
+		 * otherwise grows to double size.
+		 */
+		if (swt->deleted > swt->size / 4)
+			rehash(swt, swt->size);
+		else
+			rehash(swt, swt->size * 2);
+	}
+
+	i = find_free_slot(swt, hash);
+	if (swt->ctrl[i] == CTRL_DELETED)
+		swt->deleted--;
+	swt->ctrl[i] = HASH_H2(hash);
+	swt->items[i] = *item;
+	swt->pairs++;
+}
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the swiss table.
+ */
+void
+swhash_delete(struct swiss_table *swt, const char *key)
+{
+	long i;
+	unsigned long g;
+
+	if (key == NULL || (i = locate(swt, key, string_hash(key))) < 0)
+		return;
+
+	/* 
+	 * A group that still has an empty slot has never been full,
+	 * no probe sequence passed through it, so the slot can be 
+	 * empty again. Otherwise leaves a tombstone.
+	 */
+	g = (unsigned long)i & ~(unsigned long)(SWHASH_GROUP_WIDTH - 1);
+	if (match_empty(swt->ctrl + g) != 0)
+		swt->ctrl[i] = CTRL_EMPTY;
+	else {
+		swt->ctrl[i] = CTRL_DELETED;
+		swt->deleted++;
+	}
+	swt->pairs--;
+}
+
+/* Returns all keys in this swiss table */
+void
+swhash_keys(const struct swiss_table *swt, struct queue *keys)
+{
+	unsigned long i;
+
+	for (i = 0; i < swt->size; i++)
+		if (ISFULL(swt->ctrl[i]))
+			enqueue(keys, swt->items[i].key);
+}
+
+/* Clears this swiss table. */
+void
+swhash_clear(struct swiss_table *swt)
+{
+	ALGFREE(swt->ctrl);
+	ALGFREE(swt->items);
+	swt->pairs = 0;
+	swt->deleted = 0;
+	swt->size = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* 
+ * Returns a bit mask of the control bytes in the group
+ * that equal to C, bit i for the byte i.
+ */
+static inline unsigned int
+match_byte(const signed char *group, signed char c)
+{
+#ifdef __SSE2__
+	__m128i ctrl, match;
+
+	ctrl = _mm_loadu_si128((const __m128i *)group);
+	match = _mm_set1_epi8(c);
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(match, ctrl));
+#else
+	unsigned int i, mask = 0;
+
+	for (i = 0; i < SWHASH_GROUP_WIDTH; i++)
+		if (group[i] == c)
+			mask |= 1U << i;
+	return mask;
+#endif
+}
+
+/* Returns a bit mask of the empty slots in the group. */
+static inline unsigned int
+match_empty(const signed char *group)
+{
+	return match_byte(group, CTRL_EMPTY);
+}
+
+/* 
+ * Returns a bit mask of the empty or deleted slots in the group,
+ * they are just the control bytes that have the sign bit set.
+ */
+static inline unsigned int
+match_empty_or_deleted(const signed char *group)
+{
+#ifdef __SSE2__
+	return (unsigned int)_mm_movemask_epi8(
+		_mm_loadu_si128((const __m128i *)group));
+#else
+	unsigned int i, mask = 0;
+
+	for (i = 0; i < SWHASH_GROUP_WIDTH; i++)
+		if (!ISFULL(group[i]))
+			mask |= 1U << i;
+	return mask;
+#endif
+}
+
+/* 
+ * Returns the slot of the key, -1 if not found.
+ * Groups are probed in the triangular sequence, which visits 
+ * every group once when the number of groups is a power of 2. 
+ * Only the slots whose tags match are compared with the key, 
+ * the search ends at a group that has an empty slot.
+ */
+static long
+locate(const struct swiss_table *swt, const char *key, unsigned long hash)
+{
+	unsigned long g, step, gmask, slot;
+	unsigned int mask;
+	const signed char *group;
+
+	gmask = swt->size / SWHASH_GROUP_WIDTH - 1;
+	g = HASH_H1(hash) & gmask;
+	for (step = 1; step <= gmask + 1; step++) {
+		group = swt->ctrl + g * SWHASH_GROUP_WIDTH;
+		mask = match_byte(group, HASH_H2(hash));
+		while (mask != 0) {
+			slot = g * SWHASH_GROUP_WIDTH + __builtin_ctz(mask);
+			if (strcmp(swt->items[slot].key, key) == 0)
+				return (long)slot;
+			mask &= mask - 1;
+		}
+
+		if (match_empty(group) != 0)
+			break;
+		g = (g + step) & gmask;
+	}
+
+	return -1;
+}
+
+/* 
+ * Returns the first empty or deleted slot 
+ * in the probe sequence of the hash code.
+ */
+static unsigned long
+find_free_slot(const struct swiss_table *swt, unsigned long hash)
+{
+	unsigned long g, step, gmask;
+	unsigned int mask;
+
+	gmask = swt->size / SWHASH_GROUP_WIDTH - 1;
+	g = HASH_H1(hash) & gmask;
+	for (step = 1; ; step++) {
+		mask = match_empty_or_deleted(swt->ctrl +
+			g * SWHASH_GROUP_WIDTH);
+		if (mask != 0)
+			return g * SWHASH_GROUP_WIDTH + __builtin_ctz(mask);
+		g = (g + step) & gmask;
+	}
+}
+
+static void
+alloc_slots(struct swiss_table *swt, unsigned long htsize)
+{
+	swt->size = htsize;
+	swt->ctrl = (signed char *)algmalloc(htsize * sizeof(char));
+	memset(swt->ctrl, CTRL_EMPTY, htsize);
+	swt->items = (struct element *)
+		algmalloc(htsize * sizeof(struct element));
+}
+
+/* Moves all key-value pairs into a new table of the given size. */
+static void
+rehash(struct swiss_table *swt, unsigned long htsize)
+{
+	signed char *octrl;
+	struct element *oitems;
+	unsigned long i, j, osize, hash;
+
+	octrl = swt->ctrl;
+	oitems = swt->items;
+	osize = swt->size;
+
+	alloc_slots(swt, htsize);
+	swt->deleted = 0;
+	for (i = 0; i < osize; i++)
+		if (ISFULL(octrl[i])) {
+			hash = string_hash(oitems[i].key);
+			j = find_free_slot(swt, hash);
+			swt->ctrl[j] = HASH_H2(hash);
+			swt->items[j] = oitems[i];
+		}
+
+	ALGFREE(octrl);
+	ALGFREE(oitems);
+}
@@ -151,4 +151,16 @@ char * string_read_all(FILE *istream);
 /* Returns a substring from a string. */
 char * substring(const char *str, long lo, long hi);
 
+/* 
+ * Returns a 64-bit hash code of the string, 
+ * all bits of it are well mixed. 
+ */
+unsigned long string_hash(const char *str);
+
+/* 
+ * Returns a 64-bit hash code of the LEN bytes 
+ * that KEY points to.
+ */
+unsigned long bytes_hash(const void *key, size_t len);
+
 #endif /* _ALGCOMM_H_ */
@@ -74,6 +74,19 @@ void * avlbst_get(const struct avl_tree *avl, const void *key);
 /* Inserts the key into the AVL tree. */
 void avlbst_put(struct avl_tree *avl, const void *key);
 
+/* 
+ * Inserts the key into the AVL tree by recursion, 
+ * it is kept to compare with avlbst_put().
+ */
+void avlbst_put_recursive(struct avl_tree *avl, const void *key);
+
+/* 
+ * Builds the AVL tree from N keys in strictly ascending order 
+ * in linear time, the tree must be empty.
+ */
+void avlbst_build_sorted(struct avl_tree *avl, const void *keys,
+			unsigned long n);
+
 /* Clears this avl tree. */
 void avlbst_clear(struct avl_tree *avl);
 
@@ -117,4 +130,42 @@ void avlbst_breadth_first(const struct avl_tree *avl, struct single_list *keys);
 /* Check integrity of AVL tree data structure. */
 int avlbst_check(const struct avl_tree *avl);
 
+/* The max depth of an AVL tree, more than the height of any tree */
+#define AVLBST_CURSOR_DEPTH	128
+
+/* 
+ * A cursor over the keys of an AVL tree in ascending order, it keeps
+ * the path from the root to the current node, so no key is copied.
+ * It is invalid after the tree is modified.
+ */
+struct avlbst_cursor {
+	const struct avl_tree *avl;	/* the tree */
+	int depth;		/* number of nodes in the path */
+	struct avl_node *path[AVLBST_CURSOR_DEPTH];	/* the path */
+};
+
+/* Is the cursor on a key ? */
+#define AVLBST_CURSOR_VALID(c)	((c)->depth > 0)
+
+/* Initializes a cursor over the keys of an AVL tree. */
+void avlbst_cursor_init(struct avlbst_cursor *c, const struct avl_tree *avl);
+
+/* 
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL.
+ */
+void avlbst_cursor_seek(struct avlbst_cursor *c, const void *key);
+
+/* Moves the cursor to the largest key. */
+void avlbst_cursor_last(struct avlbst_cursor *c);
+
+/* Moves the cursor to the next key, returns 0 if there is none. */
+int avlbst_cursor_next(struct avlbst_cursor *c);
+
+/* Moves the cursor to the previous key, returns 0 if there is none. */
+int avlbst_cursor_prev(struct avlbst_cursor *c);
+
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void * avlbst_cursor_key(const struct avlbst_cursor *c);
+
 #endif /*_AVLTREE_H_ */
@@ -0,0 +1,133 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _BETREE_H_
+#define _BETREE_H_
+
+#include "algcomm.h"
+
+/* The default bytes of a B-epsilon tree node */
+#define BETREE_PAGE_SIZE	4096
+
+/* 
+ * Combines DELTA into the value VAL of an upsert, FOUND is false if 
+ * the key has no value yet, then VAL must be initialized from DELTA.
+ */
+typedef void betree_upsert_ft(void *val, const void *delta, int found);
+
+/* 
+ * B-epsilon tree node data type. A leaf holds the sorted key-value 
+ * pairs and is linked to its neighbours. An internal node holds
+ * the pivots, the children and a buffer of pending messages sorted
+ * by key, then by arrival, the child i holds the keys between pivot
+ * i - 1 and pivot i. A node may overflow while a batch goes through
+ * it, then it is split into as many nodes as needed.
+ */
+struct betree_node {
+	unsigned int sz;		/* number of keys or pivots */
+	unsigned int cap;		/* room for keys or pivots */
+	unsigned int nmsgs;		/* number of buffered messages */
+	unsigned int mcap;		/* room for messages */
+	int leaf;			/* is it a leaf node ? */
+	struct betree_node *prev;	/* previous leaf */
+	struct betree_node *sibling;	/* next leaf */
+	unsigned char *keys;		/* the keys or the pivots */
+	unsigned char *vals;		/* the values of a leaf */
+	struct betree_node **children;	/* the children of an internal */
+	unsigned char *msgs;		/* the messages of an internal */
+};
+
+/* 
+ * A write-optimized B+ tree with epsilon 1/2: an internal node of 
+ * one page spends about the square root of the page on pivots and 
+ * the rest on a message buffer. Puts, deletes and upserts are 
+ * messages added to the root buffer, a full buffer flushes the 
+ * messages of its busiest child down in one batch. So a leaf is 
+ * rewritten once for many updates, at the cost of reading the
+ * buffers on the way down. Deletes do not merge nodes.
+ */
+struct betree {
+	struct betree_node *root;	/* root of the tree */
+	int height;			/* height of the tree */
+	unsigned int keysize;		/* the bytes of the key */
+	unsigned int valsize;		/* the bytes of the value */
+	unsigned int msgsize;		/* the bytes of a message */
+	unsigned int pagesize;		/* bytes of a node */
+	unsigned int leafcap;		/* max number of keys in a leaf */
+	unsigned int innercap;		/* max number of pivots */
+	unsigned int bufcap;		/* max number of buffered messages */
+	unsigned long leafwrites;	/* number of times leaves rewritten */
+	algcomp_ft *cmp;		/* comparator over the keys */
+	betree_upsert_ft *upsert;	/* combines the upserts */
+	unsigned char *scratch;		/* one message */
+	unsigned char *mspare;		/* spare message buffer of merges */
+	unsigned int mspcap;		/* room of the spare buffer */
+};
+
+/* Returns the height of this B-epsilon tree */
+#define BETREE_HEIGHT(bt)	((bt)->height)
+
+/* Returns the max number of children of an internal node */
+#define BETREE_FANOUT(bt)	((bt)->innercap + 1)
+
+struct single_list;
+
+/* 
+ * Initializes an empty B-epsilon tree whose nodes are PGSZ bytes, 
+ * BETREE_PAGE_SIZE if PGSZ is 0. UPSERT may be NULL if 
+ * betree_upsert() is never called.
+ */
+void betree_init(struct betree *bt, unsigned int pgsz, unsigned int ksz,
+		unsigned int vsz, algcomp_ft *cmp, betree_upsert_ft *upsert);
+
+/* Inserts the key-value pair, overwriting the old value if any. */
+void betree_put(struct betree *bt, const void *key, const void *val);
+
+/* Deletes the key-value pair if the key is in the tree. */
+void betree_delete(struct betree *bt, const void *key);
+
+/* Combines DELTA into the value of the key by the upsert function. */
+void betree_upsert(struct betree *bt, const void *key, const void *delta);
+
+/* 
+ * Copies the value associated with the given key into VAL,
+ * returns 0 if the key is not found.
+ */
+int betree_get(const struct betree *bt, const void *key, void *val);
+
+/* Copies the keys between lokey and hikey into KEYS. */
+void betree_range_query(const struct betree *bt, const void *lokey,
+			const void *hikey, struct single_list *keys);
+
+/* Clears this B-epsilon tree */
+void betree_clear(struct betree *bt);
+
+#endif	/* _BETREE_H_ */
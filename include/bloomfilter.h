@@ -0,0 +1,142 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _BLOOMFILTER_H_
+#define _BLOOMFILTER_H_
+
+#include "algcomm.h"
+
+/* The number of bits in a block, one 64 bytes cache line. */
+#define BLOOM_BLOCK_BITS	512
+
+/* The number of 64-bit words in a block. */
+#define BLOOM_BLOCK_WORDS	(BLOOM_BLOCK_BITS / 64)
+
+/* The largest number of bits set per key. */
+#define BLOOM_MAX_HASHES	16
+
+/* The hash function type, returns a 64-bit hash code of the key. */
+typedef unsigned long bloom_hash_ft(const void *key);
+
+struct bloom_block {
+	_Alignas(64) unsigned long words[BLOOM_BLOCK_WORDS];
+};
+
+/* 
+ * A cache-blocked Bloom filter. All bits of a key are set in 
+ * the same block, so a lookup touches exactly one cache line.
+ * It may report a false positive, but never a false negative.
+ */
+struct bloom_filter {
+	unsigned long nblocks;		/* number of blocks */
+	int nhashes;			/* bits set per key */
+	struct bloom_block *blocks;	/* array of blocks */
+	bloom_hash_ft *hash;		/* hash function over the keys */
+};
+
+/* Returns the number of bits of this Bloom filter. */
+#define BLOOM_BITS(bf)		((bf)->nblocks * BLOOM_BLOCK_BITS)
+
+/* Returns the number of bits set per key. */
+#define BLOOM_HASHES(bf)	((bf)->nhashes)
+
+/* 
+ * Initializes an empty Bloom filter sized for NKEYS keys and 
+ * the false positive rate FPRATE. The keys are hashed by HASH,
+ * or by string_hash() if it is NULL.
+ */
+void bloom_init(struct bloom_filter *bf, unsigned long nkeys, double fprate,
+		bloom_hash_ft *hash);
+
+/* Removes all keys from this Bloom filter. */
+void bloom_reset(struct bloom_filter *bf);
+
+/* Clears this Bloom filter. */
+void bloom_clear(struct bloom_filter *bf);
+
+/* 
+ * Builds the bit mask of the key in its block, and returns the block.
+ * The block is chosen by the high half of the hash code, and each bit
+ * by the top 9 bits of the hash code multiplied by a odd constant.
+ */
+static inline struct bloom_block *
+bloom_mask(const struct bloom_filter *bf, const void *key,
+	unsigned long *mask)
+{
+	unsigned long h, s, a;
+	int i;
+
+	h = bf->hash != NULL ? bf->hash(key) : string_hash(key);
+
+	for (i = 0; i < BLOOM_BLOCK_WORDS; i++)
+		mask[i] = 0;
+	for (i = 0, s = h; i < bf->nhashes; i++) {
+		s *= 0x9e3779b97f4a7c15UL;
+		a = s >> 55;
+		mask[a >> 6] |= 1UL << (a & 63);
+	}
+
+	return &bf->blocks[((h >> 32) * bf->nblocks) >> 32];
+}
+
+/* Adds the key into this Bloom filter. */
+static inline void
+bloom_add(struct bloom_filter *bf, const void *key)
+{
+	struct bloom_block *bk;
+	unsigned long mask[BLOOM_BLOCK_WORDS];
+	int i;
+
+	bk = bloom_mask(bf, key, mask);
+	for (i = 0; i < BLOOM_BLOCK_WORDS; i++)
+		bk->words[i] |= mask[i];
+}
+
+/* 
+ * Returns false if the key is surely not in this Bloom filter, 
+ * true if it is maybe in. 
+ */
+static inline bool
+bloom_contains(const struct bloom_filter *bf, const void *key)
+{
+	const struct bloom_block *bk;
+	unsigned long mask[BLOOM_BLOCK_WORDS], miss = 0;
+	int i;
+
+	bk = bloom_mask(bf, key, mask);
+	/* no early exit, the loop is vectorized over the whole block */
+	for (i = 0; i < BLOOM_BLOCK_WORDS; i++)
+		miss |= mask[i] & ~bk->words[i];
+
+	return miss == 0;
+}
+
+#endif /* _BLOOMFILTER_H_ */
@@ -42,10 +42,17 @@ struct bstree_node {
 	long height;			/* height of the subtree */
 };
 
+/* 
+ * The tree is updated without recursion, the path from the root
+ * is kept in an array growing with the height of the tree, so 
+ * a degenerate tree of sorted keys does not overflow the stack.
+ */
 struct bstree {
 	struct bstree_node *root;	/* root node */
 	unsigned int keysize;		/* the bytes of the key */
 	algcomp_ft *cmp;		/* comparator over the keys */
+	struct bstree_node **path;	/* the path of an update */
+	unsigned long pathcap;		/* capacity of the path */
 };
 
 /* Returns the number of key-value pairs in this BST */
@@ -64,7 +71,8 @@ struct bstree {
 	((bst)->root == NULL ? (-1) : (bst)->root->height)
 
 /* Initializes an empty binary search tree */
-#define BST_INIT(b)	((b)->root = NULL)
+#define BST_INIT(b)	\
+	((b)->root = NULL, (b)->path = NULL, (b)->pathcap = 0)
 
 struct single_list;
 
@@ -74,6 +82,12 @@ void bst_init(struct bstree *bst, unsigned int ksize, algcomp_ft *kcmp);
 /* Inserts the key into the BST */
 int bst_put(struct bstree *bst, const void *key);
 
+/* 
+ * Inserts the key into the BST by recursion, it is kept to compare 
+ * with bst_put(), the depth of the recursion is the tree height.
+ */
+int bst_put_recursive(struct bstree *bst, const void *key);
+
 /* Returns the Key with the given key. */
 void * bst_get(const struct bstree *bst, const void *key);
 
@@ -132,4 +146,44 @@ void bst_keys(const struct bstree *bst, const void *lokey, const void *hikey,
 /* Check integrity of BST data structure. */
 int bst_check(const struct bstree *bst);
 
+/* 
+ * A cursor over the keys of a BST in ascending order, it keeps
+ * the path from the root to the current node, so no key is copied.
+ * The path grows with the tree height and is released by 
+ * bst_cursor_clear(). It is invalid after the tree is modified.
+ */
+struct bst_cursor {
+	const struct bstree *bst;	/* the tree */
+	unsigned long depth;	/* number of nodes in the path */
+	unsigned long cap;	/* capacity of the path */
+	struct bstree_node **path;	/* the path */
+};
+
+/* Is the cursor on a key ? */
+#define BST_CURSOR_VALID(c)	((c)->depth > 0)
+
+/* Initializes a cursor over the keys of a BST. */
+void bst_cursor_init(struct bst_cursor *c, const struct bstree *bst);
+
+/* 
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL.
+ */
+void bst_cursor_seek(struct bst_cursor *c, const void *key);
+
+/* Moves the cursor to the largest key. */
+void bst_cursor_last(struct bst_cursor *c);
+
+/* Moves the cursor to the next key, returns 0 if there is none. */
+int bst_cursor_next(struct bst_cursor *c);
+
+/* Moves the cursor to the previous key, returns 0 if there is none. */
+int bst_cursor_prev(struct bst_cursor *c);
+
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void * bst_cursor_key(const struct bst_cursor *c);
+
+/* Releases the path of the cursor. */
+void bst_cursor_clear(struct bst_cursor *c);
+
 #endif /* _BSEARCHTREE_H_ */
@@ -34,33 +34,22 @@
 
 #include "algcomm.h"
 
-/* 
- * Max children per B-tree node = MAX_CHILDREN-1
- * (must be even and greater than 2).
- */
-#define MAX_CHILDREN	8
-
-/* declare internal/external node */
-struct btree_entry;
-
-/* B-tree node data type */
-struct btree_node {
-	unsigned int sz;		/* number of children */
-	struct btree_entry *children[MAX_CHILDREN];	/* the ordered of
-							children */
-	struct btree_node *prev;	/* points to previous node */
-	struct btree_node *sibling;	/* points to next node */
-	struct btree_node *parent;	/* points to parent node */
-};
+/* The default bytes of a B-tree node */
+#define BTREE_PAGE_SIZE	4096
 
 /* 
- * internal nodes: only use key and next, 
- * external nodes: only use key and value.
+ * B-tree node data type, a node is one page of the page size.
+ * A leaf node holds the keys and then the values contiguously, 
+ * an internal node holds its children and then its keys, 
+ * the child i holds the keys between key i - 1 and key i.
+ * The nodes have a spare slot taken by an overflowing entry
+ * right before they split.
  */
-struct btree_entry {
-	void *key;			/* key contained by the entry */
-	void *value;			/* key associate with value */
-	struct btree_node *next;	/* points to lower level nodes */
+struct btree_node {
+	unsigned int sz;		/* number of keys */
+	struct btree_node *prev;	/* points to previous leaf */
+	struct btree_node *sibling;	/* points to next leaf */
+	unsigned char data[];		/* the entries of the node */
 };
 
 /* B-Tree */
@@ -70,7 +59,14 @@ struct btree {
 	unsigned long size;	/* number of key-value pairs in the B-tree */
 	unsigned int keysize;	/* max size of the key */
 	unsigned int valsize;	/* max size of the value */
+	unsigned int pagesize;	/* bytes of a node */
+	unsigned int leafcap;	/* max number of keys in a leaf node */
+	unsigned int innercap;	/* max number of keys in an internal node */
+	unsigned int valoff;	/* offset of the values in a leaf node */
+	unsigned int keyoff;	/* offset of the keys in an internal node */
+	void *sepkey;		/* the key moved up by a split */
 	algcomp_ft *kcmp;	/* compare function for keys */
+	struct bloom_filter *guard;	/* filters the missing keys */
 };
 
 /* Returns true if this symbol table is empty. */
@@ -84,22 +80,48 @@ struct btree {
 /* Returns the height of this B-tree */
 #define BTREE_HEIGHT(bt)	((bt)->height)
 
+/* Returns the max number of children of an internal node */
+#define BTREE_FANOUT(bt)	((bt)->innercap + 1)
+
 struct single_list;
+struct bloom_filter;
 
-/* Initializes an empty B-tree. */
-void btree_init(struct btree *bt, unsigned int ksz, unsigned int vsz, 
-		algcomp_ft *cmp);
+/* 
+ * Initializes an empty B-tree whose nodes are PGSZ bytes,
+ * BTREE_PAGE_SIZE if PGSZ is 0.
+ */
+void btree_init(struct btree *bt, unsigned int pgsz, unsigned int ksz, 
+		unsigned int vsz, algcomp_ft *cmp);
 
 /* Inserts the key-value pair into the B-Tree. */
 void btree_put(struct btree *bt, const void *key, const void *val);
 
+/* 
+ * Builds the B-tree bottom-up from N key-value pairs in strictly 
+ * ascending key order, filling the nodes to FILL (0 < FILL <= 1)
+ * of their capacity. The B-tree must be empty.
+ */
+void btree_bulk_load(struct btree *bt, const void *keys, const void *vals,
+			unsigned long n, double fill);
+
 /* Returns the value associated with the given key. */
 void btree_get(const struct btree *bt, const void *key, void **val);
 
+/* 
+ * Attaches a Bloom filter as the guard of btree_get(), 
+ * all keys in the B-tree are added into it. The filter must 
+ * hash what the comparator compares, returns -1 if it has no 
+ * hash function.
+ */
+int btree_set_guard(struct btree *bt, struct bloom_filter *bf);
+
 /* Clears this B-Tree */
 void btree_clear(struct btree *bt);
 
-/* Output query result that set between lokey and hikey. */
+/* 
+ * Output query result that set between lokey and hikey,
+ * the keys point into the leaf nodes.
+ */
 void btree_range_query(const struct btree *bt, const void *lokey,
 			const void *hikey, struct single_list *keys);
 
@@ -112,4 +134,42 @@ void * btree_first_key(const struct btree *bt);
 /* Returns the last key in this B-Tree. */
 void * btree_last_key(const struct btree *bt);
 
+/* 
+ * A cursor over the key-value pairs of the B-tree in ascending key 
+ * order, it walks the linked leaves. It is invalid after the B-tree
+ * is modified.
+ */
+struct btree_cursor {
+	const struct btree *bt;		/* the B-tree */
+	struct btree_node *leaf;	/* the current leaf, NULL if none */
+	unsigned int idx;		/* index of the key in the leaf */
+};
+
+/* Is the cursor on a key ? */
+#define BTREE_CURSOR_VALID(c)	((c)->leaf != NULL)
+
+/* Initializes a cursor over the B-tree. */
+void btree_cursor_init(struct btree_cursor *c, const struct btree *bt);
+
+/* 
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL.
+ */
+void btree_cursor_seek(struct btree_cursor *c, const void *key);
+
+/* Moves the cursor to the largest key. */
+void btree_cursor_last(struct btree_cursor *c);
+
+/* Moves the cursor to the next key, returns 0 if there is none. */
+int btree_cursor_next(struct btree_cursor *c);
+
+/* Moves the cursor to the previous key, returns 0 if there is none. */
+int btree_cursor_prev(struct btree_cursor *c);
+
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void * btree_cursor_key(const struct btree_cursor *c);
+
+/* Returns the value under the cursor, NULL if it is not on any key. */
+void * btree_cursor_value(const struct btree_cursor *c);
+
 #endif	/* _BTREE_H_ */
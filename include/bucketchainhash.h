@@ -0,0 +1,111 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _BUCKETCHAINHASH_H_
+#define _BUCKETCHAINHASH_H_
+
+#include "algcomm.h"
+
+/* The number of slots in a bucket. */
+#define BCHASH_BUCKET_SLOTS	6
+
+/* 
+ * The largest average number of key-value pairs per bucket, 
+ * the table grows to double size beyond that.
+ */
+#define BCHASH_MAX_LOAD		4
+
+/* 
+ * A bucket fills one 64 bytes cache line. A lookup compares the
+ * one byte fingerprints first, the elements are only visited on a 
+ * fingerprint match. A full bucket chains to an overflow bucket.
+ */
+struct bchash_bucket {
+	unsigned char tags[BCHASH_BUCKET_SLOTS];	/* fingerprints */
+	unsigned char count;			/* slots in use */
+	struct element *items[BCHASH_BUCKET_SLOTS];	/* key-value pairs */
+	struct bchash_bucket *next;		/* overflow bucket */
+};
+
+struct bchain_hash {
+	unsigned long pairs;		/* number of key-value pairs */
+	unsigned long size;		/* number of buckets, a power of 2 */
+	struct bchash_bucket *buckets;	/* array of buckets */
+};
+
+/* Returns the bucketized separate-chain hash table capacity */
+#define BCHASH_SIZE(bch)	((bch)->size)
+
+/* 
+ * Returns the number of key-value pairs in 
+ * this bucketized separate-chain hash table.
+ */
+#define BCHASH_PAIRS(bch)	((bch)->pairs)
+
+/* Is this bucketized separate-chain hash table empty? */
+#define BCHASH_ISEMPTY(bch)	((bch)->pairs == 0)
+
+struct queue;
+
+/* Initializes an empty bucketized separate-chain hash table. */
+void bchash_init(struct bchain_hash *bch, unsigned long htsize);
+
+/* 
+ * Returns the value associated with the specified key 
+ * in the bucketized separate-chain hash table.
+ */
+struct element * bchash_get(const struct bchain_hash *bch, const char *key);
+
+/* 
+ * Returns the number of buckets visited by searching the key 
+ * in the bucketized separate-chain hash table.
+ */
+unsigned long bchash_probes(const struct bchain_hash *bch, const char *key);
+
+/* 
+ * Inserts the specified key-value pair into 
+ * the bucketized separate-chain hash table.
+ */
+void bchash_put(struct bchain_hash *bch, const struct element *item);
+
+/* 
+ * Removes the specified key and its associated value
+ * from this bucketized separate-chain hash table.
+ */
+void bchash_delete(struct bchain_hash *bch, const char *key);
+
+/* Returns all keys in this bucketized separate-chain hash table. */
+void bchash_keys(const struct bchain_hash *bch, struct queue *keys);
+
+/* Clears this bucketized separate-chain hash table. */
+void bchash_clear(struct bchain_hash *bch);
+
+#endif /* _BUCKETCHAINHASH_H_ */
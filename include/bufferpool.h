@@ -0,0 +1,99 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _BUFFERPOOL_H_
+#define _BUFFERPOOL_H_
+
+#include "algcomm.h"
+
+/* A frame of the buffer pool caches one page of the file. */
+struct bpool_frame {
+	unsigned long pgno;	/* page number held by the frame */
+	unsigned int pins;	/* number of users of the page */
+	bool dirty;		/* the page is changed since it was read */
+	bool ref;		/* referenced since the clock hand passed */
+	bool used;		/* the frame holds a page */
+	unsigned char *page;	/* the page contents */
+};
+
+/* 
+ * A buffer pool of fixed-size pages stored in a file.
+ * The pages are fetched into frames which are reused by the 
+ * clock algorithm, a pinned page is never evicted. The dirty
+ * pages are written back when they are evicted or flushed.
+ */
+struct buffer_pool {
+	int fd;				/* file descriptor */
+	unsigned int pagesize;		/* bytes of a page */
+	unsigned long npages;		/* number of pages in the file */
+	unsigned long nframes;		/* number of frames */
+	struct bpool_frame *frames;	/* the frames */
+	unsigned char *pages;		/* the memory of all frames */
+	long *table;			/* page number to frame index */
+	unsigned long tabmask;		/* size of the table minus 1 */
+	unsigned long hand;		/* the clock hand */
+	unsigned long hits;		/* fetches found in the pool */
+	unsigned long misses;		/* fetches read from the file */
+	unsigned long writes;		/* pages written to the file */
+};
+
+/* Returns the number of pages in the file. */
+#define BPOOL_NPAGES(bp)	((bp)->npages)
+
+/* 
+ * Opens the file of PGSZ bytes pages with a pool of 
+ * NFRAMES frames, the file is created if it does not exist.
+ */
+void bpool_init(struct buffer_pool *bp, const char *path, unsigned int pgsz,
+		unsigned long nframes);
+
+/* Pins the page PGNO into the pool and returns its contents. */
+void * bpool_fetch(struct buffer_pool *bp, unsigned long pgno);
+
+/* 
+ * Appends a zeroed page to the file, the page is pinned and 
+ * its number is stored into PGNO.
+ */
+void * bpool_new(struct buffer_pool *bp, unsigned long *pgno);
+
+/* Unpins the page PGNO, DIRTY marks that it was changed. */
+void bpool_unpin(struct buffer_pool *bp, unsigned long pgno, bool dirty);
+
+/* Writes back all dirty pages. */
+void bpool_flush(struct buffer_pool *bp);
+
+/* Writes back all dirty pages and forces them to the disk. */
+void bpool_sync(struct buffer_pool *bp);
+
+/* Synchronizes and closes the file, then releases the pool. */
+void bpool_close(struct buffer_pool *bp);
+
+#endif /* _BUFFERPOOL_H_ */
@@ -0,0 +1,119 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _CONCURRENTBTREE_H_
+#define _CONCURRENTBTREE_H_
+
+#include "algcomm.h"
+#include <stdatomic.h>
+
+/* The default bytes of a concurrent B-tree node */
+#define CBTREE_PAGE_SIZE	4096
+
+/* 
+ * A node carries an optimistic latch: an even version when it is 
+ * free, odd while a writer holds it. Writers bump it on release, 
+ * so a reader that sees the same even version before and after 
+ * reading a node knows what it read is consistent. A leaf holds 
+ * the keys and then the values, an internal node holds its 
+ * children and then its keys, the child i holds the keys between
+ * key i - 1 and key i.
+ */
+struct cbtree_node {
+	atomic_ulong version;		/* the optimistic latch */
+	unsigned int sz;		/* number of keys */
+	int leaf;			/* is it a leaf node ? */
+	unsigned char data[];		/* the entries of the node */
+};
+
+/* 
+ * A B+ tree shared by many threads with optimistic lock coupling.
+ * Readers go down without writing to shared memory and restart 
+ * if a node they passed has changed. Writers latch only the leaf,
+ * or a full node and its parent to split it, so there is no global
+ * lock. The full nodes are split on the way down, a split never 
+ * goes up more than one level. Deletes do not merge the nodes, 
+ * they are all released by cbtree_clear().
+ */
+struct concurrent_btree {
+	_Atomic(struct cbtree_node *) root;	/* root of the B-tree */
+	atomic_int height;		/* height of the B-tree */
+	unsigned int keysize;		/* the bytes of the key */
+	unsigned int valsize;		/* the bytes of the value */
+	unsigned int pagesize;		/* bytes of a node */
+	unsigned int leafcap;		/* max number of keys in a leaf */
+	unsigned int innercap;		/* max number of keys in an inner */
+	unsigned int valoff;		/* offset of the values in a leaf */
+	unsigned int keyoff;		/* offset of the keys in an inner */
+	algcomp_ft *cmp;		/* comparator over the keys */
+	_Alignas(64) atomic_long size;	/* number of key-value pairs */
+};
+
+/* Returns the number of key-value pairs in this B-tree. */
+#define CBTREE_SIZE(bt)		\
+	((unsigned long)atomic_load_explicit(&(bt)->size, memory_order_relaxed))
+
+/* Returns the height of this B-tree. */
+#define CBTREE_HEIGHT(bt)	atomic_load(&(bt)->height)
+
+/* Returns the max number of children of an internal node */
+#define CBTREE_FANOUT(bt)	((bt)->innercap + 1)
+
+/* 
+ * Initializes an empty concurrent B-tree whose nodes are PGSZ bytes,
+ * CBTREE_PAGE_SIZE if PGSZ is 0. The keys of KSZ bytes and the values
+ * of VSZ bytes are copied into the nodes. The comparator may be given
+ * a key torn by a writer, it must not fail on it, the result is 
+ * thrown away.
+ */
+void cbtree_init(struct concurrent_btree *bt, unsigned int pgsz, 
+		unsigned int ksz, unsigned int vsz, algcomp_ft *cmp);
+
+/* 
+ * Copies the value associated with the given key into OUT, 
+ * returns -1 if not found.
+ */
+int cbtree_get(struct concurrent_btree *bt, const void *key, void *out);
+
+/* 
+ * Inserts the key-value pair, overwriting the old value if the key 
+ * is already in the B-tree. Returns 1 if the key is new, 0 otherwise.
+ */
+int cbtree_put(struct concurrent_btree *bt, const void *key, 
+		const void *val);
+
+/* Removes the key-value pair, returns -1 if not found. */
+int cbtree_delete(struct concurrent_btree *bt, const void *key);
+
+/* Clears this B-tree, no other thread may be using it. */
+void cbtree_clear(struct concurrent_btree *bt);
+
+#endif	/* _CONCURRENTBTREE_H_ */
@@ -0,0 +1,138 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _CONCURRENTHASH_H_
+#define _CONCURRENTHASH_H_
+
+#include "algcomm.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* 
+ * The number of segments, a power of 2. Writers on different 
+ * segments never contend with each other.
+ */
+#define CHASH_SEGMENTS		64
+
+/* 
+ * The largest load factor of a segment, 
+ * it grows to double size beyond that.
+ */
+#define CHASH_MAX_LOAD		0.75
+
+/* 
+ * The number of slots are moved from the old table 
+ * to the new one by each writer while a segment grows.
+ */
+#define CHASH_MIGRATE_STEP	64
+
+/* A linear-probing table owned by one segment. */
+struct chash_table {
+	unsigned long size;		/* table size, a power of 2 */
+	unsigned char *states;		/* empty, used or dead slots */
+	struct element *items;		/* key-value pairs */
+	struct chash_table *next;	/* next retired table */
+};
+
+/* 
+ * A segment is guarded by a mutex for writers and a sequence 
+ * counter for readers, which is odd while a writer is modifying it.
+ * Readers never lock, they retry if the counter has changed.
+ */
+struct chash_segment {
+	_Alignas(64) pthread_mutex_t lock;
+	atomic_ulong seq;			/* sequence counter */
+	struct chash_table *_Atomic table;	/* current table */
+	struct chash_table *_Atomic old;	/* table being migrated */
+	unsigned long moved;		/* next slot to migrate */
+	unsigned long pairs;		/* number of key-value pairs */
+	struct chash_table *retired;	/* tables no longer in use */
+};
+
+/* 
+ * A concurrent hash table shared by multiple threads. 
+ * A key is hashed to a segment first, and then to a slot.
+ */
+struct concurrent_hash {
+	struct chash_segment segs[CHASH_SEGMENTS];
+};
+
+struct queue;
+
+/* Initializes an empty concurrent hash table. */
+void chash_init(struct concurrent_hash *ch, unsigned long htsize);
+
+/* 
+ * Copies the key-value pair associated with the specified key 
+ * into ITEM, returns -1 if not found. It does not block writers.
+ */
+int chash_get(struct concurrent_hash *ch, const char *key,
+	struct element *item);
+
+/* 
+ * Returns the number of slots visited by searching the key in the
+ * concurrent hash table, it must not run concurrently with writers.
+ */
+unsigned long chash_probes(struct concurrent_hash *ch, const char *key);
+
+/* 
+ * Inserts the specified key-value pair into the concurrent hash table. 
+ */
+void chash_put(struct concurrent_hash *ch, const struct element *item);
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the concurrent hash table, returns -1 if not found.
+ */
+int chash_delete(struct concurrent_hash *ch, const char *key);
+
+/* 
+ * Returns the number of key-value pairs 
+ * in this concurrent hash table.
+ */
+unsigned long chash_pairs(struct concurrent_hash *ch);
+
+/* Returns the number of slots in this concurrent hash table. */
+unsigned long chash_size(struct concurrent_hash *ch);
+
+/* 
+ * Returns all keys in this concurrent hash table, 
+ * it must not run concurrently with writers.
+ */
+void chash_keys(struct concurrent_hash *ch, struct queue *keys);
+
+/* 
+ * Clears this concurrent hash table, 
+ * it must not run concurrently with other operations.
+ */
+void chash_clear(struct concurrent_hash *ch);
+
+#endif /* _CONCURRENTHASH_H_ */
@@ -0,0 +1,132 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _CONCURRENTSKIPLIST_H_
+#define _CONCURRENTSKIPLIST_H_
+
+#include "algcomm.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* The largest maximum level of a concurrent skip list. */
+#define CSKL_MAX_LEVEL		32
+
+/* The largest number of threads use the skip lists at the same time. */
+#define CSKL_MAX_THREADS	256
+
+/* 
+ * A node is removed logically by setting the low bit of its 
+ * forward links, from the top level down to level 0. The thread 
+ * that marks level 0 owns the deletion.
+ */
+struct cskl_node {
+	int height;			/* number of forward links */
+	atomic_int refs;		/* the inserter and the list */
+	struct cskl_node *retired;	/* next node waiting to be freed */
+	void *key;			/* the key copied behind the links */
+	_Atomic uintptr_t forward[];	/* marked links */
+};
+
+/* 
+ * A thread's record of epoch-based reclamation. A node unlinked in 
+ * epoch e is freed once every thread inside the skip list has seen 
+ * epoch e + 2, then no one can still hold a reference to it.
+ */
+struct cskl_thread {
+	_Alignas(64) atomic_ulong epoch;	/* epoch seen, 0 if outside */
+	unsigned long last;			/* last epoch entered */
+	unsigned long nretired;			/* retired since the last try */
+	struct cskl_node *limbo[3];		/* retired nodes by epoch */
+};
+
+/* 
+ * A lock-free ordered set of fixed size keys. Insertion and deletion 
+ * link and unlink nodes by compare-and-swap, searches never write
+ * and never retry, so they are wait-free.
+ */
+struct concurrent_skip_list {
+	struct cskl_node *head;		/* head node of skip-list */
+	int maxlevel;			/* maximum number of levels */
+	unsigned int keysize;		/* the bytes of the key */
+	algcomp_ft *cmp;		/* comparator over the keys */
+	atomic_long size;		/* number of keys */
+	_Alignas(64) atomic_ulong epoch;	/* global epoch */
+	struct cskl_thread threads[CSKL_MAX_THREADS];
+};
+
+/* Returns the number of keys in this skip list. */
+#define CSKL_SIZE(sl)		\
+	((unsigned long)atomic_load_explicit(&(sl)->size, memory_order_relaxed))
+
+struct single_list;
+
+/* 
+ * Initializes an empty concurrent skip list, 
+ * the keys of KSIZE bytes are copied into the nodes.
+ */
+void cskl_init(struct concurrent_skip_list *sl, int maxlvl, 
+		unsigned int ksize, algcomp_ft *cmp);
+
+/* 
+ * Copies the key equal to the given key into OUT, 
+ * returns -1 if not found.
+ */
+int cskl_get(struct concurrent_skip_list *sl, const void *key, void *out);
+
+/* Inserts the key, returns -1 if it is already in the skip list. */
+int cskl_put(struct concurrent_skip_list *sl, const void *key);
+
+/* Removes the key, returns -1 if not found. */
+int cskl_delete(struct concurrent_skip_list *sl, const void *key);
+
+/* 
+ * Copies the largest key less than or equal to the given key 
+ * into OUT, returns -1 if there is no such key.
+ */
+int cskl_floor(struct concurrent_skip_list *sl, const void *key, void *out);
+
+/* 
+ * Copies the smallest key greater than or equal to the given key 
+ * into OUT, returns -1 if there is no such key.
+ */
+int cskl_ceiling(struct concurrent_skip_list *sl, const void *key, 
+		void *out);
+
+/* 
+ * Copies all keys into the list in order, the keys inserted or 
+ * removed while scanning may or may not be seen.
+ */
+void cskl_keys(struct concurrent_skip_list *sl, struct single_list *keys);
+
+/* Clears this skip list, no other thread may be using it. */
+void cskl_clear(struct concurrent_skip_list *sl);
+
+#endif	/* _CONCURRENTSKIPLIST_H_ */
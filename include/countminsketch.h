@@ -0,0 +1,88 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _COUNTMINSKETCH_H_
+#define _COUNTMINSKETCH_H_
+
+#include "algcomm.h"
+
+/* The largest number of rows. */
+#define CMS_MAX_DEPTH		16
+
+/* The kinds of the sketch. */
+enum cms_kind {
+	CMS_COUNT_MIN,		/* count-min, estimates never too small */
+	CMS_CONSERVATIVE,	/* count-min with conservative update */
+	CMS_COUNT_SKETCH	/* count sketch, unbiased estimates */
+};
+
+/* 
+ * A frequency sketch of DEPTH rows and WIDTH counters per row.
+ * A key is counted at one counter of every row, the counter is chosen
+ * by the 64-bit hash code of the key remixed by the row number.
+ * Two sketches of the same kind and size can be merged, so a stream
+ * can be counted in parts by many threads.
+ */
+struct cm_sketch {
+	enum cms_kind kind;
+	unsigned int depth;	/* number of rows */
+	unsigned long width;	/* counters per row, a power of 2 */
+	long total;		/* sum of all counts */
+	long *counters;		/* DEPTH x WIDTH counters */
+};
+
+/* Returns the sum of all counts added. */
+#define CMS_TOTAL(cms)		((cms)->total)
+
+/* 
+ * Initializes an empty sketch, the estimate of a key is off at most 
+ * EPSILON * total with the probability 1 - DELTA for count-min. 
+ * That is WIDTH = e / EPSILON and DEPTH = ln(1 / DELTA).
+ */
+void cms_init(struct cm_sketch *cms, enum cms_kind kind, double epsilon,
+		double delta);
+
+/* Counts the key COUNT times. */
+void cms_add(struct cm_sketch *cms, const char *key, long count);
+
+/* Returns the estimated count of the key. */
+long cms_estimate(const struct cm_sketch *cms, const char *key);
+
+/* Adds all counts of the sketch SRC into DST. */
+void cms_merge(struct cm_sketch *dst, const struct cm_sketch *src);
+
+/* Removes all counts from this sketch. */
+void cms_reset(struct cm_sketch *cms);
+
+/* Clears this sketch. */
+void cms_clear(struct cm_sketch *cms);
+
+#endif /* _COUNTMINSKETCH_H_ */
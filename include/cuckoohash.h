@@ -0,0 +1,119 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _CUCKOOHASH_H_
+#define _CUCKOOHASH_H_
+
+#include "algcomm.h"
+
+/* The number of slots in a bucket. */
+#define CKHASH_BUCKET_SLOTS	4
+
+/* 
+ * The largest load factor of the table, 
+ * it grows to double size beyond that.
+ */
+#define CKHASH_MAX_LOAD		0.95
+
+/* The largest number of buckets a insertion path search visits. */
+#define CKHASH_BFS_MAX		512
+
+/* The number of key-value pairs can be kept aside in the stash. */
+#define CKHASH_STASH_SIZE	4
+
+/* 
+ * A bucket fills one 64 bytes cache line. The one byte fingerprints 
+ * are compared first, the elements are only visited on a match. 
+ * A miss reads the two candidate buckets, two cache lines, plus one 
+ * element for each false match of a fingerprint, which happens for 
+ * 1 in 256 of the occupied slots and stash entries. The keys are not
+ * in the buckets, so a hit reads up to two buckets and the element.
+ */
+struct ckhash_bucket {
+	_Alignas(64) unsigned char tags[CKHASH_BUCKET_SLOTS];
+	struct element *items[CKHASH_BUCKET_SLOTS];	/* NULL is empty */
+};
+
+/* 
+ * A key is stored in one of its two candidate buckets, 
+ * or in the stash when no path is found for it.
+ */
+struct cuckoo_hash {
+	unsigned long pairs;		/* number of key-value pairs */
+	unsigned long size;		/* number of buckets, a power of 2 */
+	struct ckhash_bucket *buckets;	/* array of buckets */
+	int nstash;			/* key-value pairs in stash */
+	unsigned char stashtags[CKHASH_STASH_SIZE];	/* fingerprints */
+	struct element *stash[CKHASH_STASH_SIZE];
+};
+
+/* Returns the cuckoo hash table capacity */
+#define CKHASH_SIZE(ckh)	((ckh)->size * CKHASH_BUCKET_SLOTS)
+
+/* Returns the number of key-value pairs in this cuckoo hash table. */
+#define CKHASH_PAIRS(ckh)	((ckh)->pairs)
+
+/* Is this cuckoo hash table empty? */
+#define CKHASH_ISEMPTY(ckh)	((ckh)->pairs == 0)
+
+struct queue;
+
+/* Initializes an empty cuckoo hash table. */
+void ckhash_init(struct cuckoo_hash *ckh, unsigned long htsize);
+
+/* 
+ * Returns the value associated with the specified key 
+ * in the cuckoo hash table.
+ */
+struct element * ckhash_get(const struct cuckoo_hash *ckh, const char *key);
+
+/* 
+ * Returns the number of buckets visited by searching the key 
+ * in the cuckoo hash table, the stash counts as one bucket.
+ */
+unsigned long ckhash_probes(const struct cuckoo_hash *ckh, const char *key);
+
+/* Inserts the specified key-value pair into the cuckoo hash table. */
+void ckhash_put(struct cuckoo_hash *ckh, const struct element *item);
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the cuckoo hash table.
+ */
+void ckhash_delete(struct cuckoo_hash *ckh, const char *key);
+
+/* Returns all keys in this cuckoo hash table. */
+void ckhash_keys(const struct cuckoo_hash *ckh, struct queue *keys);
+
+/* Clears this cuckoo hash table. */
+void ckhash_clear(struct cuckoo_hash *ckh);
+
+#endif /* _CUCKOOHASH_H_ */
@@ -0,0 +1,114 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _DISKBTREE_H_
+#define _DISKBTREE_H_
+
+#include "bufferpool.h"
+
+/* The default bytes of a page */
+#define DBTREE_PAGE_SIZE	4096
+
+/* 
+ * A node of the disk-based B-tree is one page of the file, which 
+ * links the other pages by their page numbers. A leaf node holds 
+ * the keys and then the values, an internal node holds its child 
+ * page numbers and then its keys. Page 0 is the meta page and page 
+ * number 0 means no page.
+ */
+struct dbtree_node {
+	unsigned int sz;		/* number of keys */
+	unsigned long prev;		/* page of previous leaf */
+	unsigned long sibling;		/* page of next leaf or free page */
+	unsigned char data[];		/* the entries of the node */
+};
+
+/* Disk-based B-Tree whose pages are cached by a buffer pool */
+struct dbtree {
+	struct buffer_pool pool;	/* the pages of the B-tree */
+	unsigned long root;		/* page of the root */
+	int height;			/* height of the B-tree */
+	unsigned long size;		/* number of key-value pairs */
+	unsigned long freelist;		/* first of the free pages */
+	unsigned int keysize;		/* bytes of the key */
+	unsigned int valsize;		/* bytes of the value */
+	unsigned int leafcap;		/* max number of keys in a leaf */
+	unsigned int innercap;		/* max number of keys in a node */
+	unsigned int valoff;		/* offset of the values in a leaf */
+	unsigned int keyoff;		/* offset of the keys in a node */
+	void *sepkey;			/* the key moved up by a split */
+	algcomp_ft *kcmp;		/* compare function for keys */
+};
+
+/* Returns the number of key-value pairs in this B-Tree. */
+#define DBTREE_SIZE(bt)		((bt)->size)
+
+/* Returns the height of this B-tree */
+#define DBTREE_HEIGHT(bt)	((bt)->height)
+
+/* Returns true if this B-tree is empty. */
+#define DBTREE_ISEMPTY(bt)	((bt)->size == 0)
+
+struct single_list;
+
+/* 
+ * Opens the B-tree stored in the file PATH, caching NFRAMES pages of 
+ * PGSZ bytes, DBTREE_PAGE_SIZE if PGSZ is 0. An empty B-tree is 
+ * created if the file does not exist, otherwise its page size, 
+ * key size and value size must match.
+ */
+void dbtree_open(struct dbtree *bt, const char *path, unsigned int pgsz,
+		unsigned int ksz, unsigned int vsz, unsigned long nframes,
+		algcomp_ft *cmp);
+
+/* Inserts the key-value pair into the B-Tree. */
+void dbtree_put(struct dbtree *bt, const void *key, const void *val);
+
+/* 
+ * Copies the value associated with the given key into VAL,
+ * returns 0 if the key is not found.
+ */
+int dbtree_get(struct dbtree *bt, const void *key, void *val);
+
+/* Deletes a key-value pair from this B-Tree */
+int dbtree_delete(struct dbtree *bt, const void *key);
+
+/* Copies the keys between lokey and hikey into KEYS. */
+void dbtree_range_query(struct dbtree *bt, const void *lokey,
+			const void *hikey, struct single_list *keys);
+
+/* Writes back the changed pages and forces them to the disk. */
+void dbtree_sync(struct dbtree *bt);
+
+/* Synchronizes and closes the B-tree. */
+void dbtree_close(struct dbtree *bt);
+
+#endif /* _DISKBTREE_H_ */
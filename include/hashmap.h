@@ -0,0 +1,180 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _HASHMAP_H_
+#define _HASHMAP_H_
+
+#include "algcomm.h"
+
+/* 
+ * The largest load factor of the hash map,
+ * it grows to double size beyond that.
+ */
+#define HMAP_MAX_LOAD		0.9
+
+/* The largest probe distance can be recorded in a metadata byte. */
+#define HMAP_MAX_DIST		254
+
+/* The hash function type, returns a 64-bit hash code of the key */
+typedef unsigned long hmap_hash_ft(const void *key, unsigned int ksize);
+
+/* 
+ * A Robin Hood hash map with fixed size keys and values.
+ * A slot is the key followed by the value, both are stored 
+ * in place, plus one metadata byte of probe distance.
+ */
+struct hash_map {
+	unsigned long pairs;	/* number of key-value pairs */
+	unsigned long size;	/* hash map size, a power of 2 */
+	unsigned int keysize;	/* the bytes of the key */
+	unsigned int valsize;	/* the bytes of the value */
+	unsigned int slotsize;	/* keysize + valsize */
+	unsigned char *dists;	/* probe distance plus 1, 0 is empty */
+	unsigned char *slots;	/* key-value pairs */
+	unsigned char *swap;	/* two scratch slots for insertion */
+	hmap_hash_ft *hash;	/* hash function over the keys */
+	algcomp_ft *equal;	/* returns 0 if two keys are equal */
+};
+
+/* Returns the hash map capacity */
+#define HMAP_SIZE(hm)		((hm)->size)
+
+/* Returns the number of key-value pairs in this hash map. */
+#define HMAP_PAIRS(hm)		((hm)->pairs)
+
+/* Is this hash map empty? */
+#define HMAP_ISEMPTY(hm)	((hm)->pairs == 0)
+
+/* Returns the key stored in slot i. */
+#define HMAP_SLOT_KEY(hm, i)	((hm)->slots + (i) * (hm)->slotsize)
+
+/* 
+ * Returns the value stored in slot i, 
+ * it is not aligned unless the key size is.
+ */
+#define HMAP_SLOT_VALUE(hm, i)	\
+	((hm)->slots + (i) * (hm)->slotsize + (hm)->keysize)
+
+/* 
+ * Is this hash map keyed by 8 bytes integers? It is one of 8 bytes 
+ * keys with neither a hash nor an equal function, such a map hashes 
+ * and compares keys inline without callbacks.
+ */
+#define HMAP_ISINTKEY(hm)	\
+	((hm)->keysize == sizeof(unsigned long) && (hm)->hash == NULL && \
+	(hm)->equal == NULL)
+
+struct queue;
+
+/* 
+ * Initializes an empty hash map. If HASH is NULL, the keys are hashed 
+ * by bytes_hash(), or as integers if KSIZE is 8. If EQUAL is NULL, 
+ * the keys are compared by memcmp().
+ */
+void hmap_init(struct hash_map *hm, unsigned int ksize, unsigned int vsize,
+		hmap_hash_ft *hash, algcomp_ft *equal);
+
+/* 
+ * Returns the value associated with the specified key, 
+ * NULL if not found.
+ */
+void * hmap_get(const struct hash_map *hm, const void *key);
+
+/* 
+ * Returns the number of slots visited by searching the key 
+ * in the hash map.
+ */
+unsigned long hmap_probes(const struct hash_map *hm, const void *key);
+
+/* 
+ * Grows the hash map to at least SIZE slots, rounded up to a power of 2,
+ * so it is not resized before it holds SIZE * HMAP_MAX_LOAD pairs.
+ */
+void hmap_reserve(struct hash_map *hm, unsigned long size);
+
+/* Inserts the specified key-value pair into the hash map. */
+void hmap_put(struct hash_map *hm, const void *key, const void *val);
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the hash map, returns -1 if not found.
+ */
+int hmap_delete(struct hash_map *hm, const void *key);
+
+/* Returns all keys in this hash map. */
+void hmap_keys(const struct hash_map *hm, struct queue *keys);
+
+/* Clears this hash map. */
+void hmap_clear(struct hash_map *hm);
+
+/* Scrambles a 8 bytes integer key, which is the hash of integer keys. */
+static inline unsigned long
+hmap_hash_u64(unsigned long key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdUL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53UL;
+	key ^= key >> 33;
+
+	return key;
+}
+
+/* 
+ * Returns the value associated with the integer key, NULL if not found.
+ * It is the inline search path of the map keyed by 8 bytes integers.
+ */
+static inline void *
+hmap_get_u64(const struct hash_map *hm, unsigned long key)
+{
+	unsigned long i, k, mask = hm->size - 1;
+	unsigned int dist;
+
+	assert(HMAP_ISINTKEY(hm));
+
+	i = hmap_hash_u64(key) & mask;
+	for (dist = 1; dist <= hm->dists[i]; dist++) {
+		memcpy(&k, HMAP_SLOT_KEY(hm, i), sizeof(k));
+		if (k == key)
+			return HMAP_SLOT_VALUE(hm, i);
+		i = (i + 1) & mask;
+	}
+
+	return NULL;
+}
+
+/* 
+ * Inserts the integer key and its associated value into the hash map,
+ * the key is searched by the inline path of hmap_get_u64().
+ */
+void hmap_put_u64(struct hash_map *hm, unsigned long key, const void *val);
+
+#endif /* _HASHMAP_H_ */
@@ -0,0 +1,71 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _HYPERLOGLOG_H_
+#define _HYPERLOGLOG_H_
+
+#include "algcomm.h"
+
+/* The range of the precision, the number of index bits. */
+#define HLL_MIN_PRECISION	4
+#define HLL_MAX_PRECISION	18
+
+/* 
+ * A HyperLogLog counter of distinct keys. The top bits of the 
+ * hash code of a key choose a register, which keeps the largest 
+ * number of leading zeros plus 1 seen in the rest bits.
+ * The standard error is about 1.04 / sqrt(2^precision).
+ */
+struct hyperloglog {
+	unsigned int precision;		/* number of index bits */
+	unsigned long nregs;		/* 2^precision registers */
+	unsigned char *regs;
+};
+
+/* Returns the number of registers. */
+#define HLL_REGISTERS(hll)	((hll)->nregs)
+
+/* Initializes an empty counter of 2^PRECISION registers. */
+void hll_init(struct hyperloglog *hll, unsigned int precision);
+
+/* Adds the key into the counter. */
+void hll_add(struct hyperloglog *hll, const char *key);
+
+/* Returns the estimated number of distinct keys added, it needs libm. */
+double hll_estimate(const struct hyperloglog *hll);
+
+/* Merges the counter SRC into DST, they must have the same precision. */
+void hll_merge(struct hyperloglog *dst, const struct hyperloglog *src);
+
+/* Clears the counter. */
+void hll_clear(struct hyperloglog *hll);
+
+#endif /* _HYPERLOGLOG_H_ */
@@ -38,6 +38,7 @@ struct line_prob_hash {
 	unsigned long pairs;	/* number of key-value pairs */
 	unsigned long size;	/* hash table size */
 	struct element *items;	/* key-value pair */
+	struct bloom_filter *guard;	/* filters the missing keys */
 };
 
 /* Returns the linear-probing hash table capacity */
@@ -60,6 +61,7 @@ struct line_prob_hash {
 #define LPHASH_INIT(lph, htsize)	do {		\
 	(lph)->pairs = 0;				\
 	(lph)->size = htsize;				\
+	(lph)->guard = NULL;				\
 	(lph)->items = (struct element *)algmalloc(	\
 		htsize * sizeof(struct element));	\
 } while (0)
@@ -72,6 +74,7 @@ struct line_prob_hash {
 } while (0)
 
 struct queue;
+struct bloom_filter;
 
 /* 
  * Returns the value associated with the specified key 
@@ -79,6 +82,18 @@ struct queue;
  */
 struct element * lphash_get(const struct line_prob_hash *lph, const char *key);
 
+/* 
+ * Returns the number of slots visited by searching the key 
+ * in the linear-probing hash table.
+ */
+unsigned long lphash_probes(const struct line_prob_hash *lph, const char *key);
+
+/* 
+ * Attaches a Bloom filter as the guard of lphash_get(), 
+ * all keys in the linear-probing hash table are added into it.
+ */
+void lphash_set_guard(struct line_prob_hash *lph, struct bloom_filter *bf);
+
 /* 
  * Inserts the specified key-value pair into the linear-probing hash table. 
  */
@@ -0,0 +1,120 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _PERFECTHASH_H_
+#define _PERFECTHASH_H_
+
+#include "algcomm.h"
+
+/* The largest number of levels, the rest of keys go to a fallback. */
+#define MPHASH_MAX_LEVELS	32
+
+/* The default ratio of level bits to the keys of the level. */
+#define MPHASH_GAMMA		1.0
+
+/* 
+ * The header of the image. The image is a flat array of 8 bytes words,
+ * so it is queried in place whether in memory or mapped from a file:
+ *	header
+ *	levels[nlevels + 1]	word offset of every level
+ *	words[nwords]		bits of all levels
+ *	ranks[nranks]		set bits before every 512 bits block
+ *	fallback[nfallback]	sorted hash codes of the rest of keys
+ *	values[nkeys]		values by the index of the keys
+ *	fps[nkeys]		16-bit fingerprints of the keys
+ */
+struct mphash_header {
+	char magic[8];
+	unsigned long nkeys;		/* number of keys */
+	unsigned long nlevels;		/* number of levels */
+	unsigned long nwords;		/* words of the level bits */
+	unsigned long nranks;		/* number of rank counters */
+	unsigned long nfallback;	/* keys not placed in any level */
+};
+
+/* 
+ * A minimal perfect hash map over a static set of keys, BBHash-like. 
+ * At every level, a key is hashed to a bit, the keys have a bit of 
+ * their own keep it, the others try again at the next level. 
+ * The index of a key is the rank of its bit over all levels.
+ */
+struct mphash {
+	unsigned char *base;		/* the image */
+	size_t len;			/* bytes of the image */
+	int mapped;			/* is the image mapped from a file? */
+	const struct mphash_header *hdr;
+	const unsigned long *levels;
+	const unsigned long *words;
+	const unsigned long *ranks;
+	const unsigned long *fallback;
+	const long *values;
+	const unsigned short *fps;
+};
+
+/* Returns the number of keys in this minimal perfect hash map. */
+#define MPHASH_SIZE(mph)	((mph)->hdr->nkeys)
+
+/* Returns the bits of the hash function per key, ranks included. */
+#define MPHASH_BITS_PER_KEY(mph)					\
+	((double)(((mph)->hdr->nwords + (mph)->hdr->nranks +		\
+	(mph)->hdr->nlevels + 1 + (mph)->hdr->nfallback) * 64) /	\
+	(double)(mph)->hdr->nkeys)
+
+/* 
+ * Builds a minimal perfect hash map of the N distinct keys in NTHREADS 
+ * threads. The level bits are GAMMA times the keys of the level, a 
+ * larger GAMMA builds and queries faster but takes more space.
+ */
+void mphash_build(struct mphash *mph, const struct element *items,
+		unsigned long n, double gamma, int nthreads);
+
+/* 
+ * Returns the index of the key in [0, N), it is arbitrary 
+ * if the key is not in the key set.
+ */
+unsigned long mphash_index(const struct mphash *mph, const char *key);
+
+/* 
+ * Returns the value associated with the key, NULL if not found. 
+ * A key not in the key set is found with the probability 1/65536.
+ */
+const long * mphash_get(const struct mphash *mph, const char *key);
+
+/* Writes the image of the map to the file. */
+void mphash_save(const struct mphash *mph, const char *fname);
+
+/* Maps the image in the file, it is queried with no loading. */
+void mphash_open(struct mphash *mph, const char *fname);
+
+/* Clears this minimal perfect hash map. */
+void mphash_clear(struct mphash *mph);
+
+#endif /* _PERFECTHASH_H_ */
@@ -0,0 +1,149 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _PERSISTENTRBTREE_H_
+#define _PERSISTENTRBTREE_H_
+
+#include "redblackbst.h"
+#include <stdatomic.h>
+#include <pthread.h>
+
+/* The max depth of a persistent Red-Black tree */
+#define PRBT_MAX_DEPTH		128
+
+/* 
+ * A node never changes once a version holding it is published. 
+ * An update copies the nodes on its path, the new copies share the 
+ * other subtrees with the old version, so a node may have parents 
+ * in many versions. The refs counts them and the snapshots rooted
+ * at the node, it is only touched under the writer lock. The key is
+ * stored inline, or the caller's key pointer if the key size is 0.
+ */
+struct prbt_node {
+	struct prbt_node *left;		/* link to left subtrees */
+	struct prbt_node *right;	/* link to right subtrees */
+	unsigned long sizecolor;	/* subtrees count << 1 | color */
+	unsigned long version;		/* the version creating the node */
+	unsigned long refs;		/* parents and snapshots of it */
+	unsigned char key[];		/* key contained by the Node */
+};
+
+/* 
+ * A version of the tree. The readers pin it before reading and 
+ * unpin it after, it is reclaimed once it is no longer the current
+ * version and nobody pins it.
+ */
+struct prbt_snapshot {
+	struct prbt_node *root;		/* root of this version */
+	unsigned long version;		/* number of this version */
+	atomic_long pins;		/* number of readers pinning it */
+	struct prbt_snapshot *next;	/* next retired snapshot */
+};
+
+/* 
+ * A persistent Red-Black BST, every update publishes a new version
+ * and the old ones stay readable while they are pinned. Readers never
+ * lock or wait, writers are serialized by a mutex. A reader counts 
+ * itself in readers while it pins the current snapshot, a retired 
+ * snapshot is freed only when no reader is in the middle of pinning,
+ * so none can pin it after it is freed.
+ */
+struct persistent_rbtree {
+	_Atomic(struct prbt_snapshot *) current; /* the current version */
+	atomic_long readers;		/* readers pinning a snapshot */
+	pthread_mutex_t lock;		/* the writer lock */
+	struct prbt_snapshot *retired;	/* the old versions not freed */
+	unsigned long version;		/* the number of the last version */
+	unsigned long nodes;		/* the nodes of all versions */
+	unsigned int keysize;		/* the bytes of the key */
+	algcomp_ft *cmp;		/* comparator over the keys */
+};
+
+/* Returns the number of keys in the snapshot. */
+#define PRBT_SIZE(snap)	\
+	((snap)->root == NULL ? 0 : (snap)->root->sizecolor >> 1)
+
+/* Is the snapshot empty ? */
+#define PRBT_ISEMPTY(snap)	((snap)->root == NULL)
+
+/* Returns the number of nodes of all versions alive. */
+#define PRBT_NODES(t)		((t)->nodes)
+
+struct single_list;
+
+/* Initializes an empty persistent Red-Black BST. */
+void prbt_init(struct persistent_rbtree *t, unsigned int ksize, 
+		algcomp_ft *kcmp);
+
+/* 
+ * Inserts the key and publishes a new version, 
+ * returns 1 if the key is already in the tree.
+ */
+int prbt_put(struct persistent_rbtree *t, const void *key);
+
+/* 
+ * Removes the key and publishes a new version, 
+ * returns -1 if not found.
+ */
+int prbt_delete(struct persistent_rbtree *t, const void *key);
+
+/* Pins the current version for reading, it never blocks. */
+const struct prbt_snapshot * prbt_pin(struct persistent_rbtree *t);
+
+/* 
+ * Unpins a snapshot, it never blocks. A retired snapshot is freed by 
+ * the next update or prbt_reclaim() once nobody pins it.
+ */
+void prbt_unpin(struct persistent_rbtree *t, const struct prbt_snapshot *s);
+
+/* Returns the key in the snapshot associated with the given key. */
+void * prbt_get(const struct persistent_rbtree *t, 
+		const struct prbt_snapshot *s, const void *key);
+
+/* Returns all keys in the snapshot in the given range. */
+void prbt_keys(const struct persistent_rbtree *t, 
+		const struct prbt_snapshot *s, const void *lokey, 
+		const void *hikey, struct single_list *keys);
+
+/* Check integrity of the Red-Black tree of the snapshot. */
+int prbt_check(const struct persistent_rbtree *t, 
+		const struct prbt_snapshot *s);
+
+/* Frees the retired snapshots that nobody pins. */
+void prbt_reclaim(struct persistent_rbtree *t);
+
+/* 
+ * Releases all versions and the writer lock, no other thread may be 
+ * using the tree. It must be initialized again to be reused.
+ */
+void prbt_clear(struct persistent_rbtree *t);
+
+#endif	/* _PERSISTENTRBTREE_H_ */
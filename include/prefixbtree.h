@@ -0,0 +1,137 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _PREFIXBTREE_H_
+#define _PREFIXBTREE_H_
+
+#include "algcomm.h"
+
+/* The default bytes of a prefix B-tree node */
+#define PBTREE_PAGE_SIZE	4096
+
+/* The most keys between two restart points of a leaf */
+#define PBTREE_RESTART		16
+
+/* 
+ * Prefix B-tree node data type, a node is one page of the page size.
+ * A leaf holds its entries front coded: every key keeps only the 
+ * bytes after its common prefix with the previous key, then the 
+ * value. About every PBTREE_RESTART-th key is stored in full, their
+ * offsets at the end of the page are searched in binary. An internal
+ * node holds its children, the offsets of its separators, then the
+ * separators, each as short as it can be to split its two children.
+ */
+struct pbtree_node {
+	unsigned int sz;		/* number of keys */
+	unsigned int used;		/* bytes used by the entries */
+	unsigned int nrestarts;		/* number of restart points */
+	int leaf;			/* is it a leaf node ? */
+	struct pbtree_node *prev;	/* points to previous leaf */
+	struct pbtree_node *sibling;	/* points to next leaf */
+	unsigned char data[];		/* the entries of the node */
+};
+
+/* A decoded entry of a node */
+struct pbtree_entry {
+	const unsigned char *key;	/* the key, not terminated */
+	unsigned int len;		/* the bytes of the key */
+	const void *val;		/* the value of a leaf entry */
+	unsigned int lcp;		/* common prefix with previous key */
+	int restart;			/* is it a restart point ? */
+};
+
+/* 
+ * A B+ tree over strings whose leaves are prefix compressed and 
+ * whose separators are suffix truncated, so many more keys fit in
+ * a page than in slots of the longest key. The keys are ordered 
+ * byte by byte as strcmp() does. A node is decoded to update it 
+ * and encoded back, a split or a merge goes by the encoded bytes.
+ */
+struct prefix_btree {
+	struct pbtree_node *root;	/* root of the B-tree */
+	int height;			/* height of the B-tree */
+	unsigned long size;		/* number of key-value pairs */
+	unsigned long leaves;		/* number of leaf nodes */
+	unsigned long inners;		/* number of internal nodes */
+	unsigned int maxklen;		/* max length of the key */
+	unsigned int valsize;		/* the bytes of the value */
+	unsigned int pagesize;		/* bytes of a node */
+	unsigned int maxents;		/* max entries of two nodes */
+	struct pbtree_entry *ents;	/* the decoded entries */
+	struct pbtree_node **kids;	/* the decoded children */
+	unsigned char *arena;		/* the decoded keys */
+	struct pbtree_node *page;	/* the page being encoded */
+	unsigned char *sepkey;		/* the key moved up by a split */
+	unsigned int seplen;		/* the length of the key moved up */
+};
+
+/* Returns the number of key-value pairs in this B-tree. */
+#define PBTREE_SIZE(bt)		((bt)->size)
+
+/* Returns the height of this B-tree */
+#define PBTREE_HEIGHT(bt)	((bt)->height)
+
+/* Returns the number of pages of this B-tree */
+#define PBTREE_PAGES(bt)	((bt)->leaves + (bt)->inners)
+
+struct single_list;
+
+/* 
+ * Initializes an empty prefix B-tree whose nodes are PGSZ bytes, 
+ * PBTREE_PAGE_SIZE if PGSZ is 0, for the keys of at most MAXKLEN 
+ * bytes and the values of VSZ bytes.
+ */
+void pbtree_init(struct prefix_btree *bt, unsigned int pgsz, 
+		unsigned int maxklen, unsigned int vsz);
+
+/* Inserts the key-value pair, overwriting the old value if any. */
+void pbtree_put(struct prefix_btree *bt, const char *key, const void *val);
+
+/* 
+ * Copies the value associated with the given key into VAL,
+ * returns 0 if the key is not found.
+ */
+int pbtree_get(const struct prefix_btree *bt, const char *key, void *val);
+
+/* Deletes a key-value pair, returns 0 if the key is not found. */
+int pbtree_delete(struct prefix_btree *bt, const char *key);
+
+/* 
+ * Copies the keys between lokey and hikey into KEYS, 
+ * each in MAXKLEN + 1 bytes terminated by a null byte.
+ */
+void pbtree_range_query(const struct prefix_btree *bt, const char *lokey,
+			const char *hikey, struct single_list *keys);
+
+/* Clears this prefix B-tree */
+void pbtree_clear(struct prefix_btree *bt);
+
+#endif	/* _PREFIXBTREE_H_ */
@@ -36,37 +36,50 @@
 
 enum bst_redblack {RED, BLACK};
 
+/* 
+ * The key is stored inline after the links, or the caller's key 
+ * pointer is stored there if the key size is 0. The color for 
+ * the parent link is the lowest bit of the subtrees count.
+ */
 struct rbtree_node {
-	void *key;			/* key contained by the Node */
 	struct rbtree_node *left;	/* link to left subtrees */
 	struct rbtree_node *right;	/* link to right subtrees */
-	enum bst_redblack color;	/* color for parent link */
-	unsigned long size;		/* subtrees count */
-	long height;			/* height of the subtree */
+	unsigned long sizecolor;	/* subtrees count << 1 | color */
+	unsigned char key[];		/* key contained by the Node */
 };
 
+/* 
+ * The nodes are cut from the blocks of a per-tree pool, 
+ * the deleted nodes are reused by the later insertions.
+ */
 struct rbtree {
 	struct rbtree_node *root;	/* root node */
 	unsigned int keysize;		/* the bytes of the key */
+	unsigned int nodesize;		/* the bytes of a node */
 	algcomp_ft *cmp;		/* comparator over the keys */
+	struct bloom_filter *guard;	/* filters the missing keys */
+	void *blocks;			/* the blocks of the nodes */
+	struct rbtree_node *freed;	/* the deleted nodes */
+	char *avail;			/* free space in the last block */
+	unsigned long navail;		/* number of nodes fit in it */
 };
 
 /* Returns the number of keys in this Red-Black BST. */
 #define RBBST_SIZE(bst)	\
-	((bst)->root == NULL ? 0 : (bst)->root->size)
+	((bst)->root == NULL ? 0 : (bst)->root->sizecolor >> 1)
 
 /* 
  * Returns the height of the internal Red-Black tree.
  * It is assumed that the height of an empty tree is -1 
  * and the height of a tree with just one node is 0. 
  */
-#define RBBST_HEIGHT(bst)	\
-	((bst)->root == NULL ? (-1) : (bst)->root->height)
+#define RBBST_HEIGHT(bst)	rbbst_height(bst)
 
 /* Is this Red Black BST empty ? */
 #define RBBST_ISEMPTY(bst)	((bst)->root == NULL)
 
 struct single_list;
+struct bloom_filter;
 
 /* Initializes an empty Red-Black binary search tree. */
 void rbbst_init(struct rbtree *bst, unsigned int ksize, algcomp_ft *kcmp);
@@ -74,12 +87,36 @@ void rbbst_init(struct rbtree *bst, unsigned int ksize, algcomp_ft *kcmp);
 /* Returns Key associated with the given key */
 void * rbbst_get(const struct rbtree *bst, const void *key);
 
+/* 
+ * Attaches a Bloom filter as the guard of rbbst_get(), 
+ * all keys in the Red-Black BST are added into it. The filter 
+ * must hash what the comparator compares, returns -1 if it 
+ * has no hash function.
+ */
+int rbbst_set_guard(struct rbtree *bst, struct bloom_filter *bf);
+
 /* Inserts the specified key into the Red-Black BST. */
 int rbbst_put(struct rbtree *bst, const void *key);
 
-/* Release the Red-Black tree */
+/* 
+ * Inserts the key into the Red-Black BST by recursion, 
+ * it is kept to compare with rbbst_put().
+ */
+int rbbst_put_recursive(struct rbtree *bst, const void *key);
+
+/* 
+ * Builds the Red-Black BST from N keys in strictly ascending order 
+ * in linear time, the tree must be empty.
+ */
+void rbbst_build_sorted(struct rbtree *bst, const void *keys, 
+			unsigned long n);
+
+/* Release the Red-Black tree and all of its nodes */
 void rbbst_clear(struct rbtree *bst);
 
+/* Returns the height of the Red-Black tree, computed in O(N) time. */
+long rbbst_height(const struct rbtree *bst);
+
 /* Preorder traverse */
 void rbbst_preorder(const struct rbtree *bst, struct single_list *keys);
 
@@ -126,4 +163,42 @@ void * rbbst_select(const struct rbtree *bst, unsigned long rank);
 void rbbst_keys(const struct rbtree *bst, const void *lokey, const void *hikey,
 		struct single_list *keys);
 
+/* The max depth of a Red-Black BST, more than the height of any tree */
+#define RBBST_CURSOR_DEPTH	128
+
+/* 
+ * A cursor over the keys of a Red-Black BST in ascending order, it keeps
+ * the path from the root to the current node, so no key is copied.
+ * It is invalid after the tree is modified.
+ */
+struct rbbst_cursor {
+	const struct rbtree *bst;	/* the tree */
+	int depth;		/* number of nodes in the path */
+	struct rbtree_node *path[RBBST_CURSOR_DEPTH];	/* the path */
+};
+
+/* Is the cursor on a key ? */
+#define RBBST_CURSOR_VALID(c)	((c)->depth > 0)
+
+/* Initializes a cursor over the keys of a Red-Black BST. */
+void rbbst_cursor_init(struct rbbst_cursor *c, const struct rbtree *bst);
+
+/* 
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL.
+ */
+void rbbst_cursor_seek(struct rbbst_cursor *c, const void *key);
+
+/* Moves the cursor to the largest key. */
+void rbbst_cursor_last(struct rbbst_cursor *c);
+
+/* Moves the cursor to the next key, returns 0 if there is none. */
+int rbbst_cursor_next(struct rbbst_cursor *c);
+
+/* Moves the cursor to the previous key, returns 0 if there is none. */
+int rbbst_cursor_prev(struct rbbst_cursor *c);
+
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void * rbbst_cursor_key(const struct rbbst_cursor *c);
+
 #endif /* _REDBLACKBST_H_ */
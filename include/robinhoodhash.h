@@ -0,0 +1,104 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _ROBINHOODHASH_H_
+#define _ROBINHOODHASH_H_
+
+#include "algcomm.h"
+
+/* 
+ * The largest load factor of the table, 
+ * it grows to double size beyond that.
+ */
+#define RHHASH_MAX_LOAD		0.9
+
+/* 
+ * The largest probe distance can be recorded 
+ * in a metadata byte.
+ */
+#define RHHASH_MAX_DIST		254
+
+struct robin_hood_hash {
+	unsigned long pairs;	/* number of key-value pairs */
+	unsigned long size;	/* hash table size, a power of 2 */
+	unsigned char *dists;	/* probe distance plus 1, 0 is empty */
+	struct element *items;	/* key-value pairs */
+};
+
+/* Returns the Robin Hood hash table capacity */
+#define RHHASH_SIZE(rhh)	((rhh)->size)
+
+/* 
+ * Returns the number of key-value pairs 
+ * in this Robin Hood hash table.
+ */
+#define RHHASH_PAIRS(rhh)	((rhh)->pairs)
+
+/* Is this Robin Hood hash table empty? */
+#define RHHASH_ISEMPTY(rhh)	((rhh)->pairs == 0)
+
+struct queue;
+
+/* Initializes an empty Robin Hood hash table. */
+void rhhash_init(struct robin_hood_hash *rhh, unsigned long htsize);
+
+/* 
+ * Returns the value associated with the specified key 
+ * in the Robin Hood hash table.
+ */
+struct element * rhhash_get(const struct robin_hood_hash *rhh,
+			const char *key);
+
+/* 
+ * Returns the number of slots visited by searching the key 
+ * in the Robin Hood hash table.
+ */
+unsigned long rhhash_probes(const struct robin_hood_hash *rhh,
+			const char *key);
+
+/* 
+ * Inserts the specified key-value pair into the Robin Hood hash table. 
+ */
+void rhhash_put(struct robin_hood_hash *rhh, const struct element *item);
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the Robin Hood hash table.
+ */
+void rhhash_delete(struct robin_hood_hash *rhh, const char *key);
+
+/* Returns all keys in this Robin Hood hash table. */
+void rhhash_keys(const struct robin_hood_hash *rhh, struct queue *keys);
+
+/* Clears this Robin Hood hash table. */
+void rhhash_clear(struct robin_hood_hash *rhh);
+
+#endif /* _ROBINHOODHASH_H_ */
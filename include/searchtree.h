@@ -34,8 +34,13 @@
 
 #include "bsearchtree.h"
 #include "redblackbst.h"
+#include "persistentrbtree.h"
 #include "avltree.h"
 #include "btree.h"
+#include "diskbtree.h"
+#include "concurrentbtree.h"
+#include "betree.h"
+#include "prefixbtree.h"
 #include "splaytree.h"
 
 #endif /* _SEARCHTREE_H_ */
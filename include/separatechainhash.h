@@ -36,11 +36,13 @@
 
 struct seqlist;
 struct queue;
+struct bloom_filter;
 
 struct schain_hash {
 	unsigned long pairs;	/* number of key-value pairs */
 	unsigned long size;	/* hash table size */
 	struct seqlist *lists;	/* array of linked-list */
+	struct bloom_filter *guard;	/* filters the missing keys */
 };
 
 /* Returns the separate-chain hash table capacity */
@@ -68,6 +70,18 @@ void schash_init(struct schain_hash *sch, unsigned long htsize);
  */
 struct element * schash_get(const struct schain_hash *sch, const char *key);
 
+/* 
+ * Returns the number of nodes visited by searching the key 
+ * in the separate-chains hash table.
+ */
+unsigned long schash_probes(const struct schain_hash *sch, const char *key);
+
+/* 
+ * Attaches a Bloom filter as the guard of schash_get(), 
+ * all keys in the separate-chains hash table are added into it.
+ */
+void schash_set_guard(struct schain_hash *sch, struct bloom_filter *bf);
+
 /* 
  * Inserts the specified key-value pair into 
  * the separate-chains hash table.
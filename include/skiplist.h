@@ -34,9 +34,26 @@
 
 #include "algcomm.h"
 
+/* The largest maximum level of a skip list. */
+#define SKIPL_MAX_LEVEL		32
+
+/* 
+ * A link of a level. The span is the number of nodes it passes over 
+ * at level 0, the node it points to included. The link to the end 
+ * of the list spans the nodes left plus 1.
+ */
+struct skipl_link {
+	struct skipl_node *next;
+	unsigned long span;
+};
+
+/* 
+ * A node is a single allocation: the header, the forward links of 
+ * its own height, then the key bytes if the skip list copies keys.
+ */
 struct skipl_node {
 	void *key;			/* key contained by the Node */
-	struct skipl_node **forward;	/* array to hold references to different
+	struct skipl_link forward[];	/* array to hold references to different
 					   levels */
 };
 
@@ -45,8 +62,11 @@ struct skip_list {
 	int maxlevel;			/* maximum number of levels */
 	int level;			/* current level of skip-list */
 	unsigned long size;		/* number of elements */
+	unsigned long version;		/* changed by every insertion or 
+					   deletion */
 	unsigned int keysize;		/* the bytes of the key */
 	algcomp_ft *cmp;		/* comparator over the keys */
+	struct bloom_filter *guard;	/* filters the missing keys */
 };
 
 /* 
@@ -56,7 +76,20 @@ struct skip_list {
 #define SKIPL_SIZE(sl)		((sl)->size)
 
 /* Is this skip list empty? */
-#define SKIPL_ISEMPTY(sl)	((sl)->head->forward[0] == NULL)
+#define SKIPL_ISEMPTY(sl)	((sl)->head->forward[0].next == NULL)
+
+/* 
+ * A finger keeps the path of the last search, the next search 
+ * starts from there. A search d keys away from the last one 
+ * costs O(log d) rather than O(log n).
+ */
+struct skipl_finger {
+	const struct skip_list *sl;
+	unsigned long version;		/* version of the skip list seen */
+	struct skipl_node *path[SKIPL_MAX_LEVEL + 1];	/* rightmost nodes 
+							   before the key */
+	unsigned long rank[SKIPL_MAX_LEVEL + 1];	/* their ranks */
+};
 
 /* Internal macro, used for SLIST_FOREACH. */
 #define _SKIPL_NODE_KEY(nptr)	\
@@ -67,26 +100,45 @@ struct skip_list {
  * Before use it, you must declare 'nptr' pointer.
  */
 #define SKIPL_FOREACH(sl, nptr, dtyp, key)				\
-	for ((nptr) = (sl)->head->forward[0],				\
+	for ((nptr) = (sl)->head->forward[0].next,			\
 		(key) = (dtyp *)_SKIPL_NODE_KEY(nptr); (nptr) != NULL;	\
-		(nptr) = (nptr)->forward[0],				\
+		(nptr) = (nptr)->forward[0].next,			\
 		(key) = (dtyp *)_SKIPL_NODE_KEY(nptr))
 
 struct single_list;
+struct bloom_filter;
 
-/* Initializes an empty skip list */
+/* 
+ * Initializes an empty skip list, 
+ * MAXLVL is at most SKIPL_MAX_LEVEL.
+ */
 void skipl_init(struct skip_list *sl, int maxlvl, unsigned int ksize,
 		algcomp_ft *cmp);
 
 /* Returns the value associated with the given key. */ 
 void * skipl_get(const struct skip_list *sl, const void *key);
 
+/* 
+ * Attaches a Bloom filter as the guard of skipl_get(), 
+ * all keys in the skip list are added into it. The filter 
+ * must hash what the comparator compares, returns -1 if it 
+ * has no hash function.
+ */
+int skipl_set_guard(struct skip_list *sl, struct bloom_filter *bf);
+
 /* 
  * Inserts the specified key-value pair 
  * into the ship list.
  */
 void skipl_put(struct skip_list *sl, const void *key);
 
+/* 
+ * Builds the skip list from N keys in strictly ascending order 
+ * in linear time, the skip list must be empty.
+ */
+void skipl_build_sorted(struct skip_list *sl, const void *keys,
+			unsigned long n);
+
 /* 
  * Removes the specified key and its associated with 
  * value from this skip list. 
@@ -117,4 +169,28 @@ void * skipl_floor(const struct skip_list *sl, const void *key);
  */
 void * skipl_ceiling(const struct skip_list *sl, const void *key);
 
+/* Returns the number of keys in the skip list strictly less than key. */
+unsigned long skipl_rank(const struct skip_list *sl, const void *key);
+
+/* 
+ * Returns the key in the skip list of a given rank, 
+ * NULL if the rank is not less than the size.
+ */
+void * skipl_select(const struct skip_list *sl, unsigned long rank);
+
+/* Initializes a finger at the head of the skip list. */
+void skipl_finger_init(struct skipl_finger *fg, const struct skip_list *sl);
+
+/* 
+ * Returns the key equal to the given key, NULL if not found, 
+ * searching from the finger. The finger moves to the key.
+ */
+void * skipl_finger_get(struct skipl_finger *fg, const void *key);
+
+/* 
+ * Returns the number of keys strictly less than 
+ * the key of the last search of the finger.
+ */
+#define SKIPL_FINGER_RANK(fg)	((fg)->rank[0])
+
 #endif	/* _SKIPLIST_H_ */
@@ -0,0 +1,96 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _SPACESAVING_H_
+#define _SPACESAVING_H_
+
+#include "hashmap.h"
+
+/* A monitored key. */
+struct spsv_counter {
+	char key[MAX_KEY_LEN];
+	long count;		/* estimated count, never too small */
+	long error;		/* largest overestimation of the count */
+};
+
+/* 
+ * A space-saving summary which monitors at most CAPACITY keys.
+ * A new key replaces the one with the smallest count and inherits
+ * that count as its error, so every key with a count over
+ * total / CAPACITY is monitored. The counters are kept in a min-heap
+ * by count, a hash map finds the counter of a key.
+ */
+struct space_saving {
+	unsigned long capacity;		/* largest number of keys */
+	unsigned long size;		/* number of keys monitored */
+	long total;			/* sum of all counts */
+	struct spsv_counter *counters;
+	unsigned long *heap;		/* counter indexes, a min-heap */
+	unsigned long *pos;		/* heap position of every counter */
+	struct hash_map index;		/* key -> counter index */
+};
+
+/* Returns the number of keys monitored. */
+#define SPSV_SIZE(ss)		((ss)->size)
+
+/* Returns the sum of all counts added. */
+#define SPSV_TOTAL(ss)		((ss)->total)
+
+/* Initializes an empty summary monitors at most CAPACITY keys. */
+void spsv_init(struct space_saving *ss, unsigned long capacity);
+
+/* Counts the key COUNT times. */
+void spsv_add(struct space_saving *ss, const char *key, long count);
+
+/* 
+ * Returns the counter of the key, NULL if it is not monitored, 
+ * then its count is at most the smallest count monitored.
+ */
+const struct spsv_counter * spsv_get(const struct space_saving *ss,
+				const char *key);
+
+/* 
+ * Copies the K most frequent keys into TOP by descending count, 
+ * returns the number of keys copied.
+ */
+unsigned long spsv_top(const struct space_saving *ss, 
+		struct spsv_counter *top, unsigned long k);
+
+/* 
+ * Merges the summary SRC into DST. A key missing in a full summary 
+ * is counted as its smallest count, then the largest counts are kept.
+ */
+void spsv_merge(struct space_saving *dst, const struct space_saving *src);
+
+/* Clears this summary. */
+void spsv_clear(struct space_saving *ss);
+
+#endif /* _SPACESAVING_H_ */
@@ -48,6 +48,8 @@ struct splay_tree {
 	unsigned long size;		/* size of splay tree */
 	unsigned int keysize;		/* the bytes of the key */
 	algcomp_ft *cmp;		/* comparator over the keys */
+	unsigned int splaydepth;	/* splays a lookup deeper than it */
+	unsigned int splayrate;		/* percent of the lookups splayed */
 };
 
 /* Returns the number of keys in this splay tree. */
@@ -59,10 +61,18 @@ struct splay_tree {
 struct single_list;
 
 /*
- * Initializes an empty splay tree.
+ * Initializes an empty splay tree, every lookup is splayed.
  */
 void splayt_init(struct splay_tree *st, unsigned int ksize, algcomp_ft *cmp);
 
+/* 
+ * Sets the semi-splaying of splayt_get(), a found node is splayed only 
+ * if it is deeper than DEPTH edges from the root, and then only for 
+ * RATE percent of the lookups. DEPTH 0 and RATE 100 splay every lookup.
+ */
+void splayt_semisplay(struct splay_tree *st, unsigned int depth, 
+	unsigned int rate);
+
 /* 
  * Inserts the key into this splay tree. 
  */
@@ -73,6 +83,12 @@ int splayt_put(struct splay_tree *st, const void *key);
  */
 void * splayt_get(struct splay_tree *st, const void *key);
 
+/* 
+ * Returns the key in this splay tree by the given key without splaying,
+ * the tree is not changed so the readers can share it under a read lock.
+ */
+void * splayt_peek(const struct splay_tree *st, const void *key);
+
 /* 
  * Removes the specified key from this splay tree. 
  */
@@ -0,0 +1,103 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#ifndef _SWISSTABLEHASH_H_
+#define _SWISSTABLEHASH_H_
+
+#include "algcomm.h"
+
+/* 
+ * The number of control bytes in a group, 
+ * they are matched by one SSE2 instruction.
+ */
+#define SWHASH_GROUP_WIDTH	16
+
+/* 
+ * The table is rehashed when the full and deleted slots
+ * exceed 7/8 of the capacity.
+ */
+#define SWHASH_MAX_LOAD(sz)	((sz) - (sz) / 8)
+
+struct swiss_table {
+	unsigned long pairs;	/* number of key-value pairs */
+	unsigned long deleted;	/* number of deleted slots */
+	unsigned long size;	/* hash table size, a power of 2 */
+	signed char *ctrl;	/* control bytes, one per slot */
+	struct element *items;	/* key-value pairs */
+};
+
+/* Returns the swiss table capacity */
+#define SWHASH_SIZE(swt)	((swt)->size)
+
+/* 
+ * Returns the number of key-value pairs 
+ * in this swiss table.
+ */
+#define SWHASH_PAIRS(swt)	((swt)->pairs)
+
+/* Is this swiss table empty? */
+#define SWHASH_ISEMPTY(swt)	((swt)->pairs == 0)
+
+struct queue;
+
+/* Initializes an empty swiss table. */
+void swhash_init(struct swiss_table *swt, unsigned long htsize);
+
+/* 
+ * Returns the value associated with the specified key 
+ * in the swiss table.
+ */
+struct element * swhash_get(const struct swiss_table *swt, const char *key);
+
+/* 
+ * Returns the number of groups visited by searching the key 
+ * in the swiss table.
+ */
+unsigned long swhash_probes(const struct swiss_table *swt, const char *key);
+
+/* 
+ * Inserts the specified key-value pair into the swiss table. 
+ */
+void swhash_put(struct swiss_table *swt, const struct element *item);
+
+/* 
+ * Removes the specified key and its associated value 
+ * from the swiss table.
+ */
+void swhash_delete(struct swiss_table *swt, const char *key);
+
+/* Returns all keys in this swiss table. */
+void swhash_keys(const struct swiss_table *swt, struct queue *keys);
+
+/* Clears this swiss table. */
+void swhash_clear(struct swiss_table *swt);
+
+#endif /* _SWISSTABLEHASH_H_ */
@@ -0,0 +1,409 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "searchtree.h"
+#include "skiplist.h"
+#include "bloomfilter.h"
+
+#define FPRATE		0.01	/* false positive rate of the guards */
+
+static unsigned int *keys;	/* the first half are in the tables */
+static unsigned long nkeys;
+
+static void rbbst_guard(void);
+static void skipl_guard(void);
+static void btree_guard(void);
+static void rbbst_elem_guard(void);
+static void skipl_elem_guard(void);
+static void make_element(struct element *, unsigned int);
+static unsigned long int_hash(const void *);
+static unsigned long elem_hash(const void *);
+static int cmp(const void *, const void *);
+static int less(const void *, const void *);
+
+/* 
+ * Attaches a Bloom filter guard to the Red-Black BST, the skip list 
+ * and the B-tree holding int keys, and to the Red-Black BST and the 
+ * skip list holding elements compared by their string keys. Checks 
+ * that every present key is still found and deleted, and times the 
+ * lookups of missing keys.
+ */
+int
+main(int argc, char *argv[])
+{
+	unsigned long i;
+
+	if (argc != 2)
+		errmsg_exit("Usage: %s <size>\n", argv[0]);
+
+	if (sscanf(argv[1], "%lu", &nkeys) != 1 || nkeys < 2 ||
+		nkeys > UINT_MAX / 2)
+		errmsg_exit("Illegal integer number, %s\n", argv[1]);
+
+	SET_RANDOM_SEED;
+	keys = (unsigned int *)algmalloc(nkeys * 2 * sizeof(int));
+	for (i = 0; i < nkeys * 2; i++)
+		keys[i] = (unsigned int)i;
+	shuffle_uint_array(keys, (unsigned int)nkeys * 2);
+
+	printf("Loads %lu int keys, looks up %lu missing keys.\n\n", 
+		nkeys, nkeys);
+	rbbst_guard();
+	skipl_guard();
+	btree_guard();
+
+	printf("Loads %lu elements, looks up %lu missing keys.\n\n", 
+		nkeys, nkeys);
+	rbbst_elem_guard();
+	skipl_elem_guard();
+
+	ALGFREE(keys);
+	return 0;
+}
+
+static void
+rbbst_guard(void)
+{
+	struct rbtree rbt;
+	struct bloom_filter bf;
+	clock_t start_time, end_time;
+	unsigned long i;
+
+	rbbst_init(&rbt, sizeof(int), cmp);
+	for (i = 0; i < nkeys; i++)
+		rbbst_put(&rbt, &keys[i]);
+
+	printf("Red-Black Tree\n");
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++)
+		if (rbbst_get(&rbt, &keys[i]) != NULL)
+			errmsg_exit("Key %u is found.\n", keys[i]);
+	end_time = clock();
+	printf("Misses without the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	bloom_init(&bf, nkeys, FPRATE, int_hash);
+	rbbst_set_guard(&rbt, &bf);
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++)
+		if (rbbst_get(&rbt, &keys[i]) != NULL)
+			errmsg_exit("Key %u is found.\n", keys[i]);
+	end_time = clock();
+	printf("Misses with the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	for (i = 0; i < nkeys; i++)
+		if (rbbst_get(&rbt, &keys[i]) == NULL)
+			errmsg_exit("Key %u is lost.\n", keys[i]);
+	for (i = 0; i < nkeys / 2; i++)
+		if (rbbst_delete(&rbt, &keys[i]) != 0 ||
+			rbbst_get(&rbt, &keys[i]) != NULL)
+			errmsg_exit("Key %u is not deleted.\n", keys[i]);
+	for (; i < nkeys; i++)
+		if (rbbst_get(&rbt, &keys[i]) == NULL)
+			errmsg_exit("Key %u is lost.\n", keys[i]);
+	printf("All keys found and deleted, keys left: %lu\n\n",
+		RBBST_SIZE(&rbt));
+
+	rbbst_clear(&rbt);
+	bloom_clear(&bf);
+}
+
+static void
+skipl_guard(void)
+{
+	struct skip_list sl;
+	struct bloom_filter bf;
+	clock_t start_time, end_time;
+	unsigned long i;
+
+	skipl_init(&sl, 16, sizeof(int), cmp);
+	for (i = 0; i < nkeys; i++)
+		skipl_put(&sl, &keys[i]);
+
+	printf("Skip List\n");
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++)
+		if (skipl_get(&sl, &keys[i]) != NULL)
+			errmsg_exit("Key %u is found.\n", keys[i]);
+	end_time = clock();
+	printf("Misses without the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	bloom_init(&bf, nkeys, FPRATE, int_hash);
+	skipl_set_guard(&sl, &bf);
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++)
+		if (skipl_get(&sl, &keys[i]) != NULL)
+			errmsg_exit("Key %u is found.\n", keys[i]);
+	end_time = clock();
+	printf("Misses with the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	for (i = 0; i < nkeys; i++)
+		if (skipl_get(&sl, &keys[i]) == NULL)
+			errmsg_exit("Key %u is lost.\n", keys[i]);
+	for (i = 0; i < nkeys / 2; i++) {
+		skipl_delete(&sl, &keys[i]);
+		if (skipl_get(&sl, &keys[i]) != NULL)
+			errmsg_exit("Key %u is not deleted.\n", keys[i]);
+	}
+	for (; i < nkeys; i++)
+		if (skipl_get(&sl, &keys[i]) == NULL)
+			errmsg_exit("Key %u is lost.\n", keys[i]);
+	printf("All keys found and deleted, keys left: %lu\n\n",
+		SKIPL_SIZE(&sl));
+
+	skipl_clear(&sl);
+	bloom_clear(&bf);
+}
+
+static void
+btree_guard(void)
+{
+	struct btree bt;
+	struct bloom_filter bf;
+	clock_t start_time, end_time;
+	unsigned long i;
+	unsigned int val, *pv = &val;
+
+	btree_init(&bt, 0, sizeof(int), sizeof(int), cmp);
+	for (i = 0; i < nkeys; i++)
+		btree_put(&bt, &keys[i], &keys[i]);
+
+	printf("B-Tree\n");
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++) {
+		val = UINT_MAX;
+		btree_get(&bt, &keys[i], (void **)&pv);
+		if (val != UINT_MAX)
+			errmsg_exit("Key %u is found.\n", keys[i]);
+	}
+	end_time = clock();
+	printf("Misses without the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	bloom_init(&bf, nkeys, FPRATE, NULL);
+	if (btree_set_guard(&bt, &bf) != -1)
+		errmsg_exit("A guard without a hash function is set.\n");
+	bloom_clear(&bf);
+
+	bloom_init(&bf, nkeys, FPRATE, int_hash);
+	btree_set_guard(&bt, &bf);
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++) {
+		val = UINT_MAX;
+		btree_get(&bt, &keys[i], (void **)&pv);
+		if (val != UINT_MAX)
+			errmsg_exit("Key %u is found.\n", keys[i]);
+	}
+	end_time = clock();
+	printf("Misses with the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	for (i = 0; i < nkeys; i++) {
+		val = UINT_MAX;
+		btree_get(&bt, &keys[i], (void **)&pv);
+		if (val != keys[i])
+			errmsg_exit("Key %u is lost.\n", keys[i]);
+	}
+	for (i = 0; i < nkeys / 2; i++)
+		if (btree_delete(&bt, &keys[i]) != 1)
+			errmsg_exit("Key %u is not deleted.\n", keys[i]);
+	for (; i < nkeys; i++) {
+		val = UINT_MAX;
+		btree_get(&bt, &keys[i], (void **)&pv);
+		if (val != keys[i])
+			errmsg_exit("Key %u is lost.\n", keys[i]);
+	}
+	printf("All keys found and deleted, keys left: %lu\n\n", bt.size);
+
+	btree_clear(&bt);
+	bloom_clear(&bf);
+}
+
+static void
+rbbst_elem_guard(void)
+{
+	struct rbtree rbt;
+	struct bloom_filter bf;
+	struct element item;
+	clock_t start_time, end_time;
+	unsigned long i;
+
+	rbbst_init(&rbt, sizeof(struct element), less);
+	for (i = 0; i < nkeys; i++) {
+		make_element(&item, keys[i]);
+		item.value = (long)keys[i];
+		rbbst_put(&rbt, &item);
+	}
+
+	printf("Red-Black Tree of elements\n");
+	bloom_init(&bf, nkeys, FPRATE, NULL);
+	if (rbbst_set_guard(&rbt, &bf) != -1)
+		errmsg_exit("A guard without a hash function is set.\n");
+	bloom_clear(&bf);
+
+	bloom_init(&bf, nkeys, FPRATE, elem_hash);
+	rbbst_set_guard(&rbt, &bf);
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++) {
+		make_element(&item, keys[i]);
+		if (rbbst_get(&rbt, &item) != NULL)
+			errmsg_exit("Key %s is found.\n", item.key);
+	}
+	end_time = clock();
+	printf("Misses with the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	/* looks up by the key only, as rbbst does */
+	for (i = 0; i < nkeys / 2; i++) {
+		make_element(&item, keys[i]);
+		if (rbbst_delete(&rbt, &item) != 0 ||
+			rbbst_get(&rbt, &item) != NULL)
+			errmsg_exit("Key %s is not deleted.\n", item.key);
+	}
+	for (; i < nkeys; i++) {
+		struct element *el;
+
+		make_element(&item, keys[i]);
+		el = (struct element *)rbbst_get(&rbt, &item);
+		if (el == NULL || el->value != (long)keys[i])
+			errmsg_exit("Key %s is lost.\n", item.key);
+	}
+	printf("All keys found and deleted, keys left: %lu\n\n",
+		RBBST_SIZE(&rbt));
+
+	rbbst_clear(&rbt);
+	bloom_clear(&bf);
+}
+
+static void
+skipl_elem_guard(void)
+{
+	struct skip_list sl;
+	struct bloom_filter bf;
+	struct element item;
+	clock_t start_time, end_time;
+	unsigned long i;
+
+	skipl_init(&sl, 16, sizeof(struct element), less);
+	for (i = 0; i < nkeys; i++) {
+		make_element(&item, keys[i]);
+		item.value = (long)keys[i];
+		skipl_put(&sl, &item);
+	}
+
+	printf("Skip List of elements\n");
+	bloom_init(&bf, nkeys, FPRATE, NULL);
+	if (skipl_set_guard(&sl, &bf) != -1)
+		errmsg_exit("A guard without a hash function is set.\n");
+	bloom_clear(&bf);
+
+	bloom_init(&bf, nkeys, FPRATE, elem_hash);
+	skipl_set_guard(&sl, &bf);
+	start_time = clock();
+	for (i = nkeys; i < nkeys * 2; i++) {
+		make_element(&item, keys[i]);
+		if (skipl_get(&sl, &item) != NULL)
+			errmsg_exit("Key %s is found.\n", item.key);
+	}
+	end_time = clock();
+	printf("Misses with the guard, estimated time(s): %.3f\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+
+	/* looks up by the key only, as skl does */
+	for (i = 0; i < nkeys / 2; i++) {
+		make_element(&item, keys[i]);
+		skipl_delete(&sl, &item);
+		if (skipl_get(&sl, &item) != NULL)
+			errmsg_exit("Key %s is not deleted.\n", item.key);
+	}
+	for (; i < nkeys; i++) {
+		struct element *el;
+
+		make_element(&item, keys[i]);
+		el = (struct element *)skipl_get(&sl, &item);
+		if (el == NULL || el->value != (long)keys[i])
+			errmsg_exit("Key %s is lost.\n", item.key);
+	}
+	printf("All keys found and deleted, keys left: %lu\n\n",
+		SKIPL_SIZE(&sl));
+
+	skipl_clear(&sl);
+	bloom_clear(&bf);
+}
+
+/* 
+ * Fills the search item of the key K. The bytes after the string 
+ * are stale from the last key, less() does not compare them.
+ */
+static void
+make_element(struct element *item, unsigned int k)
+{
+	snprintf(item->key, MAX_KEY_LEN, "key%u", k);
+	item->value = -1;
+}
+
+static unsigned long
+int_hash(const void *key)
+{
+	return bytes_hash(key, sizeof(unsigned int));
+}
+
+/* Hashes the string key only, which is what less() compares. */
+static unsigned long
+elem_hash(const void *key)
+{
+	return string_hash(((const struct element *)key)->key);
+}
+
+static int
+cmp(const void *key1, const void *key2)
+{
+	unsigned int k1 = *(const unsigned int *)key1;
+	unsigned int k2 = *(const unsigned int *)key2;
+
+	return k1 < k2 ? 1 : (k1 == k2 ? 0 : -1);
+}
+
+static int 
+less(const void *key1, const void *key2)
+{
+	const struct element *k1, *k2;
+	int c;
+
+	k1 = (const struct element *)key1;
+	k2 = (const struct element *)key2;
+
+	c = strcmp(k1->key, k2->key);
+	return c < 0 ? 1 : (c == 0 ? 0 : -1);
+}
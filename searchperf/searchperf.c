@@ -32,6 +32,8 @@
 #include "singlelist.h"
 #include "searchtree.h"
 #include "skiplist.h"
+#include "lineprobhash.h"
+#include "swisstablehash.h"
 
 static int cmp(const void *, const void *);
 
@@ -39,11 +41,18 @@ int
 main(int argc, char *argv[])
 {
 	int i, j, sz;
-	unsigned int *dat;
+	unsigned int lg;
+	unsigned int *dat, *sorted;
 	struct single_list slist;
 	struct rbtree rbt;
 	struct splay_tree spt;
-	struct skip_list skl;
+	struct skip_list skl, bskl;
+	struct rbtree brbt;
+	struct avl_tree bavl;
+	struct bstree bst;
+	struct element *els;
+	struct line_prob_hash lph;
+	struct swiss_table swt;
 	clock_t start_time, end_time;
 
 #define LOWER_SIZE	1000
@@ -69,6 +78,11 @@ main(int argc, char *argv[])
 	for (i = 0; i < sz; i++)
 		*(dat + i) = i;
 	shuffle_uint_array(dat, sz);
+	els = (struct element *)algmalloc(sz * sizeof(struct element));
+	for (i = 0; i < sz; i++) {
+		snprintf(els[i].key, MAX_KEY_LEN, "%u", dat[i]);
+		els[i].value = (long)dat[i];
+	}
 	END_TIME;
 	printf("Generated done.\n");
 	SHOW_ESTIMATED;
@@ -114,6 +128,123 @@ main(int argc, char *argv[])
 	SHOW_ESTIMATED;
 	printf("\n");
 
+	printf("Inserts this test data into the Linear-probing Hash Table.\n");
+	LPHASH_INIT(&lph, (unsigned long)sz * 2);
+	/* an empty slot is the one with an empty key and zero value */
+	memset(lph.items, 0, (unsigned long)sz * 2 * sizeof(struct element));
+	START_TIME;
+	for (i = 0; i < sz; i++)
+		lphash_put(&lph, &els[i]);
+	END_TIME;
+	printf("Inserted done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	printf("Inserts this test data into the Swiss Table.\n");
+	swhash_init(&swt, 0);
+	START_TIME;
+	for (i = 0; i < sz; i++)
+		swhash_put(&swt, &els[i]);
+	END_TIME;
+	printf("Inserted done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	/* the keys are loaded from a sorted snapshot */
+	sorted = (unsigned int *)algmalloc(sz * sizeof(int));
+	for (i = 0; i < sz; i++)
+		sorted[i] = i;
+
+	printf("Builds the Skip List from the sorted test data.\n");
+	skipl_init(&bskl, 16, sizeof(int), cmp);
+	START_TIME;
+	skipl_build_sorted(&bskl, sorted, sz);
+	END_TIME;
+	printf("Built done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	printf("Builds the Red-Black Tree from the sorted test data.\n");
+	rbbst_init(&brbt, sizeof(int), cmp);
+	START_TIME;
+	rbbst_build_sorted(&brbt, sorted, sz);
+	END_TIME;
+	printf("Built done, height: %ld\n", RBBST_HEIGHT(&brbt));
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	printf("Builds the AVL Tree from the sorted test data.\n");
+	avlbst_init(&bavl, sizeof(int), cmp);
+	START_TIME;
+	avlbst_build_sorted(&bavl, sorted, sz);
+	END_TIME;
+	printf("Built done, height: %ld\n", AVLBST_HEIGHT(&bavl));
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	skipl_clear(&bskl);
+	rbbst_clear(&brbt);
+	avlbst_clear(&bavl);
+	ALGFREE(sorted);
+
+	/* the iterative inserts are compared with the recursive ones */
+	printf("Inserts this test data into the Red-Black Tree "
+		"by recursion.\n");
+	rbbst_init(&brbt, sizeof(int), cmp);
+	START_TIME;
+	for (i = 0; i < sz; i++)
+		rbbst_put_recursive(&brbt, &dat[i]);
+	END_TIME;
+	printf("Inserted done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+	rbbst_clear(&brbt);
+
+	printf("Inserts this test data into the AVL Tree.\n");
+	avlbst_init(&bavl, sizeof(int), cmp);
+	START_TIME;
+	for (i = 0; i < sz; i++)
+		avlbst_put(&bavl, &dat[i]);
+	END_TIME;
+	printf("Inserted done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+	avlbst_clear(&bavl);
+
+	printf("Inserts this test data into the AVL Tree by recursion.\n");
+	avlbst_init(&bavl, sizeof(int), cmp);
+	START_TIME;
+	for (i = 0; i < sz; i++)
+		avlbst_put_recursive(&bavl, &dat[i]);
+	END_TIME;
+	printf("Inserted done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+	avlbst_clear(&bavl);
+
+	printf("Inserts this test data into the Binary Search Tree.\n");
+	bst_init(&bst, sizeof(int), cmp);
+	START_TIME;
+	for (i = 0; i < sz; i++)
+		bst_put(&bst, &dat[i]);
+	END_TIME;
+	printf("Inserted done, height: %ld\n", BST_HEIGHT(&bst));
+	SHOW_ESTIMATED;
+	printf("\n");
+	bst_clear(&bst);
+
+	printf("Inserts this test data into the Binary Search Tree "
+		"by recursion.\n");
+	bst_init(&bst, sizeof(int), cmp);
+	START_TIME;
+	for (i = 0; i < sz; i++)
+		bst_put_recursive(&bst, &dat[i]);
+	END_TIME;
+	printf("Inserted done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+	bst_clear(&bst);
+
 	printf("Query the Red-Black Tree %d times.\n", QUERIES);
 	START_TIME;
 	for (i = 0; i < QUERIES; i++) {
@@ -147,6 +278,55 @@ main(int argc, char *argv[])
 	SHOW_ESTIMATED;
 	printf("\n");
 
+	printf("Query the Splay Tree %d times by semi-splaying.\n", 
+		QUERIES);
+	/* the lookups within twice the balanced height stay in place */
+	for (lg = 0; (1 << lg) < sz; lg++)
+		;
+	splayt_semisplay(&spt, 2 * lg, 100);
+	START_TIME;
+	for (i = 0; i < QUERIES; i++) {
+		j = (int)rand_range_integer(0, sz);
+		splayt_get(&spt, &dat[j]);
+	}
+	END_TIME;
+	printf("Queried done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	printf("Peek the Splay Tree %d times.\n", QUERIES);
+	START_TIME;
+	for (i = 0; i < QUERIES; i++) {
+		j = (int)rand_range_integer(0, sz);
+		splayt_peek(&spt, &dat[j]);
+	}
+	END_TIME;
+	printf("Peeked done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	printf("Query the Linear-probing Hash Table %d times.\n", QUERIES);
+	START_TIME;
+	for (i = 0; i < QUERIES; i++) {
+		j = (int)rand_range_integer(0, sz);
+		lphash_get(&lph, els[j].key);
+	}
+	END_TIME;
+	printf("Queried done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+
+	printf("Query the Swiss Table %d times.\n", QUERIES);
+	START_TIME;
+	for (i = 0; i < QUERIES; i++) {
+		j = (int)rand_range_integer(0, sz);
+		swhash_get(&swt, els[j].key);
+	}
+	END_TIME;
+	printf("Queried done.\n");
+	SHOW_ESTIMATED;
+	printf("\n");
+
 	printf("Query the Singly Linked List %d times.\n", QUERIES);
 	START_TIME;
 	for (i = 0; i < QUERIES; i++) {
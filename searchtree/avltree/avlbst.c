@@ -44,6 +44,8 @@ main(int argc, char *argv[])
 	struct avl_tree bst;
 	struct element item, *el, *minel, *maxel;
 	struct single_list els;
+	struct avlbst_cursor cur;
+	unsigned long cnt;
 	clock_t start_time, end_time;
 	unsigned long rank;
 	char *fname = NULL, *key = NULL, *rand_key = NULL;
@@ -116,6 +118,19 @@ main(int argc, char *argv[])
 	slist_clear(&els);
 	printf("\n");
 	
+	printf("Begin traverses this AVL Tree backwards with a cursor.\n");
+	cnt = 0;
+	start_time = clock();
+	avlbst_cursor_init(&cur, &bst);
+	for (avlbst_cursor_last(&cur); AVLBST_CURSOR_VALID(&cur); 
+		avlbst_cursor_prev(&cur)) {
+		cnt++;
+	}
+	end_time = clock();
+	printf("Total elements: %lu, estimated time(s): %.3f\n", cnt,
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("\n");
+	
 	printf("Begin delete the minimum key and the maximum key from "
 		"the AVL BST...\n");
 	start_time = clock();
@@ -49,32 +49,23 @@
 #define BALANCE_FACTOR(node)	\
 	(AVLBST_HEIGHT_NODE((node)->left) - AVLBST_HEIGHT_NODE((node)->right))
 
-static struct avl_node * get_node(struct avl_node *, const void *,
-	algcomp_ft *);
 static struct avl_node * make_node(const void *, unsigned int);
 static inline struct avl_node * rotate_right(struct avl_node *);
 static inline struct avl_node * rotate_left(struct avl_node *);
 static struct avl_node * balance(struct avl_node *);
 static struct avl_node * put_node(const struct avl_tree *, struct avl_node *,
 	const void *);
-static void release_subtree(struct avl_node *, unsigned int);
-static void preorder_nodes(const struct avl_node *, struct single_list *);
+static inline const void * sorted_key(const void *, unsigned long,
+			unsigned int);
+static struct avl_node * build_subtree(const struct avl_tree *, const void *,
+			unsigned long, unsigned long);
+static inline void relink(struct avl_tree *, struct avl_node **, int,
+	struct avl_node *, struct avl_node *);
+static void fix_path(struct avl_tree *, struct avl_node **, int);
+static void remove_node(struct avl_tree *, struct avl_node **, int,
+	struct avl_node *);
 static struct avl_node * min_node(struct avl_node *);
 static struct avl_node * max_node(struct avl_node *);
-static struct avl_node * delete_min_node(struct avl_node *, unsigned int);
-static struct avl_node * delete_min(struct avl_node *);
-static struct avl_node * delete_max_node(struct avl_node *, unsigned int);
-static struct avl_node * delete_node(const struct avl_tree *, struct avl_node *,
-	const void *);
-static struct avl_node * floor_node(struct avl_node *, const void *,
-	algcomp_ft *);
-static struct avl_node * ceiling_node(struct avl_node *, const void *,
-	algcomp_ft *);
-static unsigned long rank_node(const struct avl_node *, const void *,
-	algcomp_ft *);
-static void * select_node(unsigned long, struct avl_node *);
-static void keys_range(const struct avl_node *, const void *, const void *,
-	algcomp_ft *, struct single_list *);
 static int isbst(const struct avl_node *, const void *,	const void *,
 	algcomp_ft *);
 static int isavl(const struct avl_node *node);
@@ -94,19 +85,54 @@ avlbst_init(struct avl_tree *avl, unsigned int ksize, algcomp_ft *cmp)
 void * 
 avlbst_get(const struct avl_tree *avl, const void *key)
 {
-	struct avl_node *node;
+	struct avl_node *x;
+	int cr;
 	
 	if (key == NULL)
 		return NULL;
 	
-	if ((node = get_node(avl->root, key, avl->cmp)) == NULL)
-		return NULL;
-	return (node->key);
+	for (x = avl->root; x != NULL; ) {
+		if ((cr = avl->cmp(key, x->key)) == 0)
+			return (x->key);
+		x = cr == 1 ? x->left : x->right;
+	}
+	return NULL;
 }
 
-/* Inserts the key into the AVL tree. */
+/* 
+ * Inserts the key into the AVL tree. The path from the root is 
+ * kept in an array, its nodes are fixed and balanced from the 
+ * bottom up as the recursion would do on its way back.
+ */
 void 
 avlbst_put(struct avl_tree *avl, const void *key)
+{
+	struct avl_node *path[AVLBST_CURSOR_DEPTH], *x, *node;
+	int depth = 0, cr = 0;
+
+	if (key == NULL)
+		return;
+
+	for (x = avl->root; x != NULL; ) {
+		if ((cr = avl->cmp(key, x->key)) == 0)
+			return;
+		path[depth++] = x;
+		x = cr == 1 ? x->left : x->right;
+	}
+
+	node = make_node(key, avl->keysize);
+	if (depth == 0)
+		avl->root = node;
+	else if (cr == 1)
+		path[depth - 1]->left = node;
+	else
+		path[depth - 1]->right = node;
+	fix_path(avl, path, depth);
+}
+
+/* Inserts the key into the AVL tree by recursion. */
+void 
+avlbst_put_recursive(struct avl_tree *avl, const void *key)
 {
 	if (key == NULL)
 		return;
@@ -114,19 +140,80 @@ avlbst_put(struct avl_tree *avl, const void *key)
 	avl->root = put_node(avl, avl->root, key);
 }
 
-/* Releases the AVL tree. */
+/* 
+ * Builds the AVL tree from N keys in strictly ascending order, 
+ * in O(N) time. KEYS is an array of N keys of the key size, or of 
+ * N pointers if the tree holds the caller's keys. The tree must be 
+ * empty. The middle key of every range is the root of its subtree,
+ * so the tree is perfectly balanced.
+ */
+void
+avlbst_build_sorted(struct avl_tree *avl, const void *keys, unsigned long n)
+{
+	unsigned long i;
+
+	if (!AVLBST_ISEMPTY(avl))
+		errmsg_exit("calls avlbst_build_sorted() with a non-empty "
+			"tree.\n");
+	if (n == 0)
+		return;
+	if (keys == NULL)
+		errmsg_exit("calls avlbst_build_sorted() with null "
+			"argument.\n");
+
+	for (i = 1; i < n; i++)
+		if (avl->cmp(sorted_key(keys, i - 1, avl->keysize), 
+			sorted_key(keys, i, avl->keysize)) != 1)
+			errmsg_exit("The keys are not in strictly ascending "
+				"order at %lu.\n", i);
+
+	avl->root = build_subtree(avl, keys, 0, n);
+}
+
+/* 
+ * Releases the AVL tree. The left child is rotated up until there 
+ * is none, then the node is freed and its right subtree is next.
+ */
 void 
 avlbst_clear(struct avl_tree *avl)
 {
-	if (!AVLBST_ISEMPTY(avl))
-		release_subtree(avl->root, avl->keysize);
+	struct avl_node *x, *next;
+
+	for (x = avl->root; x != NULL; x = next) {
+		if ((next = x->left) != NULL) {
+			x->left = next->right;
+			next->right = x;
+		} else {
+			next = x->right;
+			if (avl->keysize != 0)
+				ALGFREE(x->key);
+			ALGFREE(x);
+		}
+	}
+	avl->root = NULL;
 }
 
+/* 
+ * Traverses for preorder, the right subtrees not visited yet 
+ * are kept in a stack no deeper than the tree.
+ */
 void 
 avlbst_preorder(const struct avl_tree *avl, struct single_list *keys)
 {
+	struct avl_node *stack[AVLBST_CURSOR_DEPTH], *x;
+	int sp = 0;
+
 	slist_init(keys, 0, avl->cmp);
-	preorder_nodes(avl->root, keys);
+	for (x = avl->root; x != NULL; ) {
+		slist_append(keys, x->key);
+		if (x->right != NULL)
+			stack[sp++] = x->right;
+
+		if (x->left != NULL)
+			x = x->left;
+		else
+			x = sp > 0 ? stack[--sp] : NULL;
+	}
 }
 
 /* Returns the smallest key in the AVL BST */
@@ -151,29 +238,52 @@ avlbst_max(const struct avl_tree *avl)
 void 
 avlbst_delete_min(struct avl_tree *avl)
 {
-	if (!AVLBST_ISEMPTY(avl))
-		avl->root = delete_min_node(avl->root, avl->keysize);
+	struct avl_node *path[AVLBST_CURSOR_DEPTH], *x;
+	int depth = 0;
+
+	if (AVLBST_ISEMPTY(avl))
+		return;
+
+	for (x = avl->root; x->left != NULL; x = x->left)
+		path[depth++] = x;
+	remove_node(avl, path, depth, x);
 }
 
 /* Removes the largest key from this AVL tree. */
 void 
 avlbst_delete_max(struct avl_tree *avl)
 {
-	if (!AVLBST_ISEMPTY(avl))
-		avl->root = delete_max_node(avl->root, avl->keysize);
+	struct avl_node *path[AVLBST_CURSOR_DEPTH], *x;
+	int depth = 0;
+
+	if (AVLBST_ISEMPTY(avl))
+		return;
+
+	for (x = avl->root; x->right != NULL; x = x->right)
+		path[depth++] = x;
+	remove_node(avl, path, depth, x);
 }
 
 /* Removes the specified key from the AVL tree. */
 int
 avlbst_delete(struct avl_tree *avl, const void *key)
 {
+	struct avl_node *path[AVLBST_CURSOR_DEPTH], *x;
+	int depth = 0, cr;
+
 	if (AVLBST_ISEMPTY(avl))
 		return -1;
 	
-	if (avlbst_get(avl, key) == NULL)
+	for (x = avl->root; x != NULL; ) {
+		if ((cr = avl->cmp(key, x->key)) == 0)
+			break;
+		path[depth++] = x;
+		x = cr == 1 ? x->left : x->right;
+	}
+	if (x == NULL)
 		return -2;
 	
-	avl->root = delete_node(avl, avl->root, key);
+	remove_node(avl, path, depth, x);
 	return 0;
 }
 
@@ -181,9 +291,19 @@ avlbst_delete(struct avl_tree *avl, const void *key)
 void * 
 avlbst_floor(const struct avl_tree *avl, const void *key)
 {
-	struct avl_node *current;
-	
-	current = floor_node(avl->root, key, avl->cmp);
+	struct avl_node *x, *current = NULL;
+	int cr;
+
+	for (x = avl->root; x != NULL; ) {
+		if ((cr = avl->cmp(key, x->key)) == 0)
+			return (x->key);
+		if (cr == 1) {
+			x = x->left;
+		} else {
+			current = x;
+			x = x->right;
+		}
+	}
 	return current == NULL ? NULL : (current->key);
 }
 
@@ -191,9 +311,19 @@ avlbst_floor(const struct avl_tree *avl, const void *key)
 void * 
 avlbst_ceiling(const struct avl_tree *avl, const void *key)
 {
-	struct avl_node *current;
-	
-	current = ceiling_node(avl->root, key, avl->cmp);
+	struct avl_node *x, *current = NULL;
+	int cr;
+
+	for (x = avl->root; x != NULL; ) {
+		if ((cr = avl->cmp(key, x->key)) == 0)
+			return (x->key);
+		if (cr == -1) {
+			x = x->right;
+		} else {
+			current = x;
+			x = x->left;
+		}
+	}
 	return current == NULL ? NULL : (current->key);
 }
 
@@ -201,7 +331,21 @@ avlbst_ceiling(const struct avl_tree *avl, const void *key)
 unsigned long 
 avlbst_rank(const struct avl_tree *avl, const void *key)
 {
-	return rank_node(avl->root, key, avl->cmp);
+	struct avl_node *x;
+	unsigned long rank = 0;
+	int cr;
+
+	for (x = avl->root; x != NULL; ) {
+		if ((cr = avl->cmp(key, x->key)) == 1) {
+			x = x->left;
+		} else if (cr == -1) {
+			rank += 1 + AVLBST_SIZE_NODE(x->left);
+			x = x->right;
+		} else {
+			return rank + AVLBST_SIZE_NODE(x->left);
+		}
+	}
+	return rank;
 }
 
 /* 
@@ -213,18 +357,46 @@ avlbst_rank(const struct avl_tree *avl, const void *key)
 void * 
 avlbst_select(const struct avl_tree *avl, unsigned long rank)
 {
-	if (rank < AVLBST_SIZE(avl))
-		return select_node(rank, avl->root);
+	struct avl_node *x;
+	unsigned long leftsize;
+
+	if (rank >= AVLBST_SIZE(avl))
+		return NULL;
+
+	for (x = avl->root; x != NULL; ) {
+		leftsize = AVLBST_SIZE_NODE(x->left);
+		if (rank < leftsize) {
+			x = x->left;
+		} else if (rank > leftsize) {
+			rank -= leftsize + 1;
+			x = x->right;
+		} else {
+			return (x->key);
+		}
+	}
 	return NULL;
 }
 
-/* Returns all keys in the AVL tree in the given range. */
+/* 
+ * Returns all keys in the AVL tree in the given range, a cursor 
+ * walks from the smallest key not less than lokey.
+ */
 void
 avlbst_keys(const struct avl_tree *avl, const void *lokey, const void *hikey,
 		struct single_list *keys)
 {
+	struct avlbst_cursor c;
+	void *key;
+
 	slist_init(keys, 0, avl->cmp);
-	keys_range(avl->root, lokey, hikey, avl->cmp, keys);
+	avlbst_cursor_init(&c, avl);
+	for (avlbst_cursor_seek(&c, lokey); AVLBST_CURSOR_VALID(&c); 
+		avlbst_cursor_next(&c)) {
+		key = avlbst_cursor_key(&c);
+		if (avl->cmp(hikey, key) == 1)
+			break;
+		slist_append(keys, key);
+	}
 }
 
 void 
@@ -285,29 +457,124 @@ avlbst_check(const struct avl_tree *avl)
 	return flag;
 }
 
-/******************** static function boundary ********************/
+/* Initializes a cursor over the keys of the AVL tree, it is not on any key. */
+void
+avlbst_cursor_init(struct avlbst_cursor *c, const struct avl_tree *avl)
+{
+	c->avl = avl;
+	c->depth = 0;
+}
 
 /* 
- * Returns AVL Node associated with 
- * the given key in the subtree.
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL. The cursor keeps the path 
+ * from the root, cut at the last node where the search went left.
  */
-static struct avl_node * 
-get_node(struct avl_node *node, const void *key, algcomp_ft *kcmp)
+void
+avlbst_cursor_seek(struct avlbst_cursor *c, const void *key)
 {
+	struct avl_node *x;
+	int keep = 0;
 	int cr;
-	
-	if (node == NULL)
-		return NULL;	/* not found key */
-	
-	cr = kcmp(key, node->key);
-	if (cr == 1)
-		return get_node(node->left, key, kcmp);
-	else if (cr == -1)
-		return get_node(node->right, key, kcmp);
-	else
-		return node;
+
+	c->depth = 0;
+	for (x = c->avl->root; x != NULL; ) {
+		c->path[c->depth++] = x;
+		if (key == NULL)
+			cr = 1;
+		else if ((cr = c->avl->cmp(key, x->key)) == 0) {
+			keep = c->depth;
+			break;
+		}
+
+		if (cr == 1) {
+			keep = c->depth;
+			x = x->left;
+		} else
+			x = x->right;
+	}
+	c->depth = keep;
 }
 
+/* Moves the cursor to the largest key. */
+void
+avlbst_cursor_last(struct avlbst_cursor *c)
+{
+	struct avl_node *x;
+
+	c->depth = 0;
+	for (x = c->avl->root; x != NULL; x = x->right) {
+		c->path[c->depth++] = x;
+	}
+}
+
+/* 
+ * Moves the cursor to the next key in ascending order, 
+ * returns 0 if there is no next key.
+ */
+int
+avlbst_cursor_next(struct avlbst_cursor *c)
+{
+	struct avl_node *x, *child;
+
+	if (c->depth == 0)
+		return 0;
+
+	/* the smallest key of the right subtree */
+	if ((x = c->path[c->depth - 1]->right) != NULL) {
+		for (; x != NULL; x = x->left) {
+			c->path[c->depth++] = x;
+		}
+		return 1;
+	}
+
+	/* the nearest ancestor whose left subtree holds the node */
+	do {
+		child = c->path[--c->depth];
+	} while (c->depth > 0 && c->path[c->depth - 1]->right == child);
+
+	return c->depth > 0;
+}
+
+/* 
+ * Moves the cursor to the previous key in ascending order,
+ * returns 0 if there is no previous key.
+ */
+int
+avlbst_cursor_prev(struct avlbst_cursor *c)
+{
+	struct avl_node *x, *child;
+
+	if (c->depth == 0)
+		return 0;
+
+	/* the largest key of the left subtree */
+	if ((x = c->path[c->depth - 1]->left) != NULL) {
+		for (; x != NULL; x = x->right) {
+			c->path[c->depth++] = x;
+		}
+		return 1;
+	}
+
+	/* the nearest ancestor whose right subtree holds the node */
+	do {
+		child = c->path[--c->depth];
+	} while (c->depth > 0 && c->path[c->depth - 1]->left == child);
+
+	return c->depth > 0;
+}
+
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void *
+avlbst_cursor_key(const struct avlbst_cursor *c)
+{
+	if (c->depth == 0)
+		return NULL;
+	return c->path[c->depth - 1]->key;
+}
+
+/******************** static function boundary ********************/
+
 /* Make the AVL node for AVL tree using the specified key. */
 static struct avl_node * 
 make_node(const void *key, unsigned int ksize)
@@ -329,6 +596,38 @@ make_node(const void *key, unsigned int ksize)
 	return current;
 }
 
+/* Returns the key I of the sorted keys. */
+static inline const void *
+sorted_key(const void *keys, unsigned long i, unsigned int ksize)
+{
+	if (ksize != 0)
+		return (const char *)keys + i * ksize;
+	return ((const void * const *)keys)[i];
+}
+
+/* Builds a perfectly balanced subtree of the N keys starting at LO. */
+static struct avl_node *
+build_subtree(const struct avl_tree *avl, const void *keys, unsigned long lo,
+	unsigned long n)
+{
+	struct avl_node *node;
+	unsigned long mid;
+
+	if (n == 0)
+		return NULL;
+
+	mid = (n - 1) / 2;
+	node = make_node(sorted_key(keys, lo + mid, avl->keysize), 
+		avl->keysize);
+	node->left = build_subtree(avl, keys, lo, mid);
+	node->right = build_subtree(avl, keys, lo + mid + 1, n - 1 - mid);
+	node->size = n;
+	node->height = 1 + MAX(node->left == NULL ? -1 : node->left->height,
+		node->right == NULL ? -1 : node->right->height);
+
+	return node;
+}
+
 /* 
  * Rotates the given subtree to the right, meanwhile, updates the size and
  * height of subtree. 
@@ -421,277 +720,101 @@ put_node(const struct avl_tree *avl, struct avl_node *node, const void *key)
 	return balance(node);
 }
 
-static void 
-release_subtree(struct avl_node *root, unsigned int ksize)
-{
-	if (root != NULL) {
-		release_subtree(root->left, ksize);
-		release_subtree(root->right, ksize);
-		if (ksize != 0)
-			ALGFREE(root->key);
-		ALGFREE(root);
-	}
-}
-
-static void 
-preorder_nodes(const struct avl_node *root, struct single_list *keys)
-{
-	if (root != NULL) {
-		slist_append(keys, root->key);
-		preorder_nodes(root->left, keys);
-		preorder_nodes(root->right, keys);
-	}
-}
-
 /* 
- * The smallest key in the subtree rooted at Node; 
- * null if no search key.
+ * Links the node Y where the node X was, under the last node 
+ * of the first DEPTH nodes of the path.
  */
-static struct avl_node * 
-min_node(struct avl_node *node)
+static inline void
+relink(struct avl_tree *avl, struct avl_node **path, int depth,
+	struct avl_node *x, struct avl_node *y)
 {
-	if (node->left == NULL)
-		return node;
-	return min_node(node->left);
+	struct avl_node *parent;
+
+	if (depth == 0)
+		avl->root = y;
+	else if ((parent = path[depth - 1])->left == x)
+		parent->left = y;
+	else
+		parent->right = y;
 }
 
 /* 
- * The largest key in the subtree rooted at Node; 
- * null if no search key.
+ * Fixes the sizes and the heights of the first DEPTH nodes of the
+ * path from the bottom up, every node is balanced and linked back.
  */
-static struct avl_node * 
-max_node(struct avl_node *node)
-{
-	if (node->right == NULL)
-		return node;
-	return max_node(node->right);
-}
-
-/* Delete the keywith the minimum key rooted at Node. */
-static struct avl_node * 
-delete_min_node(struct avl_node *node, unsigned int ksize)
-{
-	struct avl_node *current;
-	
-	if (node->left == NULL) {
-		current = node->right;
-		if (ksize != 0)
-			ALGFREE(node->key);
-		ALGFREE(node);
-		return current;
+static void
+fix_path(struct avl_tree *avl, struct avl_node **path, int depth)
+{
+	struct avl_node *x;
+
+	while (depth-- > 0) {
+		x = path[depth];
+		x->size = 1 + AVLBST_SIZE_NODE(x->left) + 
+			AVLBST_SIZE_NODE(x->right);
+		x->height = 1 + MAX(AVLBST_HEIGHT_NODE(x->left), 
+			AVLBST_HEIGHT_NODE(x->right));
+		relink(avl, path, depth, x, balance(x));
 	}
-	
-	node->left = delete_min_node(node->left, ksize);
-	
-	node->size = 1 + AVLBST_SIZE_NODE(node->left) + 
-		AVLBST_SIZE_NODE(node->right);
-	node->height = 1 + MAX(AVLBST_HEIGHT_NODE(node->left), 
-		AVLBST_HEIGHT_NODE(node->right));
-	
-	return balance(node);
-}
-
-static struct avl_node * 
-delete_min(struct avl_node *node)
-{
-	struct avl_node *current;
-	
-	if (node->left == NULL) {
-		current = node->right;
-		return current;
-	}
-	
-	node->left = delete_min(node->left);
-	
-	node->size = 1 + AVLBST_SIZE_NODE(node->left) + 
-		AVLBST_SIZE_NODE(node->right);
-	node->height = 1 + MAX(AVLBST_HEIGHT_NODE(node->left), 
-		AVLBST_HEIGHT_NODE(node->right));
-	
-	return balance(node);
-}
-
-/* Delete the key with the maximum key rooted at Node. */
-static struct avl_node * 
-delete_max_node(struct avl_node *node, unsigned int ksize)
-{
-	struct avl_node *current;
-	
-	if (node->right == NULL) {
-		current = node->left;
-		if (ksize != 0)
-			ALGFREE(node->key);
-		ALGFREE(node);
-		return current;
-	}
-	
-	node->right = delete_max_node(node->right, ksize);
-	
-	node->size = 1 + AVLBST_SIZE_NODE(node->left) + 
-		AVLBST_SIZE_NODE(node->right);
-	node->height = 1 + MAX(AVLBST_HEIGHT_NODE(node->left), 
-		AVLBST_HEIGHT_NODE(node->right));
-	
-	return balance(node);
-}
-
-/* Delete the key by the given key rooted at Node. */
-static struct avl_node * 
-delete_node(const struct avl_tree *avl, struct avl_node *node, const void *key)
-{
-	int cr;
-	struct avl_node *current;
-	
-	if (node == NULL)
-		return NULL;
-	
-	cr = avl->cmp(key, node->key);
-	if (cr == 1)
-		node->left = delete_node(avl, node->left, key);
-	else if (cr == -1)
-		node->right = delete_node(avl, node->right, key);
-	else {
-		if (node->left == NULL) {
-			current = node->right;
-			if (avl->keysize != 0)
-				ALGFREE(node->key);
-			ALGFREE(node);
-			return current;
-		} else if (node->right == NULL) {
-			current = node->left;
-			if (avl->keysize != 0)
-				ALGFREE(node->key);
-			ALGFREE(node);
-			return current;
-		} else {
-			current = node;
-			node = min_node(current->right);
-			node->right = delete_min(current->right);
-			node->left = current->left;
-			if (avl->keysize != 0)
-				ALGFREE(current->key);
-			ALGFREE(current);
-		}
-	}
-	
-	node->size = 1 + AVLBST_SIZE_NODE(node->left) + 
-		AVLBST_SIZE_NODE(node->right);
-	node->height = 1 + MAX(AVLBST_HEIGHT_NODE(node->left), 
-		AVLBST_HEIGHT_NODE(node->right));
-	
-	return balance(node);
 }
 
 /* 
- * The largest key in the subtree rooted at Node 
- * less than or equal to the given key.
+ * Removes the node X under the first DEPTH nodes of the path. 
+ * A node of two children is replaced by the smallest node of its 
+ * right subtree, the path goes on down to that node.
  */
-static struct avl_node * 
-floor_node(struct avl_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	struct avl_node *rnode;
-	
-	if (node == NULL)	/* not found the specified key */
-		return NULL;
+static void
+remove_node(struct avl_tree *avl, struct avl_node **path, int depth,
+	struct avl_node *x)
+{
+	struct avl_node *succ, *parent;
+	int at;
+
+	if (x->left == NULL || x->right == NULL) {
+		relink(avl, path, depth, x, 
+			x->left != NULL ? x->left : x->right);
+	} else {
+		at = depth;
+		path[depth++] = x;
+		for (succ = x->right; succ->left != NULL; succ = succ->left)
+			path[depth++] = succ;
+
+		if ((parent = path[depth - 1]) != x) {
+			parent->left = succ->right;
+			succ->right = x->right;
+		}
+		succ->left = x->left;
+		relink(avl, path, at, x, succ);
+		path[at] = succ;
+	}
 
-	if ((cr = kcmp(key, node->key)) == 0)
-		return node;
-	if (cr == 1)
-		return floor_node(node->left, key, kcmp);
-	if ((rnode = floor_node(node->right, key, kcmp)) != NULL)
-		return rnode;
-	else
-		return node;
+	if (avl->keysize != 0)
+		ALGFREE(x->key);
+	ALGFREE(x);
+	fix_path(avl, path, depth);
 }
 
 /* 
- * The smallest key in the subtree rooted at Node 
- * greater than or equal to the given key.
+ * The smallest key in the subtree rooted at Node; 
+ * null if no search key.
  */
 static struct avl_node * 
-ceiling_node(struct avl_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	struct avl_node *lnode;
-	
-	if (node == NULL)
-		return NULL;
-	
-	if ((cr = kcmp(key, node->key)) == 0)
-		return node;
-	if (cr == -1)
-		return ceiling_node(node->right, key, kcmp);
-	if ((lnode = ceiling_node(node->left, key, kcmp)) != NULL)
-		return lnode;
-	else
-		return node;
-}
-
-/* 
- * Number of keys less than the given key 
- * in the subtree rooted at Node.
- */
-static unsigned long 
-rank_node(const struct avl_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	
-	if (node == NULL)
-		return 0;
-	
-	if ((cr = kcmp(key, node->key)) == 1)
-		return rank_node(node->left, key, kcmp);
-	if (cr == -1) {
-		return 1 + AVLBST_SIZE_NODE(node->left) +
-			rank_node(node->right, key, kcmp);
-	} else
-		return AVLBST_SIZE_NODE(node->left);
-}
-
-/* 
- * Return key in BST rooted at Node of given rank.
- * Precondition: rank is in legal range. 
- */
-static void * 
-select_node(unsigned long rank, struct avl_node *node)
+min_node(struct avl_node *node)
 {
-	unsigned long leftsize;
-	
-	if (node == NULL)
-		return NULL;
-	
-	leftsize = AVLBST_SIZE_NODE(node->left);
-	if (rank < leftsize)
-		return select_node(rank, node->left);
-	if (rank > leftsize)
-		return select_node(rank - leftsize - 1, node->right);
-	else
-		return (node->key);
+	while (node->left != NULL)
+		node = node->left;
+	return node;
 }
 
 /* 
- * Adds the keys between Lokey and Hikey in the subtree 
- * rooted at Node to the Queue. 
+ * The largest key in the subtree rooted at Node; 
+ * null if no search key.
  */
-static void 
-keys_range(const struct avl_node *node, const void *lokey, const void *hikey,
-		algcomp_ft *kcmp, struct single_list *keys)
+static struct avl_node * 
+max_node(struct avl_node *node)
 {
-	int cmplo, cmphi;
-	
-	if (node == NULL)
-		return;
-	
-	cmplo = kcmp(lokey, node->key);
-	cmphi = kcmp(hikey, node->key);
-	
-	if (cmplo == 1)
-		keys_range(node->left, lokey, hikey, kcmp, keys);
-	if ((cmplo == 1 || cmplo == 0) && (cmphi == -1 || cmphi == 0))
-		slist_append(keys, node->key);
-	if (cmphi == -1)
-		keys_range(node->right, lokey, hikey, kcmp, keys);
+	while (node->right != NULL)
+		node = node->right;
+	return node;
 }
 
 /* 
@@ -35,6 +35,9 @@
 
 #define MIN_WIDTH	5
 
+/* The fill factor of the bulk loaded nodes */
+#define BULK_FILL	0.9
+
 static void usage_info(const char *);
 static int kcmp(const void *, const void *);
 
@@ -42,17 +45,18 @@ int
 main(int argc, char *argv[])
 {
 	int *keys, *key;
-	char *val;
+	char *val, *vals;
 	int i, j, w, x, k, cnt = 0;
 	struct btree bt;
 	struct single_list records;
 	struct slist_node *nptr;
-	struct btree_entry *entry;
+	struct btree_cursor cur;
 	clock_t start_time, end_time;
 	int num = 0, width = 0;
+	unsigned int pgsz = 0;
 
 	int op;
-	const char *optstr = "n:w:";
+	const char *optstr = "n:w:p:";
 
 	extern char *optarg;
 	extern int optind;
@@ -72,6 +76,10 @@ main(int argc, char *argv[])
 				if (width <= MIN_WIDTH)
 					errmsg_exit("The max width must be greater than 5.\n");
 				break;
+			case 'p':
+				if (sscanf(optarg, "%u", &pgsz) != 1)
+					errmsg_exit("Illegal number. -p %s\n", optarg);
+				break;
 			default:
 				fprintf(stderr, "Parameters error.\n");
 				usage_info(argv[0]);
@@ -83,7 +91,9 @@ main(int argc, char *argv[])
 
 	SET_RANDOM_SEED;
 
-	btree_init(&bt, sizeof(int), width + 1, kcmp);
+	btree_init(&bt, pgsz, sizeof(int), width + 1, kcmp);
+	printf("Page size: %u, fanout: %u, keys per leaf: %u\n", bt.pagesize,
+		BTREE_FANOUT(&bt), bt.leafcap);
 	keys = (int *)algmalloc((num / 2) * sizeof(int));
 
 	printf("Begin inserts into B-Tree %d key-value pairs.\n", num);
@@ -108,7 +118,7 @@ main(int argc, char *argv[])
 
 	printf("Begin random query %d keys and print associated value.\n", j);
 	start_time = clock();
-	val = (char *)algmalloc(width * sizeof(char));
+	val = (char *)algmalloc((width + 1) * sizeof(char));
 	for (i = 0; i < j; i++) {
 		btree_get(&bt, &keys[i], (void **)&val);
 		printf("%-8d %-8s\n", keys[i], val);
@@ -129,6 +139,16 @@ main(int argc, char *argv[])
 	printf("The maximum of key in this B-Tree: %d\n", j);
 	printf("\n");
 
+	x = (i + j) / 2;
+	printf("Scans 10 key-value pairs from key %d with a cursor.\n", x);
+	btree_cursor_init(&cur, &bt);
+	for (btree_cursor_seek(&cur, &x), k = 0; BTREE_CURSOR_VALID(&cur) && 
+		k < 10; btree_cursor_next(&cur), k++) {
+		printf("%-8d %-8s\n", *(int *)btree_cursor_key(&cur),
+			(char *)btree_cursor_value(&cur));
+	}
+	printf("\n");
+
 	for (k = 0; k < num * 2; k++) {
 		x = rand_range_integer(1, num);
 		if (btree_delete(&bt, &x) == 0) {
@@ -142,8 +162,7 @@ main(int argc, char *argv[])
 		btree_range_query(&bt, &i, &j, &records);
 		printf("Record set size: %lu\n", SLIST_LENGTH(&records));
 		w = 0;
-		SLIST_FOREACH(&records, nptr, struct btree_entry, entry) {
-			key = (int *)entry->key;
+		SLIST_FOREACH(&records, nptr, int, key) {
 			printf("%3d ", *key);
 			if (++w % 10 == 0)
 				printf("\n");
@@ -160,6 +179,41 @@ main(int argc, char *argv[])
 	printf("The height: %d\n", BTREE_HEIGHT(&bt));
 
 	btree_clear(&bt);
+	printf("\n");
+
+	/* sorted keys with random values */
+	keys = (int *)algmalloc(num * sizeof(int));
+	vals = (char *)algcalloc(num, width + 1);
+	for (i = 0; i < num; i++) {
+		keys[i] = i + 1;
+		val = rand_string(rand_range_integer(MIN_WIDTH, width));
+		strcpy(vals + (size_t)i * (width + 1), val);
+		ALGFREE(val);
+	}
+
+	printf("Begin bulk loads %d sorted key-value pairs.\n", num);
+	btree_init(&bt, pgsz, sizeof(int), width + 1, kcmp);
+	start_time = clock();
+	btree_bulk_load(&bt, keys, vals, num, BULK_FILL);
+	end_time = clock();
+	printf("Loaded done, estimated time(s): %.3f, the height: %d\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC,
+		BTREE_HEIGHT(&bt));
+	btree_clear(&bt);
+
+	printf("Begin inserts %d sorted key-value pairs.\n", num);
+	btree_init(&bt, pgsz, sizeof(int), width + 1, kcmp);
+	start_time = clock();
+	for (i = 0; i < num; i++)
+		btree_put(&bt, &keys[i], vals + (size_t)i * (width + 1));
+	end_time = clock();
+	printf("Inserted done, estimated time(s): %.3f, the height: %d\n",
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC,
+		BTREE_HEIGHT(&bt));
+	btree_clear(&bt);
+
+	ALGFREE(keys);
+	ALGFREE(vals);
 
 	return 0;
 }
@@ -183,8 +237,9 @@ kcmp(const void *key1, const void *key2)
 static void
 usage_info(const char *pname)
 {
-	fprintf(stderr, "Usage: %s -n -w\n", pname);
+	fprintf(stderr, "Usage: %s -n -w -p\n", pname);
 	fprintf(stderr, "-n: The number of items.\n");
 	fprintf(stderr, "-w: The max width of the value.\n");
+	fprintf(stderr, "-p: The page size of the nodes, 0 is 4096.\n");
 	exit(EXIT_FAILURE);
 }
@@ -0,0 +1,210 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "betree.h"
+#include "btree.h"
+#include "singlelist.h"
+#include <getopt.h>
+
+static void usage_info(const char *);
+static int kcmp(const void *, const void *);
+static void add_count(void *, const void *, int);
+static double elapsed(const struct timespec *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct betree bet;
+	struct btree bt;
+	struct single_list keys;
+	struct timespec start;
+	long *dat, val, *pv = &val, lo, hi, one = 1;
+	unsigned long i, num = 0, found, ecnt;
+	unsigned int pgsz = 0;
+	int op;
+	const char *optstr = "n:p:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'n':
+			if (sscanf(optarg, "%lu", &num) != 1)
+				errmsg_exit("Illegal number. -n %s\n", optarg);
+			break;
+		case 'p':
+			if (sscanf(optarg, "%u", &pgsz) != 1)
+				errmsg_exit("Illegal number. -p %s\n", optarg);
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	if (num == 0)
+		errmsg_exit("The number of keys must be greater than 0.\n");
+
+	SET_RANDOM_SEED;
+
+	dat = (long *)algmalloc(num * sizeof(long));
+	for (i = 0; i < num; i++)
+		dat[i] = ((long)rand() << 31) ^ rand();
+
+	betree_init(&bet, pgsz, sizeof(long), sizeof(long), kcmp, add_count);
+	btree_init(&bt, pgsz, sizeof(long), sizeof(long), kcmp);
+	printf("Page size: %u, fanout: %u, buffered messages: %u, "
+		"keys per leaf: %u\n", bet.pagesize, BETREE_FANOUT(&bet), 
+		bet.bufcap, bet.leafcap);
+	printf("\n");
+
+	printf("Begin inserts %lu random keys into the B-epsilon tree.\n", 
+		num);
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num; i++)
+		betree_put(&bet, &dat[i], &dat[i]);
+	printf("Inserted done, estimated time(s): %.3f\n", elapsed(&start));
+	printf("Leaf writes: %lu, %.4f per insert, the height: %d\n", 
+		bet.leafwrites, (double)bet.leafwrites / (double)num, 
+		BETREE_HEIGHT(&bet));
+
+	printf("Begin inserts the same keys into the B+ tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num; i++)
+		btree_put(&bt, &dat[i], &dat[i]);
+	printf("Inserted done, estimated time(s): %.3f\n", elapsed(&start));
+	printf("Leaf writes: %lu, 1 per insert, the height: %d\n", num,
+		BTREE_HEIGHT(&bt));
+	printf("\n");
+
+	printf("Begin upserts a counter into every other key.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num; i += 2)
+		betree_upsert(&bet, &dat[i], &one);
+	printf("Upserted done, estimated time(s): %.3f\n", elapsed(&start));
+	printf("\n");
+
+	printf("Begin queries all keys in the B-epsilon tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0, found = 0; i < num; i++) {
+		if (betree_get(&bet, &dat[i], &val) && 
+			val == dat[i] + (long)(i % 2 == 0))
+			found++;
+	}
+	printf("Found %lu keys with the right values, "
+		"estimated time(s): %.3f\n", found, elapsed(&start));
+
+	printf("Begin queries all keys in the B+ tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num; i++)
+		btree_get(&bt, &dat[i], (void **)&pv);
+	printf("Estimated time(s): %.3f\n", elapsed(&start));
+	printf("\n");
+
+	printf("Begin deletes the first half of keys from the "
+		"B-epsilon tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num / 2; i++)
+		betree_delete(&bet, &dat[i]);
+	printf("Deleted done, estimated time(s): %.3f\n", elapsed(&start));
+
+	printf("Begin deletes them from the B+ tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num / 2; i++)
+		btree_delete(&bt, &dat[i]);
+	printf("Deleted done, estimated time(s): %.3f\n", elapsed(&start));
+	printf("\n");
+
+	lo = dat[num - 1] < 0 ? dat[num - 1] : -dat[num - 1];
+	hi = -lo;
+	printf("Begin range query [%ld, %ld].\n", lo, hi);
+	timespec_get(&start, TIME_UTC);
+	betree_range_query(&bet, &lo, &hi, &keys);
+	printf("B-epsilon tree keys: %lu, estimated time(s): %.3f\n", 
+		SLIST_LENGTH(&keys), elapsed(&start));
+	ecnt = SLIST_LENGTH(&keys);
+	slist_clear(&keys);
+	timespec_get(&start, TIME_UTC);
+	btree_range_query(&bt, &lo, &hi, &keys);
+	printf("B+ tree keys: %lu, estimated time(s): %.3f\n", 
+		SLIST_LENGTH(&keys), elapsed(&start));
+	if (ecnt != SLIST_LENGTH(&keys))
+		printf("The range queries are different.\n");
+	slist_clear(&keys);
+
+	betree_clear(&bet);
+	btree_clear(&bt);
+	ALGFREE(dat);
+
+	return 0;
+}
+
+static double
+elapsed(const struct timespec *start)
+{
+	struct timespec end;
+
+	timespec_get(&end, TIME_UTC);
+	return (double)(end.tv_sec - start->tv_sec) +
+		(double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -n -p\n", pname);
+	fprintf(stderr, "-n: The number of random keys.\n");
+	fprintf(stderr, "-p: The page size, 0 for the default.\n");
+	exit(EXIT_FAILURE);
+}
+
+static int
+kcmp(const void *key1, const void *key2)
+{
+	long a = *(const long *)key1, b = *(const long *)key2;
+
+	return a < b ? 1 : (a == b ? 0 : -1);
+}
+
+/* The upsert of a counter: adds the delta to the value. */
+static void
+add_count(void *val, const void *delta, int found)
+{
+	if (!found)
+		*(long *)val = 0;
+	*(long *)val += *(const long *)delta;
+}
@@ -0,0 +1,782 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "betree.h"
+#include "singlelist.h"
+
+/* the kinds of messages */
+#define MSG_PUT		0
+#define MSG_DELETE	1
+#define MSG_UPSERT	2
+
+/* 
+ * the key, the value and the kind of message I in the buffer M, 
+ * the value is aligned for the upsert function to read it in place
+ */
+#define MSG_VALOFF(bt)		ALIGN_PTR((size_t)(bt)->keysize)
+#define MSG_KEY(bt, m, i)	((m) + (size_t)(i) * (bt)->msgsize)
+#define MSG_VALUE(bt, m, i)	(MSG_KEY(bt, m, i) + MSG_VALOFF(bt))
+#define MSG_TYPE(bt, m, i)	\
+	(MSG_KEY(bt, m, i)[MSG_VALOFF(bt) + (bt)->valsize])
+
+/* the address of key/value I in node X */
+#define KEY(bt, x, i)		((x)->keys + (size_t)(i) * (bt)->keysize)
+#define VALUE(bt, x, i)		((x)->vals + (size_t)(i) * (bt)->valsize)
+
+/* rounds up N to the alignment of a pointer */
+#define ALIGN_PTR(n)	\
+	(((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* a growing array of keys collected by a range query */
+struct key_vector {
+	unsigned char *keys;
+	unsigned long n;
+	unsigned long cap;
+};
+
+static struct betree_node * make_node(const struct betree *, int);
+static void reserve_keys(const struct betree *, struct betree_node *,
+	unsigned int);
+static void reserve_msgs(const struct betree *, struct betree_node *,
+	unsigned int);
+static inline int oversize(const struct betree *, const struct betree_node *);
+static inline unsigned int get_entry_index(const struct betree *,
+	const struct betree_node *, const void *);
+static inline unsigned int get_child_index(const struct betree *,
+	const struct betree_node *, const void *);
+static inline unsigned int get_msg_index(const struct betree *,
+	const struct betree_node *, const void *, int);
+static void send(struct betree *, int, const void *, const void *);
+static void apply(struct betree *, struct betree_node *, 
+	const unsigned char *, unsigned int);
+static void add_message(struct betree *, struct betree_node *,
+	const unsigned char *);
+static void merge_messages(struct betree *, struct betree_node *,
+	const unsigned char *, unsigned int);
+static void apply_leaf(struct betree *, struct betree_node *,
+	const unsigned char *, unsigned int);
+static void flush_child(struct betree *, struct betree_node *);
+static void split_child(struct betree *, struct betree_node *, 
+	unsigned int);
+static int get_value(const struct betree *, const struct betree_node *,
+	const void *, void *);
+static void range_node(const struct betree *, const struct betree_node *,
+	const void *, const void *, struct key_vector *);
+static void push_key(const struct betree *, struct key_vector *,
+	const void *);
+static void release(struct betree_node *);
+
+/* 
+ * Initializes an empty B-epsilon tree whose nodes are PGSZ bytes. 
+ * An internal node takes about the square root of the fanout a page 
+ * could hold, the rest of the page is its message buffer.
+ */
+void
+betree_init(struct betree *bt, unsigned int pgsz, unsigned int ksz,
+	unsigned int vsz, algcomp_ft *cmp, betree_upsert_ft *upsert)
+{
+	size_t fan, piv, room;
+
+	assert(ksz != 0 && vsz != 0);
+
+	if (pgsz == 0)
+		pgsz = BETREE_PAGE_SIZE;
+
+	bt->leafcap = pgsz / (ksz + vsz);
+	if (bt->leafcap < 4)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys and %u bytes values.\n", pgsz, ksz, vsz);
+
+	/* epsilon 1/2: the square root of the fanout of a B+ tree */
+	fan = pgsz / (ksz + sizeof(void *));
+	for (piv = 1; (piv + 1) * (piv + 1) <= fan; piv++)
+		;
+	if (piv < 3)
+		piv = 3;
+	bt->innercap = piv;
+
+	bt->msgsize = ALIGN_PTR(ALIGN_PTR(ksz) + vsz + 1);
+	room = (piv + 1) * sizeof(void *) + piv * ksz;
+	if (pgsz < room + 4 * bt->msgsize)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"messages.\n", pgsz, bt->msgsize);
+	bt->bufcap = (pgsz - room) / bt->msgsize;
+
+	bt->pagesize = pgsz;
+	bt->keysize = ksz;
+	bt->valsize = vsz;
+	bt->cmp = cmp;
+	bt->upsert = upsert;
+	bt->height = 0;
+	bt->leafwrites = 0;
+	bt->scratch = (unsigned char *)algcalloc(1, bt->msgsize);
+	bt->mspcap = 2 * bt->bufcap;
+	bt->mspare = (unsigned char *)algmalloc((size_t)bt->mspcap * 
+		bt->msgsize);
+	bt->root = make_node(bt, 1);
+}
+
+/* Inserts the key-value pair as a message to the root. */
+void
+betree_put(struct betree *bt, const void *key, const void *val)
+{
+	if (key == NULL || val == NULL)
+		errmsg_exit("calls betree_put() with null argument.\n");
+	send(bt, MSG_PUT, key, val);
+}
+
+/* 
+ * Deletes the key-value pair as a message to the root, 
+ * it does not look for the key.
+ */
+void
+betree_delete(struct betree *bt, const void *key)
+{
+	if (key == NULL)
+		errmsg_exit("calls betree_delete() with null argument.\n");
+	send(bt, MSG_DELETE, key, NULL);
+}
+
+/* 
+ * Combines DELTA into the value of the key as a message to the root,
+ * the old value is not read until the message reaches the leaf 
+ * or a query.
+ */
+void
+betree_upsert(struct betree *bt, const void *key, const void *delta)
+{
+	if (key == NULL || delta == NULL)
+		errmsg_exit("calls betree_upsert() with null argument.\n");
+	if (bt->upsert == NULL)
+		errmsg_exit("The B-epsilon tree has no upsert function.\n");
+	send(bt, MSG_UPSERT, key, delta);
+}
+
+/* 
+ * Copies the value associated with the given key into VAL. 
+ * The messages for the key met on the way down are newer than 
+ * the ones below, a put or a delete ends the search.
+ */
+int
+betree_get(const struct betree *bt, const void *key, void *val)
+{
+	if (key == NULL)
+		errmsg_exit("calls betree_get() with null argument.\n");
+	return get_value(bt, bt->root, key, val);
+}
+
+/* 
+ * Copies the keys between lokey and hikey into KEYS. The keys of 
+ * the subtrees are merged with the buffered messages level by level
+ * from the leaves up, so a scan reads the leaves in order once.
+ */
+void
+betree_range_query(const struct betree *bt, const void *lokey, 
+	const void *hikey, struct single_list *keys)
+{
+	struct key_vector vec;
+	unsigned long i;
+
+	if (lokey == NULL || hikey == NULL)
+		errmsg_exit("calls betree_range_query() with null argument.\n");
+
+	slist_init(keys, bt->keysize, bt->cmp);
+	vec.n = 0;
+	vec.cap = 64;
+	vec.keys = (unsigned char *)algmalloc(vec.cap * bt->keysize);
+	range_node(bt, bt->root, lokey, hikey, &vec);
+	for (i = 0; i < vec.n; i++)
+		slist_append(keys, vec.keys + i * bt->keysize);
+	ALGFREE(vec.keys);
+}
+
+/* Clears this B-epsilon tree */
+void
+betree_clear(struct betree *bt)
+{
+	if (bt->root == NULL)
+		return;
+
+	release(bt->root);
+	ALGFREE(bt->scratch);
+	ALGFREE(bt->mspare);
+	bt->root = NULL;
+	bt->height = 0;
+	bt->mspcap = 0;
+	bt->leafwrites = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* Allocates an empty node with the room of one page. */
+static struct betree_node *
+make_node(const struct betree *bt, int leaf)
+{
+	struct betree_node *x;
+
+	x = (struct betree_node *)algmalloc(sizeof(struct betree_node));
+	x->sz = 0;
+	x->nmsgs = 0;
+	x->leaf = leaf;
+	x->prev = NULL;
+	x->sibling = NULL;
+	if (leaf) {
+		x->cap = bt->leafcap + 1;
+		x->keys = (unsigned char *)algmalloc((size_t)x->cap * 
+			bt->keysize);
+		x->vals = (unsigned char *)algmalloc((size_t)x->cap * 
+			bt->valsize);
+		x->children = NULL;
+		x->mcap = 0;
+		x->msgs = NULL;
+	} else {
+		x->cap = bt->innercap + 1;
+		x->keys = (unsigned char *)algmalloc((size_t)x->cap * 
+			bt->keysize);
+		x->vals = NULL;
+		x->children = (struct betree_node **)algmalloc(
+			(size_t)(x->cap + 1) * sizeof(struct betree_node *));
+		x->mcap = bt->bufcap + 1;
+		x->msgs = (unsigned char *)algmalloc((size_t)x->mcap * 
+			bt->msgsize);
+	}
+	return x;
+}
+
+/* Makes room for N keys or pivots in the node. */
+static void
+reserve_keys(const struct betree *bt, struct betree_node *x, unsigned int n)
+{
+	if (n <= x->cap)
+		return;
+
+	x->cap = n > 2 * x->cap ? n : 2 * x->cap;
+	x->keys = (unsigned char *)algrealloc(x->keys, (size_t)x->cap * 
+		bt->keysize);
+	if (x->leaf)
+		x->vals = (unsigned char *)algrealloc(x->vals, 
+			(size_t)x->cap * bt->valsize);
+	else
+		x->children = (struct betree_node **)algrealloc(x->children,
+			(size_t)(x->cap + 1) * sizeof(struct betree_node *));
+}
+
+/* Makes room for N messages in the internal node. */
+static void
+reserve_msgs(const struct betree *bt, struct betree_node *x, unsigned int n)
+{
+	if (n <= x->mcap)
+		return;
+
+	x->mcap = n > 2 * x->mcap ? n : 2 * x->mcap;
+	x->msgs = (unsigned char *)algrealloc(x->msgs, (size_t)x->mcap * 
+		bt->msgsize);
+}
+
+/* Has the node more keys or pivots than a page holds ? */
+static inline int
+oversize(const struct betree *bt, const struct betree_node *x)
+{
+	return x->sz > (x->leaf ? bt->leafcap : bt->innercap);
+}
+
+/* Returns the index of the first key not less than KEY in the leaf. */
+static inline unsigned int
+get_entry_index(const struct betree *bt, const struct betree_node *x,
+	const void *key)
+{
+	unsigned int lo = 0, hi = x->sz, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (bt->cmp(KEY(bt, x, mid), key) == 1)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* 
+ * Returns the index of the child holding KEY in the internal node,
+ * a key equal to a pivot goes right.
+ */
+static inline unsigned int
+get_child_index(const struct betree *bt, const struct betree_node *x,
+	const void *key)
+{
+	unsigned int lo = 0, hi = x->sz, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (bt->cmp(key, KEY(bt, x, mid)) == 1)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return lo;
+}
+
+/* 
+ * Returns the index of the first message not less than KEY, 
+ * or greater than KEY if UPPER is true.
+ */
+static inline unsigned int
+get_msg_index(const struct betree *bt, const struct betree_node *x,
+	const void *key, int upper)
+{
+	unsigned int lo = 0, hi = x->nmsgs, mid;
+	int c;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		c = bt->cmp(MSG_KEY(bt, x->msgs, mid), key);
+		if (c == 1 || (upper && c == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* 
+ * Sends a message to the root, the root is split into as many 
+ * nodes as needed under a new root if it overflows.
+ */
+static void
+send(struct betree *bt, int type, const void *key, const void *val)
+{
+	struct betree_node *root;
+
+	memcpy(MSG_KEY(bt, bt->scratch, 0), key, bt->keysize);
+	if (val != NULL)
+		memcpy(MSG_VALUE(bt, bt->scratch, 0), val, bt->valsize);
+	MSG_TYPE(bt, bt->scratch, 0) = (unsigned char)type;
+
+	apply(bt, bt->root, bt->scratch, 1);
+	while (oversize(bt, bt->root)) {
+		root = make_node(bt, 0);
+		root->children[0] = bt->root;
+		bt->root = root;
+		bt->height++;
+		split_child(bt, root, 0);
+	}
+}
+
+/* 
+ * Applies N sorted messages to the node. A leaf takes them at once,
+ * an internal node buffers them and flushes its busiest child while
+ * the buffer is over full.
+ */
+static void
+apply(struct betree *bt, struct betree_node *x, const unsigned char *msgs,
+	unsigned int n)
+{
+	if (x->leaf) {
+		apply_leaf(bt, x, msgs, n);
+		bt->leafwrites++;
+		return;
+	}
+
+	if (n == 1)
+		add_message(bt, x, msgs);
+	else
+		merge_messages(bt, x, msgs, n);
+	while (x->nmsgs > bt->bufcap)
+		flush_child(bt, x);
+}
+
+/* 
+ * Adds one message after the older ones of the same key,
+ * a put or a delete drops them.
+ */
+static void
+add_message(struct betree *bt, struct betree_node *x, const unsigned char *m)
+{
+	unsigned int i, j;
+
+	i = get_msg_index(bt, x, m, 1);
+	if (MSG_TYPE(bt, m, 0) != MSG_UPSERT) {
+		j = get_msg_index(bt, x, m, 0);
+		memmove(MSG_KEY(bt, x->msgs, j), MSG_KEY(bt, x->msgs, i),
+			(size_t)(x->nmsgs - i) * bt->msgsize);
+		x->nmsgs -= i - j;
+		i = j;
+	}
+
+	reserve_msgs(bt, x, x->nmsgs + 1);
+	memmove(MSG_KEY(bt, x->msgs, i + 1), MSG_KEY(bt, x->msgs, i),
+		(size_t)(x->nmsgs - i) * bt->msgsize);
+	memcpy(MSG_KEY(bt, x->msgs, i), m, bt->msgsize);
+	x->nmsgs++;
+}
+
+/* 
+ * Merges a batch of newer messages into the buffer of the node by
+ * way of the spare buffer, which then swaps with the node's.
+ */
+static void
+merge_messages(struct betree *bt, struct betree_node *x, 
+	const unsigned char *msgs, unsigned int n)
+{
+	unsigned char *out;
+	unsigned int i = 0, j = 0, k = 0, cap;
+
+	if (bt->mspcap < x->nmsgs + n) {
+		bt->mspcap = x->nmsgs + n;
+		bt->mspare = (unsigned char *)algrealloc(bt->mspare,
+			(size_t)bt->mspcap * bt->msgsize);
+	}
+
+	out = bt->mspare;
+	while (i < x->nmsgs || j < n) {
+		if (j == n || (i < x->nmsgs && bt->cmp(MSG_KEY(bt, x->msgs, 
+			i), MSG_KEY(bt, msgs, j)) != -1)) {
+			memcpy(MSG_KEY(bt, out, k++), MSG_KEY(bt, x->msgs, i++),
+				bt->msgsize);
+			continue;
+		}
+
+		/* a put or a delete makes the older messages useless */
+		if (MSG_TYPE(bt, msgs, j) != MSG_UPSERT) {
+			while (k > 0 && bt->cmp(MSG_KEY(bt, out, k - 1), 
+				MSG_KEY(bt, msgs, j)) == 0)
+				k--;
+		}
+		memcpy(MSG_KEY(bt, out, k++), MSG_KEY(bt, msgs, j++), 
+			bt->msgsize);
+	}
+
+	bt->mspare = x->msgs;
+	x->msgs = out;
+	cap = x->mcap;
+	x->mcap = bt->mspcap;
+	bt->mspcap = cap;
+	x->nmsgs = k;
+}
+
+/* 
+ * Applies the sorted messages to the leaf, the pairs and the 
+ * messages are merged into new arrays in one pass.
+ */
+static void
+apply_leaf(struct betree *bt, struct betree_node *x, 
+	const unsigned char *msgs, unsigned int n)
+{
+	unsigned char *keys, *vals, *val;
+	const unsigned char *key;
+	unsigned int i = 0, j = 0, k = 0, cap;
+	int found;
+
+	cap = x->sz + n > bt->leafcap + 1 ? x->sz + n : bt->leafcap + 1;
+	keys = (unsigned char *)algmalloc((size_t)cap * bt->keysize);
+	vals = (unsigned char *)algmalloc((size_t)cap * bt->valsize);
+
+	while (i < x->sz || j < n) {
+		if (j == n || (i < x->sz && bt->cmp(KEY(bt, x, i), 
+			MSG_KEY(bt, msgs, j)) == 1)) {
+			memcpy(keys + (size_t)k * bt->keysize, KEY(bt, x, i),
+				bt->keysize);
+			memcpy(vals + (size_t)k * bt->valsize, VALUE(bt, x, i),
+				bt->valsize);
+			i++;
+			k++;
+			continue;
+		}
+
+		key = MSG_KEY(bt, msgs, j);
+		val = vals + (size_t)k * bt->valsize;
+		found = 0;
+		if (i < x->sz && bt->cmp(KEY(bt, x, i), key) == 0) {
+			memcpy(val, VALUE(bt, x, i++), bt->valsize);
+			found = 1;
+		}
+
+		for (; j < n && bt->cmp(MSG_KEY(bt, msgs, j), key) == 0; j++) {
+			switch (MSG_TYPE(bt, msgs, j)) {
+			case MSG_PUT:
+				memcpy(val, MSG_VALUE(bt, msgs, j), 
+					bt->valsize);
+				found = 1;
+				break;
+			case MSG_DELETE:
+				found = 0;
+				break;
+			default:
+				bt->upsert(val, MSG_VALUE(bt, msgs, j), found);
+				found = 1;
+			}
+		}
+
+		if (found)
+			memcpy(keys + (size_t)k++ * bt->keysize, key, 
+				bt->keysize);
+	}
+
+	ALGFREE(x->keys);
+	ALGFREE(x->vals);
+	x->keys = keys;
+	x->vals = vals;
+	x->cap = cap;
+	x->sz = k;
+}
+
+/* 
+ * Flushes the messages of the child with the most of them down in
+ * one batch, then splits the child if it overflows.
+ */
+static void
+flush_child(struct betree *bt, struct betree_node *x)
+{
+	unsigned int c, lo = 0, end, best = 0, blo = 0, bhi = 0;
+
+	for (c = 0; c <= x->sz; c++) {
+		end = c < x->sz ? get_msg_index(bt, x, KEY(bt, x, c), 0) :
+			x->nmsgs;
+		if (end - lo > bhi - blo) {
+			best = c;
+			blo = lo;
+			bhi = end;
+		}
+		lo = end;
+	}
+
+	apply(bt, x->children[best], MSG_KEY(bt, x->msgs, blo), bhi - blo);
+	memmove(MSG_KEY(bt, x->msgs, blo), MSG_KEY(bt, x->msgs, bhi),
+		(size_t)(x->nmsgs - bhi) * bt->msgsize);
+	x->nmsgs -= bhi - blo;
+
+	if (oversize(bt, x->children[best]))
+		split_child(bt, x, best);
+}
+
+/* 
+ * Splits the overflowing child J of X evenly into as few nodes as 
+ * fit in a page each. The first key of a new leaf is copied up, 
+ * the pivot between two internal pieces is moved up, with the 
+ * messages of each piece following its pivots.
+ */
+static void
+split_child(struct betree *bt, struct betree_node *x, unsigned int j)
+{
+	struct betree_node *c, *t, *last;
+	unsigned int k, p, b, e, n, mlo, mhi;
+
+	c = x->children[j];
+	if (c->leaf) {
+		n = c->sz;
+		k = (n + bt->leafcap - 1) / bt->leafcap;
+	} else {
+		n = c->sz + 1;
+		k = (n + bt->innercap) / (bt->innercap + 1);
+	}
+
+	reserve_keys(bt, x, x->sz + k - 1);
+	memmove(KEY(bt, x, j + k - 1), KEY(bt, x, j),
+		(size_t)(x->sz - j) * bt->keysize);
+	memmove(x->children + j + k, x->children + j + 1,
+		(size_t)(x->sz - j) * sizeof(struct betree_node *));
+
+	last = c;
+	for (p = 1; p < k; p++) {
+		b = (unsigned int)((unsigned long)p * n / k);
+		e = (unsigned int)((unsigned long)(p + 1) * n / k);
+		t = make_node(bt, c->leaf);
+		if (c->leaf) {
+			t->sz = e - b;
+			memcpy(t->keys, KEY(bt, c, b), 
+				(size_t)t->sz * bt->keysize);
+			memcpy(t->vals, VALUE(bt, c, b), 
+				(size_t)t->sz * bt->valsize);
+			memcpy(KEY(bt, x, j + p - 1), KEY(bt, c, b), 
+				bt->keysize);
+
+			t->prev = last;
+			t->sibling = last->sibling;
+			if (last->sibling != NULL)
+				last->sibling->prev = t;
+			last->sibling = t;
+			last = t;
+		} else {
+			t->sz = e - b - 1;
+			memcpy(t->keys, KEY(bt, c, b), 
+				(size_t)t->sz * bt->keysize);
+			memcpy(t->children, c->children + b,
+				(size_t)(e - b) * sizeof(struct betree_node *));
+			memcpy(KEY(bt, x, j + p - 1), KEY(bt, c, b - 1), 
+				bt->keysize);
+
+			mlo = get_msg_index(bt, c, KEY(bt, c, b - 1), 0);
+			mhi = e < n ? get_msg_index(bt, c, KEY(bt, c, e - 1), 0) :
+				c->nmsgs;
+			reserve_msgs(bt, t, mhi - mlo);
+			memcpy(t->msgs, MSG_KEY(bt, c->msgs, mlo),
+				(size_t)(mhi - mlo) * bt->msgsize);
+			t->nmsgs = mhi - mlo;
+		}
+		x->children[j + p] = t;
+	}
+
+	/* the first piece stays in C */
+	e = n / k;
+	if (c->leaf) {
+		c->sz = e;
+	} else {
+		c->nmsgs = get_msg_index(bt, c, KEY(bt, c, e - 1), 0);
+		c->sz = e - 1;
+	}
+	x->sz += k - 1;
+}
+
+/* 
+ * Looks up the key in the subtree rooted at X, the newest message 
+ * for the key decides, the upserts after a put or a delete are 
+ * combined into it in their order.
+ */
+static int
+get_value(const struct betree *bt, const struct betree_node *x, 
+	const void *key, void *val)
+{
+	unsigned int i, lo, hi;
+	int found;
+
+	if (x->leaf) {
+		i = get_entry_index(bt, x, key);
+		if (i < x->sz && bt->cmp(key, KEY(bt, x, i)) == 0) {
+			memcpy(val, VALUE(bt, x, i), bt->valsize);
+			return 1;
+		}
+		return 0;
+	}
+
+	lo = get_msg_index(bt, x, key, 0);
+	hi = lo;
+	while (hi < x->nmsgs && bt->cmp(MSG_KEY(bt, x->msgs, hi), key) == 0)
+		hi++;
+
+	if (lo < hi && MSG_TYPE(bt, x->msgs, lo) != MSG_UPSERT) {
+		found = MSG_TYPE(bt, x->msgs, lo) == MSG_PUT;
+		if (found)
+			memcpy(val, MSG_VALUE(bt, x->msgs, lo), bt->valsize);
+		lo++;
+	} else {
+		found = get_value(bt, x->children[get_child_index(bt, x, 
+			key)], key, val);
+	}
+
+	for (; lo < hi; lo++) {
+		bt->upsert(val, MSG_VALUE(bt, x->msgs, lo), found);
+		found = 1;
+	}
+	return found;
+}
+
+/* 
+ * Appends the keys between LO and HI in the subtree rooted at X, 
+ * the keys from the children are merged with the messages of X.
+ */
+static void
+range_node(const struct betree *bt, const struct betree_node *x, 
+	const void *lo, const void *hi, struct key_vector *vec)
+{
+	unsigned char *sub;
+	unsigned long start, i, n;
+	unsigned int c, j, m;
+
+	if (x->leaf) {
+		for (c = get_entry_index(bt, x, lo); c < x->sz && 
+			bt->cmp(hi, KEY(bt, x, c)) != 1; c++)
+			push_key(bt, vec, KEY(bt, x, c));
+		return;
+	}
+
+	start = vec->n;
+	m = get_child_index(bt, x, hi);
+	for (c = get_child_index(bt, x, lo); c <= m; c++)
+		range_node(bt, x->children[c], lo, hi, vec);
+
+	j = get_msg_index(bt, x, lo, 0);
+	m = get_msg_index(bt, x, hi, 1);
+	if (j >= m)
+		return;
+
+	/* merges the keys from below with the messages of this level */
+	n = vec->n - start;
+	sub = (unsigned char *)algmalloc((n + 1) * bt->keysize);
+	memcpy(sub, vec->keys + start * bt->keysize, n * bt->keysize);
+	vec->n = start;
+	i = 0;
+	while (i < n || j < m) {
+		if (j == m || (i < n && bt->cmp(sub + i * bt->keysize, 
+			MSG_KEY(bt, x->msgs, j)) == 1)) {
+			push_key(bt, vec, sub + i++ * bt->keysize);
+			continue;
+		}
+
+		if (i < n && bt->cmp(sub + i * bt->keysize, 
+			MSG_KEY(bt, x->msgs, j)) == 0)
+			i++;
+		while (j + 1 < m && bt->cmp(MSG_KEY(bt, x->msgs, j), 
+			MSG_KEY(bt, x->msgs, j + 1)) == 0)
+			j++;
+		if (MSG_TYPE(bt, x->msgs, j) != MSG_DELETE)
+			push_key(bt, vec, MSG_KEY(bt, x->msgs, j));
+		j++;
+	}
+	ALGFREE(sub);
+}
+
+static void
+push_key(const struct betree *bt, struct key_vector *vec, const void *key)
+{
+	if (vec->n == vec->cap) {
+		vec->cap *= 2;
+		vec->keys = (unsigned char *)algrealloc(vec->keys, 
+			vec->cap * bt->keysize);
+	}
+	memcpy(vec->keys + vec->n++ * bt->keysize, key, bt->keysize);
+}
+
+/* Releases the subtree rooted at X. */
+static void
+release(struct betree_node *x)
+{
+	unsigned int i;
+
+	if (!x->leaf)
+		for (i = 0; i <= x->sz; i++)
+			release(x->children[i]);
+	ALGFREE(x->keys);
+	ALGFREE(x->vals);
+	ALGFREE(x->children);
+	ALGFREE(x->msgs);
+	ALGFREE(x);
+}
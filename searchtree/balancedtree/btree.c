@@ -31,74 +31,102 @@
  */
 #include "btree.h"
 #include "singlelist.h"
-
-#define BT_FREE_NDOE	1
-
-static inline void children_init(struct btree_node *);
-static struct btree_node * split(struct btree_node *);
+#include "bloomfilter.h"
+
+/* the address of key/value I in the leaf node X */
+#define LEAF_KEY(bt, x, i)	\
+	((x)->data + (size_t)(i) * (bt)->keysize)
+#define LEAF_VALUE(bt, x, i)	\
+	((x)->data + (bt)->valoff + (size_t)(i) * (bt)->valsize)
+
+/* the children and the address of key I in the internal node X */
+#define CHILDREN(x)		((struct btree_node **)(x)->data)
+#define INNER_KEY(bt, x, i)	\
+	((x)->data + (bt)->keyoff + (size_t)(i) * (bt)->keysize)
+
+/* rounds up N to the alignment of a pointer */
+#define ALIGN_PTR(n)	\
+	(((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+static inline struct btree_node * make_node(const struct btree *);
+static inline unsigned int get_entry_index(const struct btree *, 
+	const unsigned char *, unsigned int, const void *);
+static inline unsigned int get_child_index(const struct btree *,
+	const struct btree_node *, const void *);
+static struct btree_node * get_start_leaf(const struct btree *, const void *,
+	unsigned int *);
+static struct btree_node * split_leaf(struct btree *, struct btree_node *);
+static struct btree_node * split_inner(struct btree *, struct btree_node *);
 static struct btree_node * insert(struct btree *, struct btree_node *,
-	const void *, const void *, int);
-static void search(const struct btree *, struct btree_node *, const void *,
-	int, void **);
-static struct btree_node * get_start_leaf(const struct btree *, 
-	struct btree_node *, const void *, int);
-static struct btree_node * get_leaf_node(const struct btree *,
-	struct btree_node *, const void *, int);
-
-#if 0
-static struct btree_node * get_internal_node(const struct btree *,
-	struct btree_node *, const void *, int);
-static inline void union_left_entries(struct btree_node *, struct btree_node *);
-#endif
-
-static inline unsigned int get_entry_index(const struct btree *,
-	struct btree_node *, const void *);
-static void query(const struct btree *, const void *, const void *,
-	struct single_list *);
+	const void *, const void *, int, int *);
+static unsigned int fill_count(unsigned int, unsigned int, double);
+static unsigned long plan_nodes(unsigned long, unsigned int, unsigned int,
+	unsigned int, unsigned int *, unsigned int *);
 static void release(struct btree_node *, int);
-static void remove_leaf_entry(const struct btree *, struct btree_node *,
-	const void *);
-static void remove_internal_key(const struct btree *, struct btree_node *,
-	const void *);
-static inline void move_right_entries(struct btree_node *);
-static inline void move_left_entries(struct btree_node *);
-static void borrow_left_leaf(struct btree_node *);
-static void borrow_left_key(unsigned int, struct btree_node *);
-static void borrow_right_leaf(struct btree_node *);
-static void borrow_right_key(unsigned int, struct btree_node *);
-static inline void union_right_entries(struct btree_node *,
-	struct btree_node *);
-static struct btree_node * merge_left_leaf(struct btree_node *,
-	struct btree_node *);
-static struct btree_node * merge_left_internal(unsigned int,
-	struct btree_node *, struct btree_node *);
-static struct btree_node * merge_right_leaf(struct btree_node *,
-	struct btree_node *);
-static struct btree_node * merge_right_internal(unsigned int,
-	struct btree_node *, struct btree_node *);
-static void remove_entry(struct btree *, struct btree_node *, const void *,
-	bool isleaf);
-
-/* Initializes an empty B-tree. */
+static int remove_entry(struct btree *, struct btree_node *, const void *,
+	int);
+static void fix_child(struct btree *, struct btree_node *, unsigned int, int);
+static void borrow_left_leaf(struct btree *, struct btree_node *,
+	unsigned int);
+static void borrow_right_leaf(struct btree *, struct btree_node *,
+	unsigned int);
+static void borrow_left_key(struct btree *, struct btree_node *,
+	unsigned int);
+static void borrow_right_key(struct btree *, struct btree_node *,
+	unsigned int);
+static inline void remove_child(struct btree *, struct btree_node *,
+	unsigned int);
+static void merge_leaf(struct btree *, struct btree_node *, unsigned int);
+static void merge_internal(struct btree *, struct btree_node *, unsigned int);
+
+/* 
+ * Initializes an empty B-tree whose nodes are PGSZ bytes, 
+ * the fanout of the nodes follows the page size and 
+ * the sizes of the key and the value.
+ */
 void
-btree_init(struct btree *bt, unsigned int ksz, unsigned int vsz,
-	algcomp_ft *cmp)
+btree_init(struct btree *bt, unsigned int pgsz, unsigned int ksz, 
+	unsigned int vsz, algcomp_ft *cmp)
 {
-	assert(ksz != 0 && vsz != 0);
+	size_t room, slots;
 
-	/* root is a specific case */
-	bt->root = (struct btree_node *)algmalloc(sizeof(struct btree_node));
-	bt->root->sz = 0;
-	bt->root->prev = NULL;
-	bt->root->sibling = NULL;
-	bt->root->parent = NULL;
-	children_init(bt->root);
+	assert(ksz != 0 && vsz != 0);
 
+	if (pgsz == 0)
+		pgsz = BTREE_PAGE_SIZE;
+	if (pgsz <= sizeof(struct btree_node))
+		errmsg_exit("The page size %u is too small.\n", pgsz);
+	room = pgsz - sizeof(struct btree_node);
+
+	/* a leaf node: keys, then the values at an aligned offset */
+	slots = room / (ksz + vsz);
+	while (slots > 0 && ALIGN_PTR(slots * ksz) + slots * vsz > room)
+		slots--;
+	if (slots < 4)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys and %u bytes values.\n", pgsz, ksz, vsz);
+	bt->leafcap = slots - 1;
+	bt->valoff = ALIGN_PTR(slots * ksz);
+
+	/* an internal node: one more child than keys */
+	slots = (room - sizeof(void *)) / (ksz + sizeof(void *));
+	if (slots < 4)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys.\n", pgsz, ksz);
+	bt->innercap = slots - 1;
+	bt->keyoff = (slots + 1) * sizeof(void *);
+
+	bt->pagesize = pgsz;
 	bt->size = 0;
 	bt->height = 0;
 	bt->keysize = ksz;
 	bt->valsize = vsz;
 	bt->kcmp = cmp;
+	bt->guard = NULL;
+	bt->sepkey = algmalloc(ksz);
+
+	/* root is a specific case */
+	bt->root = make_node(bt);
 }
 
 /* 
@@ -110,68 +138,196 @@ void
 btree_put(struct btree *bt, const void *key, const void *val)
 {
 	struct btree_node *u, *t;
-	unsigned int i;
+	int added = 0;
 
 	if (key == NULL)
 		errmsg_exit("Argumment key to btree_put is null.\n");
 
-	u = insert(bt, bt->root, key, val, bt->height);
-	bt->size++;
+	if (bt->guard != NULL)
+		bloom_add(bt->guard, key);
+
+	u = insert(bt, bt->root, key, val, bt->height, &added);
+	bt->size += added;
 	if (u == NULL)
 		return;
 
-	/* when overflowing a root, need to split root */
-	t = (struct btree_node *)algmalloc(sizeof(struct btree_node));
-	t->sz = 2;
-	t->prev = NULL;
-	t->sibling = NULL;
-	t->parent = NULL;
-	children_init(t);
-
-	for (i = 0; i < 2; i++) {
-		t->children[i] = (struct btree_entry *)
-			algmalloc(sizeof(struct btree_entry));
-		t->children[i]->key = NULL;
-		t->children[i]->value = NULL;
-	}
-	/* left node with smaller items */
-	t->children[0]->key = bt->root->children[0]->key;
-	t->children[0]->next = bt->root;
-	bt->root->parent = t;
-
 	/* 
-	 * right node with larger items,
-	 * move the smallest key in new right node to the root. 
+	 * when overflowing a root, need to split root, 
+	 * the separator key is in bt->sepkey.
 	 */
-	t->children[1]->key = u->children[0]->key;
-	t->children[1]->next = u;
-	u->parent = t;
+	t = make_node(bt);
+	t->sz = 1;
+	CHILDREN(t)[0] = bt->root;
+	CHILDREN(t)[1] = u;
+	memcpy(INNER_KEY(bt, t, 0), bt->sepkey, bt->keysize);
 
 	/* now, node t beomce new root */
 	bt->root = t;
-	bt->root->parent = NULL;
 	bt->height++;
 }
 
+/* 
+ * Builds the B-tree from N key-value pairs in strictly ascending key 
+ * order. The leaves are filled to FILL of their capacity from left to 
+ * right and linked, then each internal level is built over the level 
+ * below it, taking the first key of each subtree as a separator.
+ * The last two nodes of a level share their entries if the last one 
+ * would be less than half full. The B-tree must be empty.
+ */
+void
+btree_bulk_load(struct btree *bt, const void *keys, const void *vals,
+	unsigned long n, double fill)
+{
+	struct btree_node **level, **upper, *x, *prev = NULL;
+	const unsigned char **mins, **upmins;
+	const unsigned char *kp, *vp;
+	unsigned long i, j, k, cnt, m;
+	unsigned int per, pen, last, sz;
+
+	if (!BTREE_ISEMPTY(bt))
+		errmsg_exit("calls btree_bulk_load() with a non-empty "
+			"B-tree.\n");
+	if (fill <= 0.0 || fill > 1.0)
+		errmsg_exit("The fill factor %g is not in (0, 1].\n", fill);
+	if (n == 0)
+		return;
+	if (keys == NULL || vals == NULL)
+		errmsg_exit("calls btree_bulk_load() with null argument.\n");
+
+	kp = (const unsigned char *)keys;
+	vp = (const unsigned char *)vals;
+	for (i = 1; i < n; i++)
+		if (bt->kcmp(kp + (i - 1) * bt->keysize, 
+			kp + i * bt->keysize) != 1)
+			errmsg_exit("The keys are not in strictly ascending "
+				"order at %lu.\n", i);
+
+	/* the leaves */
+	per = fill_count(bt->leafcap, bt->leafcap / 2, fill);
+	cnt = plan_nodes(n, per, bt->leafcap, bt->leafcap / 2, &pen, &last);
+	level = (struct btree_node **)algmalloc(cnt * sizeof(*level));
+	mins = (const unsigned char **)algmalloc(cnt * sizeof(*mins));
+
+	ALGFREE(bt->root);
+	for (i = 0, k = 0; i < cnt; i++, k += sz) {
+		sz = (i + 1 == cnt ? last : (i + 2 == cnt ? pen : per));
+		x = make_node(bt);
+		x->sz = sz;
+		memcpy(LEAF_KEY(bt, x, 0), kp + k * bt->keysize,
+			(size_t)sz * bt->keysize);
+		memcpy(LEAF_VALUE(bt, x, 0), vp + k * bt->valsize,
+			(size_t)sz * bt->valsize);
+		x->prev = prev;
+		if (prev != NULL)
+			prev->sibling = x;
+		prev = x;
+		level[i] = x;
+		mins[i] = LEAF_KEY(bt, x, 0);
+	}
+
+	/* the internal levels, the sizes count the children */
+	for (bt->height = 0; cnt > 1; bt->height++) {
+		per = fill_count(bt->innercap + 1, bt->innercap / 2 + 1, fill);
+		m = cnt;
+		cnt = plan_nodes(m, per, bt->innercap + 1, 
+			bt->innercap / 2 + 1, &pen, &last);
+		upper = (struct btree_node **)algmalloc(cnt * sizeof(*upper));
+		upmins = (const unsigned char **)
+			algmalloc(cnt * sizeof(*upmins));
+
+		for (i = 0, k = 0; i < cnt; i++, k += sz) {
+			sz = (i + 1 == cnt ? last : 
+				(i + 2 == cnt ? pen : per));
+			x = make_node(bt);
+			x->sz = sz - 1;
+			for (j = 0; j < sz; j++) {
+				CHILDREN(x)[j] = level[k + j];
+				if (j > 0)
+					memcpy(INNER_KEY(bt, x, j - 1), 
+						mins[k + j], bt->keysize);
+			}
+			upper[i] = x;
+			upmins[i] = mins[k];
+		}
+
+		ALGFREE(level);
+		ALGFREE(mins);
+		level = upper;
+		mins = upmins;
+	}
+
+	bt->root = level[0];
+	bt->size = n;
+	ALGFREE(level);
+	ALGFREE(mins);
+
+	if (bt->guard != NULL)
+		for (i = 0; i < n; i++)
+			bloom_add(bt->guard, kp + i * bt->keysize);
+}
+
 /* Returns the value associated with the given key. */
 void 
 btree_get(const struct btree *bt, const void *key, void **val)
 {
+	struct btree_node *x;
+	unsigned int i;
+	int ht;
+
 	if (key == NULL)
 		errmsg_exit("Argumment key to btree_get is null.\n");
 
-	search(bt, bt->root, key, bt->height, val);
+	if (bt->guard != NULL && !bloom_contains(bt->guard, key))
+		return;
+
+	for (x = bt->root, ht = bt->height; ht > 0; ht--)
+		x = CHILDREN(x)[get_child_index(bt, x, key)];
+
+	i = get_entry_index(bt, x->data, x->sz, key);
+	if (i < x->sz && bt->kcmp(key, LEAF_KEY(bt, x, i)) == 0)
+		memmove(*val, LEAF_VALUE(bt, x, i), bt->valsize);
+}
+
+/* 
+ * Attaches a Bloom filter as the guard of btree_get(), 
+ * all keys in the B-tree are added into it.
+ * The deleted keys stay in the filter, which only 
+ * makes it less selective. The filter must hash what the 
+ * comparator compares, returns -1 if it has no hash function.
+ */
+int
+btree_set_guard(struct btree *bt, struct bloom_filter *bf)
+{
+	struct btree_node *x;
+	unsigned int i;
+	int ht;
+
+	if (bf != NULL && bf->hash == NULL)
+		return -1;
+
+	bt->guard = bf;
+	if (bf == NULL || BTREE_ISEMPTY(bt))
+		return 0;
+
+	/* walks the leaf linked list from the leftmost leaf */
+	for (x = bt->root, ht = bt->height; ht > 0; ht--)
+		x = CHILDREN(x)[0];
+	for (; x != NULL; x = x->sibling)
+		for (i = 0; i < x->sz; i++)
+			bloom_add(bf, LEAF_KEY(bt, x, i));
+	return 0;
 }
 
 /* Clears this B-Tree */
 void
 btree_clear(struct btree *bt)
 {
-	if (BTREE_ISEMPTY(bt))
+	if (bt->root == NULL)
 		return;
 
 	release(bt->root, bt->height);
-	ALGFREE(bt->root);
+	ALGFREE(bt->sepkey);
+	bt->root = NULL;
 	bt->size = 0;
 	bt->height = 0;
 	bt->keysize = 0;
@@ -179,11 +335,18 @@ btree_clear(struct btree *bt)
 	bt->kcmp = NULL;
 }
 
-/* Output query result that set between lokey and hikey */
+/* 
+ * Output query result that set between lokey and hikey, 
+ * the keys are appended as the pointers into the leaf nodes,
+ * which are valid until the B-Tree is modified.
+ */
 void 
 btree_range_query(const struct btree *bt, const void *lokey, const void *hikey,
 		struct single_list *rec)
 {
+	struct btree_node *leaf;
+	unsigned int i;
+
 	if (lokey == NULL || hikey == NULL)
 		errmsg_exit("Argumment key to btree_range_query is null.\n");
 
@@ -191,21 +354,38 @@ btree_range_query(const struct btree *bt, const void *lokey, const void *hikey,
 
 	if (BTREE_ISEMPTY(bt))
 		return;
-	query(bt, lokey, hikey, rec);
+
+	for (leaf = get_start_leaf(bt, lokey, &i); leaf != NULL; 
+		leaf = leaf->sibling, i = 0) {
+		for (; i < leaf->sz; i++) {
+			if (bt->kcmp(hikey, LEAF_KEY(bt, leaf, i)) == 1)
+				return;
+			slist_append(rec, LEAF_KEY(bt, leaf, i));
+		}
+	}
 }
 
 /* Deletes a key-value pair from this B-Tree */
 int
 btree_delete(struct btree *bt, const void *key)
 {
-	struct btree_node *leaf;
+	struct btree_node *oldroot;
 
-	if ((leaf = get_leaf_node(bt, bt->root, key, bt->height)) == NULL)
+	if (key == NULL || BTREE_ISEMPTY(bt))
 		return 0;
 
-	remove_entry(bt, leaf, key, true);
+	if (!remove_entry(bt, bt->root, key, bt->height))
+		return 0;
 	bt->size--;
 
+	/* the root with one child is replaced by the child */
+	if (bt->height > 0 && bt->root->sz == 0) {
+		oldroot = bt->root;
+		bt->root = CHILDREN(oldroot)[0];
+		bt->height--;
+		ALGFREE(oldroot);
+	}
+
 	return 1;
 }
 
@@ -214,16 +394,15 @@ void *
 btree_first_key(const struct btree *bt)
 {
 	struct btree_node *first;
+	int ht;
 
 	if (BTREE_ISEMPTY(bt))
 		return NULL;
 
-	if ((first = bt->root->children[0]->next) == NULL)
-		return bt->root->children[0]->key;
-	while (first->children[0]->next != NULL)
-		first = first->children[0]->next;
+	for (first = bt->root, ht = bt->height; ht > 0; ht--)
+		first = CHILDREN(first)[0];
 	
-	return first->children[0]->key;
+	return LEAF_KEY(bt, first, 0);
 }
 
 /* Returns the last key in this B-Tree. */
@@ -231,764 +410,583 @@ void *
 btree_last_key(const struct btree *bt)
 {
 	struct btree_node *last;
+	int ht;
 
 	if (BTREE_ISEMPTY(bt))
 		return NULL;
 
-	if ((last = bt->root->children[bt->root->sz - 1]->next) == NULL)
-		return bt->root->children[bt->root->sz - 1]->key;
-	while (last->children[last->sz - 1]->next != NULL)
-		last = last->children[last->sz - 1]->next;
+	for (last = bt->root, ht = bt->height; ht > 0; ht--)
+		last = CHILDREN(last)[last->sz];
 
-	return last->children[last->sz - 1]->key;
+	return LEAF_KEY(bt, last, last->sz - 1);
 }
 
-/******************** static function boundary ********************/
-
-/* initializes an children of node */
-static inline void 
-children_init(struct btree_node *h)
+/* Initializes a cursor over the B-tree, it is not on any key. */
+void
+btree_cursor_init(struct btree_cursor *c, const struct btree *bt)
 {
-	unsigned int i;
-	for (i = 0; i < MAX_CHILDREN; i++)
-		h->children[i] = NULL;
+	c->bt = bt;
+	c->leaf = NULL;
+	c->idx = 0;
 }
 
-/* split node in half */
-static struct btree_node * 
-split(struct btree_node *h)
+/* 
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL.
+ */
+void
+btree_cursor_seek(struct btree_cursor *c, const void *key)
 {
-	struct btree_node *t;
-	int i;
+	struct btree_node *x;
+	int ht;
 
-	t = (struct btree_node *)algmalloc(sizeof(struct btree_node));
-	t->prev = NULL;
-	t->sibling = NULL;
-	t->parent = NULL;
-	children_init(t);
-	t->sz = MAX_CHILDREN / 2;
-	h->sz = MAX_CHILDREN / 2;
+	c->leaf = NULL;
+	c->idx = 0;
+	if (BTREE_ISEMPTY(c->bt))
+		return;
 
-	/*
-	 * Original node with smaller items,
-	 * New node with larger items.
-	 */
-	for (i = 0; i < MAX_CHILDREN / 2; i++) {
-		t->children[i] = h->children[MAX_CHILDREN / 2 + i];
-		if (h->children[MAX_CHILDREN / 2 + i]->next != NULL)
-			h->children[MAX_CHILDREN / 2 + i]->next->parent = t;
-		h->children[MAX_CHILDREN / 2 + i] = NULL;
+	if (key != NULL) {
+		c->leaf = get_start_leaf(c->bt, key, &c->idx);
+		return;
 	}
 
-	t->parent = h->parent;
-	t->sibling = h->sibling;
-	if (h->sibling != NULL)
-		h->sibling->prev = t;
-	h->sibling = t;
-	t->prev = h;
+	for (x = c->bt->root, ht = c->bt->height; ht > 0; ht--)
+		x = CHILDREN(x)[0];
+	c->leaf = x;
+}
 
-	return t;
+/* Moves the cursor to the largest key. */
+void
+btree_cursor_last(struct btree_cursor *c)
+{
+	struct btree_node *x;
+	int ht;
+
+	c->leaf = NULL;
+	c->idx = 0;
+	if (BTREE_ISEMPTY(c->bt))
+		return;
+
+	for (x = c->bt->root, ht = c->bt->height; ht > 0; ht--)
+		x = CHILDREN(x)[x->sz];
+	c->leaf = x;
+	c->idx = x->sz - 1;
 }
 
 /* 
- * Inserts the key-value pair into the subtree rooted at h.
+ * Moves the cursor to the next key along the sibling links,
+ * returns 0 if there is no next key.
  */
-static struct btree_node *
-insert(struct btree *bt, struct btree_node *h, const void *key,
-		const void *val, int ht)
+int
+btree_cursor_next(struct btree_cursor *c)
 {
-	unsigned int i, j;
-	struct btree_entry *t = NULL;
-	struct btree_node *u = NULL;
-
-	if (ht == 0) { /* external node */
-		t = (struct btree_entry *)algmalloc(sizeof(struct btree_entry));
-		t->key = algmalloc(bt->keysize);
-		t->value = algmalloc(bt->valsize);
-		t->next = NULL;
-		memmove(t->key, key, bt->keysize);
-		memmove(t->value, val, bt->valsize);
-
-		for (i = 0; i < h->sz; i++)
-			if (bt->kcmp(key, h->children[i]->key) == 1)
-				break;
-	} else { /* internal node */
-		for (i = 0; i < h->sz; i++)
-			if (i + 1 == h->sz || (i + 1 < h->sz && 
-				bt->kcmp(key, h->children[i + 1]->key) == 1)) {
-				if ((u = insert(bt, h->children[i++]->next, key,
-					val, ht - 1)) == NULL) {
-					return NULL;
-				}
-
-				/* 
-				 * if a node had splited,
-				 * attach the new node to its parent.
-				 */
-				t = (struct btree_entry *)
-					algmalloc(sizeof(struct btree_entry));
-
-				/*
-				 * move the smallest key to parent in
-				 * sorted order.
-				 */
-				t->key = u->children[0]->key;
-				t->value = NULL;
-				t->next = u;
-
-				break;
-			}
-	}
-
-	/* 
-	 * overwriting the old value with the new value 
-	 * if the B-Tree already contains the specified key. 
-	 */
-	if (i != 0 && h->children[i - 1] != NULL &&
-	   h->children[i - 1]->next == NULL && 
-	   bt->kcmp(key, h->children[i - 1]->key) == 0) {
-		memcpy(h->children[i - 1]->value, val, bt->valsize);
-		ALGFREE(t);
-		bt->size--;
-		return NULL;
-	} else { 
-		/* 
-		 * move the elements of children array
-		 * and inserts a new entry.
-		 */
-		for (j = h->sz; j > i; j--)
-			h->children[j] = h->children[j - 1];
-		h->children[i] = t;
-		h->sz++;
+	if (c->leaf == NULL)
+		return 0;
 
-		if (u != NULL)
-			u->parent = h;
+	if (++c->idx == c->leaf->sz) {
+		c->leaf = c->leaf->sibling;
+		c->idx = 0;
 	}
-	
-	if (h->sz < MAX_CHILDREN)
-		return NULL;
-	else
-		return split(h);
+	return c->leaf != NULL;
 }
 
 /* 
- * Returns the value associated with the given key from 
- * the subtree rooted at x.
+ * Moves the cursor to the previous key along the prev links,
+ * returns 0 if there is no previous key.
  */
-static void 
-search(const struct btree *bt, struct btree_node *x, const void *key, int ht,
-	void **val)
+int
+btree_cursor_prev(struct btree_cursor *c)
 {
-	unsigned int i;
+	if (c->leaf == NULL)
+		return 0;
 
-	if (ht == 0) {
-		for (i = 0; i < x->sz; i++)
-			if (bt->kcmp(key, x->children[i]->key) == 0) {
-				memmove(*val, x->children[i]->value,
-					bt->valsize);
-				return; 
-			}
-	} else {
-		for (i = 0; i < x->sz; i++)
-			if (i + 1 == x->sz || (i + 1 < x->sz && 
-			   bt->kcmp(key, x->children[i + 1]->key) == 1)) {
-				search(bt, x->children[i]->next, key, ht - 1,
-					val);
-			}
+	if (c->idx == 0) {
+		if ((c->leaf = c->leaf->prev) == NULL)
+			return 0;
+		c->idx = c->leaf->sz;
 	}
+	c->idx--;
+	return 1;
 }
 
-/* returns a starting leaf node in the leaf linked list */
-static struct btree_node * 
-get_start_leaf(const struct btree *bt, struct btree_node *x, const void *key,
-			int ht)
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void *
+btree_cursor_key(const struct btree_cursor *c)
 {
-	unsigned int i;
-
-	if (x == NULL)
+	if (c->leaf == NULL)
 		return NULL;
-
-	if (ht == 0) {
-		for (i = 0; i < x->sz; i++)
-			if (bt->kcmp(key, x->children[i]->key) == 0 ||
-			   bt->kcmp(key, x->children[i]->key) == 1) {
-				return x;
-			}
-
-		if (x->sibling == NULL)
-			return NULL;
-		else 
-			return get_start_leaf(bt, x->sibling, key, 0);
-	} else {
-		for (i = 0; i < x->sz; i++)
-			if (i + 1 == x->sz || (i + 1 < x->sz &&
-			   bt->kcmp(key, x->children[i + 1]->key) == 1)) {
-				return get_start_leaf(bt, x->children[i]->next,
-					key, ht - 1);
-			}
-	}
-
-	return NULL;
+	return LEAF_KEY(c->bt, c->leaf, c->idx);
 }
 
-/* returns the leaf node in this B-Tree. */
-static struct btree_node * 
-get_leaf_node(const struct btree *bt, struct btree_node *x, const void *key,
-		int ht)
+/* Returns the value under the cursor, NULL if it is not on any key. */
+void *
+btree_cursor_value(const struct btree_cursor *c)
 {
-	unsigned int i;
-
-	if (x == NULL)
+	if (c->leaf == NULL)
 		return NULL;
+	return LEAF_VALUE(c->bt, c->leaf, c->idx);
+}
 
-#if BT_FREE_NDOE == 1
-	if (x->sz >= MAX_CHILDREN) {
-		printf("--------!!! Warning 0#: This is a bug.\n");
-		return NULL;
-	}
-#endif
+/******************** static function boundary ********************/
 
-	if (ht == 0) {
-		for (i = 0; i < x->sz; i++)
-			if (bt->kcmp(key, x->children[i]->key) == 0) 
-				return x;
-	} else  {
-		for (i = 0; i < x->sz; i++)
-			if (i + 1 == x->sz || ( i + 1 < x->sz &&
-			   bt->kcmp(key, x->children[i + 1]->key) == 1)) {
-				return get_leaf_node(bt, x->children[i]->next,
-					key, ht - 1);
-			}
-	}
+/* allocates an empty node of one page */
+static inline struct btree_node *
+make_node(const struct btree *bt)
+{
+	struct btree_node *x;
 
-	return NULL;
+	x = (struct btree_node *)algmalloc(bt->pagesize);
+	x->sz = 0;
+	x->prev = NULL;
+	x->sibling = NULL;
+	return x;
 }
 
-#if 0
-/* returns the internal node in this B-Tree. */
-static struct btree_node * 
-get_internal_node(const struct btree *bt, struct btree_node *x,
-		const void *key, int ht)
+/* 
+ * Returns the index of the first of N contiguous keys which 
+ * is not less than KEY, N if there is no such key. 
+ * The keys are binary searched in place.
+ */
+static inline unsigned int 
+get_entry_index(const struct btree *bt, const unsigned char *keys, 
+	unsigned int n, const void *key)
 {
-	unsigned int i;
+	unsigned int lo = 0, hi = n, mid;
 
-	if (x == NULL)
-		return NULL;
-
-	if (ht == 1) {
-		for (i = 0; i < x->sz; i++)
-			if (bt->kcmp(key, x->children[i]->key) == 0)
-				return x;
-	} else {
-		for (i = 0; i < x->sz; i++)
-			if (i + 1 == x->sz || (i + 1 < x->sz &&
-			   bt->kcmp(key, x->children[i + 1]->key) == 1)) {
-				if (i < x->sz &&
-					bt->kcmp(key, x->children[i]->key) == 0)
-					return x;
-				return get_internal_node(bt,
-					x->children[i]->next, key, ht - 1);
-			}
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (bt->kcmp(key, keys + (size_t)mid * bt->keysize) == -1)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-
-	return NULL;
+	return lo;
 }
-#endif
 
-/* returns an entry of index in this node */
-static inline unsigned int 
-get_entry_index(const struct btree *bt, struct btree_node *x, const void *key)
+/* Returns the index of the child of X which holds KEY. */
+static inline unsigned int
+get_child_index(const struct btree *bt, const struct btree_node *x,
+	const void *key)
 {
 	unsigned int i;
 
-	for (i = 0; i < x->sz; i++)
-		if (bt->kcmp(key, x->children[i]->key) == 0)
-			return i;
-	return MAX_CHILDREN;
+	i = get_entry_index(bt, x->data + bt->keyoff, x->sz, key);
+	/* equal to a separator key goes to the right */
+	if (i < x->sz && bt->kcmp(key, INNER_KEY(bt, x, i)) == 0)
+		i++;
+	return i;
 }
 
-/* Output query result that set between lokey and hikey */
-static void
-query(const struct btree *bt, const void *lokey, const void *hikey,
-	struct single_list *rec)
+/* 
+ * Returns the leaf and the index of the first 
+ * key not less than KEY, NULL if no such key.
+ */
+static struct btree_node * 
+get_start_leaf(const struct btree *bt, const void *key, unsigned int *idx)
 {
-	unsigned int i;
-	struct btree_node *leaf;
-	bool ended = false;
-	int lcmp, hcmp;
-	
-	leaf = get_start_leaf(bt, bt->root, lokey, bt->height);
-	while (leaf != NULL) {
-		for (i = 0; i < leaf->sz; i++) {
-			lcmp = bt->kcmp(lokey, leaf->children[i]->key);
-			if (lcmp == 1 || lcmp == 0) {
-				hcmp = bt->kcmp(hikey, leaf->children[i]->key);
-				if (hcmp == -1 || hcmp == 0) {
-					slist_append(rec, leaf->children[i]);
-				} else {
-					ended = true;
-					break;
-				}
-			}
-		}
+	struct btree_node *x;
+	int ht;
 
-		if (ended)
-			break;
+	for (x = bt->root, ht = bt->height; ht > 0; ht--)
+		x = CHILDREN(x)[get_child_index(bt, x, key)];
 
-		leaf = leaf->sibling;
+	*idx = get_entry_index(bt, x->data, x->sz, key);
+	if (*idx == x->sz) {
+		*idx = 0;
+		x = x->sibling;
 	}
+	return x;
 }
 
-/* Release the subtrees rooted at NODE */
-static void 
-release(struct btree_node *node, int ht)
+/* 
+ * Split the overflowing leaf in half, 
+ * the first key of the new node is moved up.
+ */
+static struct btree_node * 
+split_leaf(struct btree *bt, struct btree_node *h)
 {
-	unsigned int i;
+	struct btree_node *t;
+	unsigned int m;
 
-	if (node == NULL)
-		return;
+	t = make_node(bt);
+	m = h->sz / 2;
+	t->sz = h->sz - m;
+	h->sz = m;
 
-#if BT_FREE_NDOE == 1
-	if (node->sz >= MAX_CHILDREN) {
-		printf("--------!!! Warning 4#: This is a bug.\n");
-		return;
-	}
-#endif
+	/*
+	 * Original node with smaller items,
+	 * New node with larger items.
+	 */
+	memcpy(LEAF_KEY(bt, t, 0), LEAF_KEY(bt, h, m), 
+		(size_t)t->sz * bt->keysize);
+	memcpy(LEAF_VALUE(bt, t, 0), LEAF_VALUE(bt, h, m),
+		(size_t)t->sz * bt->valsize);
 
-	if (ht == 0) 
-		for (i = 0; i < node->sz; i++) {
-			ALGFREE(node->children[i]->key);
-			ALGFREE(node->children[i]->value);
-			ALGFREE(node->children[i]);
-		}
-	else
-		for (i = 0; i < node->sz; i++) {
-			release(node->children[i]->next, ht - 1);
-			ALGFREE(node->children[i]);
-		}
+	t->sibling = h->sibling;
+	if (h->sibling != NULL)
+		h->sibling->prev = t;
+	h->sibling = t;
+	t->prev = h;
+
+	memcpy(bt->sepkey, LEAF_KEY(bt, t, 0), bt->keysize);
+	return t;
 }
 
-/* remove a entry from the leaf node of the entry */
-static void 
-remove_leaf_entry(const struct btree *bt, struct btree_node *x, const void *key)
-{
-	unsigned int i, j;
-	void *oldkey = NULL;
-
-	for (i = 0; i < x->sz; i++)
-		if (bt->kcmp(key, x->children[i]->key) == 0) {
-			oldkey = x->children[i]->key;
-			ALGFREE(x->children[i]->value);
-			ALGFREE(x->children[i]);
-
-			/* eliminates empty the location of index */
-			for (j = i; j < x->sz; j++)
-				x->children[j] = x->children[j + 1];
-			x->sz--;
-			break;
-		}
+/* 
+ * Split the overflowing internal node in half, 
+ * the middle key is moved up.
+ */
+static struct btree_node * 
+split_inner(struct btree *bt, struct btree_node *h)
+{
+	struct btree_node *t;
+	unsigned int m;
+
+	t = make_node(bt);
+	m = h->sz / 2;
+	t->sz = h->sz - m - 1;
+
+	memcpy(bt->sepkey, INNER_KEY(bt, h, m), bt->keysize);
+	memcpy(INNER_KEY(bt, t, 0), INNER_KEY(bt, h, m + 1), 
+		(size_t)t->sz * bt->keysize);
+	memcpy(CHILDREN(t), CHILDREN(h) + m + 1, 
+		(size_t)(t->sz + 1) * sizeof(struct btree_node *));
+	h->sz = m;
 
-	/* if the first of the key of x not in its parent */
-	if (x->parent == NULL || i != 0) 
-		ALGFREE(oldkey);
+	return t;
 }
 
-/* remmove a key from the internal node */
-static void 
-remove_internal_key(const struct btree *bt, struct btree_node *x,
-		const void *key)
+/* 
+ * Inserts the key-value pair into the subtree rooted at h,
+ * returns the new right node if h had splited.
+ */
+static struct btree_node *
+insert(struct btree *bt, struct btree_node *h, const void *key,
+		const void *val, int ht, int *added)
 {
 	unsigned int i;
-	struct btree_node *ml;
-
-	if (x == NULL)
-		return;
+	struct btree_node *u;
 
-#if BT_FREE_NDOE == 1
-	if (x->sz >= MAX_CHILDREN) {
-		printf("--------!!! Warning 1#: This is a bug.\n");
-		return;
-	}
-#endif
+	if (ht == 0) { /* external node */
+		i = get_entry_index(bt, h->data, h->sz, key);
 
-	if ((i = get_entry_index(bt, x, key)) != MAX_CHILDREN) {
-		ml = x->children[i]->next;
-		while (ml != NULL && ml->children[0] != NULL &&
-			ml->children[0]->next != NULL) {
-			ml = ml->children[0]->next;
+		/* 
+		 * overwriting the old value with the new value 
+		 * if the B-Tree already contains the specified key. 
+		 */
+		if (i < h->sz && bt->kcmp(key, LEAF_KEY(bt, h, i)) == 0) {
+			memcpy(LEAF_VALUE(bt, h, i), val, bt->valsize);
+			return NULL;
 		}
 
-		if (ml == NULL || ml->children[0] == NULL)
-			return;
-		
-		if (i != 0 || x->parent == NULL)
-			ALGFREE(x->children[i]->key);
-		x->children[i]->key = ml->children[0]->key;
+		memmove(LEAF_KEY(bt, h, i + 1), LEAF_KEY(bt, h, i),
+			(size_t)(h->sz - i) * bt->keysize);
+		memmove(LEAF_VALUE(bt, h, i + 1), LEAF_VALUE(bt, h, i),
+			(size_t)(h->sz - i) * bt->valsize);
+		memcpy(LEAF_KEY(bt, h, i), key, bt->keysize);
+		memcpy(LEAF_VALUE(bt, h, i), val, bt->valsize);
+		h->sz++;
+		*added = 1;
+
+		return h->sz > bt->leafcap ? split_leaf(bt, h) : NULL;
 	}
-}
 
-static inline void 
-move_right_entries(struct btree_node *h)
-{
-	unsigned int i, k;
+	/* internal node */
+	i = get_child_index(bt, h, key);
+	if ((u = insert(bt, CHILDREN(h)[i], key, val, ht - 1, added)) == NULL)
+		return NULL;
 
-	k = h->prev->sz - 1;	/* last entry */
-	for (i = h->sz; i > 0; i--)
-		h->children[i] = h->children[i - 1];
-	h->children[0] = h->prev->children[k];
+	/* 
+	 * if a node had splited, attach the new node to its 
+	 * parent right after the old one with the moved up key.
+	 */
+	memmove(INNER_KEY(bt, h, i + 1), INNER_KEY(bt, h, i),
+		(size_t)(h->sz - i) * bt->keysize);
+	memmove(CHILDREN(h) + i + 2, CHILDREN(h) + i + 1,
+		(size_t)(h->sz - i) * sizeof(struct btree_node *));
+	memcpy(INNER_KEY(bt, h, i), bt->sepkey, bt->keysize);
+	CHILDREN(h)[i + 1] = u;
 	h->sz++;
 
-	if (h->prev->children[k]->next != NULL)
-		h->prev->children[i]->next->parent = h;
-
-	h->prev->children[k] = NULL;
-	h->prev->sz--;
+	return h->sz > bt->innercap ? split_inner(bt, h) : NULL;
 }
 
-static inline void 
-move_left_entries(struct btree_node *h)
+/* 
+ * Returns the number of entries of a node filled to FILL 
+ * of CAP entries, which is not less than MINSZ.
+ */
+static unsigned int
+fill_count(unsigned int cap, unsigned int minsz, double fill)
 {
-	unsigned int i;
+	unsigned int cnt;
 
-	h->children[h->sz] = h->sibling->children[0];
-	if (h->sibling->children[0]->next != NULL)
-		h->sibling->children[0]->next->parent = h;
-	h->sibling->children[0] = NULL;
-	for (i = 0; i < h->sibling->sz; i++)
-		h->sibling->children[i] = h->sibling->children[i + 1];
-	h->sz++;
-	h->sibling->sz--;
+	cnt = (unsigned int)(fill * (double)cap);
+	return MIN(cap, MAX(cnt, MAX(minsz, 1U)));
 }
 
-/* borrow a left leaf entry to current leaf node */
-static void
-borrow_left_leaf(struct btree_node *h)
-{
-	unsigned int i;
-
-	assert(h->prev != NULL && h->parent != NULL);
-	assert(h->prev->parent == h->parent);
-
-	move_right_entries(h);
-
-	for (i = 0; i < h->parent->sz; i++)
-		if (h->parent->children[i]->next == h) {
-			h->parent->children[i]->key = h->children[0]->key;
-			break;
+/* 
+ * Returns the number of nodes holding TOTAL entries with PER entries 
+ * each, but the last two nodes hold PEN and LAST entries. The last node
+ * less than MINSZ entries is merged into the previous one if they fit 
+ * in CAP entries, otherwise the two nodes share their entries evenly.
+ */
+static unsigned long
+plan_nodes(unsigned long total, unsigned int per, unsigned int cap,
+	unsigned int minsz, unsigned int *pen, unsigned int *last)
+{
+	unsigned long cnt;
+	unsigned int t;
+
+	cnt = (total + per - 1) / per;
+	*pen = per;
+	*last = (unsigned int)(total - (cnt - 1) * per);
+	if (cnt > 1 && *last < minsz) {
+		t = per + *last;
+		if (t <= cap) {
+			cnt--;
+			*last = t;
+		} else {
+			*pen = t - t / 2;
+			*last = t / 2;
 		}
+	}
+	return cnt;
 }
 
-/* 
- * Borrrow a left internal key to the current internal node.
- */
-static void
-borrow_left_key(unsigned int pos, struct btree_node *h)
+/* Release the subtrees rooted at NODE */
+static void 
+release(struct btree_node *node, int ht)
 {
-	assert(h->prev != NULL && h->parent != NULL);
-	assert(h->prev->parent == h->parent);
+	unsigned int i;
 
-	move_right_entries(h);
-	h->parent->children[pos]->key = h->children[0]->key;
+	if (ht > 0)
+		for (i = 0; i <= node->sz; i++)
+			release(CHILDREN(node)[i], ht - 1);
+	ALGFREE(node);
 }
 
 /* 
- * Borrow a right leaf entry to the current leaf node.
+ * Removes KEY from the subtree rooted at X, returns 0 if not found. 
+ * The children left less than half full are fixed on the way back, 
+ * the separator keys are only routing keys and stay in place.
  */
-static void
-borrow_right_leaf(struct btree_node *h)
+static int
+remove_entry(struct btree *bt, struct btree_node *x, const void *key, int ht)
 {
-	unsigned int i;
+	unsigned int i, minsz;
 
-	assert(h->sibling != NULL && h->parent != NULL);
-	assert(h->sibling->parent == h->parent);
+	if (ht == 0) {
+		i = get_entry_index(bt, x->data, x->sz, key);
+		if (i == x->sz || bt->kcmp(key, LEAF_KEY(bt, x, i)) != 0)
+			return 0;
+
+		/* eliminates empty the location of index */
+		memmove(LEAF_KEY(bt, x, i), LEAF_KEY(bt, x, i + 1),
+			(size_t)(x->sz - i - 1) * bt->keysize);
+		memmove(LEAF_VALUE(bt, x, i), LEAF_VALUE(bt, x, i + 1),
+			(size_t)(x->sz - i - 1) * bt->valsize);
+		x->sz--;
+		return 1;
+	}
 
-	move_left_entries(h);
-	for (i = 0; i < h->parent->sz; i++)
-		if (h->parent->children[i]->next == h->sibling) {
-			h->parent->children[i]->key =
-			h->sibling->children[0]->key;
-			break;
-		}
+	i = get_child_index(bt, x, key);
+	if (!remove_entry(bt, CHILDREN(x)[i], key, ht - 1))
+		return 0;
+
+	minsz = (ht == 1 ? bt->leafcap : bt->innercap) / 2;
+	if (CHILDREN(x)[i]->sz < minsz)
+		fix_child(bt, x, i, ht - 1);
+	return 1;
 }
 
-/* borrow a right interanl key to the current right node */
+/* 
+ * Refills the child I of P, which has height HT, 
+ * by borrowing from or merging with its siblings.
+ */
 static void
-borrow_right_key(unsigned int pos, struct btree_node *h)
-{
-	assert(h->sibling != NULL && h->parent != NULL);
-	assert(h->sibling->parent == h->parent);
-
-	move_left_entries(h);
-	h->parent->children[pos]->key = h->sibling->children[0]->key;
+fix_child(struct btree *bt, struct btree_node *p, unsigned int i, int ht)
+{
+	struct btree_node *left, *right;
+	unsigned int minsz;
+
+	minsz = (ht == 0 ? bt->leafcap : bt->innercap) / 2;
+	left = i > 0 ? CHILDREN(p)[i - 1] : NULL;
+	right = i < p->sz ? CHILDREN(p)[i + 1] : NULL;
+
+	if (left != NULL && left->sz > minsz) {
+		if (ht == 0)
+			borrow_left_leaf(bt, p, i);
+		else
+			borrow_left_key(bt, p, i);
+	} else if (right != NULL && right->sz > minsz) {
+		if (ht == 0)
+			borrow_right_leaf(bt, p, i);
+		else
+			borrow_right_key(bt, p, i);
+	} else if (left != NULL) {
+		if (ht == 0)
+			merge_leaf(bt, p, i - 1);
+		else
+			merge_internal(bt, p, i - 1);
+	} else if (right != NULL) {
+		if (ht == 0)
+			merge_leaf(bt, p, i);
+		else
+			merge_internal(bt, p, i);
+	}
 }
 
-#if 0
-static inline void 
-union_left_entries(struct btree_node *current, struct btree_node *left)
+/* borrow the last entry of the left leaf to the child I of P */
+static void
+borrow_left_leaf(struct btree *bt, struct btree_node *p, unsigned int i)
 {
-	unsigned int i, j;
-	
-	for (i = 0; i < left->sz; i++) {
-		for (j = current->sz; j > i; j--)
-			current->children[j] = current->children[j - 1];
-		current->sz++;
-	}
+	struct btree_node *h, *left;
 
-	for (j = 0; j < left->sz; j++) {
-		current->children[j] = left->children[j];
-		if (left->children[j]->next != NULL)
-			left->children[j]->next->parent = current;
-		left->children[j] = NULL;
-	}
-	left->sz = 0;
-}
-#endif
+	h = CHILDREN(p)[i];
+	left = CHILDREN(p)[i - 1];
 
-static inline void 
-union_right_entries(struct btree_node *current, struct btree_node *right)
-{
-	unsigned int i, j;
+	memmove(LEAF_KEY(bt, h, 1), LEAF_KEY(bt, h, 0),
+		(size_t)h->sz * bt->keysize);
+	memmove(LEAF_VALUE(bt, h, 1), LEAF_VALUE(bt, h, 0),
+		(size_t)h->sz * bt->valsize);
+	memcpy(LEAF_KEY(bt, h, 0), LEAF_KEY(bt, left, left->sz - 1),
+		bt->keysize);
+	memcpy(LEAF_VALUE(bt, h, 0), LEAF_VALUE(bt, left, left->sz - 1),
+		bt->valsize);
+	h->sz++;
+	left->sz--;
 
-	/* combines two children of nodes become one */
-	for (i = current->sz, j = 0; j < right->sz; i++, j++) {
-		current->children[i] = right->children[j];
-		current->sz++;
-		if (right->children[j]->next != NULL)
-			right->children[j]->next->parent = current;
-		right->children[j] = NULL;
-	}
-	right->sz = 0;
+	memcpy(INNER_KEY(bt, p, i - 1), LEAF_KEY(bt, h, 0), bt->keysize);
 }
 
-/* merge left leaf node to the current node. */
-static struct btree_node * 
-merge_left_leaf(struct btree_node *current, struct btree_node *left)
+/* borrow the first entry of the right leaf to the child I of P */
+static void
+borrow_right_leaf(struct btree *bt, struct btree_node *p, unsigned int i)
 {
-	unsigned int i, j;
-	bool flag = false;
+	struct btree_node *h, *right;
 
-	assert(current->sz + left->sz < MAX_CHILDREN);
-	assert(current->parent == left->parent);
+	h = CHILDREN(p)[i];
+	right = CHILDREN(p)[i + 1];
 
-	left->sibling = current->sibling;
-	if (current->sibling != NULL)
-		current->sibling->prev = left;
-	
-	union_right_entries(left, current);
-
-	for (i = 0; i < left->parent->sz; i++)
-		if (left->parent->children[i]->next == current) {
-			flag = true;
-			ALGFREE(left->parent->children[i]);
-			for (j = i; j < left->parent->sz; j++) {
-				left->parent->children[j] =
-				left->parent->children[j + 1];
-			}
-			left->parent->sz--;
-			break;
-		}
-	
-	if (flag)
-		ALGFREE(current);
+	memcpy(LEAF_KEY(bt, h, h->sz), LEAF_KEY(bt, right, 0), bt->keysize);
+	memcpy(LEAF_VALUE(bt, h, h->sz), LEAF_VALUE(bt, right, 0),
+		bt->valsize);
+	h->sz++;
+	right->sz--;
+	memmove(LEAF_KEY(bt, right, 0), LEAF_KEY(bt, right, 1),
+		(size_t)right->sz * bt->keysize);
+	memmove(LEAF_VALUE(bt, right, 0), LEAF_VALUE(bt, right, 1),
+		(size_t)right->sz * bt->valsize);
 
-	return left;
+	memcpy(INNER_KEY(bt, p, i), LEAF_KEY(bt, right, 0), bt->keysize);
 }
 
-/* merge left internal node to the current node. */
-static struct btree_node * 
-merge_left_internal(unsigned int pos, struct btree_node *current,
-		struct btree_node *left)
+/* 
+ * Borrrow the last child of the left internal node to the child I of P,
+ * rotating the separator key through the parent.
+ */
+static void
+borrow_left_key(struct btree *bt, struct btree_node *p, unsigned int i)
 {
-	unsigned int i;
-
-	assert(current->sz + left->sz < MAX_CHILDREN);
+	struct btree_node *h, *left;
 
-	left->sibling = current->sibling;
-	if (current->sibling != NULL)
-		current->sibling->prev = left;
+	h = CHILDREN(p)[i];
+	left = CHILDREN(p)[i - 1];
 
-	union_right_entries(left, current);
-
-	ALGFREE(current->parent->children[pos]);
-	for (i = pos; i < current->parent->sz; i++)
-		current->parent->children[i] = current->parent->children[i + 1];
-	current->parent->sz--;
+	memmove(INNER_KEY(bt, h, 1), INNER_KEY(bt, h, 0),
+		(size_t)h->sz * bt->keysize);
+	memmove(CHILDREN(h) + 1, CHILDREN(h),
+		(size_t)(h->sz + 1) * sizeof(struct btree_node *));
+	memcpy(INNER_KEY(bt, h, 0), INNER_KEY(bt, p, i - 1), bt->keysize);
+	CHILDREN(h)[0] = CHILDREN(left)[left->sz];
+	h->sz++;
 
-#if BT_FREE_NDOE == 1
-	/* Warning: this a bug. */
-	ALGFREE(current); 
-#endif
-	return left;
+	memcpy(INNER_KEY(bt, p, i - 1), INNER_KEY(bt, left, left->sz - 1),
+		bt->keysize);
+	left->sz--;
 }
 
-/* merge right leaf node to the current node. */
-static struct btree_node * 
-merge_right_leaf(struct btree_node *current, struct btree_node *right)
+/* 
+ * Borrow the first child of the right internal node to the child I of P,
+ * rotating the separator key through the parent.
+ */
+static void
+borrow_right_key(struct btree *bt, struct btree_node *p, unsigned int i)
 {
-	unsigned int i, j, flag = 0;
+	struct btree_node *h, *right;
 
-	assert(current->sz + right->sz < MAX_CHILDREN);
-	assert(current->parent == right->parent);
+	h = CHILDREN(p)[i];
+	right = CHILDREN(p)[i + 1];
 
-	/* adjust linked-list of pointer*/
-	current->sibling = right->sibling;
-	if (right->sibling != NULL)
-		right->sibling->prev = current;
-
-	union_right_entries(current, right);
-
-	/* adjust its parent of key */
-	for (i = 0; i < right->parent->sz; i++)
-		if (right->parent->children[i]->next == right) {
-			flag = 1;
-			ALGFREE(right->parent->children[i]);
-			for (j = i; j < right->parent->sz; j++) {
-				right->parent->children[j] =
-				right->parent->children[j + 1];
-			}
-			right->parent->sz--;
-			break;
-		}
+	memcpy(INNER_KEY(bt, h, h->sz), INNER_KEY(bt, p, i), bt->keysize);
+	CHILDREN(h)[h->sz + 1] = CHILDREN(right)[0];
+	h->sz++;
 
-	if (flag)
-		ALGFREE(right);
+	memcpy(INNER_KEY(bt, p, i), INNER_KEY(bt, right, 0), bt->keysize);
+	memmove(INNER_KEY(bt, right, 0), INNER_KEY(bt, right, 1),
+		(size_t)(right->sz - 1) * bt->keysize);
+	memmove(CHILDREN(right), CHILDREN(right) + 1,
+		(size_t)right->sz * sizeof(struct btree_node *));
+	right->sz--;
+}
 
-	return current;
+/* removes the key I and the child I + 1 of P */
+static inline void
+remove_child(struct btree *bt, struct btree_node *p, unsigned int i)
+{
+	memmove(INNER_KEY(bt, p, i), INNER_KEY(bt, p, i + 1),
+		(size_t)(p->sz - i - 1) * bt->keysize);
+	memmove(CHILDREN(p) + i + 1, CHILDREN(p) + i + 2,
+		(size_t)(p->sz - i - 1) * sizeof(struct btree_node *));
+	p->sz--;
 }
 
-/* merge right internal node to the current node. */
-static struct btree_node * 
-merge_right_internal(unsigned int pos, struct btree_node *current,
-		struct btree_node *right)
+/* merge the leaf child I + 1 of P into the child I. */
+static void
+merge_leaf(struct btree *bt, struct btree_node *p, unsigned int i)
 {
-	unsigned int i;
+	struct btree_node *left, *right;
+
+	left = CHILDREN(p)[i];
+	right = CHILDREN(p)[i + 1];
+	assert(left->sz + right->sz <= bt->leafcap);
 
-	assert(current->sz + right->sz < MAX_CHILDREN);
+	memcpy(LEAF_KEY(bt, left, left->sz), LEAF_KEY(bt, right, 0),
+		(size_t)right->sz * bt->keysize);
+	memcpy(LEAF_VALUE(bt, left, left->sz), LEAF_VALUE(bt, right, 0),
+		(size_t)right->sz * bt->valsize);
+	left->sz += right->sz;
 
 	/* adjust linked-list of pointer*/
-	current->sibling = right->sibling;
+	left->sibling = right->sibling;
 	if (right->sibling != NULL)
-		right->sibling->prev = current;
+		right->sibling->prev = left;
 
-	union_right_entries(current, right);
-
-	ALGFREE(right->parent->children[pos + 1]);
-	for (i = pos + 1; i < right->parent->sz; i++)
-		right->parent->children[i] = right->parent->children[i + 1];
-	right->parent->sz--;
-
-#if BT_FREE_NODE == 1
-	/* Warning: this a bug. */
+	remove_child(bt, p, i);
 	ALGFREE(right);
-#endif
-	return current;
 }
 
-static void 
-remove_entry(struct btree *bt, struct btree_node *x, const void *key,
-	bool isleaf)
+/* 
+ * merge the internal child I + 1 of P into the child I,
+ * the separator key moves down between them.
+ */
+static void
+merge_internal(struct btree *bt, struct btree_node *p, unsigned int i)
 {
-	const unsigned int minsz = MAX_CHILDREN / 2;
-	struct btree_node *left, *right, *oldroot;
-	int pos = -1, i;
+	struct btree_node *left, *right;
 
-	if (x == NULL)
-		return;
+	left = CHILDREN(p)[i];
+	right = CHILDREN(p)[i + 1];
+	assert(left->sz + right->sz + 1 <= bt->innercap);
 
-#if BT_FREE_NDOE == 1
-	if (x->sz >= MAX_CHILDREN) {
-		printf("--------!!! Warning 3#: This is a bug.\n");
-		return;
-	}
-#endif
-
-	if (isleaf)
-		remove_leaf_entry(bt, x, key);
-	else 
-		remove_internal_key(bt, x, key);
-
-	if (x->sz < minsz) {
-		if (x == bt->root && !isleaf) {
-			if (bt->root->sz == 1 &&
-				bt->root->children[0]->next != NULL) {
-				bt->root->children[0]->next->parent = NULL;
-				oldroot = bt->root;
-				bt->root = bt->root->children[0]->next;
-				bt->root->parent = NULL;
-				bt->height--;
-				ALGFREE(oldroot->children[0]);
-				ALGFREE(oldroot);
-			}
-			return;
-		} else if (isleaf) {
-			left = x->prev;
-			right = x->sibling;
-
-			if (left != NULL && left->parent == x->parent
-				&& left->sz > minsz) {
-				borrow_left_leaf(x);
-			} else if (right != NULL && right->parent == x->parent
-				&& right->sz > minsz) {
-				borrow_right_leaf(x);
-			} else if (left != NULL && left->parent == x->parent
-				&& left->sz <= minsz) {
-				x = merge_left_leaf(x, left);
-			} else if (right != NULL && right->parent == x->parent
-				&& right->sz <= minsz) {
-				x = merge_right_leaf(x, right);
-			} else {	/* Nothing do it. */
-				while(0);
-			}
-		} else {
-			if (x->parent == NULL)
-				return;
+	memcpy(INNER_KEY(bt, left, left->sz), INNER_KEY(bt, p, i),
+		bt->keysize);
+	memcpy(INNER_KEY(bt, left, left->sz + 1), INNER_KEY(bt, right, 0),
+		(size_t)right->sz * bt->keysize);
+	memcpy(CHILDREN(left) + left->sz + 1, CHILDREN(right),
+		(size_t)(right->sz + 1) * sizeof(struct btree_node *));
+	left->sz += right->sz + 1;
 
-#if BT_FREE_NDOE == 1
-			if (x->parent->sz >= MAX_CHILDREN) {
-				printf("--------!!! Warning 2#: "
-					"This is a bug.\n");
-				return;
-			}
-#endif
-
-			for (i = 0; i < (int)x->parent->sz; i++)
-				if (x->parent->children[i] != NULL &&
-					x->parent->children[i]->next == x) {
-					pos = i;
-					break;
-				}
-
-			if (pos == -1)
-				return;
-
-			if ((int)x->parent->sz > pos + 1)
-				right = x->parent->children[pos + 1]->next;
-			else
-				right = NULL;
-
-			if (pos > 0)
-				left = x->parent->children[pos - 1]->next;
-			else
-				left = NULL;
-
-			if (left != NULL && left->parent == x->parent
-				&& left->sz > minsz) {
-				borrow_left_key(pos, x);
-			} else if (right != NULL && right->parent == x->parent
-				&& right->sz > minsz) {
-				borrow_right_key(pos, x);
-			} else if (left != NULL && left->parent == x->parent
-				&& left->sz <= minsz) {
-				x = merge_left_internal(pos, x, left);
-			} else if (right != NULL && right->parent == x->parent
-				&& right->sz <= minsz) {
-				x = merge_right_internal(pos, x, right);
-			} else {	/* Nothing do it. */
-				while(0);
-			}
-		}
-	}
-
-	if (x->parent != NULL)
-		remove_entry(bt, x->parent, key, false);
+	remove_child(bt, p, i);
+	ALGFREE(right);
 }
@@ -0,0 +1,363 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "bufferpool.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/* The home slot of the page number in the page table */
+#define BPOOL_HOME(bp, pgno)	\
+	(mix_pgno(pgno) & (bp)->tabmask)
+
+static inline unsigned long mix_pgno(unsigned long);
+static void read_page(struct buffer_pool *, unsigned long, unsigned char *);
+static void write_page(struct buffer_pool *, unsigned long,
+	const unsigned char *);
+static long table_find(const struct buffer_pool *, unsigned long);
+static void table_insert(struct buffer_pool *, unsigned long, long);
+static void table_remove(struct buffer_pool *, unsigned long);
+static long get_victim(struct buffer_pool *);
+static struct bpool_frame * load_frame(struct buffer_pool *, unsigned long,
+	bool);
+
+/* 
+ * Opens the file of PGSZ bytes pages with a pool of 
+ * NFRAMES frames, the file is created if it does not exist.
+ */
+void
+bpool_init(struct buffer_pool *bp, const char *path, unsigned int pgsz,
+	unsigned long nframes)
+{
+	struct stat st;
+	unsigned long i, tabsz;
+
+	if (pgsz == 0 || nframes == 0)
+		errmsg_exit("The page size and the number of frames must "
+			"be positive.\n");
+
+	if ((bp->fd = open(path, O_RDWR | O_CREAT, 0644)) == -1)
+		errmsg_exit("Can't open file \"%s\", %s\n", path,
+			strerror(errno));
+	if (fstat(bp->fd, &st) == -1)
+		errmsg_exit("Can't stat file \"%s\", %s\n", path,
+			strerror(errno));
+	if (st.st_size % pgsz != 0)
+		errmsg_exit("The size of file \"%s\" is not a multiple of "
+			"the page size %u.\n", path, pgsz);
+
+	bp->pagesize = pgsz;
+	bp->npages = (unsigned long)st.st_size / pgsz;
+	bp->nframes = nframes;
+	bp->hand = 0;
+	bp->hits = 0;
+	bp->misses = 0;
+	bp->writes = 0;
+
+	bp->frames = (struct bpool_frame *)
+		algcalloc(nframes, sizeof(struct bpool_frame));
+	bp->pages = (unsigned char *)algmalloc(nframes * pgsz);
+	for (i = 0; i < nframes; i++)
+		bp->frames[i].page = bp->pages + i * pgsz;
+
+	/* the page table is at most half full */
+	for (tabsz = 1; tabsz < 2 * nframes; tabsz <<= 1)
+		;
+	bp->tabmask = tabsz - 1;
+	bp->table = (long *)algmalloc(tabsz * sizeof(long));
+	for (i = 0; i < tabsz; i++)
+		bp->table[i] = -1;
+}
+
+/* Pins the page PGNO into the pool and returns its contents. */
+void *
+bpool_fetch(struct buffer_pool *bp, unsigned long pgno)
+{
+	struct bpool_frame *fr;
+	long k;
+
+	if (pgno >= bp->npages)
+		errmsg_exit("The page %lu is out of the file of %lu pages.\n",
+			pgno, bp->npages);
+
+	if ((k = table_find(bp, pgno)) != -1) {
+		fr = &bp->frames[k];
+		bp->hits++;
+	} else {
+		fr = load_frame(bp, pgno, true);
+		bp->misses++;
+	}
+
+	fr->pins++;
+	fr->ref = true;
+	return fr->page;
+}
+
+/* 
+ * Appends a zeroed page to the file, the page is pinned and 
+ * its number is stored into PGNO. It is written to the file
+ * when it is evicted or flushed.
+ */
+void *
+bpool_new(struct buffer_pool *bp, unsigned long *pgno)
+{
+	struct bpool_frame *fr;
+
+	*pgno = bp->npages++;
+	fr = load_frame(bp, *pgno, false);
+	memset(fr->page, 0, bp->pagesize);
+	fr->pins = 1;
+	fr->ref = true;
+	fr->dirty = true;
+	return fr->page;
+}
+
+/* Unpins the page PGNO, DIRTY marks that it was changed. */
+void
+bpool_unpin(struct buffer_pool *bp, unsigned long pgno, bool dirty)
+{
+	long k;
+
+	if ((k = table_find(bp, pgno)) == -1 || bp->frames[k].pins == 0)
+		errmsg_exit("The page %lu is not pinned.\n", pgno);
+
+	bp->frames[k].pins--;
+	if (dirty)
+		bp->frames[k].dirty = true;
+}
+
+/* Writes back all dirty pages. */
+void
+bpool_flush(struct buffer_pool *bp)
+{
+	struct bpool_frame *fr;
+	unsigned long i;
+
+	for (i = 0; i < bp->nframes; i++) {
+		fr = &bp->frames[i];
+		if (fr->used && fr->dirty) {
+			write_page(bp, fr->pgno, fr->page);
+			fr->dirty = false;
+		}
+	}
+}
+
+/* Writes back all dirty pages and forces them to the disk. */
+void
+bpool_sync(struct buffer_pool *bp)
+{
+	bpool_flush(bp);
+	if (fsync(bp->fd) == -1)
+		errmsg_exit("Synchronizes file error, %s\n", strerror(errno));
+}
+
+/* Synchronizes and closes the file, then releases the pool. */
+void
+bpool_close(struct buffer_pool *bp)
+{
+	bpool_sync(bp);
+	if (close(bp->fd) == -1)
+		errmsg_exit("Closes file error, %s\n", strerror(errno));
+
+	ALGFREE(bp->frames);
+	ALGFREE(bp->pages);
+	ALGFREE(bp->table);
+	bp->fd = -1;
+	bp->nframes = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* mixes the bits of the page number */
+static inline unsigned long
+mix_pgno(unsigned long pgno)
+{
+	pgno *= 0x9E3779B97F4A7C15UL;
+	return pgno ^ (pgno >> 29);
+}
+
+/* reads the page PGNO of the file into BUF */
+static void
+read_page(struct buffer_pool *bp, unsigned long pgno, unsigned char *buf)
+{
+	size_t done = 0;
+	ssize_t n;
+	off_t off;
+
+	off = (off_t)pgno * bp->pagesize;
+	while (done < bp->pagesize) {
+		n = pread(bp->fd, buf + done, bp->pagesize - done, 
+			off + (off_t)done);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			errmsg_exit("Reads page %lu error, %s\n", pgno,
+				n == 0 ? "unexpected end of file" : 
+				strerror(errno));
+		done += (size_t)n;
+	}
+}
+
+/* writes BUF to the page PGNO of the file */
+static void
+write_page(struct buffer_pool *bp, unsigned long pgno, 
+	const unsigned char *buf)
+{
+	size_t done = 0;
+	ssize_t n;
+	off_t off;
+
+	off = (off_t)pgno * bp->pagesize;
+	while (done < bp->pagesize) {
+		n = pwrite(bp->fd, buf + done, bp->pagesize - done,
+			off + (off_t)done);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n == -1)
+			errmsg_exit("Writes page %lu error, %s\n", pgno,
+				strerror(errno));
+		done += (size_t)n;
+	}
+	bp->writes++;
+}
+
+/* returns the frame of the page PGNO, -1 if it is not in the pool */
+static long
+table_find(const struct buffer_pool *bp, unsigned long pgno)
+{
+	unsigned long i;
+	long k;
+
+	for (i = BPOOL_HOME(bp, pgno); (k = bp->table[i]) != -1;
+		i = (i + 1) & bp->tabmask) {
+		if (bp->frames[k].pgno == pgno)
+			return k;
+	}
+	return -1;
+}
+
+/* maps the page PGNO to the frame K by linear probing */
+static void
+table_insert(struct buffer_pool *bp, unsigned long pgno, long k)
+{
+	unsigned long i;
+
+	for (i = BPOOL_HOME(bp, pgno); bp->table[i] != -1;
+		i = (i + 1) & bp->tabmask)
+		;
+	bp->table[i] = k;
+}
+
+/* 
+ * removes the page PGNO from the table, the following
+ * entries are shifted back so that no tombstone is left.
+ */
+static void
+table_remove(struct buffer_pool *bp, unsigned long pgno)
+{
+	unsigned long i, j, h;
+
+	for (i = BPOOL_HOME(bp, pgno); bp->frames[bp->table[i]].pgno != pgno;
+		i = (i + 1) & bp->tabmask)
+		;
+	bp->table[i] = -1;
+
+	for (j = (i + 1) & bp->tabmask; bp->table[j] != -1;
+		j = (j + 1) & bp->tabmask) {
+		h = BPOOL_HOME(bp, bp->frames[bp->table[j]].pgno);
+		/* moves the entry unless its home is in (i, j] */
+		if ((j > i && (h <= i || h > j)) || 
+			(j < i && h <= i && h > j)) {
+			bp->table[i] = bp->table[j];
+			bp->table[j] = -1;
+			i = j;
+		}
+	}
+}
+
+/* 
+ * Returns a frame to be reused by the clock algorithm, a referenced 
+ * frame gets a second chance and a pinned frame is skipped.
+ */
+static long
+get_victim(struct buffer_pool *bp)
+{
+	struct bpool_frame *fr;
+	unsigned long n;
+	long k;
+
+	for (n = 0; n < 2 * bp->nframes; n++) {
+		k = (long)bp->hand;
+		bp->hand = (bp->hand + 1) % bp->nframes;
+		fr = &bp->frames[k];
+		if (!fr->used)
+			return k;
+		if (fr->pins > 0)
+			continue;
+		if (fr->ref)
+			fr->ref = false;
+		else
+			return k;
+	}
+
+	errmsg_exit("All %lu frames of the buffer pool are pinned.\n",
+		bp->nframes);
+	return -1;
+}
+
+/* 
+ * Puts the page PGNO into a victim frame, the old page is
+ * written back if it is dirty. READ loads it from the file.
+ */
+static struct bpool_frame *
+load_frame(struct buffer_pool *bp, unsigned long pgno, bool read)
+{
+	struct bpool_frame *fr;
+	long k;
+
+	k = get_victim(bp);
+	fr = &bp->frames[k];
+	if (fr->used) {
+		if (fr->dirty)
+			write_page(bp, fr->pgno, fr->page);
+		table_remove(bp, fr->pgno);
+	}
+
+	if (read)
+		read_page(bp, pgno, fr->page);
+	fr->pgno = pgno;
+	fr->pins = 0;
+	fr->dirty = false;
+	fr->used = true;
+	table_insert(bp, pgno, k);
+
+	return fr;
+}
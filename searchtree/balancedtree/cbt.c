@@ -0,0 +1,249 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "concurrentbtree.h"
+#include "btree.h"
+#include <getopt.h>
+#include <pthread.h>
+
+#define OPS_PER_THREAD	1000000
+#define MAX_THREADS	256
+
+struct worker {
+	pthread_t tid;
+	unsigned long seed;
+};
+
+/* the percentages of put and delete operations of the workloads */
+static const int workloads[] = { 5, 50 };
+static const char *wlnames[] = { "read-heavy", "mixed" };
+
+static long *keys;		/* random keys, the first half are loaded */
+static unsigned long nkeys;
+static int putpct;		/* percentage of put and delete operations */
+
+static struct concurrent_btree cbt;
+static struct btree bt;
+static pthread_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER;
+
+static void * cbtree_worker(void *);
+static void * btree_worker(void *);
+static double run(void *(*)(void *), int);
+static unsigned long next_rand(unsigned long *);
+static int kcmp(const void *, const void *);
+static void usage_info(const char *);
+
+int 
+main(int argc, char *argv[])
+{
+	unsigned long i;
+	int nthreads = 0, t, w;
+	double ct, bst;
+
+	int op;
+	const char *optstr = "n:t:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'n':
+			if (sscanf(optarg, "%lu", &nkeys) != 1)
+				errmsg_exit("Illegal number. -n %s\n",
+					optarg);
+			break;
+		case 't':
+			if (sscanf(optarg, "%d", &nthreads) != 1)
+				errmsg_exit("Illegal number. -t %s\n",
+					optarg);
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	if (nkeys < 2)
+		errmsg_exit("The number of keys must be greater than 1.\n");
+	if (nthreads <= 0 || nthreads > MAX_THREADS)
+		errmsg_exit("The number of threads must be in 1 ~ %d.\n",
+			MAX_THREADS);
+	
+	SET_RANDOM_SEED;
+	
+	keys = (long *)algmalloc(nkeys * sizeof(long));
+	for (i = 0; i < nkeys; i++)
+		keys[i] = ((long)rand() << 31) ^ rand();
+	
+	printf("Keys: %lu, operations per thread: %d\n", nkeys, 
+		OPS_PER_THREAD);
+	printf("The first half of keys are loaded before each run, "
+		"puts may insert the rest.\n");
+
+	for (w = 0; w < (int)(sizeof(workloads) / sizeof(workloads[0])); w++) {
+		putpct = workloads[w];
+		printf("\nWorkload %s, puts and deletes: %d%%\n", wlnames[w],
+			putpct);
+		printf("%-8s %28s %28s\n", "threads", 
+			"optimistic B-tree(Mops/s)", "rwlock B-tree(Mops/s)");
+
+		for (t = 1; ; t = (t * 2 > nthreads && t < nthreads) ?
+			nthreads : t * 2) {
+			cbtree_init(&cbt, 0, sizeof(long), sizeof(long), kcmp);
+			for (i = 0; i < nkeys / 2; i++)
+				cbtree_put(&cbt, &keys[i], &keys[i]);
+			ct = run(cbtree_worker, t);
+			cbtree_clear(&cbt);
+
+			btree_init(&bt, 0, sizeof(long), sizeof(long), kcmp);
+			for (i = 0; i < nkeys / 2; i++)
+				btree_put(&bt, &keys[i], &keys[i]);
+			bst = run(btree_worker, t);
+			btree_clear(&bt);
+
+			printf("%-8d %28.3f %28.3f\n", t, 
+				(double)t * OPS_PER_THREAD / ct / 1e6,
+				(double)t * OPS_PER_THREAD / bst / 1e6);
+			if (t == nthreads)
+				break;
+		}
+	}
+	
+	ALGFREE(keys);
+	
+	return 0;
+}
+
+static void *
+cbtree_worker(void *arg)
+{
+	struct worker *w = (struct worker *)arg;
+	unsigned long r;
+	long *key, val;
+	int i;
+
+	for (i = 0; i < OPS_PER_THREAD; i++) {
+		r = next_rand(&w->seed);
+		key = &keys[(r >> 8) % nkeys];
+		if ((int)(r % 100) < putpct) {
+			if ((r >> 7) & 1)
+				cbtree_put(&cbt, key, key);
+			else
+				cbtree_delete(&cbt, key);
+		} else {
+			cbtree_get(&cbt, key, &val);
+		}
+	}
+
+	return NULL;
+}
+
+static void *
+btree_worker(void *arg)
+{
+	struct worker *w = (struct worker *)arg;
+	unsigned long r;
+	long *key, val, *pv = &val;
+	int i;
+
+	for (i = 0; i < OPS_PER_THREAD; i++) {
+		r = next_rand(&w->seed);
+		key = &keys[(r >> 8) % nkeys];
+		if ((int)(r % 100) < putpct) {
+			pthread_rwlock_wrlock(&rwlock);
+			if ((r >> 7) & 1)
+				btree_put(&bt, key, key);
+			else
+				btree_delete(&bt, key);
+		} else {
+			pthread_rwlock_rdlock(&rwlock);
+			btree_get(&bt, key, (void **)&pv);
+		}
+		pthread_rwlock_unlock(&rwlock);
+	}
+
+	return NULL;
+}
+
+/* Runs the worker in NTH threads, returns the wall time in seconds. */
+static double
+run(void *(*worker)(void *), int nth)
+{
+	struct worker ws[MAX_THREADS];
+	struct timespec start, end;
+	int i;
+
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < nth; i++) {
+		ws[i].seed = (unsigned long)rand() * 2654435761UL + 1;
+		if (pthread_create(&ws[i].tid, NULL, worker, &ws[i]) != 0)
+			errmsg_exit("Creates thread failure.\n");
+	}
+	for (i = 0; i < nth; i++)
+		pthread_join(ws[i].tid, NULL);
+	timespec_get(&end, TIME_UTC);
+
+	return (double)(end.tv_sec - start.tv_sec) +
+		(double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/* The xorshift64 generator, one state per thread. */
+static unsigned long
+next_rand(unsigned long *s)
+{
+	*s ^= *s << 13;
+	*s ^= *s >> 7;
+	*s ^= *s << 17;
+	return *s;
+}
+
+static int
+kcmp(const void *key1, const void *key2)
+{
+	long a = *(const long *)key1, b = *(const long *)key2;
+
+	return a < b ? 1 : (a == b ? 0 : -1);
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -n -t\n", pname);
+	fprintf(stderr, "-n: The number of random keys.\n");
+	fprintf(stderr, "-t: The largest number of threads.\n");
+	exit(EXIT_FAILURE);
+}
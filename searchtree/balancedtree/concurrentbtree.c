@@ -0,0 +1,509 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "concurrentbtree.h"
+#include <sched.h>
+
+/* the address of key/value I in the leaf node X */
+#define LEAF_KEY(bt, x, i)	\
+	((x)->data + (size_t)(i) * (bt)->keysize)
+#define LEAF_VALUE(bt, x, i)	\
+	((x)->data + (bt)->valoff + (size_t)(i) * (bt)->valsize)
+
+/* the children and the address of key I in the internal node X */
+#define CHILDREN(x)		((struct cbtree_node **)(x)->data)
+#define INNER_KEY(bt, x, i)	\
+	((x)->data + (bt)->keyoff + (size_t)(i) * (bt)->keysize)
+
+/* rounds up N to the alignment of a pointer */
+#define ALIGN_PTR(n)	\
+	(((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* The number of restarts before a thread yields the processor. */
+#define SPIN_LIMIT	8
+
+static inline int read_latch(struct cbtree_node *, unsigned long *);
+static inline int validate(struct cbtree_node *, unsigned long);
+static inline int upgrade(struct cbtree_node *, unsigned long);
+static inline void unlatch(struct cbtree_node *);
+static void backoff(int);
+static struct cbtree_node * make_node(const struct concurrent_btree *, int);
+static inline unsigned int key_count(const struct concurrent_btree *,
+	const struct cbtree_node *);
+static inline unsigned int get_entry_index(const struct concurrent_btree *, 
+	const struct cbtree_node *, const void *);
+static inline unsigned int get_child_index(const struct concurrent_btree *,
+	const struct cbtree_node *, const void *);
+static struct cbtree_node * enter_root(struct concurrent_btree *,
+	unsigned long *);
+static struct cbtree_node * find_leaf(struct concurrent_btree *, 
+	const void *, unsigned long *);
+static void split(struct concurrent_btree *, struct cbtree_node *,
+	struct cbtree_node *);
+static void release(struct cbtree_node *);
+
+/* 
+ * Initializes an empty concurrent B-tree whose nodes are PGSZ bytes,
+ * the fanout follows the page size and the sizes of the key and
+ * the value.
+ */
+void
+cbtree_init(struct concurrent_btree *bt, unsigned int pgsz, unsigned int ksz,
+	unsigned int vsz, algcomp_ft *cmp)
+{
+	size_t room, slots;
+
+	assert(ksz != 0 && vsz != 0);
+
+	if (pgsz == 0)
+		pgsz = CBTREE_PAGE_SIZE;
+	if (pgsz <= sizeof(struct cbtree_node))
+		errmsg_exit("The page size %u is too small.\n", pgsz);
+	room = pgsz - sizeof(struct cbtree_node);
+
+	/* a leaf node: keys, then the values at an aligned offset */
+	slots = room / (ksz + vsz);
+	while (slots > 0 && ALIGN_PTR(slots * ksz) + slots * vsz > room)
+		slots--;
+	if (slots < 3)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys and %u bytes values.\n", pgsz, ksz, vsz);
+	bt->leafcap = slots;
+	bt->valoff = ALIGN_PTR(slots * ksz);
+
+	/* an internal node: one more child than keys */
+	slots = (room - sizeof(void *)) / (ksz + sizeof(void *));
+	if (slots < 3)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys.\n", pgsz, ksz);
+	bt->innercap = slots;
+	bt->keyoff = (slots + 1) * sizeof(void *);
+
+	bt->pagesize = pgsz;
+	bt->keysize = ksz;
+	bt->valsize = vsz;
+	bt->cmp = cmp;
+	atomic_init(&bt->size, 0);
+	atomic_init(&bt->height, 0);
+	atomic_init(&bt->root, make_node(bt, 1));
+}
+
+/* 
+ * Copies the value associated with the given key into OUT. 
+ * The value is copied optimistically, then it is thrown away and 
+ * read again if the leaf has changed meanwhile.
+ */
+int
+cbtree_get(struct concurrent_btree *bt, const void *key, void *out)
+{
+	struct cbtree_node *leaf;
+	unsigned long v;
+	unsigned int i;
+	int ret, restarts = 0;
+
+	if (key == NULL)
+		errmsg_exit("calls cbtree_get() with null argument.\n");
+
+	for (;;) {
+		if ((leaf = find_leaf(bt, key, &v)) != NULL) {
+			i = get_entry_index(bt, leaf, key);
+			ret = -1;
+			if (i < key_count(bt, leaf) && 
+				bt->cmp(key, LEAF_KEY(bt, leaf, i)) == 0) {
+				memcpy(out, LEAF_VALUE(bt, leaf, i), 
+					bt->valsize);
+				ret = 0;
+			}
+			if (validate(leaf, v))
+				return ret;
+		}
+		backoff(++restarts);
+	}
+}
+
+/* 
+ * Inserts the key-value pair. A full node met on the way down is 
+ * split at once with its parent latched, then it starts over, so 
+ * the parent of a node always has room for one more key. Only the 
+ * leaf is latched to put the pair in.
+ */
+int
+cbtree_put(struct concurrent_btree *bt, const void *key, const void *val)
+{
+	struct cbtree_node *node, *parent, *child;
+	unsigned long v, pv = 0;
+	unsigned int i, cap;
+	int restarts = 0;
+
+	if (key == NULL || val == NULL)
+		errmsg_exit("calls cbtree_put() with null argument.\n");
+
+restart:
+	backoff(restarts++);
+
+	if ((node = enter_root(bt, &v)) == NULL)
+		goto restart;
+	parent = NULL;
+
+	for (;;) {
+		cap = node->leaf ? bt->leafcap : bt->innercap;
+		if (node->sz >= cap) {
+			if (parent != NULL && !upgrade(parent, pv))
+				goto restart;
+			if (!upgrade(node, v)) {
+				if (parent != NULL)
+					unlatch(parent);
+				goto restart;
+			}
+			if (parent == NULL && node != atomic_load(&bt->root)) {
+				unlatch(node);
+				goto restart;
+			}
+			split(bt, parent, node);
+			unlatch(node);
+			if (parent != NULL)
+				unlatch(parent);
+			goto restart;
+		}
+		if (node->leaf)
+			break;
+
+		child = CHILDREN(node)[get_child_index(bt, node, key)];
+		if (!validate(node, v))
+			goto restart;
+		parent = node;
+		pv = v;
+		node = child;
+		if (!read_latch(node, &v) || !validate(parent, pv))
+			goto restart;
+	}
+
+	if (!upgrade(node, v))
+		goto restart;
+	if (parent != NULL && !validate(parent, pv)) {
+		unlatch(node);
+		goto restart;
+	}
+
+	i = get_entry_index(bt, node, key);
+	if (i < node->sz && bt->cmp(key, LEAF_KEY(bt, node, i)) == 0) {
+		memcpy(LEAF_VALUE(bt, node, i), val, bt->valsize);
+		unlatch(node);
+		return 0;
+	}
+
+	memmove(LEAF_KEY(bt, node, i + 1), LEAF_KEY(bt, node, i),
+		(size_t)(node->sz - i) * bt->keysize);
+	memmove(LEAF_VALUE(bt, node, i + 1), LEAF_VALUE(bt, node, i),
+		(size_t)(node->sz - i) * bt->valsize);
+	memcpy(LEAF_KEY(bt, node, i), key, bt->keysize);
+	memcpy(LEAF_VALUE(bt, node, i), val, bt->valsize);
+	node->sz++;
+	unlatch(node);
+	atomic_fetch_add_explicit(&bt->size, 1, memory_order_relaxed);
+
+	return 1;
+}
+
+/* 
+ * Removes the key-value pair, only the leaf is latched. 
+ * The leaf is left as it is even if it becomes empty.
+ */
+int
+cbtree_delete(struct concurrent_btree *bt, const void *key)
+{
+	struct cbtree_node *leaf;
+	unsigned long v;
+	unsigned int i;
+	int restarts = 0;
+
+	if (key == NULL)
+		errmsg_exit("calls cbtree_delete() with null argument.\n");
+
+	for (;;) {
+		if ((leaf = find_leaf(bt, key, &v)) != NULL &&
+			upgrade(leaf, v))
+			break;
+		backoff(++restarts);
+	}
+
+	i = get_entry_index(bt, leaf, key);
+	if (i == leaf->sz || bt->cmp(key, LEAF_KEY(bt, leaf, i)) != 0) {
+		unlatch(leaf);
+		return -1;
+	}
+
+	memmove(LEAF_KEY(bt, leaf, i), LEAF_KEY(bt, leaf, i + 1),
+		(size_t)(leaf->sz - i - 1) * bt->keysize);
+	memmove(LEAF_VALUE(bt, leaf, i), LEAF_VALUE(bt, leaf, i + 1),
+		(size_t)(leaf->sz - i - 1) * bt->valsize);
+	leaf->sz--;
+	unlatch(leaf);
+	atomic_fetch_sub_explicit(&bt->size, 1, memory_order_relaxed);
+
+	return 0;
+}
+
+/* Clears this B-tree, no other thread may be using it. */
+void
+cbtree_clear(struct concurrent_btree *bt)
+{
+	release(atomic_load(&bt->root));
+	atomic_store(&bt->root, NULL);
+	atomic_store(&bt->size, 0);
+	atomic_store(&bt->height, 0);
+}
+
+/******************** static function boundary ********************/
+
+/* 
+ * Reads the version of the node into V, 
+ * returns false if a writer holds the node.
+ */
+static inline int
+read_latch(struct cbtree_node *x, unsigned long *v)
+{
+	*v = atomic_load_explicit(&x->version, memory_order_acquire);
+	return (*v & 1) == 0;
+}
+
+/* Returns true if the node has not changed since version V was read. */
+static inline int
+validate(struct cbtree_node *x, unsigned long v)
+{
+	atomic_thread_fence(memory_order_acquire);
+	return atomic_load_explicit(&x->version, memory_order_relaxed) == v;
+}
+
+/* 
+ * Latches the node if it is still at version V, the reads made 
+ * under V are ordered before it, so they are validated too.
+ */
+static inline int
+upgrade(struct cbtree_node *x, unsigned long v)
+{
+	return atomic_compare_exchange_strong_explicit(&x->version, &v, v + 1,
+		memory_order_acq_rel, memory_order_relaxed);
+}
+
+/* Releases the node with a new version. */
+static inline void
+unlatch(struct cbtree_node *x)
+{
+	atomic_fetch_add_explicit(&x->version, 1, memory_order_release);
+}
+
+/* 
+ * The processor is yielded after a few restarts, 
+ * the writer we wait for may not be running.
+ */
+static void
+backoff(int restarts)
+{
+	if (restarts > SPIN_LIMIT)
+		sched_yield();
+}
+
+/* Allocates a free node of one page. */
+static struct cbtree_node *
+make_node(const struct concurrent_btree *bt, int leaf)
+{
+	struct cbtree_node *x;
+
+	x = (struct cbtree_node *)algmalloc(bt->pagesize);
+	atomic_init(&x->version, 0);
+	x->sz = 0;
+	x->leaf = leaf;
+	return x;
+}
+
+/* 
+ * Returns the number of keys of the node read optimistically, 
+ * bounded by the capacity so a torn one never leaves the page.
+ */
+static inline unsigned int
+key_count(const struct concurrent_btree *bt, const struct cbtree_node *x)
+{
+	unsigned int n = x->sz, cap;
+
+	cap = x->leaf ? bt->leafcap : bt->innercap;
+	return n < cap ? n : cap;
+}
+
+/* Returns the index of the first key not less than KEY in the leaf. */
+static inline unsigned int
+get_entry_index(const struct concurrent_btree *bt, const struct cbtree_node *x,
+	const void *key)
+{
+	unsigned int lo = 0, hi = key_count(bt, x), mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (bt->cmp(LEAF_KEY(bt, x, mid), key) == 1)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* 
+ * Returns the index of the child holding KEY in the internal node,
+ * a key equal to a separator goes right.
+ */
+static inline unsigned int
+get_child_index(const struct concurrent_btree *bt, 
+	const struct cbtree_node *x, const void *key)
+{
+	unsigned int lo = 0, hi = key_count(bt, x), mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (bt->cmp(key, INNER_KEY(bt, x, mid)) == 1)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return lo;
+}
+
+/* 
+ * Reads the version of the root, returns NULL if it is latched or 
+ * it is not the root any more after a split.
+ */
+static struct cbtree_node *
+enter_root(struct concurrent_btree *bt, unsigned long *v)
+{
+	struct cbtree_node *root;
+
+	root = atomic_load(&bt->root);
+	if (!read_latch(root, v) || root != atomic_load(&bt->root))
+		return NULL;
+	return root;
+}
+
+/* 
+ * Goes down to the leaf which may hold KEY with lock coupling, 
+ * the child is only entered after the pointer to it is validated,
+ * and the parent is validated again once the child's version is 
+ * read. Returns NULL if it must restart.
+ */
+static struct cbtree_node *
+find_leaf(struct concurrent_btree *bt, const void *key, unsigned long *ver)
+{
+	struct cbtree_node *x, *child;
+	unsigned long v, cv;
+
+	if ((x = enter_root(bt, &v)) == NULL)
+		return NULL;
+
+	while (!x->leaf) {
+		child = CHILDREN(x)[get_child_index(bt, x, key)];
+		if (!validate(x, v))
+			return NULL;
+		if (!read_latch(child, &cv) || !validate(x, v))
+			return NULL;
+		x = child;
+		v = cv;
+	}
+
+	*ver = v;
+	return x;
+}
+
+/* 
+ * Splits the full node X in half, both X and its parent P are
+ * latched. The first key of the right half of a leaf is copied up, 
+ * the middle key of an internal node is moved up. A new root is 
+ * made if X is the root.
+ */
+static void
+split(struct concurrent_btree *bt, struct cbtree_node *p, 
+	struct cbtree_node *x)
+{
+	struct cbtree_node *t, *root;
+	const unsigned char *sep;
+	unsigned int m, i;
+
+	t = make_node(bt, x->leaf);
+	m = x->sz / 2;
+	if (x->leaf) {
+		t->sz = x->sz - m;
+		memcpy(LEAF_KEY(bt, t, 0), LEAF_KEY(bt, x, m),
+			(size_t)t->sz * bt->keysize);
+		memcpy(LEAF_VALUE(bt, t, 0), LEAF_VALUE(bt, x, m),
+			(size_t)t->sz * bt->valsize);
+		sep = LEAF_KEY(bt, t, 0);
+	} else {
+		t->sz = x->sz - m - 1;
+		memcpy(INNER_KEY(bt, t, 0), INNER_KEY(bt, x, m + 1),
+			(size_t)t->sz * bt->keysize);
+		memcpy(CHILDREN(t), CHILDREN(x) + m + 1,
+			(size_t)(t->sz + 1) * sizeof(struct cbtree_node *));
+		sep = INNER_KEY(bt, x, m);
+	}
+	x->sz = m;
+
+	if (p == NULL) {
+		root = make_node(bt, 0);
+		root->sz = 1;
+		CHILDREN(root)[0] = x;
+		CHILDREN(root)[1] = t;
+		memcpy(INNER_KEY(bt, root, 0), sep, bt->keysize);
+		atomic_fetch_add(&bt->height, 1);
+		atomic_store(&bt->root, root);
+		return;
+	}
+
+	i = get_child_index(bt, p, sep);
+	memmove(INNER_KEY(bt, p, i + 1), INNER_KEY(bt, p, i),
+		(size_t)(p->sz - i) * bt->keysize);
+	memmove(CHILDREN(p) + i + 2, CHILDREN(p) + i + 1,
+		(size_t)(p->sz - i) * sizeof(struct cbtree_node *));
+	memcpy(INNER_KEY(bt, p, i), sep, bt->keysize);
+	CHILDREN(p)[i + 1] = t;
+	p->sz++;
+}
+
+/* Releases the subtree rooted at X. */
+static void
+release(struct cbtree_node *x)
+{
+	unsigned int i;
+
+	if (x == NULL)
+		return;
+	if (!x->leaf) {
+		for (i = 0; i <= x->sz; i++)
+			release(CHILDREN(x)[i]);
+	}
+	ALGFREE(x);
+}
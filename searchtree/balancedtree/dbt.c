@@ -0,0 +1,185 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "diskbtree.h"
+#include "singlelist.h"
+#include <getopt.h>
+#include <unistd.h>
+
+static void usage_info(const char *);
+static int kcmp(const void *, const void *);
+static void print_pool(const struct dbtree *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct dbtree bt;
+	struct single_list keys;
+	long *dat, val, lo, hi;
+	unsigned long i, num = 0, frames = 0, found;
+	unsigned int pgsz = 0;
+	clock_t start_time, end_time;
+	char *fname = NULL;
+	int op;
+	const char *optstr = "f:n:c:p:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+			case 'f':
+				fname = optarg;
+				break;
+			case 'n':
+				if (sscanf(optarg, "%lu", &num) != 1 || num == 0)
+					errmsg_exit("Illegal number. -n %s\n", optarg);
+				break;
+			case 'c':
+				if (sscanf(optarg, "%lu", &frames) != 1)
+					errmsg_exit("Illegal number. -c %s\n", optarg);
+				break;
+			case 'p':
+				if (sscanf(optarg, "%u", &pgsz) != 1)
+					errmsg_exit("Illegal number. -p %s\n", optarg);
+				break;
+			default:
+				fprintf(stderr, "Parameters error.\n");
+				usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+
+	SET_RANDOM_SEED;
+
+	dat = (long *)algmalloc(num * sizeof(long));
+	for (i = 0; i < num; i++)
+		dat[i] = (long)rand_range_integer(1, INT_MAX);
+
+	/* always starts with a new index file */
+	unlink(fname);
+	dbtree_open(&bt, fname, pgsz, sizeof(long), sizeof(long), frames, kcmp);
+	printf("Page size: %u, keys per leaf: %u, fanout: %u\n", 
+		bt.pool.pagesize,
+		bt.leafcap, bt.innercap + 1);
+
+	printf("Begin inserts %lu key-value pairs into \"%s\".\n", num, fname);
+	start_time = clock();
+	for (i = 0; i < num; i++) {
+		val = dat[i] * 2;
+		dbtree_put(&bt, &dat[i], &val);
+	}
+	dbtree_sync(&bt);
+	end_time = clock();
+	printf("Inserted done, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("The size: %lu, the height: %d, pages: %lu\n", DBTREE_SIZE(&bt),
+		DBTREE_HEIGHT(&bt), BPOOL_NPAGES(&bt.pool));
+	print_pool(&bt);
+	dbtree_close(&bt);
+	printf("\n");
+
+	printf("Reopens \"%s\" and queries all keys.\n", fname);
+	dbtree_open(&bt, fname, pgsz, sizeof(long), sizeof(long), frames, kcmp);
+	start_time = clock();
+	for (i = 0, found = 0; i < num; i++)
+		if (dbtree_get(&bt, &dat[i], &val) && val == dat[i] * 2)
+			found++;
+	end_time = clock();
+	printf("Found %lu of %lu keys, estimated time(s): %.3f\n", found, num,
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	print_pool(&bt);
+	printf("\n");
+
+	printf("Begin deletes half of the keys.\n");
+	start_time = clock();
+	for (i = 0; i < num; i += 2)
+		dbtree_delete(&bt, &dat[i]);
+	dbtree_sync(&bt);
+	end_time = clock();
+	printf("Deleted done, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("The size: %lu, the height: %d\n", DBTREE_SIZE(&bt),
+		DBTREE_HEIGHT(&bt));
+
+	lo = INT_MAX / 4;
+	hi = lo + INT_MAX / 100;
+	dbtree_range_query(&bt, &lo, &hi, &keys);
+	printf("The number of keys between %ld and %ld: %lu\n", lo, hi,
+		SLIST_LENGTH(&keys));
+	slist_clear(&keys);
+	print_pool(&bt);
+
+	dbtree_close(&bt);
+	ALGFREE(dat);
+
+	return 0;
+}
+
+static void
+print_pool(const struct dbtree *bt)
+{
+	printf("Buffer pool: %lu frames, %lu hits, %lu misses, "
+		"%lu pages written\n", bt->pool.nframes, bt->pool.hits,
+		bt->pool.misses, bt->pool.writes);
+}
+
+static int
+kcmp(const void *key1, const void *key2)
+{
+	const long *k1, *k2;
+
+	k1 = (long *)key1;
+	k2 = (long *)key2;
+
+	if (*k1 < *k2)
+		return 1;
+	else if (*k1 == *k2)
+		return 0;
+	else
+		return -1;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -f -n -c -p\n", pname);
+	fprintf(stderr, "-f: The index file, it is created again.\n");
+	fprintf(stderr, "-n: The number of items.\n");
+	fprintf(stderr, "-c: The number of cached pages.\n");
+	fprintf(stderr, "-p: The page size, 0 is 4096.\n");
+	exit(EXIT_FAILURE);
+}
@@ -0,0 +1,741 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "diskbtree.h"
+#include "singlelist.h"
+
+/* Marks the meta page of a B-tree file */
+#define DBTREE_MAGIC	0x45455254424B5344UL
+
+/* The page number of the meta page */
+#define META_PAGE	0
+
+/* the address of key/value I in the leaf node X */
+#define LEAF_KEY(bt, x, i)	\
+	((x)->data + (size_t)(i) * (bt)->keysize)
+#define LEAF_VALUE(bt, x, i)	\
+	((x)->data + (bt)->valoff + (size_t)(i) * (bt)->valsize)
+
+/* the child pages and the address of key I in the internal node X */
+#define CHILDREN(x)		((unsigned long *)(x)->data)
+#define INNER_KEY(bt, x, i)	\
+	((x)->data + (bt)->keyoff + (size_t)(i) * (bt)->keysize)
+
+/* rounds up N to the alignment of a pointer */
+#define ALIGN_PTR(n)	\
+	(((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* fetches/unpins the node of the page PG */
+#define FETCH(bt, pg)	\
+	((struct dbtree_node *)bpool_fetch(&(bt)->pool, (pg)))
+#define UNPIN(bt, pg, dirty)	bpool_unpin(&(bt)->pool, (pg), (dirty))
+
+/* The contents of the meta page */
+struct dbtree_meta {
+	unsigned long magic;		/* DBTREE_MAGIC */
+	unsigned int pagesize;		/* bytes of a page */
+	unsigned int keysize;		/* bytes of the key */
+	unsigned int valsize;		/* bytes of the value */
+	int height;			/* height of the B-tree */
+	unsigned long root;		/* page of the root */
+	unsigned long size;		/* number of key-value pairs */
+	unsigned long freelist;		/* first of the free pages */
+};
+
+/* The results of remove_entry() */
+enum remove_result {NOT_FOUND, REMOVED, UNDERFLOW};
+
+static void set_capacity(struct dbtree *, unsigned int);
+static void write_meta(struct dbtree *);
+static struct dbtree_node * alloc_node(struct dbtree *, unsigned long *);
+static void free_node(struct dbtree *, struct dbtree_node *, unsigned long);
+static inline unsigned int get_entry_index(const struct dbtree *, 
+	const unsigned char *, unsigned int, const void *);
+static inline unsigned int get_child_index(const struct dbtree *,
+	const struct dbtree_node *, const void *);
+static void split_leaf(struct dbtree *, struct dbtree_node *, unsigned long,
+	unsigned long *);
+static void split_inner(struct dbtree *, struct dbtree_node *,
+	unsigned long *);
+static int insert(struct dbtree *, unsigned long, const void *, const void *,
+	int, int *, unsigned long *);
+static enum remove_result remove_entry(struct dbtree *, unsigned long,
+	const void *, int);
+static void fix_child(struct dbtree *, struct dbtree_node *, unsigned int,
+	int);
+static void borrow_left(struct dbtree *, struct dbtree_node *, unsigned int,
+	struct dbtree_node *, struct dbtree_node *, int);
+static void borrow_right(struct dbtree *, struct dbtree_node *, unsigned int,
+	struct dbtree_node *, struct dbtree_node *, int);
+static void merge_right(struct dbtree *, struct dbtree_node *, unsigned int,
+	struct dbtree_node *, struct dbtree_node *, int);
+
+/* 
+ * Opens the B-tree stored in the file PATH, caching NFRAMES pages of 
+ * PGSZ bytes, DBTREE_PAGE_SIZE if PGSZ is 0. An empty B-tree is 
+ * created if the file does not exist, otherwise its page size, 
+ * key size and value size must match.
+ */
+void
+dbtree_open(struct dbtree *bt, const char *path, unsigned int pgsz,
+	unsigned int ksz, unsigned int vsz, unsigned long nframes,
+	algcomp_ft *cmp)
+{
+	struct dbtree_meta *meta;
+	unsigned long pg;
+
+	assert(ksz != 0 && vsz != 0);
+
+	if (pgsz == 0)
+		pgsz = DBTREE_PAGE_SIZE;
+	if (pgsz < sizeof(struct dbtree_meta))
+		errmsg_exit("The page size %u is too small.\n", pgsz);
+	/* a path of the B-tree and the split nodes are pinned together */
+	if (nframes < 16)
+		errmsg_exit("The buffer pool needs at least 16 frames.\n");
+
+	bt->keysize = ksz;
+	bt->valsize = vsz;
+	bt->kcmp = cmp;
+	set_capacity(bt, pgsz);
+
+	bpool_init(&bt->pool, path, pgsz, nframes);
+	if (BPOOL_NPAGES(&bt->pool) == 0) {
+		/* a new file, the meta page and an empty leaf root */
+		bt->freelist = 0;
+		bpool_new(&bt->pool, &pg);
+		UNPIN(bt, pg, true);
+		alloc_node(bt, &bt->root);
+		UNPIN(bt, bt->root, true);
+		bt->height = 0;
+		bt->size = 0;
+		write_meta(bt);
+	} else {
+		meta = (struct dbtree_meta *)bpool_fetch(&bt->pool, META_PAGE);
+		if (meta->magic != DBTREE_MAGIC)
+			errmsg_exit("The file \"%s\" is not a B-tree.\n", path);
+		if (meta->pagesize != pgsz || meta->keysize != ksz ||
+			meta->valsize != vsz) {
+			errmsg_exit("The B-tree file \"%s\" has page size %u, "
+				"key size %u and value size %u.\n", path,
+				meta->pagesize, meta->keysize, meta->valsize);
+		}
+		bt->root = meta->root;
+		bt->height = meta->height;
+		bt->size = meta->size;
+		bt->freelist = meta->freelist;
+		UNPIN(bt, META_PAGE, false);
+	}
+
+	bt->sepkey = algmalloc(ksz);
+}
+
+/* 
+ * Inserts the key-value pair into the B-Tree, 
+ * overwriting the old value with the new value
+ * if the key is already in the B-Tree. 
+ */
+void
+dbtree_put(struct dbtree *bt, const void *key, const void *val)
+{
+	struct dbtree_node *t;
+	unsigned long u, tpg;
+	int added = 0;
+
+	if (key == NULL)
+		errmsg_exit("Argumment key to dbtree_put is null.\n");
+
+	if (!insert(bt, bt->root, key, val, bt->height, &added, &u)) {
+		bt->size += added;
+		return;
+	}
+	bt->size += added;
+
+	/* when overflowing a root, need to split root */
+	t = alloc_node(bt, &tpg);
+	t->sz = 1;
+	CHILDREN(t)[0] = bt->root;
+	CHILDREN(t)[1] = u;
+	memcpy(INNER_KEY(bt, t, 0), bt->sepkey, bt->keysize);
+	UNPIN(bt, tpg, true);
+
+	bt->root = tpg;
+	bt->height++;
+}
+
+/* 
+ * Copies the value associated with the given key into VAL,
+ * returns 0 if the key is not found.
+ */
+int
+dbtree_get(struct dbtree *bt, const void *key, void *val)
+{
+	struct dbtree_node *x;
+	unsigned long pg, next;
+	unsigned int i;
+	int ht, found = 0;
+
+	if (key == NULL)
+		errmsg_exit("Argumment key to dbtree_get is null.\n");
+
+	for (pg = bt->root, ht = bt->height; ht > 0; ht--, pg = next) {
+		x = FETCH(bt, pg);
+		next = CHILDREN(x)[get_child_index(bt, x, key)];
+		UNPIN(bt, pg, false);
+	}
+
+	x = FETCH(bt, pg);
+	i = get_entry_index(bt, x->data, x->sz, key);
+	if (i < x->sz && bt->kcmp(key, LEAF_KEY(bt, x, i)) == 0) {
+		memcpy(val, LEAF_VALUE(bt, x, i), bt->valsize);
+		found = 1;
+	}
+	UNPIN(bt, pg, false);
+
+	return found;
+}
+
+/* Deletes a key-value pair from this B-Tree */
+int
+dbtree_delete(struct dbtree *bt, const void *key)
+{
+	struct dbtree_node *x;
+	unsigned long oldroot;
+
+	if (key == NULL || DBTREE_ISEMPTY(bt))
+		return 0;
+
+	if (remove_entry(bt, bt->root, key, bt->height) == NOT_FOUND)
+		return 0;
+	bt->size--;
+
+	/* the root with one child is replaced by the child */
+	x = FETCH(bt, bt->root);
+	if (bt->height > 0 && x->sz == 0) {
+		oldroot = bt->root;
+		bt->root = CHILDREN(x)[0];
+		bt->height--;
+		free_node(bt, x, oldroot);
+		UNPIN(bt, oldroot, true);
+	} else
+		UNPIN(bt, bt->root, false);
+
+	return 1;
+}
+
+/* 
+ * Copies the keys between lokey and hikey into KEYS, 
+ * walking the linked list of the leaves.
+ */
+void
+dbtree_range_query(struct dbtree *bt, const void *lokey, const void *hikey,
+	struct single_list *keys)
+{
+	struct dbtree_node *x;
+	unsigned long pg, next;
+	unsigned int i;
+	int ht;
+
+	if (lokey == NULL || hikey == NULL)
+		errmsg_exit("Argumment key to dbtree_range_query is null.\n");
+
+	slist_init(keys, bt->keysize, bt->kcmp);
+
+	for (pg = bt->root, ht = bt->height; ht > 0; ht--, pg = next) {
+		x = FETCH(bt, pg);
+		next = CHILDREN(x)[get_child_index(bt, x, lokey)];
+		UNPIN(bt, pg, false);
+	}
+
+	x = FETCH(bt, pg);
+	i = get_entry_index(bt, x->data, x->sz, lokey);
+	for (;;) {
+		for (; i < x->sz; i++) {
+			if (bt->kcmp(hikey, LEAF_KEY(bt, x, i)) == 1) {
+				UNPIN(bt, pg, false);
+				return;
+			}
+			slist_append(keys, LEAF_KEY(bt, x, i));
+		}
+
+		next = x->sibling;
+		UNPIN(bt, pg, false);
+		if ((pg = next) == 0)
+			return;
+		x = FETCH(bt, pg);
+		i = 0;
+	}
+}
+
+/* Writes back the changed pages and forces them to the disk. */
+void
+dbtree_sync(struct dbtree *bt)
+{
+	write_meta(bt);
+	bpool_sync(&bt->pool);
+}
+
+/* Synchronizes and closes the B-tree. */
+void
+dbtree_close(struct dbtree *bt)
+{
+	write_meta(bt);
+	bpool_close(&bt->pool);
+	ALGFREE(bt->sepkey);
+	bt->size = 0;
+	bt->height = 0;
+}
+
+/******************** static function boundary ********************/
+
+/* computes the number of entries of the leaf and internal nodes */
+static void
+set_capacity(struct dbtree *bt, unsigned int pgsz)
+{
+	size_t room, slots;
+
+	room = pgsz - sizeof(struct dbtree_node);
+
+	/* a leaf node: keys, then the values at an aligned offset */
+	slots = room / (bt->keysize + bt->valsize);
+	while (slots > 0 && ALIGN_PTR(slots * bt->keysize) + 
+		slots * bt->valsize > room)
+		slots--;
+	if (slots < 4)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys and %u bytes values.\n", pgsz, bt->keysize,
+			bt->valsize);
+	bt->leafcap = slots - 1;
+	bt->valoff = ALIGN_PTR(slots * bt->keysize);
+
+	/* an internal node: one more child than keys */
+	slots = (room - sizeof(unsigned long)) / 
+		(bt->keysize + sizeof(unsigned long));
+	if (slots < 4)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys.\n", pgsz, bt->keysize);
+	bt->innercap = slots - 1;
+	bt->keyoff = (slots + 1) * sizeof(unsigned long);
+}
+
+/* writes the state of the B-tree to the meta page */
+static void
+write_meta(struct dbtree *bt)
+{
+	struct dbtree_meta *meta;
+
+	meta = (struct dbtree_meta *)bpool_fetch(&bt->pool, META_PAGE);
+	meta->magic = DBTREE_MAGIC;
+	meta->pagesize = bt->pool.pagesize;
+	meta->keysize = bt->keysize;
+	meta->valsize = bt->valsize;
+	meta->height = bt->height;
+	meta->root = bt->root;
+	meta->size = bt->size;
+	meta->freelist = bt->freelist;
+	UNPIN(bt, META_PAGE, true);
+}
+
+/* 
+ * Returns a pinned empty node, a free page is reused first,
+ * otherwise a page is appended to the file.
+ */
+static struct dbtree_node *
+alloc_node(struct dbtree *bt, unsigned long *pg)
+{
+	struct dbtree_node *x;
+
+	if (bt->freelist != 0) {
+		*pg = bt->freelist;
+		x = FETCH(bt, *pg);
+		bt->freelist = x->sibling;
+	} else
+		x = (struct dbtree_node *)bpool_new(&bt->pool, pg);
+
+	x->sz = 0;
+	x->prev = 0;
+	x->sibling = 0;
+	return x;
+}
+
+/* puts the node X of the page PG on the free list */
+static void
+free_node(struct dbtree *bt, struct dbtree_node *x, unsigned long pg)
+{
+	x->sz = 0;
+	x->prev = 0;
+	x->sibling = bt->freelist;
+	bt->freelist = pg;
+}
+
+/* 
+ * Returns the index of the first of N contiguous keys which 
+ * is not less than KEY, N if there is no such key. 
+ */
+static inline unsigned int 
+get_entry_index(const struct dbtree *bt, const unsigned char *keys, 
+	unsigned int n, const void *key)
+{
+	unsigned int lo = 0, hi = n, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (bt->kcmp(key, keys + (size_t)mid * bt->keysize) == -1)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Returns the index of the child of X which holds KEY. */
+static inline unsigned int
+get_child_index(const struct dbtree *bt, const struct dbtree_node *x,
+	const void *key)
+{
+	unsigned int i;
+
+	i = get_entry_index(bt, x->data + bt->keyoff, x->sz, key);
+	if (i < x->sz && bt->kcmp(key, INNER_KEY(bt, x, i)) == 0)
+		i++;
+	return i;
+}
+
+/* 
+ * Split the overflowing leaf H of the page HPG in half, the new
+ * page is stored into TPG and its first key is moved up.
+ */
+static void
+split_leaf(struct dbtree *bt, struct dbtree_node *h, unsigned long hpg,
+	unsigned long *tpg)
+{
+	struct dbtree_node *t, *s;
+	unsigned int m;
+
+	t = alloc_node(bt, tpg);
+	m = h->sz / 2;
+	t->sz = h->sz - m;
+	h->sz = m;
+	memcpy(LEAF_KEY(bt, t, 0), LEAF_KEY(bt, h, m), 
+		(size_t)t->sz * bt->keysize);
+	memcpy(LEAF_VALUE(bt, t, 0), LEAF_VALUE(bt, h, m),
+		(size_t)t->sz * bt->valsize);
+
+	t->sibling = h->sibling;
+	if (h->sibling != 0) {
+		s = FETCH(bt, h->sibling);
+		s->prev = *tpg;
+		UNPIN(bt, h->sibling, true);
+	}
+	h->sibling = *tpg;
+	t->prev = hpg;
+
+	memcpy(bt->sepkey, LEAF_KEY(bt, t, 0), bt->keysize);
+	UNPIN(bt, *tpg, true);
+}
+
+/* 
+ * Split the overflowing internal node H in half, the new 
+ * page is stored into TPG and the middle key is moved up.
+ */
+static void
+split_inner(struct dbtree *bt, struct dbtree_node *h, unsigned long *tpg)
+{
+	struct dbtree_node *t;
+	unsigned int m;
+
+	t = alloc_node(bt, tpg);
+	m = h->sz / 2;
+	t->sz = h->sz - m - 1;
+
+	memcpy(bt->sepkey, INNER_KEY(bt, h, m), bt->keysize);
+	memcpy(INNER_KEY(bt, t, 0), INNER_KEY(bt, h, m + 1), 
+		(size_t)t->sz * bt->keysize);
+	memcpy(CHILDREN(t), CHILDREN(h) + m + 1, 
+		(size_t)(t->sz + 1) * sizeof(unsigned long));
+	h->sz = m;
+
+	UNPIN(bt, *tpg, true);
+}
+
+/* 
+ * Inserts the key-value pair into the subtree rooted at the page PG,
+ * returns 1 if it had splited and the new page is stored into U.
+ */
+static int
+insert(struct dbtree *bt, unsigned long pg, const void *key, const void *val,
+	int ht, int *added, unsigned long *u)
+{
+	struct dbtree_node *h;
+	unsigned long child, v;
+	unsigned int i;
+	int split = 0;
+
+	h = FETCH(bt, pg);
+	if (ht == 0) {
+		i = get_entry_index(bt, h->data, h->sz, key);
+		if (i < h->sz && bt->kcmp(key, LEAF_KEY(bt, h, i)) == 0) {
+			memcpy(LEAF_VALUE(bt, h, i), val, bt->valsize);
+			UNPIN(bt, pg, true);
+			return 0;
+		}
+
+		memmove(LEAF_KEY(bt, h, i + 1), LEAF_KEY(bt, h, i),
+			(size_t)(h->sz - i) * bt->keysize);
+		memmove(LEAF_VALUE(bt, h, i + 1), LEAF_VALUE(bt, h, i),
+			(size_t)(h->sz - i) * bt->valsize);
+		memcpy(LEAF_KEY(bt, h, i), key, bt->keysize);
+		memcpy(LEAF_VALUE(bt, h, i), val, bt->valsize);
+		h->sz++;
+		*added = 1;
+
+		if ((split = h->sz > bt->leafcap))
+			split_leaf(bt, h, pg, u);
+		UNPIN(bt, pg, true);
+		return split;
+	}
+
+	/* internal node */
+	i = get_child_index(bt, h, key);
+	child = CHILDREN(h)[i];
+	if (!insert(bt, child, key, val, ht - 1, added, &v)) {
+		UNPIN(bt, pg, false);
+		return 0;
+	}
+
+	memmove(INNER_KEY(bt, h, i + 1), INNER_KEY(bt, h, i),
+		(size_t)(h->sz - i) * bt->keysize);
+	memmove(CHILDREN(h) + i + 2, CHILDREN(h) + i + 1,
+		(size_t)(h->sz - i) * sizeof(unsigned long));
+	memcpy(INNER_KEY(bt, h, i), bt->sepkey, bt->keysize);
+	CHILDREN(h)[i + 1] = v;
+	h->sz++;
+
+	if ((split = h->sz > bt->innercap))
+		split_inner(bt, h, u);
+	UNPIN(bt, pg, true);
+	return split;
+}
+
+/* 
+ * Removes KEY from the subtree rooted at the page PG, the children 
+ * left less than half full are fixed on the way back.
+ */
+static enum remove_result
+remove_entry(struct dbtree *bt, unsigned long pg, const void *key, int ht)
+{
+	struct dbtree_node *x;
+	enum remove_result r;
+	unsigned int i;
+
+	x = FETCH(bt, pg);
+	if (ht == 0) {
+		i = get_entry_index(bt, x->data, x->sz, key);
+		if (i == x->sz || bt->kcmp(key, LEAF_KEY(bt, x, i)) != 0) {
+			UNPIN(bt, pg, false);
+			return NOT_FOUND;
+		}
+
+		memmove(LEAF_KEY(bt, x, i), LEAF_KEY(bt, x, i + 1),
+			(size_t)(x->sz - i - 1) * bt->keysize);
+		memmove(LEAF_VALUE(bt, x, i), LEAF_VALUE(bt, x, i + 1),
+			(size_t)(x->sz - i - 1) * bt->valsize);
+		x->sz--;
+		r = x->sz < bt->leafcap / 2 ? UNDERFLOW : REMOVED;
+		UNPIN(bt, pg, true);
+		return r;
+	}
+
+	i = get_child_index(bt, x, key);
+	if ((r = remove_entry(bt, CHILDREN(x)[i], key, ht - 1)) != UNDERFLOW) {
+		UNPIN(bt, pg, false);
+		return r;
+	}
+
+	fix_child(bt, x, i, ht - 1);
+	r = x->sz < bt->innercap / 2 ? UNDERFLOW : REMOVED;
+	UNPIN(bt, pg, true);
+	return r;
+}
+
+/* 
+ * Refills the child I of P, which has height HT, 
+ * by borrowing from or merging with its siblings.
+ */
+static void
+fix_child(struct dbtree *bt, struct dbtree_node *p, unsigned int i, int ht)
+{
+	struct dbtree_node *h, *left = NULL, *right = NULL;
+	unsigned long hpg, lpg = 0, rpg = 0;
+	unsigned int minsz;
+
+	minsz = (ht == 0 ? bt->leafcap : bt->innercap) / 2;
+	hpg = CHILDREN(p)[i];
+	h = FETCH(bt, hpg);
+	if (i > 0) {
+		lpg = CHILDREN(p)[i - 1];
+		left = FETCH(bt, lpg);
+	}
+	if (i < p->sz) {
+		rpg = CHILDREN(p)[i + 1];
+		right = FETCH(bt, rpg);
+	}
+
+	if (left != NULL && left->sz > minsz)
+		borrow_left(bt, p, i, h, left, ht);
+	else if (right != NULL && right->sz > minsz)
+		borrow_right(bt, p, i, h, right, ht);
+	else if (left != NULL)
+		merge_right(bt, p, i - 1, left, h, ht);
+	else if (right != NULL)
+		merge_right(bt, p, i, h, right, ht);
+
+	UNPIN(bt, hpg, true);
+	if (left != NULL)
+		UNPIN(bt, lpg, true);
+	if (right != NULL)
+		UNPIN(bt, rpg, true);
+}
+
+/* 
+ * Moves the last entry of LEFT into the child I of P, H. The internal 
+ * nodes rotate the separator key through the parent.
+ */
+static void
+borrow_left(struct dbtree *bt, struct dbtree_node *p, unsigned int i,
+	struct dbtree_node *h, struct dbtree_node *left, int ht)
+{
+	if (ht == 0) {
+		memmove(LEAF_KEY(bt, h, 1), LEAF_KEY(bt, h, 0),
+			(size_t)h->sz * bt->keysize);
+		memmove(LEAF_VALUE(bt, h, 1), LEAF_VALUE(bt, h, 0),
+			(size_t)h->sz * bt->valsize);
+		memcpy(LEAF_KEY(bt, h, 0), LEAF_KEY(bt, left, left->sz - 1),
+			bt->keysize);
+		memcpy(LEAF_VALUE(bt, h, 0), 
+			LEAF_VALUE(bt, left, left->sz - 1), bt->valsize);
+		memcpy(INNER_KEY(bt, p, i - 1), LEAF_KEY(bt, h, 0), 
+			bt->keysize);
+	} else {
+		memmove(INNER_KEY(bt, h, 1), INNER_KEY(bt, h, 0),
+			(size_t)h->sz * bt->keysize);
+		memmove(CHILDREN(h) + 1, CHILDREN(h),
+			(size_t)(h->sz + 1) * sizeof(unsigned long));
+		memcpy(INNER_KEY(bt, h, 0), INNER_KEY(bt, p, i - 1), 
+			bt->keysize);
+		CHILDREN(h)[0] = CHILDREN(left)[left->sz];
+		memcpy(INNER_KEY(bt, p, i - 1), 
+			INNER_KEY(bt, left, left->sz - 1), bt->keysize);
+	}
+	h->sz++;
+	left->sz--;
+}
+
+/* 
+ * Moves the first entry of RIGHT into the child I of P, H. The internal 
+ * nodes rotate the separator key through the parent.
+ */
+static void
+borrow_right(struct dbtree *bt, struct dbtree_node *p, unsigned int i,
+	struct dbtree_node *h, struct dbtree_node *right, int ht)
+{
+	if (ht == 0) {
+		memcpy(LEAF_KEY(bt, h, h->sz), LEAF_KEY(bt, right, 0),
+			bt->keysize);
+		memcpy(LEAF_VALUE(bt, h, h->sz), LEAF_VALUE(bt, right, 0),
+			bt->valsize);
+		memmove(LEAF_KEY(bt, right, 0), LEAF_KEY(bt, right, 1),
+			(size_t)(right->sz - 1) * bt->keysize);
+		memmove(LEAF_VALUE(bt, right, 0), LEAF_VALUE(bt, right, 1),
+			(size_t)(right->sz - 1) * bt->valsize);
+		memcpy(INNER_KEY(bt, p, i), LEAF_KEY(bt, right, 0),
+			bt->keysize);
+	} else {
+		memcpy(INNER_KEY(bt, h, h->sz), INNER_KEY(bt, p, i),
+			bt->keysize);
+		CHILDREN(h)[h->sz + 1] = CHILDREN(right)[0];
+		memcpy(INNER_KEY(bt, p, i), INNER_KEY(bt, right, 0),
+			bt->keysize);
+		memmove(INNER_KEY(bt, right, 0), INNER_KEY(bt, right, 1),
+			(size_t)(right->sz - 1) * bt->keysize);
+		memmove(CHILDREN(right), CHILDREN(right) + 1,
+			(size_t)right->sz * sizeof(unsigned long));
+	}
+	h->sz++;
+	right->sz--;
+}
+
+/* 
+ * Merges RIGHT, the child I + 1 of P, into LEFT, the child I,
+ * the page of RIGHT is freed.
+ */
+static void
+merge_right(struct dbtree *bt, struct dbtree_node *p, unsigned int i,
+	struct dbtree_node *left, struct dbtree_node *right, int ht)
+{
+	struct dbtree_node *s;
+	unsigned long rpg;
+
+	rpg = CHILDREN(p)[i + 1];
+	if (ht == 0) {
+		memcpy(LEAF_KEY(bt, left, left->sz), LEAF_KEY(bt, right, 0),
+			(size_t)right->sz * bt->keysize);
+		memcpy(LEAF_VALUE(bt, left, left->sz), 
+			LEAF_VALUE(bt, right, 0), 
+			(size_t)right->sz * bt->valsize);
+		left->sz += right->sz;
+
+		left->sibling = right->sibling;
+		if (right->sibling != 0) {
+			s = FETCH(bt, right->sibling);
+			s->prev = CHILDREN(p)[i];
+			UNPIN(bt, right->sibling, true);
+		}
+	} else {
+		memcpy(INNER_KEY(bt, left, left->sz), INNER_KEY(bt, p, i),
+			bt->keysize);
+		memcpy(INNER_KEY(bt, left, left->sz + 1), 
+			INNER_KEY(bt, right, 0), 
+			(size_t)right->sz * bt->keysize);
+		memcpy(CHILDREN(left) + left->sz + 1, CHILDREN(right),
+			(size_t)(right->sz + 1) * sizeof(unsigned long));
+		left->sz += right->sz + 1;
+	}
+
+	/* removes the key I and the child I + 1 of P */
+	memmove(INNER_KEY(bt, p, i), INNER_KEY(bt, p, i + 1),
+		(size_t)(p->sz - i - 1) * bt->keysize);
+	memmove(CHILDREN(p) + i + 1, CHILDREN(p) + i + 2,
+		(size_t)(p->sz - i - 1) * sizeof(unsigned long));
+	p->sz--;
+
+	free_node(bt, right, rpg);
+}
@@ -0,0 +1,224 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "prefixbtree.h"
+#include "btree.h"
+#include "singlelist.h"
+#include <getopt.h>
+
+/* the longest generated key */
+#define MAX_URL_LEN		63
+
+static void usage_info(const char *);
+static int strkcmp(const void *, const void *);
+static unsigned long count_leaves(const struct btree *);
+static double elapsed(const struct timespec *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct prefix_btree pbt;
+	struct btree bt;
+	struct single_list keys;
+	struct timespec start;
+	char *urls, *url;
+	long val, *pv = &val;
+	unsigned long i, num = 0, found, leaves, pages, ecnt;
+	unsigned int pgsz = 0;
+	int op;
+	const char *optstr = "n:p:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'n':
+			if (sscanf(optarg, "%lu", &num) != 1)
+				errmsg_exit("Illegal number. -n %s\n", optarg);
+			break;
+		case 'p':
+			if (sscanf(optarg, "%u", &pgsz) != 1)
+				errmsg_exit("Illegal number. -p %s\n", optarg);
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	if (num == 0)
+		errmsg_exit("The number of keys must be greater than 0.\n");
+
+	SET_RANDOM_SEED;
+
+	/* URL-like keys sharing long prefixes */
+	urls = (char *)algmalloc(num * (MAX_URL_LEN + 1));
+	for (i = 0; i < num; i++)
+		snprintf(urls + i * (MAX_URL_LEN + 1), MAX_URL_LEN + 1, 
+			"https://www.site%d.com/dir%d/page%d.html", 
+			rand() % 100, rand() % 50, rand() % 10000);
+
+	pbtree_init(&pbt, pgsz, MAX_URL_LEN, sizeof(long));
+	btree_init(&bt, pgsz, MAX_URL_LEN + 1, sizeof(long), strkcmp);
+
+	printf("Begin inserts %lu URLs into the prefix B-tree.\n", num);
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num; i++) {
+		val = (long)i;
+		pbtree_put(&pbt, urls + i * (MAX_URL_LEN + 1), &val);
+	}
+	printf("Inserted done, estimated time(s): %.3f\n", elapsed(&start));
+
+	printf("Begin inserts them into the B+ tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num; i++) {
+		val = (long)i;
+		btree_put(&bt, urls + i * (MAX_URL_LEN + 1), &val);
+	}
+	printf("Inserted done, estimated time(s): %.3f\n", elapsed(&start));
+	printf("\n");
+
+	pages = PBTREE_PAGES(&pbt);
+	printf("Prefix B-tree: %lu keys, the height: %d, %lu pages "
+		"(%lu KiB), %.1f keys per leaf\n", PBTREE_SIZE(&pbt), 
+		PBTREE_HEIGHT(&pbt), pages, pages * pbt.pagesize / 1024, 
+		(double)PBTREE_SIZE(&pbt) / (double)pbt.leaves);
+	leaves = count_leaves(&bt);
+	printf("B+ tree: %lu keys, the height: %d, %lu leaves (%lu KiB), "
+		"%.1f keys per leaf\n", BTREE_SIZE(&bt), BTREE_HEIGHT(&bt), 
+		leaves, leaves * bt.pagesize / 1024, 
+		(double)BTREE_SIZE(&bt) / (double)leaves);
+	printf("\n");
+
+	printf("Begin queries all URLs in the prefix B-tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0, found = 0; i < num; i++)
+		if (pbtree_get(&pbt, urls + i * (MAX_URL_LEN + 1), &val))
+			found++;
+	printf("Found %lu keys, estimated time(s): %.3f\n", found, 
+		elapsed(&start));
+
+	printf("Begin queries all URLs in the B+ tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num; i++)
+		btree_get(&bt, urls + i * (MAX_URL_LEN + 1), (void **)&pv);
+	printf("Estimated time(s): %.3f\n", elapsed(&start));
+	printf("\n");
+
+	printf("Begin deletes the first half of URLs from the "
+		"prefix B-tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num / 2; i++)
+		pbtree_delete(&pbt, urls + i * (MAX_URL_LEN + 1));
+	printf("Deleted done, estimated time(s): %.3f, %lu pages left\n", 
+		elapsed(&start), PBTREE_PAGES(&pbt));
+
+	printf("Begin deletes them from the B+ tree.\n");
+	timespec_get(&start, TIME_UTC);
+	for (i = 0; i < num / 2; i++)
+		btree_delete(&bt, urls + i * (MAX_URL_LEN + 1));
+	printf("Deleted done, estimated time(s): %.3f\n", elapsed(&start));
+	printf("\n");
+
+	url = urls + (num - 1) * (MAX_URL_LEN + 1);
+	printf("Begin range query [https://www.site1, %s].\n", url);
+	timespec_get(&start, TIME_UTC);
+	pbtree_range_query(&pbt, "https://www.site1", url, &keys);
+	printf("Prefix B-tree keys: %lu, estimated time(s): %.3f\n", 
+		SLIST_LENGTH(&keys), elapsed(&start));
+	ecnt = SLIST_LENGTH(&keys);
+	slist_clear(&keys);
+	timespec_get(&start, TIME_UTC);
+	btree_range_query(&bt, "https://www.site1", url, &keys);
+	printf("B+ tree keys: %lu, estimated time(s): %.3f\n", 
+		SLIST_LENGTH(&keys), elapsed(&start));
+	if (ecnt != SLIST_LENGTH(&keys))
+		printf("The range queries are different.\n");
+	slist_clear(&keys);
+
+	pbtree_clear(&pbt);
+	btree_clear(&bt);
+	ALGFREE(urls);
+
+	return 0;
+}
+
+static double
+elapsed(const struct timespec *start)
+{
+	struct timespec end;
+
+	timespec_get(&end, TIME_UTC);
+	return (double)(end.tv_sec - start->tv_sec) +
+		(double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/* Counts the leaves of the B+ tree by walking its keys. */
+static unsigned long
+count_leaves(const struct btree *bt)
+{
+	struct btree_cursor c;
+	const struct btree_node *leaf = NULL;
+	unsigned long n = 0;
+
+	btree_cursor_init(&c, bt);
+	for (btree_cursor_seek(&c, NULL); BTREE_CURSOR_VALID(&c); 
+		btree_cursor_next(&c)) {
+		if (c.leaf != leaf) {
+			leaf = c.leaf;
+			n++;
+		}
+	}
+	return n;
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -n -p\n", pname);
+	fprintf(stderr, "-n: The number of random URLs.\n");
+	fprintf(stderr, "-p: The page size, 0 for the default.\n");
+	exit(EXIT_FAILURE);
+}
+
+static int
+strkcmp(const void *key1, const void *key2)
+{
+	int c = strcmp((const char *)key1, (const char *)key2);
+
+	return c < 0 ? 1 : (c > 0 ? -1 : 0);
+}
@@ -0,0 +1,941 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "prefixbtree.h"
+#include "singlelist.h"
+
+/* the bytes of a node for the entries */
+#define ROOM(bt)		((bt)->pagesize - sizeof(struct pbtree_node))
+
+/* the offsets of the restart points at the end of the leaf X */
+#define RESTARTS(bt, x)		((x)->data + ROOM(bt) - 2 * (x)->nrestarts)
+
+/* the children and the offsets of the separators of the inner X */
+#define CHILDREN(x)		((struct pbtree_node **)(x)->data)
+#define SEP_OFFSETS(x)		\
+	((x)->data + ((x)->sz + 1) * sizeof(struct pbtree_node *))
+
+/* the longest key, the lengths take at most two bytes */
+#define PBTREE_MAX_KLEN		16383
+
+static inline unsigned int get16(const unsigned char *);
+static inline void put16(unsigned char *, unsigned int);
+static inline unsigned int varint_size(unsigned int);
+static inline unsigned char * put_varint(unsigned char *, unsigned int);
+static inline const unsigned char * get_varint(const unsigned char *,
+	unsigned int *);
+static inline int keycmp(const unsigned char *, unsigned int,
+	const unsigned char *, unsigned int);
+static inline unsigned int common_prefix(const unsigned char *, 
+	unsigned int, const unsigned char *, unsigned int);
+static struct pbtree_node * make_node(struct prefix_btree *, int);
+static void free_node(struct prefix_btree *, struct pbtree_node *);
+static int leaf_search(const struct prefix_btree *, 
+	const struct pbtree_node *, const unsigned char *, unsigned int,
+	const unsigned char **);
+static unsigned int entry_index(const struct pbtree_entry *, unsigned int,
+	const unsigned char *, unsigned int);
+static void mark_restarts(struct pbtree_entry *, unsigned int, 
+	unsigned int);
+static inline void set_lcp(struct pbtree_entry *, unsigned int,
+	unsigned int);
+static unsigned int leaf_size(const struct prefix_btree *, 
+	const struct pbtree_entry *, unsigned int, unsigned int);
+static unsigned int split_point(struct prefix_btree *, unsigned int);
+static void encode_leaf(const struct prefix_btree *, struct pbtree_node *,
+	const struct pbtree_entry *, unsigned int, unsigned int);
+static unsigned int decode_leaf(const struct prefix_btree *, 
+	const struct pbtree_node *, struct pbtree_entry *, unsigned char *);
+static inline const unsigned char * inner_key(const struct pbtree_node *,
+	unsigned int, unsigned int *);
+static unsigned int get_child_index(const struct pbtree_node *,
+	const unsigned char *, unsigned int);
+static unsigned int inner_size(const struct pbtree_entry *, unsigned int);
+static void encode_inner(struct pbtree_node *, const struct pbtree_entry *,
+	struct pbtree_node **, unsigned int);
+static unsigned int decode_inner(const struct pbtree_node *, 
+	struct pbtree_entry *, struct pbtree_node **);
+static void commit_page(struct prefix_btree *, struct pbtree_node *);
+static struct pbtree_node * insert(struct prefix_btree *, 
+	struct pbtree_node *, const unsigned char *, unsigned int, 
+	const void *, int);
+static struct pbtree_node * split_leaf(struct prefix_btree *, 
+	struct pbtree_node *, unsigned int);
+static struct pbtree_node * split_inner(struct prefix_btree *,
+	struct pbtree_node *, unsigned int);
+static int remove_entry(struct prefix_btree *, struct pbtree_node *,
+	const unsigned char *, unsigned int, int);
+static void merge_children(struct prefix_btree *, struct pbtree_node *,
+	unsigned int);
+static void remove_separator(struct prefix_btree *, struct pbtree_node *,
+	unsigned int);
+static void release(struct prefix_btree *, struct pbtree_node *);
+static int strequal(const void *, const void *);
+
+/* 
+ * Initializes an empty prefix B-tree whose nodes are PGSZ bytes, 
+ * a page must hold at least four of the longest entries.
+ */
+void
+pbtree_init(struct prefix_btree *bt, unsigned int pgsz, unsigned int maxklen,
+	unsigned int vsz)
+{
+	unsigned int entmax, leafents, innerents;
+
+	assert(maxklen != 0 && vsz != 0);
+
+	if (pgsz == 0)
+		pgsz = PBTREE_PAGE_SIZE;
+	if (pgsz > 65536 || maxklen > PBTREE_MAX_KLEN)
+		errmsg_exit("The page size must be at most 65536 and the "
+			"keys at most %d bytes.\n", PBTREE_MAX_KLEN);
+	
+	entmax = maxklen + (vsz > sizeof(void *) ? vsz : sizeof(void *)) + 6;
+	if (pgsz <= sizeof(struct pbtree_node) || 
+		pgsz - sizeof(struct pbtree_node) < 4 * entmax)
+		errmsg_exit("The page size %u is too small for %u bytes "
+			"keys and %u bytes values.\n", pgsz, maxklen, vsz);
+
+	bt->pagesize = pgsz;
+	bt->maxklen = maxklen;
+	bt->valsize = vsz;
+	bt->size = 0;
+	bt->height = 0;
+	bt->leaves = 0;
+	bt->inners = 0;
+
+	/* two nodes of the shortest entries and one more */
+	leafents = ROOM(bt) / (2 + vsz) + 1;
+	innerents = ROOM(bt) / (sizeof(void *) + 3) + 1;
+	bt->maxents = 2 * (leafents > innerents ? leafents : innerents) + 2;
+	bt->ents = (struct pbtree_entry *)algmalloc(bt->maxents * 
+		sizeof(struct pbtree_entry));
+	bt->kids = (struct pbtree_node **)algmalloc((bt->maxents + 1) *
+		sizeof(struct pbtree_node *));
+	bt->arena = (unsigned char *)algmalloc((size_t)bt->maxents * maxklen);
+	bt->page = (struct pbtree_node *)algmalloc(pgsz);
+	bt->sepkey = (unsigned char *)algmalloc(maxklen);
+	bt->seplen = 0;
+
+	bt->root = make_node(bt, 1);
+}
+
+/* 
+ * Inserts the key-value pair into the B-tree, 
+ * overwriting the old value if the key is already in it.
+ */
+void
+pbtree_put(struct prefix_btree *bt, const char *key, const void *val)
+{
+	struct pbtree_node *t, *root;
+	struct pbtree_entry sep;
+	size_t len;
+
+	if (key == NULL || val == NULL)
+		errmsg_exit("calls pbtree_put() with null argument.\n");
+	if ((len = strlen(key)) > bt->maxklen)
+		errmsg_exit("The key \"%s\" is longer than %u bytes.\n", 
+			key, bt->maxklen);
+
+	t = insert(bt, bt->root, (const unsigned char *)key, 
+		(unsigned int)len, val, bt->height);
+	if (t == NULL)
+		return;
+
+	/* the root splits, a new root of one separator */
+	root = make_node(bt, 0);
+	sep.key = bt->sepkey;
+	sep.len = bt->seplen;
+	sep.val = NULL;
+	bt->kids[0] = bt->root;
+	bt->kids[1] = t;
+	encode_inner(root, &sep, bt->kids, 1);
+	bt->root = root;
+	bt->height++;
+}
+
+/* Copies the value associated with the given key into VAL. */
+int
+pbtree_get(const struct prefix_btree *bt, const char *key, void *val)
+{
+	const struct pbtree_node *x;
+	const unsigned char *k = (const unsigned char *)key, *vp;
+	unsigned int len;
+	int ht;
+
+	if (key == NULL)
+		errmsg_exit("calls pbtree_get() with null argument.\n");
+
+	len = (unsigned int)strlen(key);
+	for (x = bt->root, ht = bt->height; ht > 0; ht--)
+		x = CHILDREN(x)[get_child_index(x, k, len)];
+
+	if (!leaf_search(bt, x, k, len, &vp))
+		return 0;
+	memcpy(val, vp, bt->valsize);
+	return 1;
+}
+
+/* 
+ * Deletes a key-value pair from the B-tree. A node left less than a 
+ * quarter full is merged with its neighbour if both fit in a page.
+ */
+int
+pbtree_delete(struct prefix_btree *bt, const char *key)
+{
+	struct pbtree_node *oldroot;
+
+	if (key == NULL)
+		errmsg_exit("calls pbtree_delete() with null argument.\n");
+
+	if (!remove_entry(bt, bt->root, (const unsigned char *)key,
+		(unsigned int)strlen(key), bt->height))
+		return 0;
+	bt->size--;
+
+	/* the root with one child is replaced by the child */
+	if (bt->height > 0 && bt->root->sz == 0) {
+		oldroot = bt->root;
+		bt->root = CHILDREN(oldroot)[0];
+		bt->height--;
+		free_node(bt, oldroot);
+	}
+	return 1;
+}
+
+/* 
+ * Copies the keys between lokey and hikey into KEYS, the leaves are 
+ * decoded in order along the sibling links.
+ */
+void
+pbtree_range_query(const struct prefix_btree *bt, const char *lokey,
+	const char *hikey, struct single_list *keys)
+{
+	const struct pbtree_node *x;
+	const unsigned char *p, *lo, *hi;
+	unsigned char *buf;
+	unsigned int lolen, hilen, shared, slen, i;
+	int ht;
+
+	if (lokey == NULL || hikey == NULL)
+		errmsg_exit("calls pbtree_range_query() with null argument.\n");
+
+	slist_init(keys, bt->maxklen + 1, strequal);
+	lo = (const unsigned char *)lokey;
+	hi = (const unsigned char *)hikey;
+	lolen = (unsigned int)strlen(lokey);
+	hilen = (unsigned int)strlen(hikey);
+
+	for (x = bt->root, ht = bt->height; ht > 0; ht--)
+		x = CHILDREN(x)[get_child_index(x, lo, lolen)];
+
+	buf = (unsigned char *)algcalloc(bt->maxklen + 1, 1);
+	for (; x != NULL; x = x->sibling) {
+		for (i = 0, p = x->data; i < x->sz; i++) {
+			p = get_varint(p, &shared);
+			p = get_varint(p, &slen);
+			memcpy(buf + shared, p, slen);
+			buf[shared + slen] = '\0';
+			p += slen + bt->valsize;
+
+			if (keycmp(buf, shared + slen, lo, lolen) < 0)
+				continue;
+			if (keycmp(buf, shared + slen, hi, hilen) > 0)
+				goto done;
+			slist_append(keys, buf);
+		}
+	}
+
+done:
+	ALGFREE(buf);
+}
+
+/* Clears this prefix B-tree */
+void
+pbtree_clear(struct prefix_btree *bt)
+{
+	if (bt->root == NULL)
+		return;
+
+	release(bt, bt->root);
+	ALGFREE(bt->ents);
+	ALGFREE(bt->kids);
+	ALGFREE(bt->arena);
+	ALGFREE(bt->page);
+	ALGFREE(bt->sepkey);
+	bt->root = NULL;
+	bt->size = 0;
+	bt->height = 0;
+}
+
+/******************** static function boundary ********************/
+
+static inline unsigned int
+get16(const unsigned char *p)
+{
+	return (unsigned int)p[0] | (unsigned int)p[1] << 8;
+}
+
+static inline void
+put16(unsigned char *p, unsigned int n)
+{
+	p[0] = (unsigned char)(n & 0xff);
+	p[1] = (unsigned char)(n >> 8);
+}
+
+/* A length below 128 takes one byte, otherwise two. */
+static inline unsigned int
+varint_size(unsigned int n)
+{
+	return n < 128 ? 1 : 2;
+}
+
+static inline unsigned char *
+put_varint(unsigned char *p, unsigned int n)
+{
+	if (n < 128) {
+		*p++ = (unsigned char)n;
+	} else {
+		*p++ = (unsigned char)((n & 127) | 128);
+		*p++ = (unsigned char)(n >> 7);
+	}
+	return p;
+}
+
+static inline const unsigned char *
+get_varint(const unsigned char *p, unsigned int *n)
+{
+	if ((p[0] & 128) == 0) {
+		*n = p[0];
+		return p + 1;
+	}
+	*n = (p[0] & 127) | (unsigned int)p[1] << 7;
+	return p + 2;
+}
+
+/* Compares two keys byte by byte, a prefix is less than the key. */
+static inline int
+keycmp(const unsigned char *a, unsigned int alen, const unsigned char *b,
+	unsigned int blen)
+{
+	int c;
+
+	if ((c = memcmp(a, b, alen < blen ? alen : blen)) != 0)
+		return c;
+	return (alen > blen) - (alen < blen);
+}
+
+static inline unsigned int
+common_prefix(const unsigned char *a, unsigned int alen, 
+	const unsigned char *b, unsigned int blen)
+{
+	unsigned int i, n = alen < blen ? alen : blen;
+
+	for (i = 0; i < n && a[i] == b[i]; i++)
+		;
+	return i;
+}
+
+static struct pbtree_node *
+make_node(struct prefix_btree *bt, int leaf)
+{
+	struct pbtree_node *x;
+
+	x = (struct pbtree_node *)algmalloc(bt->pagesize);
+	x->sz = 0;
+	x->used = 0;
+	x->nrestarts = 0;
+	x->leaf = leaf;
+	x->prev = NULL;
+	x->sibling = NULL;
+	if (leaf)
+		bt->leaves++;
+	else
+		bt->inners++;
+	return x;
+}
+
+static void
+free_node(struct prefix_btree *bt, struct pbtree_node *x)
+{
+	if (x->leaf)
+		bt->leaves--;
+	else
+		bt->inners--;
+	ALGFREE(x);
+}
+
+/* 
+ * Searches the leaf for KEY, returns true if found and sets VP to 
+ * its value. The restart points are searched in binary, then the 
+ * keys after the restart are compared as they are coded: a key 
+ * sharing fewer bytes with its previous key than the previous one 
+ * matched KEY is greater than KEY, sharing more it is less than KEY,
+ * only the rest of a key sharing as many bytes is compared.
+ */
+static int
+leaf_search(const struct prefix_btree *bt, const struct pbtree_node *x,
+	const unsigned char *key, unsigned int klen, const unsigned char **vp)
+{
+	const unsigned char *p, *end, *rs;
+	unsigned int lo = 0, hi = x->nrestarts, mid, shared, slen;
+	unsigned int matched = 0, m;
+
+	rs = RESTARTS(bt, x);
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		p = get_varint(x->data + get16(rs + 2 * mid), &shared);
+		p = get_varint(p, &slen);
+		if (keycmp(p, slen, key, klen) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == 0)
+		return 0;
+
+	end = x->data + x->used;
+	for (p = x->data + get16(rs + 2 * (lo - 1)); p < end; ) {
+		p = get_varint(p, &shared);
+		p = get_varint(p, &slen);
+		if (shared < matched)
+			break;
+		if (shared == matched) {
+			m = common_prefix(p, slen, key + matched, klen - matched);
+			if (m == slen && m == klen - matched) {
+				*vp = p + slen;
+				return 1;
+			}
+			if (m == klen - matched || 
+				(m < slen && p[m] > key[matched + m]))
+				break;
+			matched += m;
+		}
+		p += slen + bt->valsize;
+	}
+	return 0;
+}
+
+/* Returns the index of the first decoded key not less than KEY. */
+static unsigned int
+entry_index(const struct pbtree_entry *ents, unsigned int n, 
+	const unsigned char *key, unsigned int klen)
+{
+	unsigned int lo = 0, hi = n, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (keycmp(ents[mid].key, ents[mid].len, key, klen) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Sets the common prefix of the entry I with its previous one. */
+static inline void
+set_lcp(struct pbtree_entry *ents, unsigned int i, unsigned int n)
+{
+	if (i == 0 || i >= n)
+		return;
+	ents[i].lcp = common_prefix(ents[i - 1].key, ents[i - 1].len,
+		ents[i].key, ents[i].len);
+}
+
+/* Makes every PBTREE_RESTART-th entry from A to B a restart point. */
+static void
+mark_restarts(struct pbtree_entry *ents, unsigned int a, unsigned int b)
+{
+	unsigned int i;
+
+	for (i = a; i < b; i++)
+		ents[i].restart = (i - a) % PBTREE_RESTART == 0;
+}
+
+/* Returns the bytes the entries A to B take coded in a leaf. */
+static unsigned int
+leaf_size(const struct prefix_btree *bt, const struct pbtree_entry *ents,
+	unsigned int a, unsigned int b)
+{
+	unsigned int i, shared, size = 0;
+
+	for (i = a; i < b; i++) {
+		if (i == a || ents[i].restart) {
+			shared = 0;
+			size += 2;
+		} else {
+			shared = ents[i].lcp;
+		}
+		size += varint_size(shared) + varint_size(ents[i].len - 
+			shared) + ents[i].len - shared + bt->valsize;
+	}
+	return size;
+}
+
+/* 
+ * Returns where to split the N decoded entries of a leaf, so that 
+ * both halves take about as many bytes and fit in a page.
+ */
+static unsigned int
+split_point(struct prefix_btree *bt, unsigned int n)
+{
+	unsigned int m, half, size;
+
+	mark_restarts(bt->ents, 0, n);
+	half = leaf_size(bt, bt->ents, 0, n) / 2;
+	for (m = 1, size = 0; m < n - 1; m++) {
+		size += leaf_size(bt, bt->ents, m - 1, m);
+		if (size >= half)
+			break;
+	}
+
+	for (;;) {
+		mark_restarts(bt->ents, 0, m);
+		mark_restarts(bt->ents, m, n);
+		if (m > 1 && leaf_size(bt, bt->ents, 0, m) > ROOM(bt))
+			m--;
+		else if (m < n - 1 && leaf_size(bt, bt->ents, m, n) > ROOM(bt))
+			m++;
+		else
+			return m;
+	}
+}
+
+/* Codes the entries A to B into the leaf DST, A is a restart point. */
+static void
+encode_leaf(const struct prefix_btree *bt, struct pbtree_node *dst,
+	const struct pbtree_entry *ents, unsigned int a, unsigned int b)
+{
+	unsigned char *p, *rs;
+	unsigned int i, r, shared;
+
+	dst->leaf = 1;
+	dst->sz = b - a;
+	for (i = a, dst->nrestarts = 0; i < b; i++)
+		if (i == a || ents[i].restart)
+			dst->nrestarts++;
+
+	rs = RESTARTS(bt, dst);
+	for (i = a, r = 0, p = dst->data; i < b; i++) {
+		if (i == a || ents[i].restart) {
+			put16(rs + 2 * r++, (unsigned int)(p - dst->data));
+			shared = 0;
+		} else {
+			shared = ents[i].lcp;
+		}
+		p = put_varint(p, shared);
+		p = put_varint(p, ents[i].len - shared);
+		memcpy(p, ents[i].key + shared, ents[i].len - shared);
+		p += ents[i].len - shared;
+		memcpy(p, ents[i].val, bt->valsize);
+		p += bt->valsize;
+	}
+	dst->used = (unsigned int)(p - dst->data);
+}
+
+/* 
+ * Decodes the leaf into ENTS, the keys are rebuilt in ARENA, 
+ * the values point into the leaf. Returns the number of entries.
+ * The common prefixes are kept to code the entries back.
+ */
+static unsigned int
+decode_leaf(const struct prefix_btree *bt, const struct pbtree_node *x,
+	struct pbtree_entry *ents, unsigned char *arena)
+{
+	const unsigned char *p, *rs;
+	unsigned int i, r, shared, slen;
+
+	rs = RESTARTS(bt, x);
+	for (i = 0, r = 0, p = x->data; i < x->sz; i++) {
+		ents[i].restart = r < x->nrestarts && 
+			x->data + get16(rs + 2 * r) == p;
+		if (ents[i].restart)
+			r++;
+		p = get_varint(p, &shared);
+		p = get_varint(p, &slen);
+		if (shared > 0)
+			memcpy(arena, ents[i - 1].key, shared);
+		memcpy(arena + shared, p, slen);
+		ents[i].key = arena;
+		ents[i].len = shared + slen;
+		ents[i].val = p + slen;
+		ents[i].lcp = shared;
+		if (ents[i].restart)
+			set_lcp(ents, i, x->sz);
+		arena += shared + slen;
+		p += slen + bt->valsize;
+	}
+	return x->sz;
+}
+
+/* Returns separator I of the internal node and its length in LEN. */
+static inline const unsigned char *
+inner_key(const struct pbtree_node *x, unsigned int i, unsigned int *len)
+{
+	return get_varint(x->data + get16(SEP_OFFSETS(x) + 2 * i), len);
+}
+
+/* 
+ * Returns the index of the child holding KEY in the internal node,
+ * a key equal to a separator goes right.
+ */
+static unsigned int
+get_child_index(const struct pbtree_node *x, const unsigned char *key,
+	unsigned int klen)
+{
+	const unsigned char *sep;
+	unsigned int lo = 0, hi = x->sz, mid, len;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		sep = inner_key(x, mid, &len);
+		if (keycmp(key, klen, sep, len) < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return lo;
+}
+
+/* Returns the bytes an internal node of N separators takes. */
+static unsigned int
+inner_size(const struct pbtree_entry *seps, unsigned int n)
+{
+	unsigned int i, size;
+
+	size = (n + 1) * sizeof(struct pbtree_node *) + 2 * n;
+	for (i = 0; i < n; i++)
+		size += varint_size(seps[i].len) + seps[i].len;
+	return size;
+}
+
+/* Codes N separators and N + 1 children into the internal node DST. */
+static void
+encode_inner(struct pbtree_node *dst, const struct pbtree_entry *seps,
+	struct pbtree_node **kids, unsigned int n)
+{
+	unsigned char *p;
+	unsigned int i;
+
+	dst->leaf = 0;
+	dst->sz = n;
+	dst->nrestarts = 0;
+	memcpy(CHILDREN(dst), kids, (n + 1) * sizeof(struct pbtree_node *));
+	p = SEP_OFFSETS(dst) + 2 * n;
+	for (i = 0; i < n; i++) {
+		put16(SEP_OFFSETS(dst) + 2 * i, (unsigned int)(p - dst->data));
+		p = put_varint(p, seps[i].len);
+		memcpy(p, seps[i].key, seps[i].len);
+		p += seps[i].len;
+	}
+	dst->used = (unsigned int)(p - dst->data);
+}
+
+/* 
+ * Decodes the internal node into SEPS and KIDS, 
+ * the separators point into the node.
+ */
+static unsigned int
+decode_inner(const struct pbtree_node *x, struct pbtree_entry *seps,
+	struct pbtree_node **kids)
+{
+	unsigned int i;
+
+	memcpy(kids, CHILDREN(x), (x->sz + 1) * sizeof(struct pbtree_node *));
+	for (i = 0; i < x->sz; i++) {
+		seps[i].key = inner_key(x, i, &seps[i].len);
+		seps[i].val = NULL;
+	}
+	return x->sz;
+}
+
+/* Copies the page just coded into the node X, keeping its links. */
+static void
+commit_page(struct prefix_btree *bt, struct pbtree_node *x)
+{
+	unsigned int rsz = 2 * bt->page->nrestarts;
+
+	x->sz = bt->page->sz;
+	x->used = bt->page->used;
+	x->nrestarts = bt->page->nrestarts;
+	x->leaf = bt->page->leaf;
+	memcpy(x->data, bt->page->data, x->used);
+	memcpy(x->data + ROOM(bt) - rsz, bt->page->data + ROOM(bt) - rsz, rsz);
+}
+
+/* 
+ * Inserts the key-value pair into the subtree rooted at H of height
+ * HT. Returns the new right node if H splits, the key to move up is
+ * left in bt->sepkey.
+ */
+static struct pbtree_node *
+insert(struct prefix_btree *bt, struct pbtree_node *h, 
+	const unsigned char *key, unsigned int klen, const void *val, int ht)
+{
+	struct pbtree_node *t;
+	const unsigned char *vp;
+	unsigned int i, n;
+
+	if (ht == 0) {
+		if (leaf_search(bt, h, key, klen, &vp)) {
+			memcpy((unsigned char *)vp, val, bt->valsize);
+			return NULL;
+		}
+
+		n = decode_leaf(bt, h, bt->ents, bt->arena);
+		i = entry_index(bt->ents, n, key, klen);
+		memmove(bt->ents + i + 1, bt->ents + i, 
+			(n - i) * sizeof(struct pbtree_entry));
+		bt->ents[i].key = key;
+		bt->ents[i].len = klen;
+		bt->ents[i].val = val;
+		n++;
+		bt->size++;
+		set_lcp(bt->ents, i, n);
+		set_lcp(bt->ents, i + 1, n);
+
+		mark_restarts(bt->ents, 0, n);
+		if (leaf_size(bt, bt->ents, 0, n) <= ROOM(bt)) {
+			encode_leaf(bt, bt->page, bt->ents, 0, n);
+			commit_page(bt, h);
+			return NULL;
+		}
+		return split_leaf(bt, h, n);
+	}
+
+	i = get_child_index(h, key, klen);
+	if ((t = insert(bt, CHILDREN(h)[i], key, klen, val, ht - 1)) == NULL)
+		return NULL;
+
+	/* the separator from the child goes in at I */
+	n = decode_inner(h, bt->ents, bt->kids);
+	memmove(bt->ents + i + 1, bt->ents + i, 
+		(n - i) * sizeof(struct pbtree_entry));
+	memmove(bt->kids + i + 2, bt->kids + i + 1, 
+		(n - i) * sizeof(struct pbtree_node *));
+	bt->ents[i].key = bt->sepkey;
+	bt->ents[i].len = bt->seplen;
+	bt->ents[i].val = NULL;
+	bt->kids[i + 1] = t;
+	n++;
+
+	if (inner_size(bt->ents, n) <= ROOM(bt)) {
+		encode_inner(bt->page, bt->ents, bt->kids, n);
+		commit_page(bt, h);
+		return NULL;
+	}
+	return split_inner(bt, h, n);
+}
+
+/* 
+ * Splits the N decoded entries of the leaf H in two by their coded 
+ * bytes. The separator is the shortest prefix of the first key on 
+ * the right greater than the last key on the left.
+ */
+static struct pbtree_node *
+split_leaf(struct prefix_btree *bt, struct pbtree_node *h, unsigned int n)
+{
+	struct pbtree_node *t;
+	unsigned int m;
+
+	m = split_point(bt, n);
+	t = make_node(bt, 1);
+	encode_leaf(bt, t, bt->ents, m, n);
+	encode_leaf(bt, bt->page, bt->ents, 0, m);
+
+	bt->seplen = common_prefix(bt->ents[m - 1].key, bt->ents[m - 1].len,
+		bt->ents[m].key, bt->ents[m].len) + 1;
+	memcpy(bt->sepkey, bt->ents[m].key, bt->seplen);
+
+	commit_page(bt, h);
+	t->prev = h;
+	t->sibling = h->sibling;
+	if (h->sibling != NULL)
+		h->sibling->prev = t;
+	h->sibling = t;
+	return t;
+}
+
+/* 
+ * Splits the N decoded separators of the internal node H in two by 
+ * their bytes, the separator between the halves moves up.
+ */
+static struct pbtree_node *
+split_inner(struct prefix_btree *bt, struct pbtree_node *h, unsigned int n)
+{
+	struct pbtree_node *t;
+	unsigned int m, half, size;
+
+	half = inner_size(bt->ents, n) / 2;
+	for (m = 1, size = 0; m < n - 2; m++) {
+		size += inner_size(bt->ents + m - 1, 1);
+		if (size >= half)
+			break;
+	}
+
+	t = make_node(bt, 0);
+	encode_inner(t, bt->ents + m + 1, bt->kids + m + 1, n - m - 1);
+	encode_inner(bt->page, bt->ents, bt->kids, m);
+
+	/* the separator may be bt->sepkey itself */
+	bt->seplen = bt->ents[m].len;
+	memmove(bt->sepkey, bt->ents[m].key, bt->seplen);
+
+	commit_page(bt, h);
+	return t;
+}
+
+/* 
+ * Removes the key from the subtree rooted at H of height HT, 
+ * returns true if it is found.
+ */
+static int
+remove_entry(struct prefix_btree *bt, struct pbtree_node *h,
+	const unsigned char *key, unsigned int klen, int ht)
+{
+	struct pbtree_node *x;
+	const unsigned char *vp;
+	unsigned int i, n;
+
+	if (ht == 0) {
+		if (!leaf_search(bt, h, key, klen, &vp))
+			return 0;
+
+		/* 
+		 * The restart points stay where they are, moving them 
+		 * could make the leaf longer than it was.
+		 */
+		n = decode_leaf(bt, h, bt->ents, bt->arena);
+		i = entry_index(bt->ents, n, key, klen);
+		if (bt->ents[i].restart && i + 1 < n)
+			bt->ents[i + 1].restart = 1;
+		memmove(bt->ents + i, bt->ents + i + 1, 
+			(n - i - 1) * sizeof(struct pbtree_entry));
+		set_lcp(bt->ents, i, n - 1);
+		encode_leaf(bt, bt->page, bt->ents, 0, n - 1);
+		commit_page(bt, h);
+		return 1;
+	}
+
+	i = get_child_index(h, key, klen);
+	x = CHILDREN(h)[i];
+	if (!remove_entry(bt, x, key, klen, ht - 1))
+		return 0;
+
+	if (x->used + 2 * x->nrestarts < ROOM(bt) / 4 && h->sz > 0)
+		merge_children(bt, h, i < h->sz ? i : i - 1);
+	return 1;
+}
+
+/* 
+ * Merges the child I + 1 of H into the child I if both fit in one 
+ * page, the separator between internal children is pulled down.
+ */
+static void
+merge_children(struct prefix_btree *bt, struct pbtree_node *h, 
+	unsigned int i)
+{
+	struct pbtree_node *left, *right;
+	unsigned int n, m;
+
+	left = CHILDREN(h)[i];
+	right = CHILDREN(h)[i + 1];
+
+	if (left->leaf) {
+		n = decode_leaf(bt, left, bt->ents, bt->arena);
+		if (n > 0)
+			m = decode_leaf(bt, right, bt->ents + n, 
+				(unsigned char *)bt->ents[n - 1].key + 
+				bt->ents[n - 1].len);
+		else
+			m = decode_leaf(bt, right, bt->ents, bt->arena);
+		set_lcp(bt->ents, n, n + m);
+		mark_restarts(bt->ents, 0, n + m);
+		if (leaf_size(bt, bt->ents, 0, n + m) > ROOM(bt))
+			return;
+
+		encode_leaf(bt, bt->page, bt->ents, 0, n + m);
+		commit_page(bt, left);
+		left->sibling = right->sibling;
+		if (right->sibling != NULL)
+			right->sibling->prev = left;
+	} else {
+		n = decode_inner(left, bt->ents, bt->kids);
+		bt->ents[n].key = inner_key(h, i, &bt->ents[n].len);
+		bt->ents[n].val = NULL;
+		m = decode_inner(right, bt->ents + n + 1, bt->kids + n + 1);
+		if (inner_size(bt->ents, n + m + 1) > ROOM(bt))
+			return;
+
+		encode_inner(bt->page, bt->ents, bt->kids, n + m + 1);
+		commit_page(bt, left);
+	}
+
+	free_node(bt, right);
+	remove_separator(bt, h, i);
+}
+
+/* Removes the separator I and the child I + 1 of the internal node. */
+static void
+remove_separator(struct prefix_btree *bt, struct pbtree_node *h, 
+	unsigned int i)
+{
+	unsigned int n;
+
+	n = decode_inner(h, bt->ents, bt->kids);
+	memmove(bt->ents + i, bt->ents + i + 1, 
+		(n - i - 1) * sizeof(struct pbtree_entry));
+	memmove(bt->kids + i + 1, bt->kids + i + 2, 
+		(n - i - 1) * sizeof(struct pbtree_node *));
+	encode_inner(bt->page, bt->ents, bt->kids, n - 1);
+	commit_page(bt, h);
+}
+
+/* Releases the subtree rooted at X. */
+static void
+release(struct prefix_btree *bt, struct pbtree_node *x)
+{
+	unsigned int i;
+
+	if (!x->leaf)
+		for (i = 0; i <= x->sz; i++)
+			release(bt, CHILDREN(x)[i]);
+	free_node(bt, x);
+}
+
+static int
+strequal(const void *k1, const void *k2)
+{
+	int c = strcmp((const char *)k1, (const char *)k2);
+
+	return c < 0 ? 1 : (c > 0 ? -1 : 0);
+}
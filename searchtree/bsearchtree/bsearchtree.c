@@ -38,30 +38,20 @@
 static struct bstree_node * make_node(const void *, unsigned int);
 static struct bstree_node * put_node(const struct bstree *,
 	struct bstree_node *, const void *);
-static void * get_node(struct bstree_node *, const void *, algcomp_ft *);
-static void preorder_node(const struct bstree_node *, struct single_list *);
-static void release_subtree(struct bstree_node *root, unsigned int);
+static struct bstree_node ** grow_path(struct bstree_node **, 
+	unsigned long *);
+static inline void push_node(struct bstree *, unsigned long *,
+	struct bstree_node *);
+static inline void relink(struct bstree *, unsigned long, 
+	struct bstree_node *, struct bstree_node *);
+static void fix_path(struct bstree *, unsigned long);
+static void remove_node(struct bstree *, unsigned long, struct bstree_node *);
 static struct bstree_node * min_node(struct bstree_node *);
 static struct bstree_node * max_node(struct bstree_node *);
-static struct bstree_node * delete_min(struct bstree_node *, unsigned int);
-static struct bstree_node * delete_min2(struct bstree_node *);
-static struct bstree_node * delete_max(struct bstree_node *, unsigned int);
-static struct bstree_node * delete_node(const struct bstree *,
-	struct bstree_node *, const void *);
-static unsigned long rank_node(const struct bstree_node *, const void *,
-	algcomp_ft *);
-static void * select_node(struct bstree_node *, unsigned long);
-static struct bstree_node * floor_node(struct bstree_node *, const void *,
-	algcomp_ft *);
-static struct bstree_node * ceiling_node(struct bstree_node *, const void *,
-	algcomp_ft *);
-static long leaf_nodes(const struct bstree_node *);
-static void keys_node(const struct bstree_node *, const void *, const void *,
-	algcomp_ft *, struct single_list *);
-static int is_size_consistent(const struct bstree_node *);
+static int is_size_consistent(const struct bstree *);
 static int is_rank_consistent(const struct bstree *);
-static int is_bst(const struct bstree_node *, const void *, const void *,
-	algcomp_ft *);
+static int is_bst(const struct bstree *);
+static void push_path(struct bst_cursor *, struct bstree_node *);
 
 /* Initializes an empty binary search tree */
 void
@@ -70,11 +60,46 @@ bst_init(struct bstree *bst, unsigned int ksize, algcomp_ft *kcmp)
 	bst->root = NULL;
 	bst->keysize = ksize;
 	bst->cmp = kcmp;
+	bst->path = NULL;
+	bst->pathcap = 0;
 }
 
-/* Inserts the specified key into the BST */
+/* 
+ * Inserts the specified key into the BST, the sizes and the heights
+ * of the nodes on the path are fixed from the bottom up.
+ */
 int
 bst_put(struct bstree *bst, const void *key)
+{
+	struct bstree_node *x, *node;
+	unsigned long depth = 0;
+	int cr = 0;
+
+	if (key == NULL)
+		return -1;
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, x->key)) == 0)
+			return 0;
+		push_node(bst, &depth, x);
+		x = cr == 1 ? x->left : x->right;
+	}
+
+	node = make_node(key, bst->keysize);
+	if (depth == 0)
+		bst->root = node;
+	else if (cr == 1)
+		bst->path[depth - 1]->left = node;
+	else
+		bst->path[depth - 1]->right = node;
+	fix_path(bst, depth);
+
+	return 0;
+}
+
+/* Inserts the specified key into the BST by recursion. */
+int
+bst_put_recursive(struct bstree *bst, const void *key)
 {
 	if (key == NULL)
 		return -1;
@@ -86,25 +111,71 @@ bst_put(struct bstree *bst, const void *key)
 void * 
 bst_get(const struct bstree *bst, const void *key)
 {
+	struct bstree_node *x;
+	int cr;
+
 	if (key == NULL)
 		return NULL;
 	
-	return get_node(bst->root, key, bst->cmp);
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, x->key)) == 0)
+			return x->key;
+		x = cr == 1 ? x->left : x->right;
+	}
+	return NULL;
 }
 
-/* Prints all elements using previous order traverse */
+/* 
+ * Prints all elements using previous order traverse, 
+ * the right subtrees not visited yet are kept in a stack.
+ */
 void
 bst_preorder(const struct bstree *bst, struct single_list *keys)
 {
+	struct bstree_node **stack = NULL, *x;
+	unsigned long sp = 0, cap = 0;
+
 	slist_init(keys, 0, bst->cmp);
-	preorder_node(bst->root, keys);
+	for (x = bst->root; x != NULL; ) {
+		slist_append(keys, x->key);
+		if (x->right != NULL) {
+			if (sp == cap)
+				stack = grow_path(stack, &cap);
+			stack[sp++] = x->right;
+		}
+
+		if (x->left != NULL)
+			x = x->left;
+		else
+			x = sp > 0 ? stack[--sp] : NULL;
+	}
+	ALGFREE(stack);
 }
 
-/* Releases this binary search tree */
+/* 
+ * Releases this binary search tree. The left child is rotated up 
+ * until there is none, then the node is freed and its right subtree
+ * is next, so no stack is needed.
+ */
 void
 bst_clear(struct bstree *bst)
 {
-	release_subtree(bst->root, bst->keysize);
+	struct bstree_node *x, *next;
+
+	for (x = bst->root; x != NULL; x = next) {
+		if ((next = x->left) != NULL) {
+			x->left = next->right;
+			next->right = x;
+		} else {
+			next = x->right;
+			if (bst->keysize != 0)
+				ALGFREE(x->key);
+			ALGFREE(x);
+		}
+	}
+	bst->root = NULL;
+	ALGFREE(bst->path);
+	bst->pathcap = 0;
 }
 
 /* Returns the smallest key in the BST */
@@ -125,9 +196,15 @@ bst_max(const struct bstree *bst)
 int
 bst_delete_min(struct bstree *bst)
 {
+	struct bstree_node *x;
+	unsigned long depth = 0;
+
 	if (BST_ISEMPTY(bst))
 		return -1;
-	bst->root = delete_min(bst->root, bst->keysize);
+
+	for (x = bst->root; x->left != NULL; x = x->left)
+		push_node(bst, &depth, x);
+	remove_node(bst, depth, x);
 	return 0;
 }
 
@@ -135,9 +212,15 @@ bst_delete_min(struct bstree *bst)
 int
 bst_delete_max(struct bstree *bst)
 {
+	struct bstree_node *x;
+	unsigned long depth = 0;
+
 	if (BST_ISEMPTY(bst))
 		return -1;
-	bst->root = delete_max(bst->root, bst->keysize);
+
+	for (x = bst->root; x->right != NULL; x = x->right)
+		push_node(bst, &depth, x);
+	remove_node(bst, depth, x);
 	return 0;
 }
 
@@ -145,9 +228,21 @@ bst_delete_max(struct bstree *bst)
 int
 bst_delete(struct bstree *bst, const void *key)
 {
+	struct bstree_node *x;
+	unsigned long depth = 0;
+	int cr;
+
 	if (BST_ISEMPTY(bst))
 		return -1;
-	bst->root = delete_node(bst, bst->root, key);
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, x->key)) == 0)
+			break;
+		push_node(bst, &depth, x);
+		x = cr == 1 ? x->left : x->right;
+	}
+	if (x != NULL)
+		remove_node(bst, depth, x);
 	return 0;
 }
 
@@ -158,7 +253,21 @@ bst_delete(struct bstree *bst, const void *key)
 unsigned long 
 bst_rank(const struct bstree *bst, const void *key)
 {
-	return rank_node(bst->root, key, bst->cmp);
+	struct bstree_node *x;
+	unsigned long rank = 0;
+	int cr;
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, x->key)) == 1) {
+			x = x->left;
+		} else if (cr == -1) {
+			rank += BST_NODE_SIZE(x->left) + 1;
+			x = x->right;
+		} else {
+			return rank + BST_NODE_SIZE(x->left);
+		}
+	}
+	return rank;
 }
 
 /* 
@@ -169,8 +278,23 @@ bst_rank(const struct bstree *bst, const void *key)
 void * 
 bst_select(const struct bstree *bst, unsigned long rank)
 {
-	if (rank < BST_SIZE(bst))
-		return select_node(bst->root, rank);
+	struct bstree_node *x;
+	unsigned long leftsize;
+
+	if (rank >= BST_SIZE(bst))
+		return NULL;
+
+	for (x = bst->root; x != NULL; ) {
+		leftsize = BST_NODE_SIZE(x->left);
+		if (rank < leftsize) {
+			x = x->left;
+		} else if (rank > leftsize) {
+			rank -= leftsize + 1;
+			x = x->right;
+		} else {
+			return x->key;
+		}
+	}
 	return NULL;
 }
 
@@ -181,9 +305,19 @@ bst_select(const struct bstree *bst, unsigned long rank)
 void * 
 bst_floor(const struct bstree *bst, const void *key)
 {
-	struct bstree_node *current;
-	
-	current = floor_node(bst->root, key, bst->cmp);
+	struct bstree_node *x, *current = NULL;
+	int cr;
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, x->key)) == 0)
+			return x->key;
+		if (cr == 1) {
+			x = x->left;
+		} else {
+			current = x;
+			x = x->right;
+		}
+	}
 	/* NULL is the specified key to small. */
 	return current != NULL ? current->key : NULL; 
 }
@@ -195,18 +329,40 @@ bst_floor(const struct bstree *bst, const void *key)
 void * 
 bst_ceiling(const struct bstree *bst, const void *key)
 {
-	struct bstree_node *current;
-	
-	current = ceiling_node(bst->root, key, bst->cmp);
+	struct bstree_node *x, *current = NULL;
+	int cr;
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, x->key)) == 0)
+			return x->key;
+		if (cr == -1) {
+			x = x->right;
+		} else {
+			current = x;
+			x = x->left;
+		}
+	}
 	/* NULL is the specified key to large. */
 	return current != NULL ? current->key: NULL; 
 }
 
-/* Returns the number of leaf nodes */
+/* Returns the number of leaf nodes, every node is visited by a cursor. */
 long
 bst_leaf_nodes(const struct bstree *bst)
 {
-	return leaf_nodes(bst->root);
+	struct bst_cursor c;
+	struct bstree_node *x;
+	long cnt = 0;
+
+	bst_cursor_init(&c, bst);
+	for (bst_cursor_seek(&c, NULL); BST_CURSOR_VALID(&c); 
+		bst_cursor_next(&c)) {
+		x = c.path[c.depth - 1];
+		if (x->left == NULL && x->right == NULL)
+			cnt++;
+	}
+	bst_cursor_clear(&c);
+	return cnt;
 }
 
 /* Breadth-first search traverse. */
@@ -237,13 +393,27 @@ bst_breadth_first(const struct bstree *bst, struct single_list *keys)
 	queue_clear(&qp);
 }
 
-/* Gets all keys in the BST in the given range in ascending order. */
+/* 
+ * Gets all keys in the BST in the given range in ascending order,
+ * a cursor walks from the smallest key not less than lokey.
+ */
 void 
 bst_keys(const struct bstree *bst, const void *lokey, const void *hikey,
 	struct single_list *keys)
 {
+	struct bst_cursor c;
+	void *key;
+
 	slist_init(keys, 0, bst->cmp);
-	keys_node(bst->root, lokey, hikey, bst->cmp, keys);
+	bst_cursor_init(&c, bst);
+	for (bst_cursor_seek(&c, lokey); BST_CURSOR_VALID(&c); 
+		bst_cursor_next(&c)) {
+		key = bst_cursor_key(&c);
+		if (bst->cmp(hikey, key) == 1)
+			break;
+		slist_append(keys, key);
+	}
+	bst_cursor_clear(&c);
 }
 
 /* Check integrity of BST data structure. */
@@ -252,12 +422,12 @@ bst_check(const struct bstree *bst)
 {
 	int flag = 1;
 
-	if (!is_bst(bst->root, NULL, NULL, bst->cmp)) {
+	if (!is_bst(bst)) {
 		printf("Not in symmetric order.\n");
 		flag = 0;
 	}
 	
-	if (!is_size_consistent(bst->root)) {
+	if (!is_size_consistent(bst)) {
 		printf("Subtree counts not consistent.\n");
 		flag = 0;
 	}
@@ -270,6 +440,133 @@ bst_check(const struct bstree *bst)
 	return flag;
 }
 
+/* Initializes a cursor over the keys of the BST, it is not on any key. */
+void
+bst_cursor_init(struct bst_cursor *c, const struct bstree *bst)
+{
+	c->bst = bst;
+	c->depth = 0;
+	c->cap = 0;
+	c->path = NULL;
+}
+
+/* 
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL. The cursor keeps the path 
+ * from the root, cut at the last node where the search went left.
+ */
+void
+bst_cursor_seek(struct bst_cursor *c, const void *key)
+{
+	struct bstree_node *x;
+	unsigned long keep = 0;
+	int cr;
+
+	c->depth = 0;
+	for (x = c->bst->root; x != NULL; ) {
+		push_path(c, x);
+		if (key == NULL)
+			cr = 1;
+		else if ((cr = c->bst->cmp(key, x->key)) == 0) {
+			keep = c->depth;
+			break;
+		}
+
+		if (cr == 1) {
+			keep = c->depth;
+			x = x->left;
+		} else
+			x = x->right;
+	}
+	c->depth = keep;
+}
+
+/* Moves the cursor to the largest key. */
+void
+bst_cursor_last(struct bst_cursor *c)
+{
+	struct bstree_node *x;
+
+	c->depth = 0;
+	for (x = c->bst->root; x != NULL; x = x->right) {
+		push_path(c, x);
+	}
+}
+
+/* 
+ * Moves the cursor to the next key in ascending order, 
+ * returns 0 if there is no next key.
+ */
+int
+bst_cursor_next(struct bst_cursor *c)
+{
+	struct bstree_node *x, *child;
+
+	if (c->depth == 0)
+		return 0;
+
+	/* the smallest key of the right subtree */
+	if ((x = c->path[c->depth - 1]->right) != NULL) {
+		for (; x != NULL; x = x->left) {
+			push_path(c, x);
+		}
+		return 1;
+	}
+
+	/* the nearest ancestor whose left subtree holds the node */
+	do {
+		child = c->path[--c->depth];
+	} while (c->depth > 0 && c->path[c->depth - 1]->right == child);
+
+	return c->depth > 0;
+}
+
+/* 
+ * Moves the cursor to the previous key in ascending order,
+ * returns 0 if there is no previous key.
+ */
+int
+bst_cursor_prev(struct bst_cursor *c)
+{
+	struct bstree_node *x, *child;
+
+	if (c->depth == 0)
+		return 0;
+
+	/* the largest key of the left subtree */
+	if ((x = c->path[c->depth - 1]->left) != NULL) {
+		for (; x != NULL; x = x->right) {
+			push_path(c, x);
+		}
+		return 1;
+	}
+
+	/* the nearest ancestor whose right subtree holds the node */
+	do {
+		child = c->path[--c->depth];
+	} while (c->depth > 0 && c->path[c->depth - 1]->left == child);
+
+	return c->depth > 0;
+}
+
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void *
+bst_cursor_key(const struct bst_cursor *c)
+{
+	if (c->depth == 0)
+		return NULL;
+	return c->path[c->depth - 1]->key;
+}
+
+/* Releases the path of the cursor. */
+void
+bst_cursor_clear(struct bst_cursor *c)
+{
+	ALGFREE(c->path);
+	c->cap = 0;
+	c->depth = 0;
+}
+
 /******************** static function boundary ********************/
 
 /* 
@@ -320,293 +617,132 @@ put_node(const struct bstree *bst, struct bstree_node *node, const void *key)
 	return node;
 }
 
-static void * 
-get_node(struct bstree_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	
-	if (node == NULL)
-		return NULL;
-	
-	cr = kcmp(key, node->key);
-	if (cr == 1)
-		return get_node(node->left, key, kcmp);
-	else if (cr == -1)
-		return get_node(node->right, key, kcmp);
-	else
-		return (node->key);
-}
-
-static void
-preorder_node(const struct bstree_node *root, struct single_list *keys)
+/* 
+ * Makes room for one more node in the PATH of capacity CAP,
+ * the path doubles when it is full.
+ */
+static struct bstree_node **
+grow_path(struct bstree_node **path, unsigned long *cap)
 {
-	if (root != NULL) {
-		slist_append(keys, root->key);
-		preorder_node(root->left, keys);
-		preorder_node(root->right, keys);
+	if (*cap == 0) {
+		*cap = 32;
+		return (struct bstree_node **)algmalloc(*cap * 
+			sizeof(struct bstree_node *));
 	}
+	*cap *= 2;
+	return (struct bstree_node **)algrealloc(path, *cap *
+		sizeof(struct bstree_node *));
 }
 
-static void
-release_subtree(struct bstree_node *root, unsigned int ksize)
-{
-	if (root != NULL) {
-		release_subtree(root->left, ksize);
-		release_subtree(root->right, ksize);
-		if (ksize != 0)
-			ALGFREE(root->key);
-		ALGFREE(root);
-	}
-}
-
-static struct bstree_node *
-min_node(struct bstree_node *node)
-{
-	if (node->left == NULL)
-		return node;
-	else
-		return min_node(node->left);
-}
-
-static struct bstree_node *
-max_node(struct bstree_node *node)
+/* Pushes the node onto the path of an update of the BST. */
+static inline void
+push_node(struct bstree *bst, unsigned long *depth, struct bstree_node *x)
 {
-	if (node->right == NULL)
-		return node;
-	else
-		return max_node(node->right);
+	if (*depth == bst->pathcap)
+		bst->path = grow_path(bst->path, &bst->pathcap);
+	bst->path[(*depth)++] = x;
 }
 
-static struct bstree_node *
-delete_min(struct bstree_node *node, unsigned int ksize)
+/* 
+ * Links the node Y where the node X was, under the last node 
+ * of the first DEPTH nodes of the path.
+ */
+static inline void
+relink(struct bstree *bst, unsigned long depth, struct bstree_node *x,
+	struct bstree_node *y)
 {
-	struct bstree_node *current;
-	
-	if (node->left == NULL) {
-		current = node->right;
-		if (ksize != 0)
-			ALGFREE(node->key);
-		ALGFREE(node);
-		return current;
-	}
-	
-	node->left = delete_min(node->left, ksize);
-	node->size = 1 + BST_NODE_SIZE(node->left) + BST_NODE_SIZE(node->right);
-	node->height = 1 + MAX(BST_HEIGHT_NODE(node->left), 
-		BST_HEIGHT_NODE(node->right));
-	
-	return node;
-}
+	struct bstree_node *parent;
 
-static struct bstree_node *
-delete_min2(struct bstree_node *node)
-{
-	if (node->left == NULL)
-		return node->right;
-	
-	node->left = delete_min2(node->left);
-	node->size = 1 + BST_NODE_SIZE(node->left) + BST_NODE_SIZE(node->right);
-	node->height = 1 + MAX(BST_HEIGHT_NODE(node->left), 
-		BST_HEIGHT_NODE(node->right));
-	
-	return node;
+	if (depth == 0)
+		bst->root = y;
+	else if ((parent = bst->path[depth - 1])->left == x)
+		parent->left = y;
+	else
+		parent->right = y;
 }
 
-static struct bstree_node * 
-delete_max(struct bstree_node *node, unsigned int ksize)
+/* Fixes the sizes and the heights of the first DEPTH nodes of the path. */
+static void
+fix_path(struct bstree *bst, unsigned long depth)
 {
-	struct bstree_node *current;
-	
-	if (node->right == NULL) {
-		current = node->left;
-		if (ksize != 0)
-			ALGFREE(node->key);
-		ALGFREE(node);
-		return current;
-	}
-	
-	node->right = delete_max(node->right, ksize);
-	node->size = 1 + BST_NODE_SIZE(node->left) + BST_NODE_SIZE(node->right);
-	node->height = 1 + MAX(BST_HEIGHT_NODE(node->left), 
-		BST_HEIGHT_NODE(node->right));
-	
-	return node;
-}
+	struct bstree_node *x;
 
-static struct bstree_node * 
-delete_node(const struct bstree *bst, struct bstree_node *node, const void *key)
-{
-	int cr;
-	struct bstree_node *current;
-	
-	if (node == NULL)	/* not found key will be deleted */
-		return NULL;
-	
-	cr = bst->cmp(key, node->key);
-	if (cr == 1)
-		node->left = delete_node(bst, node->left, key);
-	else if (cr == -1)
-		node->right = delete_node(bst, node->right, key);
-	else {
-		if (node->left == NULL) {
-			current = node->right;
-			if (bst->keysize != 0)
-				ALGFREE(node->key);
-			ALGFREE(node);
-			return current;
-		}
-		
-		if (node->right == NULL) {
-			current = node->left;
-			if (bst->keysize != 0)
-				ALGFREE(node->key);
-			ALGFREE(node);
-			return current;
-		}
-		current = node;
-		node = min_node(current->right);
-		node->right = delete_min2(current->right);
-		node->left = current->left;
-		if (bst->keysize != 0)
-			ALGFREE(current->key);
-		ALGFREE(current);
+	while (depth-- > 0) {
+		x = bst->path[depth];
+		x->size = 1 + BST_NODE_SIZE(x->left) + 
+			BST_NODE_SIZE(x->right);
+		x->height = 1 + MAX(BST_HEIGHT_NODE(x->left),
+			BST_HEIGHT_NODE(x->right));
 	}
-	node->size = BST_NODE_SIZE(node->left) + BST_NODE_SIZE(node->right) + 1;
-	node->height = 1 + MAX(BST_HEIGHT_NODE(node->left), 
-		BST_HEIGHT_NODE(node->right));
-	
-	return node;
-}
-
-/* Number of keys in the subtree less than key. */
-static unsigned long 
-rank_node(const struct bstree_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	
-	if (node == NULL)
-		return 0;
-	
-	cr = kcmp(key, node->key);
-	if (cr == 1)
-		return rank_node(node->left, key, kcmp);
-	else if (cr == -1) {
-		return rank_node(node->right, key, kcmp) +
-			BST_NODE_SIZE(node->left) + 1;
-	} else
-		return BST_NODE_SIZE(node->left);
 }
 
 /* 
- * Return element in BST rooted at node of given rank. 
- * Precondition: rank is in legal range.
+ * Removes the node X under the first DEPTH nodes of the path. 
+ * A node of two children is replaced by the smallest node of its 
+ * right subtree, the path goes on down to that node.
  */
-static void * 
-select_node(struct bstree_node *node, unsigned long rank)
-{
-	unsigned long leftsize;
-	
-	if (node == NULL)
-		return NULL;
-
-	leftsize = BST_NODE_SIZE(node->left);
-	if (rank < leftsize)
-		return select_node(node->left, rank);
-	else if (rank > leftsize)
-		return select_node(node->right, rank - leftsize - 1);
-	else
-		return (node->key);
-}
-
-static struct bstree_node * 
-floor_node(struct bstree_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	struct bstree_node *rnode;
-	
-	if (node == NULL)	/* not found to the specified key */
-		return NULL;
-	
-	cr = kcmp(key, node->key);
-	if(cr == 1)
-		return floor_node(node->left, key, kcmp);
-	else if (cr == 0)
-		return node;
-	else {
-		rnode = floor_node(node->right, key, kcmp);
-		if (rnode != NULL)
-			return rnode;
-		else
-			return node;
+static void
+remove_node(struct bstree *bst, unsigned long depth, struct bstree_node *x)
+{
+	struct bstree_node *succ, *parent;
+	unsigned long at;
+
+	if (x->left == NULL || x->right == NULL) {
+		relink(bst, depth, x, x->left != NULL ? x->left : x->right);
+	} else {
+		at = depth;
+		push_node(bst, &depth, x);
+		for (succ = x->right; succ->left != NULL; succ = succ->left)
+			push_node(bst, &depth, succ);
+
+		if ((parent = bst->path[depth - 1]) != x) {
+			parent->left = succ->right;
+			succ->right = x->right;
+		}
+		succ->left = x->left;
+		relink(bst, at, x, succ);
+		bst->path[at] = succ;
 	}
-}
 
-static struct bstree_node * 
-ceiling_node(struct bstree_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	struct bstree_node *lnode;
-	
-	if (node == NULL)
-		return NULL;
-	
-	cr = kcmp(key, node->key);
-	if (cr == 0)
-		return node;
-	else if (cr == -1)
-		return ceiling_node(node->right, key, kcmp);
-	else {
-		lnode = ceiling_node(node->left, key, kcmp);
-		if (lnode != NULL)
-			return lnode;
-		else
-			return node;
-	}
+	if (bst->keysize != 0)
+		ALGFREE(x->key);
+	ALGFREE(x);
+	fix_path(bst, depth);
 }
 
-static long
-leaf_nodes(const struct bstree_node *node)
+static struct bstree_node *
+min_node(struct bstree_node *node)
 {
-	if (node == NULL)
-		return 0;
-	else if (node->left == NULL && node->right == NULL)
-		return 1;
-	else
-		return leaf_nodes(node->left) + leaf_nodes(node->right);
+	while (node->left != NULL)
+		node = node->left;
+	return node;
 }
 
-static void
-keys_node(const struct bstree_node *node, const void *lokey, const void *hikey,
-	algcomp_ft *kcmp, struct single_list *keys)
+static struct bstree_node *
+max_node(struct bstree_node *node)
 {
-	int cmplo, cmphi;
-	
-	if (node == NULL)
-		return;
-	
-	cmplo = kcmp(lokey, node->key);
-	cmphi = kcmp(hikey, node->key);
-
-	if (cmplo == 1)
-		keys_node(node->left, lokey, hikey, kcmp, keys);
-	if ((cmplo == 1 || cmplo == 0) && (cmphi == -1 || cmphi == 0))
-		slist_append(keys, node->key);
-	if (cmphi == -1)
-		keys_node(node->right, lokey, hikey, kcmp, keys);
+	while (node->right != NULL)
+		node = node->right;
+	return node;
 }
 
 /* are the size fields correct? */
 static int 
-is_size_consistent(const struct bstree_node *node)
+is_size_consistent(const struct bstree *bst)
 {
-	if (node == NULL)
-		return 1;	/* treat as empty constraint */
-	if (node->size != BST_NODE_SIZE(node->left) +
-	   BST_NODE_SIZE(node->right) + 1) {
-		return 0;
+	struct bst_cursor c;
+	struct bstree_node *x;
+	int flag = 1;
+
+	bst_cursor_init(&c, bst);
+	for (bst_cursor_seek(&c, NULL); BST_CURSOR_VALID(&c) && flag;
+		bst_cursor_next(&c)) {
+		x = c.path[c.depth - 1];
+		flag = x->size == BST_NODE_SIZE(x->left) + 
+			BST_NODE_SIZE(x->right) + 1;
 	}
-	return is_size_consistent(node->left) &&
-		is_size_consistent(node->right);
+	bst_cursor_clear(&c);
+	return flag;
 }
 
 /* check that ranks are consistent */
@@ -638,21 +774,30 @@ is_rank_consistent(const struct bstree *bst)
 	return 1;
 }
 
-/* 
- * Is the tree rooted at Node a BST with all keys strictly between min and max
- * (if min or max is null, treat as empty constraint).
- */
+/* Are the keys in strictly ascending order in the symmetric order ? */
 static int
-is_bst(const struct bstree_node *node, const void *minkey, const void *maxkey,
-	algcomp_ft *kcmp)
+is_bst(const struct bstree *bst)
 {
-	if (node == NULL)
-		return 1;
-	
-	if (minkey != NULL && kcmp(node->key, minkey) == 1) 
-		return 0;
-	if (maxkey != NULL && kcmp(node->key, maxkey) == -1)
-		return 0;
-	return is_bst(node->left, minkey, node->key, kcmp) &&
-		is_bst(node->right, node->key, maxkey, kcmp);
+	struct bst_cursor c;
+	void *prev = NULL, *key;
+	int flag = 1;
+
+	bst_cursor_init(&c, bst);
+	for (bst_cursor_seek(&c, NULL); BST_CURSOR_VALID(&c) && flag;
+		bst_cursor_next(&c)) {
+		key = bst_cursor_key(&c);
+		flag = prev == NULL || bst->cmp(prev, key) == 1;
+		prev = key;
+	}
+	bst_cursor_clear(&c);
+	return flag;
+}
+
+/* Pushes the node onto the path of the cursor, grows the path if full. */
+static void
+push_path(struct bst_cursor *c, struct bstree_node *x)
+{
+	if (c->depth == c->cap)
+		c->path = grow_path(c->path, &c->cap);
+	c->path[c->depth++] = x;
 }
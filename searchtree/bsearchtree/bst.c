@@ -42,6 +42,8 @@ main(int argc, char *argv[])
 	FILE *fp;
 	struct bstree bst;
 	struct element item, *el, *minel, *maxel;
+	struct bst_cursor cur;
+	unsigned long cnt;
 	clock_t start_time, end_time;
 	char *fname = NULL, *key = NULL, *rand_key = NULL;
 	int rank, len;
@@ -103,6 +105,20 @@ main(int argc, char *argv[])
 		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
 	printf("\n");
 	
+	printf("Begin traverses this BST backwards with a cursor.\n");
+	cnt = 0;
+	start_time = clock();
+	bst_cursor_init(&cur, &bst);
+	for (bst_cursor_last(&cur); BST_CURSOR_VALID(&cur); 
+		bst_cursor_prev(&cur)) {
+		cnt++;
+	}
+	end_time = clock();
+	bst_cursor_clear(&cur);
+	printf("Total elements: %lu, estimated time(s): %.3f\n", cnt,
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("\n");
+	
 	printf("Begin delete the minimum key and the maximum key from "
 		"the BST.\n");
 	start_time = clock();
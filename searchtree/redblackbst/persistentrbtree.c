@@ -0,0 +1,668 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "persistentrbtree.h"
+#include "singlelist.h"
+
+#define PRBT_SIZE_NODE(node)	((node) == NULL ? 0 : (node)->sizecolor >> 1)
+#define PRBT_COLOR(node)	((enum bst_redblack)((node)->sizecolor & 1))
+#define PRBT_ISRED(node)	((node) == NULL ? 0 : PRBT_COLOR(node) == RED)
+
+#define PRBT_SET_COLOR(node, c)	\
+	((node)->sizecolor = ((node)->sizecolor & ~1UL) | (c))
+#define PRBT_FIX_SIZE(node)	\
+	((node)->sizecolor = ((PRBT_SIZE_NODE((node)->left) +	\
+	PRBT_SIZE_NODE((node)->right) + 1) << 1) | ((node)->sizecolor & 1))
+
+/* the bytes stored in the key of a node */
+#define PRBT_KEY_BYTES(t)	\
+	((t)->keysize != 0 ? (t)->keysize : sizeof(void *))
+
+static inline void * node_key(const struct persistent_rbtree *,
+	const struct prbt_node *);
+static struct prbt_node * make_node(struct persistent_rbtree *, 
+	const void *);
+static struct prbt_node * own(struct persistent_rbtree *, 
+	struct prbt_node *);
+static void release_node(struct persistent_rbtree *, struct prbt_node *);
+static struct prbt_node * rotate_left(struct persistent_rbtree *, 
+	struct prbt_node *);
+static struct prbt_node * rotate_right(struct persistent_rbtree *, 
+	struct prbt_node *);
+static void flip_colors(struct persistent_rbtree *, struct prbt_node *);
+static struct prbt_node * balance(struct persistent_rbtree *, 
+	struct prbt_node *);
+static struct prbt_node * move_red_left(struct persistent_rbtree *, 
+	struct prbt_node *);
+static struct prbt_node * move_red_right(struct persistent_rbtree *, 
+	struct prbt_node *);
+static struct prbt_node * put_node(struct persistent_rbtree *, 
+	struct prbt_node *, const void *);
+static struct prbt_node * delete_min_node(struct persistent_rbtree *, 
+	struct prbt_node *);
+static struct prbt_node * delete_node(struct persistent_rbtree *, 
+	struct prbt_node *, const void *);
+static struct prbt_snapshot * begin_update(struct persistent_rbtree *);
+static void publish(struct persistent_rbtree *, struct prbt_snapshot *);
+static void reclaim_retired(struct persistent_rbtree *);
+static int isbst(const struct persistent_rbtree *, const struct prbt_node *,
+	const void *, const void *);
+static int is23(const struct prbt_node *, const struct prbt_node *);
+static int isbal_node(const struct prbt_node *, int);
+static int is_size_consistent(const struct prbt_node *);
+
+/* Initializes an empty persistent Red-Black BST. */
+void
+prbt_init(struct persistent_rbtree *t, unsigned int ksize, algcomp_ft *kcmp)
+{
+	struct prbt_snapshot *s;
+
+	s = (struct prbt_snapshot *)algmalloc(sizeof(struct prbt_snapshot));
+	s->root = NULL;
+	s->version = 0;
+	atomic_init(&s->pins, 0);
+	s->next = NULL;
+
+	atomic_init(&t->current, s);
+	atomic_init(&t->readers, 0);
+	if (pthread_mutex_init(&t->lock, NULL) != 0)
+		errmsg_exit("Initializes the writer lock failure.\n");
+	t->retired = NULL;
+	t->version = 0;
+	t->nodes = 0;
+	t->keysize = ksize;
+	t->cmp = kcmp;
+}
+
+/* 
+ * Inserts the key, the nodes on the path are copied into the new 
+ * version and the other ones are shared with the current version.
+ */
+int
+prbt_put(struct persistent_rbtree *t, const void *key)
+{
+	struct prbt_snapshot *s;
+
+	pthread_mutex_lock(&t->lock);
+	s = atomic_load_explicit(&t->current, memory_order_relaxed);
+	if (prbt_get(t, s, key) != NULL) {
+		pthread_mutex_unlock(&t->lock);
+		return 1;
+	}
+
+	s = begin_update(t);
+	s->root = put_node(t, s->root, key);
+	PRBT_SET_COLOR(s->root, BLACK);
+	publish(t, s);
+	pthread_mutex_unlock(&t->lock);
+
+	return 0;
+}
+
+/* Removes the key, the nodes on the path are copied as prbt_put(). */
+int
+prbt_delete(struct persistent_rbtree *t, const void *key)
+{
+	struct prbt_snapshot *s;
+
+	pthread_mutex_lock(&t->lock);
+	s = atomic_load_explicit(&t->current, memory_order_relaxed);
+	if (prbt_get(t, s, key) == NULL) {
+		pthread_mutex_unlock(&t->lock);
+		return -1;
+	}
+
+	s = begin_update(t);
+	s->root = own(t, s->root);
+	/* if both children of root are black, set root to red */
+	if (!PRBT_ISRED(s->root->left) && !PRBT_ISRED(s->root->right))
+		PRBT_SET_COLOR(s->root, RED);
+	s->root = delete_node(t, s->root, key);
+	if (s->root != NULL)
+		PRBT_SET_COLOR(s->root, BLACK);
+	publish(t, s);
+	pthread_mutex_unlock(&t->lock);
+
+	return 0;
+}
+
+/* 
+ * Pins the current version. The reader stays counted in the readers
+ * until its pin is visible, so a writer seeing no readers knows that 
+ * nobody is about to pin a retired snapshot.
+ */
+const struct prbt_snapshot *
+prbt_pin(struct persistent_rbtree *t)
+{
+	struct prbt_snapshot *s;
+
+	atomic_fetch_add(&t->readers, 1);
+	s = atomic_load(&t->current);
+	atomic_fetch_add(&s->pins, 1);
+	atomic_fetch_sub(&t->readers, 1);
+
+	return s;
+}
+
+/* 
+ * Unpins a snapshot, it only drops the pin. The retired snapshots are
+ * freed by the writers, so the readers never touch the writer lock.
+ */
+void
+prbt_unpin(struct persistent_rbtree *t, const struct prbt_snapshot *s)
+{
+	(void)t;
+	atomic_fetch_sub(&((struct prbt_snapshot *)s)->pins, 1);
+}
+
+/* Returns the key in the snapshot associated with the given key. */
+void *
+prbt_get(const struct persistent_rbtree *t, const struct prbt_snapshot *s,
+	const void *key)
+{
+	const struct prbt_node *x;
+	int cr;
+
+	if (key == NULL)
+		return NULL;
+
+	for (x = s->root; x != NULL; ) {
+		if ((cr = t->cmp(key, node_key(t, x))) == 0)
+			return node_key(t, x);
+		x = cr == 1 ? x->left : x->right;
+	}
+	return NULL;
+}
+
+/* 
+ * Returns all keys in the snapshot in the given range, the nodes 
+ * whose left subtrees are not done are kept in a stack.
+ */
+void
+prbt_keys(const struct persistent_rbtree *t, const struct prbt_snapshot *s,
+	const void *lokey, const void *hikey, struct single_list *keys)
+{
+	const struct prbt_node *stack[PRBT_MAX_DEPTH], *x;
+	int sp = 0;
+
+	slist_init(keys, 0, t->cmp);
+	x = s->root;
+	for (;;) {
+		while (x != NULL) {
+			if (t->cmp(lokey, node_key(t, x)) == -1) {
+				x = x->right;
+			} else {
+				stack[sp++] = x;
+				x = x->left;
+			}
+		}
+		if (sp == 0)
+			break;
+
+		x = stack[--sp];
+		if (t->cmp(hikey, node_key(t, x)) == 1)
+			break;
+		slist_append(keys, node_key(t, x));
+		x = x->right;
+	}
+}
+
+/* Check integrity of the Red-Black tree of the snapshot. */
+int
+prbt_check(const struct persistent_rbtree *t, const struct prbt_snapshot *s)
+{
+	const struct prbt_node *x;
+	int flag = 1, blacks = 0;
+
+	if (!isbst(t, s->root, NULL, NULL)) {
+		printf("Not in symmetric order.\n");
+		flag = 0;
+	}
+
+	if (!is23(s->root, s->root)) {
+		printf("Not a 2-3 tree.\n");
+		flag = 0;
+	}
+
+	/* number of black links on path from root to min */
+	for (x = s->root; x != NULL; x = x->left)
+		if (!PRBT_ISRED(x))
+			blacks++;
+	if (!isbal_node(s->root, blacks)) {
+		printf("Not balanced.\n");
+		flag = 0;
+	}
+
+	if (!is_size_consistent(s->root)) {
+		printf("Subtree counts not consistent.\n");
+		flag = 0;
+	}
+
+	return flag;
+}
+
+/* Frees the retired snapshots that nobody pins. */
+void
+prbt_reclaim(struct persistent_rbtree *t)
+{
+	pthread_mutex_lock(&t->lock);
+	reclaim_retired(t);
+	pthread_mutex_unlock(&t->lock);
+}
+
+/* Releases all versions and the writer lock. */
+void
+prbt_clear(struct persistent_rbtree *t)
+{
+	struct prbt_snapshot *s;
+
+	while ((s = t->retired) != NULL) {
+		t->retired = s->next;
+		release_node(t, s->root);
+		ALGFREE(s);
+	}
+
+	s = atomic_load(&t->current);
+	release_node(t, s->root);
+	ALGFREE(s);
+	atomic_store(&t->current, NULL);
+	pthread_mutex_destroy(&t->lock);
+}
+
+/******************** static function boundary ********************/
+
+/* Returns the key of the node. */
+static inline void *
+node_key(const struct persistent_rbtree *t, const struct prbt_node *node)
+{
+	void *key;
+
+	if (t->keysize != 0)
+		return (void *)node->key;
+	memcpy(&key, node->key, sizeof(void *));
+	return key;
+}
+
+/* Makes a red node of the version being built. */
+static struct prbt_node *
+make_node(struct persistent_rbtree *t, const void *key)
+{
+	struct prbt_node *node;
+
+	node = (struct prbt_node *)algmalloc(sizeof(struct prbt_node) + 
+		PRBT_KEY_BYTES(t));
+	node->left = NULL;
+	node->right = NULL;
+	node->sizecolor = (1UL << 1) | RED;
+	node->version = t->version;
+	node->refs = 1;
+	if (t->keysize != 0)
+		memcpy(node->key, key, t->keysize);
+	else
+		memcpy(node->key, &key, sizeof(void *));
+	t->nodes++;
+
+	return node;
+}
+
+/* 
+ * Returns the node X of the version being built. A node of an older 
+ * version is copied, the copy takes over the reference to X of the 
+ * caller and holds a reference to each child.
+ */
+static struct prbt_node *
+own(struct persistent_rbtree *t, struct prbt_node *x)
+{
+	struct prbt_node *node;
+
+	if (x->version == t->version)
+		return x;
+
+	node = (struct prbt_node *)algmalloc(sizeof(struct prbt_node) + 
+		PRBT_KEY_BYTES(t));
+	memcpy(node, x, sizeof(struct prbt_node) + PRBT_KEY_BYTES(t));
+	node->version = t->version;
+	node->refs = 1;
+	if (node->left != NULL)
+		node->left->refs++;
+	if (node->right != NULL)
+		node->right->refs++;
+	t->nodes++;
+
+	release_node(t, x);
+	return node;
+}
+
+/* 
+ * Drops a reference to the node, it is freed with the references to
+ * its children if it was the last one. The depth of the recursion is 
+ * bounded by the height of a version.
+ */
+static void
+release_node(struct persistent_rbtree *t, struct prbt_node *x)
+{
+	struct prbt_node *left, *right;
+
+	if (x == NULL || --x->refs != 0)
+		return;
+
+	left = x->left;
+	right = x->right;
+	ALGFREE(x);
+	t->nodes--;
+	release_node(t, left);
+	release_node(t, right);
+}
+
+/* Make a right-leaning link lean to the left, HNODE must be owned. */
+static struct prbt_node *
+rotate_left(struct persistent_rbtree *t, struct prbt_node *hnode)
+{
+	struct prbt_node *x;
+
+	x = own(t, hnode->right);
+	hnode->right = x->left;
+	x->left = hnode;
+	x->sizecolor = (hnode->sizecolor & ~1UL) | PRBT_COLOR(hnode);
+	PRBT_SET_COLOR(hnode, RED);
+	PRBT_FIX_SIZE(hnode);
+	return x;
+}
+
+/* Make a left-leaning link lean to the right, HNODE must be owned. */
+static struct prbt_node *
+rotate_right(struct persistent_rbtree *t, struct prbt_node *hnode)
+{
+	struct prbt_node *x;
+
+	x = own(t, hnode->left);
+	hnode->left = x->right;
+	x->right = hnode;
+	x->sizecolor = (hnode->sizecolor & ~1UL) | PRBT_COLOR(hnode);
+	PRBT_SET_COLOR(hnode, RED);
+	PRBT_FIX_SIZE(hnode);
+	return x;
+}
+
+/* Flips the colors of a node and its two children. */
+static void
+flip_colors(struct persistent_rbtree *t, struct prbt_node *hnode)
+{
+	hnode->left = own(t, hnode->left);
+	hnode->right = own(t, hnode->right);
+	hnode->sizecolor ^= 1;
+	hnode->left->sizecolor ^= 1;
+	hnode->right->sizecolor ^= 1;
+}
+
+/* Restores Red-Black tree invariant. */
+static struct prbt_node *
+balance(struct persistent_rbtree *t, struct prbt_node *hnode)
+{
+	if (PRBT_ISRED(hnode->right) && !PRBT_ISRED(hnode->left))
+		hnode = rotate_left(t, hnode);
+	if (PRBT_ISRED(hnode->left) && PRBT_ISRED(hnode->left->left))
+		hnode = rotate_right(t, hnode);
+	if (PRBT_ISRED(hnode->left) && PRBT_ISRED(hnode->right))
+		flip_colors(t, hnode);
+
+	PRBT_FIX_SIZE(hnode);
+	return hnode;
+}
+
+/* 
+ * Assuming that hnode is red and both hnode.left and hnode.left.left
+ * are black, make hnode.left or one of its children red.
+ */
+static struct prbt_node *
+move_red_left(struct persistent_rbtree *t, struct prbt_node *hnode)
+{
+	flip_colors(t, hnode);
+	if (PRBT_ISRED(hnode->right->left)) {
+		hnode->right = rotate_right(t, hnode->right);
+		hnode = rotate_left(t, hnode);
+		flip_colors(t, hnode);
+	}
+	return hnode;
+}
+
+/* 
+ * Assuming that hnode is red and both hnode.right and hnode.right.left
+ * are black, make hnode.right or one of its children red.
+ */
+static struct prbt_node *
+move_red_right(struct persistent_rbtree *t, struct prbt_node *hnode)
+{
+	flip_colors(t, hnode);
+	if (PRBT_ISRED(hnode->left->left)) {
+		hnode = rotate_right(t, hnode);
+		flip_colors(t, hnode);
+	}
+	return hnode;
+}
+
+/* 
+ * Inserts the key into the subtree rooted at HNODE, which is not in it.
+ * The caller's reference to HNODE is taken over, the returned subtree 
+ * root is owned by the version being built.
+ */
+static struct prbt_node *
+put_node(struct persistent_rbtree *t, struct prbt_node *hnode, 
+	const void *key)
+{
+	if (hnode == NULL)
+		return make_node(t, key);
+
+	hnode = own(t, hnode);
+	if (t->cmp(key, node_key(t, hnode)) == 1)
+		hnode->left = put_node(t, hnode->left, key);
+	else
+		hnode->right = put_node(t, hnode->right, key);
+	return balance(t, hnode);
+}
+
+/* Delete the key-value pair with the minimum key rooted at HNODE. */
+static struct prbt_node *
+delete_min_node(struct persistent_rbtree *t, struct prbt_node *hnode)
+{
+	hnode = own(t, hnode);
+	if (hnode->left == NULL) {
+		release_node(t, hnode);
+		return NULL;
+	}
+
+	if (!PRBT_ISRED(hnode->left) && !PRBT_ISRED(hnode->left->left))
+		hnode = move_red_left(t, hnode);
+	hnode->left = delete_min_node(t, hnode->left);
+	return balance(t, hnode);
+}
+
+/* Delete the key-value pair with the given key rooted at HNODE. */
+static struct prbt_node *
+delete_node(struct persistent_rbtree *t, struct prbt_node *hnode, 
+	const void *key)
+{
+	struct prbt_node *x;
+
+	hnode = own(t, hnode);
+	if (t->cmp(key, node_key(t, hnode)) == 1) {
+		if (!PRBT_ISRED(hnode->left) && !PRBT_ISRED(hnode->left->left))
+			hnode = move_red_left(t, hnode);
+		hnode->left = delete_node(t, hnode->left, key);
+	} else {
+		if (PRBT_ISRED(hnode->left))
+			hnode = rotate_right(t, hnode);
+		if (t->cmp(key, node_key(t, hnode)) == 0 && 
+			hnode->right == NULL) {
+			release_node(t, hnode);
+			return NULL;
+		}
+		if (!PRBT_ISRED(hnode->right) && 
+			!PRBT_ISRED(hnode->right->left))
+			hnode = move_red_right(t, hnode);
+		if (t->cmp(key, node_key(t, hnode)) == 0) {
+			for (x = hnode->right; x->left != NULL; x = x->left)
+				;
+			memcpy(hnode->key, x->key, PRBT_KEY_BYTES(t));
+			hnode->right = delete_min_node(t, hnode->right);
+		} else {
+			hnode->right = delete_node(t, hnode->right, key);
+		}
+	}
+	return balance(t, hnode);
+}
+
+/* 
+ * Starts a new version sharing the root of the current one, 
+ * the writer lock is held.
+ */
+static struct prbt_snapshot *
+begin_update(struct persistent_rbtree *t)
+{
+	struct prbt_snapshot *s, *cur;
+
+	cur = atomic_load_explicit(&t->current, memory_order_relaxed);
+	s = (struct prbt_snapshot *)algmalloc(sizeof(struct prbt_snapshot));
+	s->root = cur->root;
+	if (s->root != NULL)
+		s->root->refs++;
+	s->version = ++t->version;
+	atomic_init(&s->pins, 0);
+	s->next = NULL;
+
+	return s;
+}
+
+/* 
+ * Publishes the new version, the old one is retired and 
+ * freed as soon as nobody pins it.
+ */
+static void
+publish(struct persistent_rbtree *t, struct prbt_snapshot *s)
+{
+	struct prbt_snapshot *old;
+
+	old = atomic_exchange(&t->current, s);
+	old->next = t->retired;
+	t->retired = old;
+	reclaim_retired(t);
+}
+
+/* 
+ * Frees the retired snapshots not pinned, the writer lock is held. 
+ * Nothing is freed while a reader is pinning, it may have loaded a
+ * retired snapshot without pinning it yet.
+ */
+static void
+reclaim_retired(struct persistent_rbtree *t)
+{
+	struct prbt_snapshot **pp, *s;
+
+	if (atomic_load(&t->readers) != 0)
+		return;
+
+	for (pp = &t->retired; (s = *pp) != NULL; ) {
+		if (atomic_load(&s->pins) == 0) {
+			*pp = s->next;
+			release_node(t, s->root);
+			ALGFREE(s);
+		} else {
+			pp = &s->next;
+		}
+	}
+}
+
+/* 
+ * Checks if the tree rooted at Note is a BST with all keys strictly 
+ * between minkey and maxkey.
+ */
+static int
+isbst(const struct persistent_rbtree *t, const struct prbt_node *node,
+	const void *minkey, const void *maxkey)
+{
+	void *key;
+
+	if (node == NULL)
+		return 1;	/* empty tree */
+
+	key = node_key(t, node);
+	if (minkey != NULL && t->cmp(key, minkey) == 1)
+		return 0;
+	if (maxkey != NULL && t->cmp(key, maxkey) == -1)
+		return 0;
+	return isbst(t, node->left, minkey, key) &&
+		isbst(t, node->right, key, maxkey);
+}
+
+/* 
+ * Does the tree have no red right links, 
+ * and at most one (left) red links in a row on any path? 
+ */
+static int
+is23(const struct prbt_node *root, const struct prbt_node *node)
+{
+	if (node == NULL)
+		return 1;
+	if (PRBT_ISRED(node->right))
+		return 0;
+	if (root != node && PRBT_ISRED(node) && PRBT_ISRED(node->left))
+		return 0;
+
+	return is23(root, node->left) && is23(root, node->right);
+}
+
+/* 
+ * Does every path from the root to a leaf have 
+ * the given number of black links? 
+ */
+static int
+isbal_node(const struct prbt_node *node, int blacks)
+{
+	if (node == NULL)
+		return blacks == 0;
+	if (!PRBT_ISRED(node))
+		blacks--;
+	return isbal_node(node->left, blacks) &&
+		isbal_node(node->right, blacks);
+}
+
+/* Are the size fields correct? */
+static int
+is_size_consistent(const struct prbt_node *node)
+{
+	if (node == NULL)
+		return 1;
+	if (PRBT_SIZE_NODE(node) != PRBT_SIZE_NODE(node->left) +
+		PRBT_SIZE_NODE(node->right) + 1)
+		return 0;
+	return is_size_consistent(node->left) && 
+		is_size_consistent(node->right);
+}
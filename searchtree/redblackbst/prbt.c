@@ -0,0 +1,226 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "persistentrbtree.h"
+#include "singlelist.h"
+#include <getopt.h>
+
+#define MAX_THREADS	256
+#define GETS_PER_PIN	64	/* lookups done in a pinned snapshot */
+#define SCAN_PERIOD	4096	/* every so many pins scans the snapshot */
+
+struct reader {
+	pthread_t tid;
+	unsigned long seed;
+	unsigned long gets;	/* number of lookups */
+	unsigned long scans;	/* number of snapshots scanned */
+	unsigned long bad;	/* number of inconsistent snapshots */
+};
+
+static unsigned int *keys;	/* the keys in random order */
+static unsigned long nkeys;
+static struct persistent_rbtree prbt;
+static atomic_int done;
+
+static void * reader(void *);
+static unsigned long next_rand(unsigned long *);
+static int kcmp(const void *, const void *);
+static void usage_info(const char *);
+
+int 
+main(int argc, char *argv[])
+{
+	struct reader rs[MAX_THREADS];
+	struct timespec start, end;
+	unsigned long i, gets = 0, scans = 0, bad = 0;
+	int nthreads = 0, t;
+	double secs;
+
+	int op;
+	const char *optstr = "n:t:";
+
+	extern char *optarg;
+	extern int optind;
+
+	if (argc != (int)strlen(optstr) + 1)
+		usage_info(argv[0]);
+	
+	while ((op = getopt(argc, argv, optstr)) != -1) {
+		switch (op) {
+		case 'n':
+			if (sscanf(optarg, "%lu", &nkeys) != 1)
+				errmsg_exit("Illegal number. -n %s\n",
+					optarg);
+			break;
+		case 't':
+			if (sscanf(optarg, "%d", &nthreads) != 1)
+				errmsg_exit("Illegal number. -t %s\n",
+					optarg);
+			break;
+		default:
+			fprintf(stderr, "Parameters error.\n");
+			usage_info(argv[0]);
+		}
+	}
+	
+	if (optind < argc)
+		usage_info(argv[0]);
+	if (nkeys < 2 || nkeys > UINT_MAX)
+		errmsg_exit("The number of keys must be in 2 ~ %u.\n",
+			UINT_MAX);
+	if (nthreads <= 0 || nthreads > MAX_THREADS)
+		errmsg_exit("The number of threads must be in 1 ~ %d.\n",
+			MAX_THREADS);
+	
+	SET_RANDOM_SEED;
+	
+	keys = (unsigned int *)algmalloc(nkeys * sizeof(int));
+	for (i = 0; i < nkeys; i++)
+		keys[i] = (unsigned int)i;
+	shuffle_uint_array(keys, (unsigned int)nkeys);
+
+	prbt_init(&prbt, sizeof(int), kcmp);
+	atomic_init(&done, 0);
+
+	printf("Inserts and then deletes %lu keys, %d readers pin the "
+		"snapshots meanwhile.\n", nkeys, nthreads);
+	timespec_get(&start, TIME_UTC);
+	for (t = 0; t < nthreads; t++) {
+		rs[t].seed = (unsigned long)rand() * 2654435761UL + 1;
+		rs[t].gets = rs[t].scans = rs[t].bad = 0;
+		if (pthread_create(&rs[t].tid, NULL, reader, &rs[t]) != 0)
+			errmsg_exit("Creates thread failure.\n");
+	}
+
+	for (i = 0; i < nkeys; i++)
+		prbt_put(&prbt, &keys[i]);
+	printf("Inserted done, versions: %lu, nodes alive: %lu\n",
+		prbt.version, PRBT_NODES(&prbt));
+	for (i = 0; i < nkeys; i++)
+		prbt_delete(&prbt, &keys[i]);
+
+	atomic_store(&done, 1);
+	for (t = 0; t < nthreads; t++) {
+		pthread_join(rs[t].tid, NULL);
+		gets += rs[t].gets;
+		scans += rs[t].scans;
+		bad += rs[t].bad;
+	}
+	timespec_get(&end, TIME_UTC);
+	secs = (double)(end.tv_sec - start.tv_sec) +
+		(double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("Deleted done, versions: %lu, nodes alive: %lu\n",
+		prbt.version, PRBT_NODES(&prbt));
+	prbt_reclaim(&prbt);
+	printf("Reclaimed done, nodes alive: %lu\n", PRBT_NODES(&prbt));
+	printf("Updates: %.3f Mops/s, lookups: %.3f Mops/s\n",
+		2.0 * (double)nkeys / secs / 1e6, (double)gets / secs / 1e6);
+	printf("Snapshots scanned: %lu, inconsistent: %lu\n", scans, bad);
+	printf("Estimated time(s): %.3f\n", secs);
+
+	prbt_clear(&prbt);
+	ALGFREE(keys);
+
+	return 0;
+}
+
+/* 
+ * Looks up the random keys in pinned snapshots, some of them are 
+ * scanned and must hold as many keys as their sizes in order.
+ */
+static void *
+reader(void *arg)
+{
+	struct reader *r = (struct reader *)arg;
+	const struct prbt_snapshot *s;
+	struct single_list keyset;
+	struct slist_node *nptr;
+	unsigned int lo = 0, hi = (unsigned int)nkeys, *k;
+	long prev;
+	unsigned long pins, n;
+	int i;
+
+	for (pins = 0; !atomic_load(&done); pins++) {
+		s = prbt_pin(&prbt);
+		for (i = 0; i < GETS_PER_PIN; i++) {
+			prbt_get(&prbt, s, &keys[next_rand(&r->seed) % nkeys]);
+			r->gets++;
+		}
+
+		if (pins % SCAN_PERIOD == 0) {
+			prbt_keys(&prbt, s, &lo, &hi, &keyset);
+			n = 0;
+			prev = -1;
+			SLIST_FOREACH(&keyset, nptr, unsigned int, k) {
+				if ((long)*k <= prev)
+					break;
+				prev = (long)*k;
+				n++;
+			}
+			if (n != PRBT_SIZE(s) || SLIST_LENGTH(&keyset) != n)
+				r->bad++;
+			slist_clear(&keyset);
+			r->scans++;
+		}
+		prbt_unpin(&prbt, s);
+	}
+
+	return NULL;
+}
+
+/* The xorshift64 generator, one state per thread. */
+static unsigned long
+next_rand(unsigned long *s)
+{
+	*s ^= *s << 13;
+	*s ^= *s >> 7;
+	*s ^= *s << 17;
+	return *s;
+}
+
+static int
+kcmp(const void *key1, const void *key2)
+{
+	unsigned int a = *(const unsigned int *)key1;
+	unsigned int b = *(const unsigned int *)key2;
+
+	return a < b ? 1 : (a == b ? 0 : -1);
+}
+
+static void
+usage_info(const char *pname)
+{
+	fprintf(stderr, "Usage: %s -n -t\n", pname);
+	fprintf(stderr, "-n: The number of keys.\n");
+	fprintf(stderr, "-t: The number of reader threads.\n");
+	exit(EXIT_FAILURE);
+}
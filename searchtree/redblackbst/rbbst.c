@@ -44,6 +44,8 @@ main(int argc, char *argv[])
 	struct rbtree bst;
 	struct element item, *el, *minel, *maxel;
 	struct single_list els;
+	struct rbbst_cursor cur;
+	unsigned long cnt;
 	clock_t start_time, end_time;
 	char *fname = NULL, *key = NULL, *rand_key = NULL;
 	int rank, len;
@@ -117,6 +119,19 @@ main(int argc, char *argv[])
 	slist_clear(&els);
 	printf("\n");
 	
+	printf("Begin traverses this Red-Black Tree backwards with a cursor.\n");
+	cnt = 0;
+	start_time = clock();
+	rbbst_cursor_init(&cur, &bst);
+	for (rbbst_cursor_last(&cur); RBBST_CURSOR_VALID(&cur); 
+		rbbst_cursor_prev(&cur)) {
+		cnt++;
+	}
+	end_time = clock();
+	printf("Total elements: %lu, estimated time(s): %.3f\n", cnt,
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("\n");
+	
 	printf("Begin delete the minimum key and the maximum key from "
 		"the Red-Black BST...\n");
 	start_time = clock();
@@ -31,63 +31,91 @@
  */
 #include "redblackbst.h"
 #include "singlelist.h"
+#include "bloomfilter.h"
 
-#define RBBST_SIZE_NODE(node)	((node) == NULL ? 0 : (node)->size)
-#define RBBST_ISRED(node)	((node) == NULL ? 0 : (node)->color == RED)
-#define RBBST_HEIGHT_NODE(node)	((node) == NULL ? (-1) : (node)->height)
+/* Bytes of a block of nodes allocated by the tree pool */
+#define RBBST_BLOCK_SIZE	65536
+
+#define RBBST_SIZE_NODE(node)	((node) == NULL ? 0 : (node)->sizecolor >> 1)
+#define RBBST_COLOR(node)	((enum bst_redblack)((node)->sizecolor & 1))
+#define RBBST_ISRED(node)	((node) == NULL ? 0 : RBBST_COLOR(node) == RED)
+
+/* Sets the color or the subtrees count of node, keeping the other one */
+#define RBBST_SET_COLOR(node, c)	\
+	((node)->sizecolor = ((node)->sizecolor & ~1UL) | (c))
+#define RBBST_SET_SIZE(node, n)		\
+	((node)->sizecolor = ((unsigned long)(n) << 1) | ((node)->sizecolor & 1))
+
+/* Bytes of the inline key, a pointer if the tree holds the caller's keys */
+#define RBBST_KEY_BYTES(bst)	\
+	((bst)->keysize != 0 ? (bst)->keysize : sizeof(void *))
+
+/* What an iterative deletion removes */
+#define DELETE_KEY		0
+#define DELETE_MIN		1
+#define DELETE_MAX		2
 
 /* Flips the colors of node and its two children */
 #define FLIP_COLORS(node)	do {					\
 	if (node != NULL) {						\
-		node->color = !node->color;				\
+		node->sizecolor ^= 1;					\
 		if (node->left != NULL)					\
-			node->left->color = !node->left->color;		\
+			node->left->sizecolor ^= 1;			\
 		if (node->right != NULL)				\
-			node->right->color = !node->right->color;	\
+			node->right->sizecolor ^= 1;			\
 	}								\
 } while (0)
 
-static void * get_node(struct rbtree_node *, const void *, algcomp_ft *);
-static struct rbtree_node * make_node(const void *, unsigned int);
+static inline void * node_key(const struct rbtree *,
+	const struct rbtree_node *);
+static struct rbtree_node * alloc_node(struct rbtree *);
+static inline void free_node(struct rbtree *, struct rbtree_node *);
+static void * get_node(const struct rbtree *, const void *);
+static struct rbtree_node * make_node(struct rbtree *, const void *);
 static inline struct rbtree_node * rotate_right(struct rbtree_node *);
 static inline struct rbtree_node * rotate_left(struct rbtree_node *);
 static inline struct rbtree_node * balance(struct rbtree_node *);
-static struct rbtree_node * put_node(const struct rbtree *,
-	struct rbtree_node *, const void *);
-static void release_subtree(struct rbtree_node *, unsigned int);
-static void preorder_nodes(struct rbtree_node *, struct single_list *);
+static struct rbtree_node * put_node(struct rbtree *, struct rbtree_node *,
+	const void *);
+static void guard_keys(const struct rbtree *, struct bloom_filter *);
 static struct rbtree_node * min_node(struct rbtree_node *);
 static struct rbtree_node * max_node(struct rbtree_node *);
 static struct rbtree_node * move_red_left(struct rbtree_node *);
 static struct rbtree_node * move_red_right(struct rbtree_node *);
-static struct rbtree_node * delete_min_node(struct rbtree_node *, unsigned int);
-static struct rbtree_node * delete_max_node(struct rbtree_node *, unsigned int);
-static struct rbtree_node * delete_node(const struct rbtree *,
-	struct rbtree_node *, const void *);
-static int isbst(const struct rbtree_node *, const void *, const void *,
-	algcomp_ft *);
+static void remove_node(struct rbtree *, const void *, int);
+static int isbst(const struct rbtree *, const struct rbtree_node *,
+	const void *, const void *);
 static int is23(const struct rbtree_node *, const struct rbtree_node *);
 static inline int isbal_node(const struct rbtree_node *node, int blacks);
 static int isbalanced(const struct rbtree_node *);
 static int is_size_consistent(const struct rbtree_node *);
 static int is_rank_consistent(const struct rbtree *);
-static struct rbtree_node * floor_node(struct rbtree_node *, const void *,
-	algcomp_ft *);
-static struct rbtree_node * ceiling_node(struct rbtree_node *, const void *,
-	algcomp_ft *);
-static unsigned long rank_node(const struct rbtree_node *, const void *,
-	algcomp_ft *);
-static void * select_node(struct rbtree_node *, unsigned long);
-static void keys_range(const struct rbtree_node *, const void *, const void *,
-	algcomp_ft *, struct single_list *);
+static inline const void * sorted_key(const void *, unsigned long,
+			unsigned int);
+static struct rbtree_node * build_subtree(struct rbtree *, const void *,
+			unsigned long, unsigned long, int);
 
 /* Initializes an empty Red-Black binary search tree. */
 void
 rbbst_init(struct rbtree *bst, unsigned int ksize, algcomp_ft *kcmp)
 {
+	size_t nsize;
+
 	bst->root = NULL;
 	bst->keysize = ksize;
 	bst->cmp = kcmp;
+	bst->guard = NULL;
+
+	/* keeps the inline keys aligned as the pointers */
+	nsize = sizeof(struct rbtree_node) + RBBST_KEY_BYTES(bst);
+	nsize = (nsize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	if (nsize > RBBST_BLOCK_SIZE - sizeof(void *))
+		errmsg_exit("The key size %u is too large.\n", ksize);
+	bst->nodesize = (unsigned int)nsize;
+	bst->blocks = NULL;
+	bst->freed = NULL;
+	bst->avail = NULL;
+	bst->navail = 0;
 }
 
 /* Returns item associated with the given key. */
@@ -96,35 +124,172 @@ rbbst_get(const struct rbtree *bst, const void *key)
 {
 	if (key == NULL)
 		return NULL;
-	return get_node(bst->root, key, bst->cmp);
+	if (bst->guard != NULL && !bloom_contains(bst->guard, key))
+		return NULL;
+	return get_node(bst, key);
 }
 
-/* Inserts the specified key into the Red-Black BST. */
+/* 
+ * Attaches a Bloom filter as the guard of rbbst_get(), 
+ * all keys in the Red-Black BST are added into it.
+ * The deleted keys stay in the filter, which only 
+ * makes it less selective. The filter must hash what the 
+ * comparator compares, returns -1 if it has no hash function.
+ */
+int
+rbbst_set_guard(struct rbtree *bst, struct bloom_filter *bf)
+{
+	if (bf != NULL && bf->hash == NULL)
+		return -1;
+
+	bst->guard = bf;
+	if (bf != NULL)
+		guard_keys(bst, bf);
+	return 0;
+}
+
+/* 
+ * Inserts the specified key into the Red-Black BST. The path from 
+ * the root is kept in an array, its nodes are balanced from the 
+ * bottom up as the recursion would do on its way back.
+ */
 int
 rbbst_put(struct rbtree *bst, const void *key)
+{
+	struct rbtree_node *path[RBBST_CURSOR_DEPTH], *x;
+	unsigned char left[RBBST_CURSOR_DEPTH];
+	int depth = 0, cr;
+
+	if (key == NULL)
+		return -1;
+
+	for (x = bst->root; x != NULL; depth++) {
+		if ((cr = bst->cmp(key, node_key(bst, x))) == 0)
+			return 0;
+		path[depth] = x;
+		left[depth] = cr == 1;
+		x = cr == 1 ? x->left : x->right;
+	}
+
+	for (x = make_node(bst, key); depth-- > 0; x = balance(path[depth])) {
+		if (left[depth])
+			path[depth]->left = x;
+		else
+			path[depth]->right = x;
+	}
+	bst->root = x;
+	RBBST_SET_COLOR(bst->root, BLACK);
+	if (bst->guard != NULL)
+		bloom_add(bst->guard, key);
+	return 0;
+}
+
+/* Inserts the specified key into the Red-Black BST by recursion. */
+int
+rbbst_put_recursive(struct rbtree *bst, const void *key)
 {
 	if (key == NULL)
 		return -1;
 	bst->root = put_node(bst, bst->root, key);
-	bst->root->color = BLACK;
+	RBBST_SET_COLOR(bst->root, BLACK);
+	if (bst->guard != NULL)
+		bloom_add(bst->guard, key);
 	return 0;
 }
 
-/* Release the Red-Black tree */
+/* 
+ * Builds the Red-Black BST from N keys in strictly ascending order, 
+ * in O(N) time. KEYS is an array of N keys of the key size, or of 
+ * N pointers if the tree holds the caller's keys. The tree must be 
+ * empty. It is a perfect 2-3 tree of black height floor(lg(N + 1)),
+ * the keys that do not fit are red left children at the bottom.
+ */
 void
-rbbst_clear(struct rbtree *bst)
+rbbst_build_sorted(struct rbtree *bst, const void *keys, unsigned long n)
 {
+	unsigned long i;
+	int h;
+
 	if (!RBBST_ISEMPTY(bst))
-		release_subtree(bst->root, bst->keysize);
+		errmsg_exit("calls rbbst_build_sorted() with a non-empty "
+			"tree.\n");
+	if (n == 0)
+		return;
+	if (keys == NULL)
+		errmsg_exit("calls rbbst_build_sorted() with null argument.\n");
+
+	for (i = 1; i < n; i++)
+		if (bst->cmp(sorted_key(keys, i - 1, bst->keysize), 
+			sorted_key(keys, i, bst->keysize)) != 1)
+			errmsg_exit("The keys are not in strictly ascending "
+				"order at %lu.\n", i);
+
+	for (h = 0; (2UL << h) - 1 <= n; h++)
+		;
+	bst->root = build_subtree(bst, keys, 0, n, h);
+	if (bst->guard != NULL)
+		guard_keys(bst, bst->guard);
+}
+
+/* 
+ * Release the Red-Black tree, the blocks of the 
+ * node pool are freed and the tree is empty again.
+ */
+void
+rbbst_clear(struct rbtree *bst)
+{
+	void *blk;
+
+	while ((blk = bst->blocks) != NULL) {
+		bst->blocks = *(void **)blk;
+		ALGFREE(blk);
+	}
+	bst->root = NULL;
+	bst->freed = NULL;
+	bst->avail = NULL;
+	bst->navail = 0;
+}
+
+/* 
+ * Returns the height of the Red-Black tree, it is computed 
+ * by a traversal since the nodes do not keep it. The path 
+ * of a cursor is as long as the depth of its node.
+ */
+long
+rbbst_height(const struct rbtree *bst)
+{
+	struct rbbst_cursor c;
+	long height = -1;
+
+	rbbst_cursor_init(&c, bst);
+	for (rbbst_cursor_seek(&c, NULL); RBBST_CURSOR_VALID(&c); 
+		rbbst_cursor_next(&c)) {
+		height = MAX(height, (long)c.depth - 1);
+	}
+	return height;
 }
 
-/* Preorder traverse. */
+/* 
+ * Preorder traverse, the right subtrees not visited yet 
+ * are kept in a stack no deeper than the tree.
+ */
 void 
 rbbst_preorder(const struct rbtree *bst, struct single_list *keys)
 {
+	struct rbtree_node *stack[RBBST_CURSOR_DEPTH], *x;
+	int sp = 0;
+
 	slist_init(keys, 0, bst->cmp);
-	if (!RBBST_ISEMPTY(bst))
-		preorder_nodes(bst->root, keys);
+	for (x = bst->root; x != NULL; ) {
+		slist_append(keys, node_key(bst, x));
+		if (x->right != NULL)
+			stack[sp++] = x->right;
+
+		if (x->left != NULL)
+			x = x->left;
+		else
+			x = sp > 0 ? stack[--sp] : NULL;
+	}
 }
 
 /* Returns the smallest key in the Red-Black BST. */
@@ -133,7 +298,7 @@ rbbst_min(const struct rbtree *bst)
 {
 	if (RBBST_ISEMPTY(bst))
 		return NULL;
-	return (min_node(bst->root)->key);
+	return node_key(bst, min_node(bst->root));
 }
 
 /* Returns the largest key in the Red-Black BST. */
@@ -142,7 +307,7 @@ rbbst_max(const struct rbtree *bst)
 {
 	if (RBBST_ISEMPTY(bst))
 		return NULL;
-	return (max_node(bst->root)->key);
+	return node_key(bst, max_node(bst->root));
 }
 
 /* Remove the smallest key from this Red-Black BST. */
@@ -151,15 +316,7 @@ rbbst_delete_min(struct rbtree *bst)
 {
 	if (RBBST_ISEMPTY(bst))
 		return -1;
-	
-	/* if both children of root are black, set root to red. */
-	if (!RBBST_ISRED(bst->root->left) && !RBBST_ISRED(bst->root->right))
-		bst->root->color = RED;
-	
-	bst->root = delete_min_node(bst->root, bst->keysize);
-	if (!RBBST_ISEMPTY(bst))
-		bst->root->color = BLACK;
-
+	remove_node(bst, NULL, DELETE_MIN);
 	return 0;
 }
 
@@ -171,15 +328,7 @@ rbbst_delete_max(struct rbtree *bst)
 {
 	if (RBBST_ISEMPTY(bst))
 		return -1;
-	
-	/* if both children of root are black, set root to red. */
-	if (!RBBST_ISRED(bst->root->left) && !RBBST_ISRED(bst->root->right))
-		bst->root->color = RED;
-	
-	bst->root = delete_max_node(bst->root, bst->keysize);
-	if (!RBBST_ISEMPTY(bst))
-		bst->root->color = BLACK;
-
+	remove_node(bst, NULL, DELETE_MAX);
 	return 0;
 }
 
@@ -193,13 +342,7 @@ rbbst_delete(struct rbtree *bst, const void *key)
 	if (rbbst_get(bst, key) == NULL)
 		return -2;
 	
-	if (!RBBST_ISRED(bst->root->left) && !RBBST_ISRED(bst->root->right))
-		bst->root->color = RED;
-	bst->root = delete_node(bst, bst->root, key);
-	
-	if (!RBBST_ISEMPTY(bst))
-		bst->root->color = BLACK;
-	
+	remove_node(bst, key, DELETE_KEY);
 	return 0;
 }
 
@@ -209,7 +352,7 @@ rbbst_check(const struct rbtree *bst)
 {
 	int flag = 1;
 	
-	if (!isbst(bst->root, NULL, NULL, bst->cmp)) {
+	if (!isbst(bst, bst->root, NULL, NULL)) {
 		printf("Not in symmetric order.\n");
 		flag = 0;
 	}
@@ -241,29 +384,63 @@ rbbst_check(const struct rbtree *bst)
 void * 
 rbbst_floor(const struct rbtree *bst, const void *key)
 {
-	struct rbtree_node *current;
-	
-	current = floor_node(bst->root, key, bst->cmp);
+	struct rbtree_node *x, *current = NULL;
+	int cr;
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, node_key(bst, x))) == 0)
+			return node_key(bst, x);
+		if (cr == 1) {
+			x = x->left;
+		} else {
+			current = x;
+			x = x->right;
+		}
+	}
 	/* NULL is the specified key to small. */
-	return (current == NULL ? NULL : current->key);	
+	return (current == NULL ? NULL : node_key(bst, current));
 }
 
 /* Returns the smallest key in the Red-Black greater than or equal to Key. */
 void * 
 rbbst_ceiling(const struct rbtree *bst, const void *key)
 {
-	struct rbtree_node *current;
-	
-	current = ceiling_node(bst->root, key, bst->cmp);
+	struct rbtree_node *x, *current = NULL;
+	int cr;
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, node_key(bst, x))) == 0)
+			return node_key(bst, x);
+		if (cr == -1) {
+			x = x->right;
+		} else {
+			current = x;
+			x = x->left;
+		}
+	}
 	/* NULL is the specified key to large. */
-	return (current == NULL ? NULL : current->key);
+	return (current == NULL ? NULL : node_key(bst, current));
 }
 
 /* Return the number of keys in the Red-Black BST strictly less than Key. */
 unsigned long 
 rbbst_rank(const struct rbtree *bst, const void *key)
 {
-	return rank_node(bst->root, key, bst->cmp);
+	struct rbtree_node *x;
+	unsigned long rank = 0;
+	int cr;
+
+	for (x = bst->root; x != NULL; ) {
+		if ((cr = bst->cmp(key, node_key(bst, x))) == 1) {
+			x = x->left;
+		} else if (cr == -1) {
+			rank += 1 + RBBST_SIZE_NODE(x->left);
+			x = x->right;
+		} else {
+			return rank + RBBST_SIZE_NODE(x->left);
+		}
+	}
+	return rank;
 }
 
 /* 
@@ -275,43 +452,239 @@ rbbst_rank(const struct rbtree *bst, const void *key)
 void * 
 rbbst_select(const struct rbtree *bst, unsigned long rank)
 {
-	if(rank < RBBST_SIZE(bst))
-		return select_node(bst->root, rank);
+	struct rbtree_node *x;
+	unsigned long leftsize;
+
+	if (rank >= RBBST_SIZE(bst))
+		return NULL;
+
+	for (x = bst->root; x != NULL; ) {
+		leftsize = RBBST_SIZE_NODE(x->left);
+		if (rank < leftsize) {
+			x = x->left;
+		} else if (rank > leftsize) {
+			rank -= leftsize + 1;
+			x = x->right;
+		} else {
+			return node_key(bst, x);
+		}
+	}
 	return NULL;
 }
 
 /* 
- * Returns all keys in the Red-Black BST in the given range in ascending order.
+ * Returns all keys in the Red-Black BST in the given range in ascending 
+ * order, a cursor walks from the smallest key not less than lokey.
  */
 void
 rbbst_keys(const struct rbtree *bst, const void *lokey, const void *hikey,
 		struct single_list *keys)
 {
+	struct rbbst_cursor c;
+	void *key;
+
 	slist_init(keys, 0, bst->cmp);
-	keys_range(bst->root, lokey, hikey, bst->cmp, keys);
+	rbbst_cursor_init(&c, bst);
+	for (rbbst_cursor_seek(&c, lokey); RBBST_CURSOR_VALID(&c); 
+		rbbst_cursor_next(&c)) {
+		key = rbbst_cursor_key(&c);
+		if (bst->cmp(hikey, key) == 1)
+			break;
+		slist_append(keys, key);
+	}
+}
+
+/* Initializes a cursor over the keys of the Red-Black BST, not on any key. */
+void
+rbbst_cursor_init(struct rbbst_cursor *c, const struct rbtree *bst)
+{
+	c->bst = bst;
+	c->depth = 0;
+}
+
+/* 
+ * Moves the cursor to the smallest key greater than or equal to KEY,
+ * or to the smallest key if KEY is NULL. The cursor keeps the path 
+ * from the root, cut at the last node where the search went left.
+ */
+void
+rbbst_cursor_seek(struct rbbst_cursor *c, const void *key)
+{
+	struct rbtree_node *x;
+	int keep = 0;
+	int cr;
+
+	c->depth = 0;
+	for (x = c->bst->root; x != NULL; ) {
+		c->path[c->depth++] = x;
+		if (key == NULL)
+			cr = 1;
+		else if ((cr = c->bst->cmp(key, node_key(c->bst, x))) == 0) {
+			keep = c->depth;
+			break;
+		}
+
+		if (cr == 1) {
+			keep = c->depth;
+			x = x->left;
+		} else
+			x = x->right;
+	}
+	c->depth = keep;
+}
+
+/* Moves the cursor to the largest key. */
+void
+rbbst_cursor_last(struct rbbst_cursor *c)
+{
+	struct rbtree_node *x;
+
+	c->depth = 0;
+	for (x = c->bst->root; x != NULL; x = x->right) {
+		c->path[c->depth++] = x;
+	}
+}
+
+/* 
+ * Moves the cursor to the next key in ascending order, 
+ * returns 0 if there is no next key.
+ */
+int
+rbbst_cursor_next(struct rbbst_cursor *c)
+{
+	struct rbtree_node *x, *child;
+
+	if (c->depth == 0)
+		return 0;
+
+	/* the smallest key of the right subtree */
+	if ((x = c->path[c->depth - 1]->right) != NULL) {
+		for (; x != NULL; x = x->left) {
+			c->path[c->depth++] = x;
+		}
+		return 1;
+	}
+
+	/* the nearest ancestor whose left subtree holds the node */
+	do {
+		child = c->path[--c->depth];
+	} while (c->depth > 0 && c->path[c->depth - 1]->right == child);
+
+	return c->depth > 0;
+}
+
+/* 
+ * Moves the cursor to the previous key in ascending order,
+ * returns 0 if there is no previous key.
+ */
+int
+rbbst_cursor_prev(struct rbbst_cursor *c)
+{
+	struct rbtree_node *x, *child;
+
+	if (c->depth == 0)
+		return 0;
+
+	/* the largest key of the left subtree */
+	if ((x = c->path[c->depth - 1]->left) != NULL) {
+		for (; x != NULL; x = x->right) {
+			c->path[c->depth++] = x;
+		}
+		return 1;
+	}
+
+	/* the nearest ancestor whose right subtree holds the node */
+	do {
+		child = c->path[--c->depth];
+	} while (c->depth > 0 && c->path[c->depth - 1]->left == child);
+
+	return c->depth > 0;
+}
+
+/* Returns the key under the cursor, NULL if it is not on any key. */
+void *
+rbbst_cursor_key(const struct rbbst_cursor *c)
+{
+	if (c->depth == 0)
+		return NULL;
+	return node_key(c->bst, c->path[c->depth - 1]);
 }
 
 /******************** static function boundary ********************/
 
 /* 
- * The Key with the given key in subtree rooted at node;
+ * The key of the node, it is inline or 
+ * the caller's pointer stored inline.
+ */
+static inline void *
+node_key(const struct rbtree *bst, const struct rbtree_node *node)
+{
+	void *key;
+
+	if (bst->keysize != 0)
+		return (void *)node->key;
+	memcpy(&key, node->key, sizeof(void *));
+	return key;
+}
+
+/* 
+ * Takes a node from the pool, a deleted node is reused first,
+ * otherwise it is cut from the last block.
+ */
+static struct rbtree_node *
+alloc_node(struct rbtree *bst)
+{
+	struct rbtree_node *node;
+	void *blk;
+
+	if ((node = bst->freed) != NULL) {
+		bst->freed = node->left;
+		return node;
+	}
+
+	if (bst->navail == 0) {
+		/* the first word of a block links the blocks */
+		blk = algmalloc(RBBST_BLOCK_SIZE);
+		*(void **)blk = bst->blocks;
+		bst->blocks = blk;
+		bst->avail = (char *)blk + sizeof(void *);
+		bst->navail = (RBBST_BLOCK_SIZE - sizeof(void *)) /
+			bst->nodesize;
+	}
+
+	node = (struct rbtree_node *)bst->avail;
+	bst->avail += bst->nodesize;
+	bst->navail--;
+	return node;
+}
+
+/* Gives the node back to the pool. */
+static inline void
+free_node(struct rbtree *bst, struct rbtree_node *node)
+{
+	node->left = bst->freed;
+	bst->freed = node;
+}
+
+/* 
+ * The Key with the given key in the tree;
  * if null no search key.
  */
 static void * 
-get_node(struct rbtree_node *node, const void *key, algcomp_ft *kcmp)
+get_node(const struct rbtree *bst, const void *key)
 {
 	int cr;
 	struct rbtree_node *proot;
 	
-	proot = node;
+	proot = bst->root;
 	while (proot != NULL) {
-		cr = kcmp(key, proot->key);
+		cr = bst->cmp(key, node_key(bst, proot));
 		if (cr == 1)
 			proot = proot->left;
 		else if (cr == -1)
 			proot = proot->right;
 		else
-			return (proot->key);
+			return node_key(bst, proot);
 	}
 	return NULL;
 }
@@ -321,26 +694,76 @@ get_node(struct rbtree_node *node, const void *key, algcomp_ft *kcmp)
  * the specified key-value pair. 
  */
 static struct rbtree_node * 
-make_node(const void *key, unsigned int ksize)
+make_node(struct rbtree *bst, const void *key)
 {
 	struct rbtree_node *current;
 	
-	current = (struct rbtree_node *)algmalloc(sizeof(struct rbtree_node));
+	current = alloc_node(bst);
 	
-	if (ksize != 0) {
-		current->key = algmalloc(ksize);
-		memcpy(current->key, key, ksize);
-	} else
-		current->key = (void *)key;
+	if (bst->keysize != 0)
+		memcpy(current->key, key, bst->keysize);
+	else
+		memcpy(current->key, &key, sizeof(void *));
 	current->left = NULL;
 	current->right = NULL;
-	current->color = RED;	/* default red link */
-	current->size = 1;
-	current->height = 0;
+	current->sizecolor = (1UL << 1) | RED;	/* default red link */
 	
 	return current;
 }
 
+/* Returns the key I of the sorted keys. */
+static inline const void *
+sorted_key(const void *keys, unsigned long i, unsigned int ksize)
+{
+	if (ksize != 0)
+		return (const char *)keys + i * ksize;
+	return ((const void * const *)keys)[i];
+}
+
+/* 
+ * Builds a subtree of black height H from the N keys starting at LO,
+ * where 2^H - 1 <= N <= 2^(H + 1) - 2. The root is a 2-node with two 
+ * subtrees of black height H - 1 while the keys fit, otherwise 
+ * a 3-node, a black node with a red left child and three subtrees.
+ */
+static struct rbtree_node *
+build_subtree(struct rbtree *bst, const void *keys, unsigned long lo,
+	unsigned long n, int h)
+{
+	struct rbtree_node *node, *red;
+	unsigned long mn, a, b, c;
+
+	if (n == 0)
+		return NULL;
+
+	mn = (1UL << (h - 1)) - 1;
+	if (n <= 4 * mn + 1) {
+		a = (n - 1) / 2;
+		node = make_node(bst, sorted_key(keys, lo + a, bst->keysize));
+		node->left = build_subtree(bst, keys, lo, a, h - 1);
+		node->right = build_subtree(bst, keys, lo + a + 1, 
+			n - 1 - a, h - 1);
+	} else {
+		a = (n - 2) / 3;
+		b = (n - 2 - a) / 2;
+		c = n - 2 - a - b;
+		red = make_node(bst, sorted_key(keys, lo + a, bst->keysize));
+		red->left = build_subtree(bst, keys, lo, a, h - 1);
+		red->right = build_subtree(bst, keys, lo + a + 1, b, h - 1);
+		RBBST_SET_SIZE(red, 1 + a + b);
+
+		node = make_node(bst, sorted_key(keys, lo + a + 1 + b, 
+			bst->keysize));
+		node->left = red;
+		node->right = build_subtree(bst, keys, lo + a + b + 2, c, 
+			h - 1);
+	}
+
+	node->sizecolor = (n << 1) | BLACK;
+
+	return node;
+}
+
 /* Make a left-leaning link lean to the right */
 static inline struct rbtree_node * 
 rotate_right(struct rbtree_node *hnode)
@@ -352,19 +775,12 @@ rotate_right(struct rbtree_node *hnode)
 	lnode = hnode->left;
 	hnode->left = lnode->right;
 	lnode->right = hnode;
-	lnode->color = hnode->color;	/* update color */
-	hnode->color = RED;
-	lnode->size = hnode->size;	/* update size */
+	/* low node takes the color and the size of high node */
+	lnode->sizecolor = hnode->sizecolor;
 	
-	/* update the size of high node. */
-	hnode->size = RBBST_SIZE_NODE(hnode->left) +
-		RBBST_SIZE_NODE(hnode->right) + 1;
-	
-	/* update the height of high node and low node */
-	hnode->height = 1 + MAX(RBBST_HEIGHT_NODE(hnode->left),
-		RBBST_HEIGHT_NODE(hnode->right));
-	lnode->height = 1 + MAX(RBBST_HEIGHT_NODE(lnode->left),
-		RBBST_HEIGHT_NODE(lnode->right));
+	/* update the size of high node, now it is red. */
+	hnode->sizecolor = ((RBBST_SIZE_NODE(hnode->left) +
+		RBBST_SIZE_NODE(hnode->right) + 1) << 1) | RED;
 	
 	return lnode;	/* now this is a left high node */
 }
@@ -380,19 +796,12 @@ rotate_left(struct rbtree_node *hnode)
 	lnode = hnode->right;
 	hnode->right = lnode->left;
 	lnode->left = hnode;
-	lnode->color = hnode->color;	/* update color */
-	hnode->color = RED;
-	lnode->size = hnode->size;	/* update size */
-	
-	/* update the size of high node. */
-	hnode->size = RBBST_SIZE_NODE(hnode->left) +
-		RBBST_SIZE_NODE(hnode->right) + 1;
+	/* low node takes the color and the size of high node */
+	lnode->sizecolor = hnode->sizecolor;
 	
-	/* update the height of high node and low node */
-	hnode->height = 1 + MAX(RBBST_HEIGHT_NODE(hnode->left),
-		RBBST_HEIGHT_NODE(hnode->right));
-	lnode->height = 1 + MAX(RBBST_HEIGHT_NODE(lnode->left),
-		RBBST_HEIGHT_NODE(lnode->right));
+	/* update the size of high node, now it is red. */
+	hnode->sizecolor = ((RBBST_SIZE_NODE(hnode->left) +
+		RBBST_SIZE_NODE(hnode->right) + 1) << 1) | RED;
 	
 	return lnode;	/* now this is a right high node */
 }
@@ -408,24 +817,22 @@ balance(struct rbtree_node *hnode)
 	if (RBBST_ISRED(hnode->left) && RBBST_ISRED(hnode->right))
 		FLIP_COLORS(hnode);
 	
-	hnode->size = RBBST_SIZE_NODE(hnode->left) +
-		RBBST_SIZE_NODE(hnode->right) + 1;
-	hnode->height = 1 + MAX(RBBST_HEIGHT_NODE(hnode->left),
-		RBBST_HEIGHT_NODE(hnode->right));
+	RBBST_SET_SIZE(hnode, RBBST_SIZE_NODE(hnode->left) +
+		RBBST_SIZE_NODE(hnode->right) + 1);
 	
 	return hnode;
 }
 
 /* Insert the key-value pair in the subtree rooted as hnode. */
 static struct rbtree_node * 
-put_node(const struct rbtree *bst, struct rbtree_node *hnode, const void *key)
+put_node(struct rbtree *bst, struct rbtree_node *hnode, const void *key)
 {
 	int cr;
 	
 	if (hnode == NULL)
-		return make_node(key, bst->keysize);
+		return make_node(bst, key);
 	
-	cr = bst->cmp(key, hnode->key);
+	cr = bst->cmp(key, node_key(bst, hnode));
 	if (cr == 1)
 		hnode->left = put_node(bst, hnode->left, key);
 	else if (cr == -1)
@@ -436,25 +843,16 @@ put_node(const struct rbtree *bst, struct rbtree_node *hnode, const void *key)
 	return balance(hnode);
 }
 
-static void 
-release_subtree(struct rbtree_node *root, unsigned int ksize)
-{
-	if (root != NULL) {
-		release_subtree(root->left, ksize);
-		release_subtree(root->right, ksize);
-		if (ksize != 0)
-			ALGFREE(root->key);
-		ALGFREE(root);
-	}
-}
-
+/* Adds all keys of the tree into the Bloom filter. */
 static void
-preorder_nodes(struct rbtree_node *root, struct single_list *keys)
+guard_keys(const struct rbtree *bst, struct bloom_filter *bf)
 {
-	if (root != NULL) {
-		slist_append(keys, root->key);
-		preorder_nodes(root->left, keys);
-		preorder_nodes(root->right, keys);
+	struct rbbst_cursor c;
+
+	rbbst_cursor_init(&c, bst);
+	for (rbbst_cursor_seek(&c, NULL); RBBST_CURSOR_VALID(&c); 
+		rbbst_cursor_next(&c)) {
+		bloom_add(bf, rbbst_cursor_key(&c));
 	}
 }
 
@@ -465,9 +863,9 @@ preorder_nodes(struct rbtree_node *root, struct single_list *keys)
 static struct rbtree_node * 
 min_node(struct rbtree_node *node)
 {
-	if (node->left == NULL)
-		return node;
-	return min_node(node->left);
+	while (node->left != NULL)
+		node = node->left;
+	return node;
 }
 
 /* 
@@ -477,9 +875,9 @@ min_node(struct rbtree_node *node)
 static struct rbtree_node * 
 max_node(struct rbtree_node *node)
 {
-	if (node->right == NULL)
-		return node;
-	return max_node(node->right);
+	while (node->right != NULL)
+		node = node->right;
+	return node;
 }
 
 /* 
@@ -516,94 +914,71 @@ move_red_right(struct rbtree_node *hnode)
 	return hnode;
 }
 
-/* Delete the minimum key rooted at node. */
-static struct rbtree_node * 
-delete_min_node(struct rbtree_node *node, unsigned int ksize)
-{	
-	if (node->left == NULL) {
-		if (ksize != 0)
-			ALGFREE(node->key);
-		ALGFREE(node);
-		return NULL;
-	}
+/* 
+ * Deletes the key, the smallest or the largest key by the MODE from 
+ * the tree. It goes down as the recursive deletion does, the nodes 
+ * are moved red on the way and kept in an array, then they are 
+ * balanced from the bottom up. A key with a right subtree is 
+ * replaced by the smallest key of the subtree, which is deleted.
+ */
+static void
+remove_node(struct rbtree *bst, const void *key, int mode)
+{
+	struct rbtree_node *path[RBBST_CURSOR_DEPTH], *x;
+	unsigned char left[RBBST_CURSOR_DEPTH];
+	int depth;
 
-	/* node is 2-node */
-	if (!RBBST_ISRED(node->left) && !RBBST_ISRED(node->left->left))
-		node = move_red_left(node);
-	node->left = delete_min_node(node->left, ksize);
-	
-	return balance(node);
-}
+	/* if both children of root are black, set root to red. */
+	if (!RBBST_ISRED(bst->root->left) && !RBBST_ISRED(bst->root->right))
+		RBBST_SET_COLOR(bst->root, RED);
 
-/* Delete the maximum key rooted at node. */
-static struct rbtree_node * 
-delete_max_node(struct rbtree_node *node, unsigned int ksize)
-{
-	if (RBBST_ISRED(node->left))	/* node is 3-node */
-		node = rotate_right(node);
-		
-	if (node->right == NULL) {
-		if (ksize != 0)
-			ALGFREE(node->key);
-		ALGFREE(node);
-		return NULL;
-	}
+	for (x = bst->root, depth = 0; ; depth++) {
+		if (mode == DELETE_MIN || (mode == DELETE_KEY && 
+			bst->cmp(key, node_key(bst, x)) == 1)) {
+			if (mode == DELETE_MIN && x->left == NULL)
+				break;
 
-	/* left node is 2-node */
-	if (!RBBST_ISRED(node->right) && !RBBST_ISRED(node->right->left))
-		node = move_red_right(node);
-	node->right = delete_max_node(node->right, ksize);
-	
-	return balance(node);
-}
+			/* left node is 2-node */
+			if (!RBBST_ISRED(x->left) && 
+				!RBBST_ISRED(x->left->left))
+				x = move_red_left(x);
+			path[depth] = x;
+			left[depth] = 1;
+			x = x->left;
+		} else {
+			if (RBBST_ISRED(x->left))
+				x = rotate_right(x);
+			if (x->right == NULL && (mode == DELETE_MAX ||
+				bst->cmp(key, node_key(bst, x)) == 0))
+				break;
 
-/* 
- * Delete the key-value pair with 
- * the given key rooted at NODE.
- */
-static struct rbtree_node * 
-delete_node(const struct rbtree *bst, struct rbtree_node *node, const void *key)
-{
-	struct rbtree_node *minnode;
-	
-	if (node == NULL)
-		return NULL;
-	
-	if (bst->cmp(key, node->key) == 1) {
-		if (!RBBST_ISRED(node->left) && !RBBST_ISRED(node->left->left))
-			node = move_red_left(node);
-		node->left = delete_node(bst, node->left, key);
-	} else {
-		if (RBBST_ISRED(node->left))
-			node = rotate_right(node);
-	
-		/* may max key */
-		if (bst->cmp(key, node->key) == 0 && node->right == NULL) {
-			if (bst->keysize != 0)
-				ALGFREE(node->key);
-			ALGFREE(node);
-			return NULL;
+			/* right node is 2-node */
+			if (!RBBST_ISRED(x->right) && 
+				!RBBST_ISRED(x->right->left))
+				x = move_red_right(x);
+			if (mode == DELETE_KEY && 
+				bst->cmp(key, node_key(bst, x)) == 0) {
+				/* coping delete */
+				memcpy(x->key, min_node(x->right)->key, 
+					RBBST_KEY_BYTES(bst));
+				mode = DELETE_MIN;
+			}
+			path[depth] = x;
+			left[depth] = 0;
+			x = x->right;
 		}
-		
-		if (!RBBST_ISRED(node->right) &&
-			!RBBST_ISRED(node->right->left)) {
-			node = move_red_right(node);
-		}
-		
-		if (bst->cmp(key, node->key) == 0) {
-			minnode = min_node(node->right);
-			/* coping delete */
-			if (bst->keysize == 0)
-				node->key = minnode->key;
-			else
-				memcpy(node->key, minnode->key, bst->keysize);
-			node->right = delete_min_node(node->right,
-				bst->keysize);
-		} else
-			node->right = delete_node(bst, node->right, key);
 	}
-	
-	return balance(node);
+
+	free_node(bst, x);
+	for (x = NULL; depth-- > 0; x = balance(path[depth])) {
+		if (left[depth])
+			path[depth]->left = x;
+		else
+			path[depth]->right = x;
+	}
+	bst->root = x;
+	if (!RBBST_ISEMPTY(bst))
+		RBBST_SET_COLOR(bst->root, BLACK);
 }
 
 /* 
@@ -611,20 +986,22 @@ delete_node(const struct rbtree *bst, struct rbtree_node *node, const void *key)
  * (if min or max is null, treat as empty constraint).
  */
 static int
-isbst(const struct rbtree_node *node, const void *minkey, const void *maxkey,
-	algcomp_ft *kcmp)
+isbst(const struct rbtree *bst, const struct rbtree_node *node,
+	const void *minkey, const void *maxkey)
 {
+	void *key;
+
 	if (node == NULL)
 		return 1;	/* empty tree */
 	
-	if (minkey != NULL && kcmp(node->key, minkey) == 1)
+	key = node_key(bst, node);
+	if (minkey != NULL && bst->cmp(key, minkey) == 1)
 		return 0;
-	if (maxkey != NULL && kcmp(node->key, maxkey) == -1)
+	if (maxkey != NULL && bst->cmp(key, maxkey) == -1)
 		return 0;
-	return isbst(node->left, minkey, node->key, kcmp) &&
-		isbst(node->right, node->key, maxkey, kcmp);
+	return isbst(bst, node->left, minkey, key) &&
+		isbst(bst, node->right, key, maxkey);
 }
-
 /* 
  * Does the tree have no red right links, 
  * and at most one (left) red links in a row on any path? 
@@ -716,113 +1093,3 @@ is_rank_consistent(const struct rbtree *bst)
 	
 	return 1;
 }
-
-/* 
- * The largest key in the subtree rooted at Node less than 
- * or equal to the given key.
- */
-static struct rbtree_node * 
-floor_node(struct rbtree_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	struct rbtree_node *rnode;
-	
-	if (node == NULL)	/* not found the specified key */
-		return NULL;
-
-	if ((cr = kcmp(key, node->key)) == 0)
-		return node;
-	if(cr == 1)
-		return floor_node(node->left, key, kcmp);
-	if ((rnode = floor_node(node->right, key, kcmp)) != NULL)
-		return rnode;
-	else
-		return node;
-}
-
-/* 
- * The smallest key in the subtree rooted at Node greater than
- * or equal to the given key.
- */
-static struct rbtree_node * 
-ceiling_node(struct rbtree_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	struct rbtree_node *lnode;
-	
-	if (node == NULL)
-		return NULL;
-	
-	if ((cr = kcmp(key, node->key)) == 0)
-		return node;
-	if (cr == -1)
-		return ceiling_node(node->right, key, kcmp);
-	if ((lnode = ceiling_node(node->left, key, kcmp)) != NULL)
-		return lnode;
-	else
-		return node;
-}
-
-/* Number of keys less than key in the subtree rooted at Node. */
-static unsigned long 
-rank_node(const struct rbtree_node *node, const void *key, algcomp_ft *kcmp)
-{
-	int cr;
-	
-	if (node == NULL)
-		return 0;
-	
-	if ((cr = kcmp(key, node->key)) == 1)
-		return rank_node(node->left, key, kcmp);
-	if (cr == -1) {
-		return 1 + RBBST_SIZE_NODE(node->left) +
-			rank_node(node->right, key, kcmp);
-	} else {
-		return RBBST_SIZE_NODE(node->left);
-	}
-}
-
-/* 
- * Return key in BST rooted at Node of given rank.
- * Precondition: rank is in legal range. 
- */
-static void * 
-select_node(struct rbtree_node *node, unsigned long rank)
-{
-	unsigned long leftsize;
-	
-	if (node == NULL)
-		return NULL;
-	
-	leftsize = RBBST_SIZE_NODE(node->left);
-	if (rank < leftsize)
-		return select_node(node->left, rank);
-	if (rank > leftsize)
-		return select_node(node->right, rank - leftsize - 1);
-	else
-		return (node->key);
-}
-
-/* 
- * Add the keys between lokey and hikey in the subtree 
- * rooted at Node to queue.
- */
-static void 
-keys_range(const struct rbtree_node *node, const void *lokey, const void *hikey,
-	algcomp_ft *kcmp, struct single_list *keys)
-{
-	int cmplo, cmphi;
-	
-	if (node == NULL)
-		return;
-	
-	cmplo = kcmp(lokey, node->key);
-	cmphi = kcmp(hikey, node->key);
-	
-	if (cmplo == 1)
-		keys_range(node->left, lokey, hikey, kcmp, keys);
-	if ((cmplo == 1 || cmplo == 0) && (cmphi == -1 || cmphi == 0))
-		slist_append(keys, node->key);
-	if(cmphi == -1)
-		keys_range(node->right, lokey, hikey, kcmp, keys);
-}
@@ -105,6 +105,19 @@ main(int argc, char *argv[])
 		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
 	printf("\n");
 	
+	printf("Begin peek key: %s\n", key);
+	snprintf(item.key, MAX_KEY_LEN, "%s", key);
+	item.value = -1;
+	start_time = clock();
+	if ((el = (struct element *)splayt_peek(&bst, &item)) != NULL)
+		printf("It's value: %ld\n", el->value);
+	else
+		printf("Not found.\n");
+	end_time = clock();
+	printf("Peek completed, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	printf("\n");
+
 	printf("Begin search key: %s\n", key);
 	strncpy(item.key, key, MAX_KEY_LEN);
 	item.value = -1;
@@ -36,7 +36,8 @@ static struct splayt_node * make_node(const void *, unsigned int);
 static inline void rotate_left(struct splay_tree *, struct splayt_node *);
 static inline void rotate_right(struct splay_tree *, struct splayt_node *);
 static struct splayt_node * splay(struct splay_tree *, struct splayt_node *);
-static struct splayt_node * find(const struct splay_tree *, const void *);
+static struct splayt_node * find(const struct splay_tree *, const void *,
+	unsigned int *);
 static struct splayt_node * min_node(struct splayt_node *);
 static struct splayt_node * max_node(struct splayt_node *);
 static void replace(struct splay_tree *, struct splayt_node *,
@@ -52,6 +53,16 @@ splayt_init(struct splay_tree *st, unsigned int ksize, algcomp_ft *cmp)
 	st->size = 0;
 	st->keysize = ksize;
 	st->cmp = cmp;
+	st->splaydepth = 0;
+	st->splayrate = 100;
+}
+
+/* Sets the semi-splaying of the lookups. */
+void
+splayt_semisplay(struct splay_tree *st, unsigned int depth, unsigned int rate)
+{
+	st->splaydepth = depth;
+	st->splayrate = MIN(rate, 100);
 }
 
 /* 
@@ -98,23 +109,34 @@ splayt_put(struct splay_tree *st, const void *key)
 	return 0;
 }
 
-/* Returns the key in this splay tree by the given key. */
+/* 
+ * Returns the key in this splay tree by the given key. A shallow node
+ * is left where it is, and a deep one is splayed as the rate allows.
+ */
 void * 
 splayt_get(struct splay_tree *st, const void *key)
 {
 	struct splayt_node *current;
-	void *el;
-
-	if (st->cmp(st->root->key, key) == 0)
-		return (st->root->key);
+	unsigned int depth;
 
-	if((current = find(st, key)) == NULL)
+	if ((current = find(st, key, &depth)) == NULL)
 		return NULL;
-	else {
-		el = current->key;
+
+	if (depth > st->splaydepth && (st->splayrate >= 100 || 
+		rand_range_integer(0, 100) < st->splayrate))
 		st->root = splay(st, current);
-		return el;
-	}
+	return (current->key);
+}
+
+/* Returns the key in this splay tree by the given key without splaying. */
+void * 
+splayt_peek(const struct splay_tree *st, const void *key)
+{
+	struct splayt_node *current;
+
+	if ((current = find(st, key, NULL)) == NULL)
+		return NULL;
+	return (current->key);
 }
 
 /* 
@@ -135,7 +157,7 @@ splayt_delete(struct splay_tree *st, const void *key)
 {
 	struct splayt_node *current, *min;
 
-	if((current = find(st, key)) == NULL)
+	if((current = find(st, key, NULL)) == NULL)
 		return 1;
 	
 	splay(st, current);
@@ -149,11 +171,11 @@ splayt_delete(struct splay_tree *st, const void *key)
 		if (min->parent != current) {
 			replace(st, min, min->right);
 			min->right = current->right;
-			min->right->parent = current;
+			min->right->parent = min;
 		}
 		replace(st, current, min);
 		min->left = current->left;
-		min->left->parent = current;
+		min->left->parent = min;
 	}
 
 	if (st->keysize != 0)
@@ -199,6 +221,7 @@ splayt_clear(struct splay_tree *st)
 {
 	if (!SPLAYT_ISEMPTY(st)) {
 		clear(st->root, st->keysize);
+		st->root = NULL;
 		st->size = 0;
 		st->keysize = 0;
 		st->cmp = NULL;
@@ -362,20 +385,27 @@ splay(struct splay_tree *st, struct splayt_node *x)
 	return x;
 }
 
-/* the search for BST */
+/* 
+ * the search for BST, the number of edges from the root to 
+ * the found node is saved in DEPTH if it is not null.
+ */
 static struct splayt_node * 
-find(const struct splay_tree *st, const void *key)
+find(const struct splay_tree *st, const void *key, unsigned int *depth)
 {
 	struct splayt_node *current;
+	unsigned int d = 0;
+	int cr;
 
 	current = st->root;
-	while (current != NULL)
-		if (st->cmp(current->key, key) == 1)
-			current = current->right;
-		else if (st->cmp(current->key, key) == -1)
-			current = current->left;
-		else
+	while (current != NULL) {
+		if ((cr = st->cmp(current->key, key)) == 0) {
+			if (depth != NULL)
+				*depth = d;
 			return current;
+		}
+		current = cr == 1 ? current->right : current->left;
+		d++;
+	}
 	return NULL;
 }
 
@@ -0,0 +1,557 @@
+/*-
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2026 Jianping Duan <static.integer@hotmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Author nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ */
+#include "concurrentskiplist.h"
+#include "singlelist.h"
+#include <pthread.h>
+
+/* The low bit of a forward link marks the node removed at that level. */
+#define IS_MARKED(p)	(((p) & 1) != 0)
+#define PTR(p)		((struct cskl_node *)((p) & ~(uintptr_t)1))
+
+#define LOAD(p)		atomic_load_explicit((p), memory_order_acquire)
+
+/* The number of nodes a thread retires between tries to advance. */
+#define RETIRE_BATCH	64
+
+static pthread_once_t tid_once = PTHREAD_ONCE_INIT;
+static pthread_key_t tid_key;
+static atomic_ulong tid_used[CSKL_MAX_THREADS / 64];
+static _Thread_local int self = -1;
+static _Thread_local unsigned long seed;
+
+static int thread_id(void);
+static void tid_key_init(void);
+static void tid_release(void *);
+static struct cskl_thread * enter(struct concurrent_skip_list *);
+static void leave(struct cskl_thread *);
+static void release(struct concurrent_skip_list *, struct cskl_thread *,
+		struct cskl_node *);
+static void try_advance(struct concurrent_skip_list *);
+static void free_nodes(struct cskl_node *);
+static int find(struct concurrent_skip_list *, const void *,
+		struct cskl_node **, struct cskl_node **);
+static struct cskl_node * search(const struct concurrent_skip_list *,
+			const void *, struct cskl_node **);
+static struct cskl_node * node_new(const struct concurrent_skip_list *, 
+			const void *, int);
+static int random_level(int);
+
+/* Initializes an empty concurrent skip list. */
+void
+cskl_init(struct concurrent_skip_list *sl, int maxlvl, unsigned int ksize,
+	algcomp_ft *cmp)
+{
+	int i;
+
+	assert(ksize > 0);
+
+	if (maxlvl > CSKL_MAX_LEVEL)
+		maxlvl = CSKL_MAX_LEVEL;
+	else if (maxlvl < 0)
+		maxlvl = 0;
+
+	sl->maxlevel = maxlvl;
+	sl->keysize = ksize;
+	sl->cmp = cmp;
+	sl->head = (struct cskl_node *)algcalloc(1, sizeof(struct cskl_node) +
+		(maxlvl + 1) * sizeof(uintptr_t));
+	sl->head->height = maxlvl + 1;
+	for (i = 0; i <= maxlvl; i++)
+		atomic_init(&sl->head->forward[i], (uintptr_t)NULL);
+	atomic_init(&sl->size, 0);
+	atomic_init(&sl->epoch, 1);
+
+	for (i = 0; i < CSKL_MAX_THREADS; i++) {
+		atomic_init(&sl->threads[i].epoch, 0);
+		sl->threads[i].last = 0;
+		sl->threads[i].nretired = 0;
+		sl->threads[i].limbo[0] = NULL;
+		sl->threads[i].limbo[1] = NULL;
+		sl->threads[i].limbo[2] = NULL;
+	}
+}
+
+/* 
+ * Copies the key equal to the given key into OUT. 
+ * It only reads the links, the marked nodes are stepped over.
+ */
+int
+cskl_get(struct concurrent_skip_list *sl, const void *key, void *out)
+{
+	struct cskl_thread *rec;
+	struct cskl_node *curr;
+	int ret = -1;
+
+	if (key == NULL)
+		errmsg_exit("calls cskl_get() with null argument.\n");
+
+	rec = enter(sl);
+	curr = search(sl, key, NULL);
+	if (curr != NULL && sl->cmp(curr->key, key) == 0) {
+		memcpy(out, curr->key, sl->keysize);
+		ret = 0;
+	}
+	leave(rec);
+
+	return ret;
+}
+
+/* 
+ * Inserts the key. The node is linked at level 0 first, which makes 
+ * it in the skip list, then at the upper levels one by one. 
+ * It stops linking if the node is removed meanwhile.
+ */
+int
+cskl_put(struct concurrent_skip_list *sl, const void *key)
+{
+	struct cskl_node *preds[CSKL_MAX_LEVEL + 1];
+	struct cskl_node *succs[CSKL_MAX_LEVEL + 1];
+	struct cskl_thread *rec;
+	struct cskl_node *node;
+	uintptr_t link, expected;
+	int i, lvl;
+
+	if (key == NULL)
+		errmsg_exit("calls cskl_put() with null argument.\n");
+
+	lvl = random_level(sl->maxlevel);
+	rec = enter(sl);
+	for (;;) {
+		if (find(sl, key, preds, succs)) {
+			leave(rec);
+			return -1;
+		}
+
+		node = node_new(sl, key, lvl);
+		for (i = 0; i <= lvl; i++)
+			atomic_init(&node->forward[i], (uintptr_t)succs[i]);
+		expected = (uintptr_t)succs[0];
+		if (atomic_compare_exchange_strong(&preds[0]->forward[0],
+			&expected, (uintptr_t)node))
+			break;
+		ALGFREE(node);		/* never seen by others */
+	}
+	atomic_fetch_add_explicit(&sl->size, 1, memory_order_relaxed);
+
+	for (i = 1; i <= lvl; i++) {
+		for (;;) {
+			link = LOAD(&node->forward[i]);
+			if (IS_MARKED(link))
+				goto done;
+			if (PTR(link) != succs[i] && 
+				!atomic_compare_exchange_strong(
+				&node->forward[i], &link, (uintptr_t)succs[i]))
+				continue;
+			expected = (uintptr_t)succs[i];
+			if (atomic_compare_exchange_strong(
+				&preds[i]->forward[i], &expected, 
+				(uintptr_t)node))
+				break;
+			find(sl, key, preds, succs);
+		}
+	}
+
+done:
+	/* the deleter may have missed the levels linked after it */
+	if (IS_MARKED(LOAD(&node->forward[0])))
+		find(sl, key, preds, succs);
+	release(sl, rec, node);
+	leave(rec);
+
+	return 0;
+}
+
+/* 
+ * Removes the key. The node is marked from the top level down, 
+ * the one who marks level 0 removes it, then it is unlinked by 
+ * searching it again.
+ */
+int
+cskl_delete(struct concurrent_skip_list *sl, const void *key)
+{
+	struct cskl_node *preds[CSKL_MAX_LEVEL + 1];
+	struct cskl_node *succs[CSKL_MAX_LEVEL + 1];
+	struct cskl_thread *rec;
+	struct cskl_node *node;
+	uintptr_t link;
+	int i;
+
+	if (key == NULL)
+		errmsg_exit("calls cskl_delete() with null argument.\n");
+
+	rec = enter(sl);
+	if (!find(sl, key, preds, succs)) {
+		leave(rec);
+		return -1;
+	}
+
+	node = succs[0];
+	for (i = node->height - 1; i > 0; i--)
+		atomic_fetch_or(&node->forward[i], (uintptr_t)1);
+
+	link = LOAD(&node->forward[0]);
+	do {
+		if (IS_MARKED(link)) {
+			/* removed by another thread */
+			leave(rec);
+			return -1;
+		}
+	} while (!atomic_compare_exchange_weak(&node->forward[0], &link, 
+		link | 1));
+
+	atomic_fetch_sub_explicit(&sl->size, 1, memory_order_relaxed);
+	find(sl, key, preds, succs);
+	release(sl, rec, node);
+	leave(rec);
+
+	return 0;
+}
+
+/* Copies the largest key less than or equal to the given key. */
+int
+cskl_floor(struct concurrent_skip_list *sl, const void *key, void *out)
+{
+	struct cskl_thread *rec;
+	struct cskl_node *pred, *curr;
+	int ret = 0;
+
+	if (key == NULL)
+		errmsg_exit("calls cskl_floor() with null argument.\n");
+
+	rec = enter(sl);
+	curr = search(sl, key, &pred);
+	if (curr != NULL && sl->cmp(curr->key, key) == 0)
+		memcpy(out, curr->key, sl->keysize);
+	else if (pred != sl->head)
+		memcpy(out, pred->key, sl->keysize);
+	else
+		ret = -1;
+	leave(rec);
+
+	return ret;
+}
+
+/* Copies the smallest key greater than or equal to the given key. */
+int
+cskl_ceiling(struct concurrent_skip_list *sl, const void *key, void *out)
+{
+	struct cskl_thread *rec;
+	struct cskl_node *curr;
+	int ret = -1;
+
+	if (key == NULL)
+		errmsg_exit("calls cskl_ceiling() with null argument.\n");
+
+	rec = enter(sl);
+	if ((curr = search(sl, key, NULL)) != NULL) {
+		memcpy(out, curr->key, sl->keysize);
+		ret = 0;
+	}
+	leave(rec);
+
+	return ret;
+}
+
+/* Copies all keys into the list in order. */
+void
+cskl_keys(struct concurrent_skip_list *sl, struct single_list *keys)
+{
+	struct cskl_thread *rec;
+	struct cskl_node *curr;
+	uintptr_t link;
+
+	slist_init(keys, sl->keysize, sl->cmp);
+	rec = enter(sl);
+	for (curr = PTR(LOAD(&sl->head->forward[0])); curr != NULL;
+		curr = PTR(link)) {
+		link = LOAD(&curr->forward[0]);
+		if (!IS_MARKED(link))
+			slist_append(keys, curr->key);
+	}
+	leave(rec);
+}
+
+/* Clears this skip list, no other thread may be using it. */
+void
+cskl_clear(struct concurrent_skip_list *sl)
+{
+	struct cskl_node *curr, *next;
+	int i;
+
+	for (curr = PTR(LOAD(&sl->head->forward[0])); curr != NULL; 
+		curr = next) {
+		next = PTR(LOAD(&curr->forward[0]));
+		ALGFREE(curr);
+	}
+	ALGFREE(sl->head);
+
+	for (i = 0; i < CSKL_MAX_THREADS; i++) {
+		free_nodes(sl->threads[i].limbo[0]);
+		free_nodes(sl->threads[i].limbo[1]);
+		free_nodes(sl->threads[i].limbo[2]);
+		sl->threads[i].limbo[0] = NULL;
+		sl->threads[i].limbo[1] = NULL;
+		sl->threads[i].limbo[2] = NULL;
+	}
+	atomic_store(&sl->size, 0);
+}
+
+/******************** static function boundary ********************/
+
+/* 
+ * Returns the index of the calling thread in [0, CSKL_MAX_THREADS),
+ * it is given back when the thread exits.
+ */
+static int
+thread_id(void)
+{
+	unsigned long bit, old;
+	int t;
+
+	if (self >= 0)
+		return self;
+
+	pthread_once(&tid_once, tid_key_init);
+	for (t = 0; t < CSKL_MAX_THREADS; t++) {
+		bit = 1UL << (t % 64);
+		old = atomic_fetch_or(&tid_used[t / 64], bit);
+		if ((old & bit) == 0) {
+			self = t;
+			pthread_setspecific(tid_key, (void *)(uintptr_t)(t + 1));
+			return t;
+		}
+	}
+
+	errmsg_exit("More than %d threads use the concurrent skip lists.\n",
+		CSKL_MAX_THREADS);
+	return -1;
+}
+
+static void
+tid_key_init(void)
+{
+	if (pthread_key_create(&tid_key, tid_release) != 0)
+		errmsg_exit("Creates thread key failure.\n");
+}
+
+static void
+tid_release(void *p)
+{
+	unsigned long t = (uintptr_t)p - 1;
+
+	atomic_fetch_and(&tid_used[t / 64], ~(1UL << (t % 64)));
+}
+
+/* 
+ * Enters the skip list at the current epoch. The nodes retired 
+ * by this thread three epochs ago are freed, no one can see them.
+ */
+static struct cskl_thread *
+enter(struct concurrent_skip_list *sl)
+{
+	struct cskl_thread *rec = &sl->threads[thread_id()];
+	unsigned long e;
+
+	e = atomic_load(&sl->epoch);
+	atomic_store(&rec->epoch, e);
+	if (rec->last != e) {
+		rec->last = e;
+		free_nodes(rec->limbo[e % 3]);
+		rec->limbo[e % 3] = NULL;
+	}
+
+	return rec;
+}
+
+static void
+leave(struct cskl_thread *rec)
+{
+	atomic_store_explicit(&rec->epoch, 0, memory_order_release);
+}
+
+/* 
+ * Drops a reference to the node, the inserter's or the list's. 
+ * The last one retires it, after both have unlinked it.
+ */
+static void
+release(struct concurrent_skip_list *sl, struct cskl_thread *rec,
+	struct cskl_node *node)
+{
+	if (atomic_fetch_sub(&node->refs, 1) != 1)
+		return;
+
+	node->retired = rec->limbo[rec->last % 3];
+	rec->limbo[rec->last % 3] = node;
+	if (++rec->nretired >= RETIRE_BATCH) {
+		rec->nretired = 0;
+		try_advance(sl);
+	}
+}
+
+/* Advances the global epoch if all threads inside have seen it. */
+static void
+try_advance(struct concurrent_skip_list *sl)
+{
+	unsigned long e, t;
+	int i;
+
+	e = atomic_load(&sl->epoch);
+	for (i = 0; i < CSKL_MAX_THREADS; i++) {
+		t = atomic_load(&sl->threads[i].epoch);
+		if (t != 0 && t != e)
+			return;
+	}
+	atomic_compare_exchange_strong(&sl->epoch, &e, e + 1);
+}
+
+static void
+free_nodes(struct cskl_node *node)
+{
+	struct cskl_node *next;
+
+	for (; node != NULL; node = next) {
+		next = node->retired;
+		ALGFREE(node);
+	}
+}
+
+/* 
+ * Finds the predecessors and successors of the key at all levels, 
+ * unlinks the marked nodes on the way. Returns true if the key is 
+ * found at level 0.
+ */
+static int
+find(struct concurrent_skip_list *sl, const void *key,
+	struct cskl_node **preds, struct cskl_node **succs)
+{
+	struct cskl_node *pred, *curr;
+	uintptr_t succ, expected;
+	int i;
+
+retry:
+	pred = sl->head;
+	curr = NULL;
+	for (i = sl->maxlevel; i >= 0; i--) {
+		curr = PTR(LOAD(&pred->forward[i]));
+		while (curr != NULL) {
+			succ = LOAD(&curr->forward[i]);
+			if (IS_MARKED(succ)) {
+				expected = (uintptr_t)curr;
+				if (!atomic_compare_exchange_strong(
+					&pred->forward[i], &expected, 
+					(uintptr_t)PTR(succ)))
+					goto retry;
+				curr = PTR(succ);
+				continue;
+			}
+			if (sl->cmp(curr->key, key) != 1)
+				break;
+			pred = curr;
+			curr = PTR(succ);
+		}
+		preds[i] = pred;
+		succs[i] = curr;
+	}
+
+	return curr != NULL && sl->cmp(curr->key, key) == 0;
+}
+
+/* 
+ * Returns the first node at level 0 not less than the key, and 
+ * its predecessor in PRED. It steps over the marked nodes with no 
+ * writes, so it finishes in a bounded number of steps.
+ */
+static struct cskl_node *
+search(const struct concurrent_skip_list *sl, const void *key,
+	struct cskl_node **pred)
+{
+	struct cskl_node *p, *curr = NULL;
+	uintptr_t succ;
+	int i;
+
+	p = sl->head;
+	for (i = sl->maxlevel; i >= 0; i--) {
+		curr = PTR(LOAD(&p->forward[i]));
+		while (curr != NULL) {
+			succ = LOAD(&curr->forward[i]);
+			if (!IS_MARKED(succ) && sl->cmp(curr->key, key) != 1)
+				break;
+			if (!IS_MARKED(succ))
+				p = curr;
+			curr = PTR(succ);
+		}
+	}
+
+	if (pred != NULL)
+		*pred = p;
+	return curr;
+}
+
+/* Allocates a node of LVL + 1 links, the key is copied behind them. */
+static struct cskl_node *
+node_new(const struct concurrent_skip_list *sl, const void *key, int lvl)
+{
+	struct cskl_node *node;
+	size_t sz;
+
+	sz = sizeof(struct cskl_node) + (lvl + 1) * sizeof(uintptr_t);
+	node = (struct cskl_node *)algmalloc(sz + sl->keysize);
+	node->height = lvl + 1;
+	atomic_init(&node->refs, 2);
+	node->retired = NULL;
+	node->key = (char *)node + sz;
+	memcpy(node->key, key, sl->keysize);
+
+	return node;
+}
+
+/* 
+ * Returns a random level with the probability 1/2 of going up, 
+ * by a xorshift generator of this thread, rand() is not reentrant.
+ */
+static int
+random_level(int maxlvl)
+{
+	unsigned long r;
+	int lvl;
+
+	if (seed == 0)
+		seed = ((uintptr_t)&seed ^ (unsigned long)time(NULL)) | 1;
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+
+	r = seed;
+	for (lvl = 0; (r & 1) != 0 && lvl < maxlvl; r >>= 1)
+		lvl++;
+	return lvl;
+}
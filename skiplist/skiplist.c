@@ -31,13 +31,15 @@
  */
 #include "skiplist.h"
 #include "singlelist.h"
+#include "bloomfilter.h"
 
 /* returns a random value in [0...1] */
 #define SL_FRACTION	((double)rand() / (double)RAND_MAX)
 
 #define SL_PROBABILITY	0.5
 
-static inline void pointers_init(struct skipl_node **, int);
+static struct skipl_node * node_new(const struct skip_list *, const void *,
+			int);
 static int random_level(double, int);
 
 /* 
@@ -53,22 +55,29 @@ static int random_level(double, int);
  * of elements in a skip list). 
  * If p = 1/2, using MaxLevel = 16 is appropriate for data 
  * structures containing up to 216 elements.
+ * The level is capped at SKIPL_MAX_LEVEL, so the update vector 
+ * of an insertion or deletion can live on the stack.
  */
 void 
 skipl_init(struct skip_list *sl, int maxlvl, unsigned int ksize,
 	algcomp_ft *cmp)
 {
+	if (maxlvl > SKIPL_MAX_LEVEL)
+		maxlvl = SKIPL_MAX_LEVEL;
+	else if (maxlvl < 0)
+		maxlvl = 0;
+
 	sl->maxlevel = maxlvl;
 	sl->level = 0;
 	sl->size = 0;
+	sl->version = 0;
 	sl->keysize = ksize;
 	sl->cmp = cmp;
-	sl->head = (struct skipl_node *)algmalloc(sizeof(struct skipl_node));
-
-	sl->head->key = NULL;
-	sl->head->forward = (struct skipl_node **)
-		algcalloc(sl->maxlevel + 1, sizeof(struct skipl_node *));
-	pointers_init(sl->head->forward, maxlvl);
+	sl->guard = NULL;
+	sl->head = (struct skipl_node *)algcalloc(1, 
+		sizeof(struct skipl_node) + 
+		(maxlvl + 1) * sizeof(struct skipl_link));
+	sl->head->forward[0].span = 1;
 
 	SET_RANDOM_SEED;
 }
@@ -92,14 +101,17 @@ skipl_get(const struct skip_list *sl, const void *key)
 	if (key == NULL)
 		errmsg_exit("calls skipl_get() with null argument.\n");
 
+	if (sl->guard != NULL && !bloom_contains(sl->guard, key))
+		return NULL;
+
 	current = sl->head;
 	for (i = sl->level; i >= 0; i--)
-		while (current->forward[i] != NULL &&
-			sl->cmp(current->forward[i]->key, key) == 1) {
-			current = current->forward[i];
+		while (current->forward[i].next != NULL &&
+			sl->cmp(current->forward[i].next->key, key) == 1) {
+			current = current->forward[i].next;
 		}
 
-	if ((current = current->forward[0]) != NULL &&
+	if ((current = current->forward[0].next) != NULL &&
 		sl->cmp(current->key, key) == 0) {
 		return current->key;
 	}
@@ -125,53 +137,145 @@ skipl_get(const struct skip_list *sl, const void *key)
 void
 skipl_put(struct skip_list *sl, const void *key)
 {
-	struct skipl_node **update, *current, *newnode;
+	struct skipl_node *update[SKIPL_MAX_LEVEL + 1], *current, *newnode;
+	unsigned long rank[SKIPL_MAX_LEVEL + 1], r;
 	int i, lvl;
 
 	if (key == NULL)
 		errmsg_exit("calls skipl_put() with null argument.\n");
 
-	update = (struct skipl_node **)
-		algcalloc(sl->maxlevel + 1, sizeof(struct skipl_node *));
-	pointers_init(update, sl->maxlevel);
-
 	current = sl->head;	
-	for (i = sl->level; i >= 0; i--) {
-		while (current->forward[i] != NULL && 
-			  sl->cmp(current->forward[i]->key, key) == 1) {
-			current = current->forward[i];
+	for (i = sl->level, r = 0; i >= 0; i--) {
+		while (current->forward[i].next != NULL && 
+			  sl->cmp(current->forward[i].next->key, key) == 1) {
+			r += current->forward[i].span;
+			current = current->forward[i].next;
 		}
 		update[i] = current;
+		rank[i] = r;
 	}
 
-	current = current->forward[0];
+	current = current->forward[0].next;
 	if (current == NULL || sl->cmp(current->key, key) != 0) {
 		lvl = random_level(SL_PROBABILITY, sl->maxlevel);
 		if (lvl > sl->level) {
-			for (i = sl->level + 1; i <= lvl; i++)
+			for (i = sl->level + 1; i <= lvl; i++) {
 				update[i] = sl->head;
+				rank[i] = 0;
+				sl->head->forward[i].next = NULL;
+				sl->head->forward[i].span = sl->size + 1;
+			}
 			sl->level = lvl;
 		}
 
-		newnode = (struct skipl_node *)
-			algmalloc(sizeof(struct skipl_node));
-		if (sl->keysize != 0) {
-			newnode->key = algmalloc(sl->keysize);
-			memcpy(newnode->key, key, sl->keysize);
-		} else
-			newnode->key = (void *)key;
-		newnode->forward = (struct skipl_node **)
-			algcalloc(lvl + 1, sizeof(struct skipl_node *));
-		pointers_init(newnode->forward, lvl);
+		/* 
+		 * the new node has rank R + 1, the nodes after it 
+		 * move one rank up 
+		 */
+		newnode = node_new(sl, key, lvl);
 		for (i = 0; i <= lvl; i++) {
-			newnode->forward[i] = update[i]->forward[i];
-			update[i]->forward[i] = newnode;
+			newnode->forward[i].next = update[i]->forward[i].next;
+			newnode->forward[i].span = update[i]->forward[i].span -
+				(r - rank[i]);
+			update[i]->forward[i].next = newnode;
+			update[i]->forward[i].span = r - rank[i] + 1;
 		}
+		for (; i <= sl->level; i++)
+			update[i]->forward[i].span++;
 
 		sl->size++;
+		sl->version++;
+		if (sl->guard != NULL)
+			bloom_add(sl->guard, key);
+	}
+}
+
+/* 
+ * Builds the skip list from N keys in strictly ascending order, 
+ * in O(N) time. KEYS is an array of N keys of the key size, or of 
+ * N pointers if the skip list holds the caller's keys. The skip list 
+ * must be empty. The levels are deterministic: the node of rank r
+ * (from 1) has as many levels above 0 as the trailing zeros of r,
+ * so every link of level i spans 2^i nodes.
+ */
+void
+skipl_build_sorted(struct skip_list *sl, const void *keys, unsigned long n)
+{
+	struct skipl_node *last[SKIPL_MAX_LEVEL + 1], *node;
+	unsigned long lastrank[SKIPL_MAX_LEVEL + 1], r;
+	const void *key, *prev = NULL;
+	int i, lvl;
+
+	if (!SKIPL_ISEMPTY(sl))
+		errmsg_exit("calls skipl_build_sorted() with a non-empty "
+			"skip list.\n");
+	if (n == 0)
+		return;
+	if (keys == NULL)
+		errmsg_exit("calls skipl_build_sorted() with null argument.\n");
+
+	for (i = 0; i <= sl->maxlevel; i++) {
+		last[i] = sl->head;
+		lastrank[i] = 0;
+	}
+
+	for (r = 1; r <= n; r++) {
+		if (sl->keysize != 0)
+			key = (const char *)keys + (r - 1) * sl->keysize;
+		else
+			key = ((const void * const *)keys)[r - 1];
+		if (prev != NULL && sl->cmp(prev, key) != 1)
+			errmsg_exit("The keys are not in strictly ascending "
+				"order at %lu.\n", r - 1);
+		prev = key;
+
+		lvl = __builtin_ctzl(r);
+		if (lvl > sl->maxlevel)
+			lvl = sl->maxlevel;
+		node = node_new(sl, key, lvl);
+		for (i = 0; i <= lvl; i++) {
+			last[i]->forward[i].next = node;
+			last[i]->forward[i].span = r - lastrank[i];
+			last[i] = node;
+			lastrank[i] = r;
+		}
+		if (lvl > sl->level)
+			sl->level = lvl;
+		if (sl->guard != NULL)
+			bloom_add(sl->guard, key);
+	}
+
+	for (i = 0; i <= sl->level; i++) {
+		last[i]->forward[i].next = NULL;
+		last[i]->forward[i].span = n + 1 - lastrank[i];
 	}
+	sl->size = n;
+	sl->version++;
+}
+
+/* 
+ * Attaches a Bloom filter as the guard of skipl_get(), 
+ * all keys in the skip list are added into it.
+ * The deleted keys stay in the filter, which only 
+ * makes it less selective. The filter must hash what the 
+ * comparator compares, returns -1 if it has no hash function.
+ */
+int
+skipl_set_guard(struct skip_list *sl, struct bloom_filter *bf)
+{
+	struct skipl_node *current;
 
-	ALGFREE(update);
+	if (bf != NULL && bf->hash == NULL)
+		return -1;
+
+	sl->guard = bf;
+	if (bf == NULL)
+		return 0;
+
+	for (current = sl->head->forward[0].next; current != NULL;
+		current = current->forward[0].next)
+		bloom_add(bf, current->key);
+	return 0;
 }
 
 /* 
@@ -181,43 +285,41 @@ skipl_put(struct skip_list *sl, const void *key)
 void 
 skipl_delete(struct skip_list *sl, const void *key)
 {
-	struct skipl_node **update, *current;
+	struct skipl_node *update[SKIPL_MAX_LEVEL + 1], *current;
 	int i;
 
 	if (key == NULL)
 		errmsg_exit("calls skipl_delete() with null argument.\n");
 
-	update = (struct skipl_node **)
-		algcalloc(sl->maxlevel + 1, sizeof(struct skipl_node *));
-	pointers_init(update, sl->maxlevel);
-
 	current = sl->head;	
 	for (i = sl->level; i >= 0; i--) {
-		while (current->forward[i] != NULL && 
-			sl->cmp(current->forward[i]->key, key) == 1) {
-			current = current->forward[i];
+		while (current->forward[i].next != NULL && 
+			sl->cmp(current->forward[i].next->key, key) == 1) {
+			current = current->forward[i].next;
 		}
 		update[i] = current;
 	}
 
-	current = current->forward[0];
+	current = current->forward[0].next;
 	if (current != NULL && sl->cmp(current->key, key) == 0) {
 		for (i = 0; i <= sl->level; i++) {
-			if (update[i]->forward[i] != current)
-				break;
-			update[i]->forward[i] = current->forward[i];
+			if (update[i]->forward[i].next == current) {
+				update[i]->forward[i].next = 
+					current->forward[i].next;
+				update[i]->forward[i].span += 
+					current->forward[i].span - 1;
+			} else
+				update[i]->forward[i].span--;
 		}
-		if (sl->keysize != 0)
-			ALGFREE(current->key);
 		ALGFREE(current);
 
-		while (sl->level > 0 && sl->head->forward[i] == NULL)
+		while (sl->level > 0 && 
+			sl->head->forward[sl->level].next == NULL)
 			sl->level--;
 
 		sl->size--;
+		sl->version++;
 	}
-
-	ALGFREE(update);
 }
 
 /* Gets all keys from this skip list */
@@ -228,9 +330,9 @@ skipl_keys(const struct skip_list *sl, struct single_list *keys)
 
 	slist_init(keys, 0, sl->cmp);
 	current = sl->head;
-	while (current->forward[0] != NULL) {
-		slist_append(keys, current->forward[0]->key);
-		current = current->forward[0];
+	while (current->forward[0].next != NULL) {
+		slist_append(keys, current->forward[0].next->key);
+		current = current->forward[0].next;
 	}
 }
 
@@ -242,10 +344,7 @@ skipl_clear(struct skip_list *sl)
 
 	current = sl->head;
 	while (current != NULL) {
-		next = current->forward[0];
-		if (sl->keysize != 0)
-			ALGFREE(current->key);
-		ALGFREE(current->forward);
+		next = current->forward[0].next;
 		ALGFREE(current);
 		current = next;
 	}
@@ -262,7 +361,7 @@ skipl_min(const struct skip_list *sl)
 {
 	if (SKIPL_ISEMPTY(sl))
 		return NULL;
-	return sl->head->forward[0]->key;
+	return sl->head->forward[0].next->key;
 }
 
 /* Returns ths largest key in ths skip list. */
@@ -274,17 +373,17 @@ skipl_max(const struct skip_list *sl)
 
 	current = sl->head;
 	for (i = sl->level; i >= 0; i--) {
-		while (current->forward[i] != NULL)
-			current = current->forward[i];
-		if (current->forward[i] == NULL)
+		while (current->forward[i].next != NULL)
+			current = current->forward[i].next;
+		if (current->forward[i].next == NULL)
 			break;
 	}
 
-	if (i + 1 == 0 && current->forward[0] == NULL)
+	if (i + 1 == 0 && current->forward[0].next == NULL)
 		return current->key;
 
-	while (current->forward[0] != NULL)
-		current = current->forward[0];
+	while (current->forward[0].next != NULL)
+		current = current->forward[0].next;
 
 	return current->key;
 }
@@ -307,17 +406,17 @@ skipl_floor(const struct skip_list *sl, const void *key)
 
 	current = sl->head;
 	for (i = sl->level; i >= 0; i--)
-		while (current->forward[i] != NULL && 
-			sl->cmp(current->forward[i]->key, key) == 1) {
-			current = current->forward[i];
+		while (current->forward[i].next != NULL && 
+			sl->cmp(current->forward[i].next->key, key) == 1) {
+			current = current->forward[i].next;
 		}
 
 	if (current == sl->head)
 		errmsg_exit("argument to skipl_floor() is too small.\n");
 
-	if (current->forward[0] != NULL && 
-		sl->cmp(current->forward[0]->key, key) == 0) {
-		return (current->forward[0]->key);
+	if (current->forward[0].next != NULL && 
+		sl->cmp(current->forward[0].next->key, key) == 0) {
+		return (current->forward[0].next->key);
 	}
 	return (current->key);
 
@@ -341,25 +440,163 @@ skipl_ceiling(const struct skip_list *sl, const void *key)
 
 	current = sl->head;
 	for (i = sl->level; i >= 0; i--)
-		while (current->forward[i] != NULL && 
-			sl->cmp(current->forward[i]->key, key) == 1) {
-			current = current->forward[i];
+		while (current->forward[i].next != NULL && 
+			sl->cmp(current->forward[i].next->key, key) == 1) {
+			current = current->forward[i].next;
 		}
 	
-	if (current->forward[0] == NULL)
+	if (current->forward[0].next == NULL)
 		errmsg_exit("argument to skipl_floor() is too small.\n");
 
-	return (current->forward[0]->key);
+	return (current->forward[0].next->key);
 }
 
-/******************** static function boundary ********************/
+/* 
+ * Returns the number of keys in the skip list strictly less than key,
+ * the sum of the spans passed over while searching the key.
+ */
+unsigned long
+skipl_rank(const struct skip_list *sl, const void *key)
+{
+	struct skipl_node *current;
+	unsigned long r = 0;
+	int i;
+
+	if (key == NULL)
+		errmsg_exit("calls skipl_rank() with null argument.\n");
+
+	current = sl->head;
+	for (i = sl->level; i >= 0; i--)
+		while (current->forward[i].next != NULL &&
+			sl->cmp(current->forward[i].next->key, key) == 1) {
+			r += current->forward[i].span;
+			current = current->forward[i].next;
+		}
+
+	return r;
+}
 
-static inline void
-pointers_init(struct skipl_node **ptrs, int len)
+/* 
+ * Returns the key in the skip list of a given rank.
+ * There are rank keys in the skip list smaller than it.
+ */
+void *
+skipl_select(const struct skip_list *sl, unsigned long rank)
 {
+	struct skipl_node *current;
+	unsigned long r = 0;
 	int i;
-	for (i = 0; i <= len; i++)
-		ptrs[i] = NULL;
+
+	if (rank >= sl->size)
+		return NULL;
+
+	/* the nodes are numbered from 1, the head is 0 */
+	rank++;
+	current = sl->head;
+	for (i = sl->level; i >= 0; i--)
+		while (current->forward[i].next != NULL &&
+			r + current->forward[i].span <= rank) {
+			r += current->forward[i].span;
+			current = current->forward[i].next;
+		}
+
+	return current->key;
+}
+
+/* Initializes a finger at the head of the skip list. */
+void
+skipl_finger_init(struct skipl_finger *fg, const struct skip_list *sl)
+{
+	int i;
+
+	fg->sl = sl;
+	fg->version = sl->version;
+	for (i = 0; i <= SKIPL_MAX_LEVEL; i++) {
+		fg->path[i] = sl->head;
+		fg->rank[i] = 0;
+	}
+}
+
+/* 
+ * Returns the key equal to the given key, NULL if not found.
+ * The search climbs from the finger up to the lowest level that 
+ * reaches over the key, then goes down as usual. Going forward, 
+ * it climbs while the next node at the upper level is still less 
+ * than the key; going backward, while the node of the path is not
+ * less than the key. The finger is reset if the skip list has 
+ * been modified since the last search.
+ */
+void *
+skipl_finger_get(struct skipl_finger *fg, const void *key)
+{
+	const struct skip_list *sl = fg->sl;
+	struct skipl_node *current, *next;
+	unsigned long r;
+	int i = 0;
+
+	if (key == NULL)
+		errmsg_exit("calls skipl_finger_get() with null argument.\n");
+
+	if (fg->version != sl->version)
+		skipl_finger_init(fg, sl);
+
+	if (fg->path[0] != sl->head && sl->cmp(fg->path[0]->key, key) != 1) {
+		while (i < sl->level && fg->path[i] != sl->head &&
+			sl->cmp(fg->path[i]->key, key) != 1)
+			i++;
+		if (fg->path[i] != sl->head && 
+			sl->cmp(fg->path[i]->key, key) != 1) {
+			fg->path[i] = sl->head;
+			fg->rank[i] = 0;
+		}
+	} else {
+		while (i < sl->level && 
+			(next = fg->path[i + 1]->forward[i + 1].next) != NULL &&
+			sl->cmp(next->key, key) == 1)
+			i++;
+	}
+
+	current = fg->path[i];
+	r = fg->rank[i];
+	for (; i >= 0; i--) {
+		while (current->forward[i].next != NULL &&
+			sl->cmp(current->forward[i].next->key, key) == 1) {
+			r += current->forward[i].span;
+			current = current->forward[i].next;
+		}
+		fg->path[i] = current;
+		fg->rank[i] = r;
+	}
+
+	if ((current = current->forward[0].next) != NULL &&
+		sl->cmp(current->key, key) == 0)
+		return current->key;
+	return NULL;
+}
+
+/******************** static function boundary ********************/
+
+/* 
+ * Allocates a node of LVL + 1 forward pointers in one block, 
+ * the key is copied behind the pointers unless the skip list 
+ * holds the caller's keys.
+ */
+static struct skipl_node *
+node_new(const struct skip_list *sl, const void *key, int lvl)
+{
+	struct skipl_node *node;
+	size_t sz;
+
+	sz = sizeof(struct skipl_node) + 
+		(lvl + 1) * sizeof(struct skipl_link);
+	node = (struct skipl_node *)algmalloc(sz + sl->keysize);
+	if (sl->keysize != 0) {
+		node->key = (char *)node + sz;
+		memcpy(node->key, key, sl->keysize);
+	} else
+		node->key = (void *)key;
+
+	return node;
 }
 
 /* 
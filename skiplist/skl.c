@@ -41,7 +41,10 @@ main(int argc, char *argv[])
 {
 	FILE *fp;
 	struct skip_list sl;
-	struct element item, *el;
+	struct skipl_finger fg;
+	struct skipl_node *nptr;
+	struct element item, *el, *sorted;
+	unsigned long n, i;
 	int len, sz = 0;
 	clock_t start_time, end_time;
 	char *fname = NULL, *key = NULL, *rand_key = NULL;
@@ -149,6 +152,37 @@ main(int argc, char *argv[])
 	printf("Search completed, estimated time(s): %.3f\n\n",
 		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
 	
+	printf("The rank of key %s: %lu\n", key, skipl_rank(&sl, &item));
+	el = (struct element *)skipl_select(&sl, SKIPL_SIZE(&sl) / 2);
+	printf("The median key: %s, value: %ld\n\n", el->key, el->value);
+	
+	/* the sorted keys are looked up one by one */
+	sorted = (struct element *)algmalloc(SKIPL_SIZE(&sl) * 
+		sizeof(struct element));
+	n = 0;
+	SKIPL_FOREACH(&sl, nptr, struct element, el)
+		sorted[n++] = *el;
+	
+	printf("Look up %lu sorted keys from the head.\n", n);
+	start_time = clock();
+	for (i = 0; i < n; i++)
+		if (skipl_get(&sl, &sorted[i]) == NULL)
+			errmsg_exit("Key %s is lost.\n", sorted[i].key);
+	end_time = clock();
+	printf("Search completed, estimated time(s): %.3f\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	
+	printf("Look up %lu sorted keys from a finger.\n", n);
+	skipl_finger_init(&fg, &sl);
+	start_time = clock();
+	for (i = 0; i < n; i++)
+		if (skipl_finger_get(&fg, &sorted[i]) == NULL)
+			errmsg_exit("Key %s is lost.\n", sorted[i].key);
+	end_time = clock();
+	printf("Search completed, estimated time(s): %.3f\n\n", 
+		(double)(end_time - start_time) / (double)CLOCKS_PER_SEC);
+	ALGFREE(sorted);
+	
 	printf("Begin delete key: %s\n", key);
 	start_time = clock();
 	skipl_delete(&sl, &item);